@@ -0,0 +1,50 @@
+#include <stan/math/rev.hpp>
+#include <benchmark/benchmark.h>
+
+// Compares gradient() for arguments of dynamic and of fixed size on
+// small functions, where the fixed cost of a call dominates.
+//
+// Build and run with
+//   make benchmarks/gradient_fixed_size
+//   ./benchmarks/gradient_fixed_size
+
+struct sum_of_squares {
+  template <typename T, int N>
+  inline T operator()(const Eigen::Matrix<T, N, 1>& x) const {
+    return stan::math::dot_self(x) + stan::math::exp(x(0));
+  }
+};
+
+template <int N>
+static void gradient_dynamic(benchmark::State& state) {
+  Eigen::VectorXd x = Eigen::VectorXd::LinSpaced(N, 0.1, 1.0);
+  Eigen::VectorXd grad_fx(N);
+  double fx;
+  for (auto _ : state) {
+    stan::math::gradient(sum_of_squares(), x, fx, grad_fx);
+    benchmark::DoNotOptimize(grad_fx.data());
+  }
+}
+
+template <int N>
+static void gradient_fixed(benchmark::State& state) {
+  Eigen::Matrix<double, N, 1> x
+      = Eigen::Matrix<double, N, 1>::LinSpaced(N, 0.1, 1.0);
+  Eigen::Matrix<double, N, 1> grad_fx;
+  double fx;
+  for (auto _ : state) {
+    stan::math::gradient(sum_of_squares(), x, fx, grad_fx);
+    benchmark::DoNotOptimize(grad_fx.data());
+  }
+}
+
+BENCHMARK_TEMPLATE(gradient_dynamic, 2);
+BENCHMARK_TEMPLATE(gradient_fixed, 2);
+BENCHMARK_TEMPLATE(gradient_dynamic, 5);
+BENCHMARK_TEMPLATE(gradient_fixed, 5);
+BENCHMARK_TEMPLATE(gradient_dynamic, 10);
+BENCHMARK_TEMPLATE(gradient_fixed, 10);
+BENCHMARK_TEMPLATE(gradient_dynamic, 20);
+BENCHMARK_TEMPLATE(gradient_fixed, 20);
+
+BENCHMARK_MAIN();
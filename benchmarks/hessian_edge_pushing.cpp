@@ -0,0 +1,75 @@
+// This file builds as its own program, so defining STAN_COMPACT_TAPE here
+// keeps it the same in all its translation units
+#ifndef STAN_COMPACT_TAPE
+#define STAN_COMPACT_TAPE
+#endif
+#include <stan/math/mix.hpp>
+#include <benchmark/benchmark.h>
+
+// Hessian of a log density with 100 to 1600 parameters whose Hessian is
+// sparse (a random walk prior and a shared scale), recorded on the
+// compact tape:
+//
+// - edge_pushing: one evaluation and one second order reverse sweep
+// - forward_over_reverse: one fvar<var> evaluation and one reverse pass
+//   per parameter
+//
+// Run with
+//   make benchmarks/hessian_edge_pushing
+//   ./benchmarks/hessian_edge_pushing
+
+namespace {
+
+struct random_walk_lp {
+  template <typename T>
+  T operator()(const Eigen::Matrix<T, Eigen::Dynamic, 1>& x) const {
+    using stan::math::exp;
+    using stan::math::log;
+    using stan::math::square;
+    const int n = x.size();
+    const T& log_sigma = x(0);
+    const T inv_sigma = exp(-log_sigma);
+    T lp = -(n - 1) * log_sigma;
+    for (int i = 2; i < n; ++i) {
+      lp -= 0.5 * square((x(i) - x(i - 1)) * inv_sigma);
+      lp += log(1.0 + square(x(i)));
+    }
+    return lp;
+  }
+};
+
+template <stan::math::hessian_method Method>
+static void run_hessian(benchmark::State& state) {
+  const Eigen::VectorXd x
+      = Eigen::VectorXd::LinSpaced(state.range(0), -1, 1).array().sin();
+  double fx;
+  Eigen::VectorXd grad;
+  Eigen::MatrixXd H;
+  for (auto _ : state) {
+    stan::math::hessian(random_walk_lp(), x, fx, grad, H, Method);
+    benchmark::DoNotOptimize(H.data());
+  }
+}
+
+}  // namespace
+
+static void edge_pushing(benchmark::State& state) {
+  run_hessian<stan::math::hessian_method::edge_pushing>(state);
+}
+
+static void forward_over_reverse(benchmark::State& state) {
+  run_hessian<stan::math::hessian_method::forward_over_reverse>(state);
+}
+
+BENCHMARK(edge_pushing)
+    ->Arg(100)
+    ->Arg(400)
+    ->Arg(1600)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(forward_over_reverse)
+    ->Arg(100)
+    ->Arg(400)
+    ->Arg(1600)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,83 @@
+// This file builds as its own program, so defining STAN_COMPACT_TAPE here
+// keeps it the same in all its translation units
+#ifndef STAN_COMPACT_TAPE
+#define STAN_COMPACT_TAPE
+#endif
+#include <stan/math/mix.hpp>
+#include <benchmark/benchmark.h>
+
+// Products of the Hessian of a log density with 200 parameters with
+// blocks of 8 to 64 directions, as used by Newton-CG and Lanczos
+// iterations, recorded on the compact tape:
+//
+// - batched: stan::math::hessian_times_vector with a matrix of
+//   directions, one evaluation, then a tangent and a second order
+//   adjoint sweep over its tape per 8 directions
+// - loop: one call of hessian_times_vector per direction
+//
+// Run with
+//   make benchmarks/hessian_times_matrix
+//   ./benchmarks/hessian_times_matrix
+
+namespace {
+
+struct coupled_lp {
+  template <typename T>
+  T operator()(const Eigen::Matrix<T, Eigen::Dynamic, 1>& x) const {
+    using stan::math::exp;
+    using stan::math::log;
+    using stan::math::square;
+    const int n = x.size();
+    T lp = 0;
+    for (int i = 0; i < n; ++i) {
+      const T& a = x(i);
+      const T& b = x((i + 1) % n);
+      const T& c = x((i + 7) % n);
+      lp -= 0.5 * square(a - b) * exp(0.1 * c);
+      lp -= log(1.0 + square(a));
+    }
+    return lp;
+  }
+};
+
+constexpr int num_parameters = 200;
+
+Eigen::MatrixXd directions(int num_directions) {
+  return Eigen::MatrixXd::Random(num_parameters, num_directions);
+}
+
+}  // namespace
+
+static void batched(benchmark::State& state) {
+  const Eigen::VectorXd x
+      = Eigen::VectorXd::LinSpaced(num_parameters, -1, 1);
+  const Eigen::MatrixXd V = directions(state.range(0));
+  double fx;
+  Eigen::MatrixXd HV;
+  for (auto _ : state) {
+    stan::math::hessian_times_vector(coupled_lp(), x, V, fx, HV);
+    benchmark::DoNotOptimize(HV.data());
+  }
+}
+
+static void loop(benchmark::State& state) {
+  const Eigen::VectorXd x
+      = Eigen::VectorXd::LinSpaced(num_parameters, -1, 1);
+  const Eigen::MatrixXd V = directions(state.range(0));
+  double fx;
+  Eigen::VectorXd Hv;
+  Eigen::MatrixXd HV(V.rows(), V.cols());
+  for (auto _ : state) {
+    for (int j = 0; j < V.cols(); ++j) {
+      stan::math::hessian_times_vector(coupled_lp(), x,
+                                       Eigen::VectorXd(V.col(j)), fx, Hv);
+      HV.col(j) = Hv;
+    }
+    benchmark::DoNotOptimize(HV.data());
+  }
+}
+
+BENCHMARK(batched)->Arg(8)->Arg(16)->Arg(64)->Unit(benchmark::kMicrosecond);
+BENCHMARK(loop)->Arg(8)->Arg(16)->Arg(64)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,76 @@
+// This file builds as its own program, so defining STAN_COMPACT_TAPE here
+// keeps it the same in all its translation units
+#ifndef STAN_COMPACT_TAPE
+#define STAN_COMPACT_TAPE
+#endif
+#include <stan/math.hpp>
+#include <benchmark/benchmark.h>
+
+// Jacobian of a system of equations with 50 to 200 outputs, as they are
+// solved by the algebraic solvers, recorded on the compact tape:
+//
+// - lanes: stan::math::jacobian, 8 rows per reverse sweep
+// - reverse_passes: one reverse pass per row
+//
+// Run with
+//   make benchmarks/jacobian_lanes
+//   ./benchmarks/jacobian_lanes
+
+namespace {
+
+struct system_fun {
+  template <typename T>
+  Eigen::Matrix<T, Eigen::Dynamic, 1> operator()(
+      const Eigen::Matrix<T, Eigen::Dynamic, 1>& x) const {
+    using stan::math::exp;
+    using stan::math::square;
+    const int n = x.size();
+    Eigen::Matrix<T, Eigen::Dynamic, 1> y(n);
+    for (int i = 0; i < n; ++i) {
+      T sum = 0.0;
+      for (int j = 0; j < 8; ++j) {
+        sum = sum + x((i + j) % n) * x((i + 3 * j + 1) % n);
+      }
+      y(i) = exp(-square(x(i))) + sum / (1.0 + square(x((i + 1) % n)));
+    }
+    return y;
+  }
+};
+
+}  // namespace
+
+static void lanes(benchmark::State& state) {
+  const Eigen::VectorXd x = Eigen::VectorXd::LinSpaced(state.range(0), 0, 1);
+  Eigen::VectorXd fx;
+  Eigen::MatrixXd J;
+  for (auto _ : state) {
+    stan::math::jacobian(system_fun(), x, fx, J);
+    benchmark::DoNotOptimize(J.data());
+  }
+}
+
+static void reverse_passes(benchmark::State& state) {
+  using stan::math::var;
+  const Eigen::VectorXd x = Eigen::VectorXd::LinSpaced(state.range(0), 0, 1);
+  Eigen::MatrixXd J(x.size(), x.size());
+  for (auto _ : state) {
+    stan::math::nested_rev_autodiff nested;
+    Eigen::Matrix<var, Eigen::Dynamic, 1> x_var(x);
+    Eigen::Matrix<var, Eigen::Dynamic, 1> y = system_fun()(x_var);
+    for (int i = 0; i < y.size(); ++i) {
+      nested.set_zero_all_adjoints();
+      stan::math::grad(y(i).vi_);
+      J.row(i) = x_var.adj();
+    }
+    benchmark::DoNotOptimize(J.data());
+  }
+}
+
+BENCHMARK(lanes)->Arg(50)->Arg(100)->Arg(200)->Unit(benchmark::kMicrosecond);
+BENCHMARK(reverse_passes)
+    ->Arg(50)
+    ->Arg(100)
+    ->Arg(200)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,124 @@
+#include <stan/math.hpp>
+#include <benchmark/benchmark.h>
+#include <tbb/task_arena.h>
+#include <ostream>
+#include <vector>
+
+// Scaling of a two-level hierarchical model whose groups are summed in
+// parallel by reduce_sum or map_rect and whose observations within a
+// group are summed in parallel by a nested reduce_sum, sharing one TBB
+// arena of the given number of threads.
+//
+// Build with STAN_THREADS=true in make/local and run with
+//   make benchmarks/nested_parallelism
+//   ./benchmarks/nested_parallelism
+
+namespace {
+
+constexpr int num_groups = 64;
+constexpr int num_obs = 2000;
+
+struct obs_lpdf {
+  template <typename T1, typename T2>
+  stan::return_type_t<T1, T2> operator()(const std::vector<double>& y_slice,
+                                         std::size_t start, std::size_t end,
+                                         std::ostream* msgs, const T1& mu,
+                                         const T2& sigma) const {
+    return stan::math::normal_lpdf(y_slice, mu, sigma);
+  }
+};
+
+struct groups_lpdf {
+  template <typename T1, typename T2>
+  stan::return_type_t<T1, T2> operator()(
+      const std::vector<int>& group_slice, std::size_t start, std::size_t end,
+      std::ostream* msgs, const std::vector<std::vector<double>>& y,
+      const std::vector<T1>& mu, const T2& sigma) const {
+    stan::return_type_t<T1, T2> lp = 0;
+    for (int g : group_slice) {
+      lp += stan::math::reduce_sum<obs_lpdf>(y[g], 100, msgs, mu[g], sigma);
+    }
+    return lp;
+  }
+};
+
+struct group_job {
+  template <typename T1, typename T2>
+  Eigen::Matrix<stan::return_type_t<T1, T2>, Eigen::Dynamic, 1> operator()(
+      const Eigen::Matrix<T1, Eigen::Dynamic, 1>& sigma,
+      const Eigen::Matrix<T2, Eigen::Dynamic, 1>& mu,
+      const std::vector<double>& y, const std::vector<int>& x_i,
+      std::ostream* msgs) const {
+    Eigen::Matrix<stan::return_type_t<T1, T2>, Eigen::Dynamic, 1> lp(1);
+    lp(0) = stan::math::reduce_sum<obs_lpdf>(y, 100, msgs, mu(0), sigma(0));
+    return lp;
+  }
+};
+
+std::vector<std::vector<double>> make_data() {
+  std::vector<std::vector<double>> y(num_groups, std::vector<double>(num_obs));
+  for (int g = 0; g < num_groups; ++g) {
+    for (int i = 0; i < num_obs; ++i) {
+      y[g][i] = 0.01 * g + 0.001 * i;
+    }
+  }
+  return y;
+}
+
+}  // namespace
+
+STAN_REGISTER_MAP_RECT(0, group_job)
+
+static void reduce_sum_in_reduce_sum(benchmark::State& state) {
+  using stan::math::var;
+  const auto y = make_data();
+  std::vector<int> groups(num_groups);
+  for (int g = 0; g < num_groups; ++g) {
+    groups[g] = g;
+  }
+  tbb::task_arena arena(state.range(0));
+  for (auto _ : state) {
+    arena.execute([&] {
+      std::vector<var> mu(num_groups, 0.5);
+      var sigma = 1.2;
+      var lp = stan::math::reduce_sum<groups_lpdf>(groups, 1, nullptr, y, mu,
+                                                   sigma);
+      lp.grad();
+      benchmark::DoNotOptimize(sigma.adj());
+      stan::math::recover_memory();
+    });
+  }
+}
+
+static void reduce_sum_in_map_rect(benchmark::State& state) {
+  using stan::math::var;
+  const auto y = make_data();
+  const std::vector<std::vector<int>> x_i(num_groups, std::vector<int>(0));
+  tbb::task_arena arena(state.range(0));
+  for (auto _ : state) {
+    arena.execute([&] {
+      Eigen::Matrix<var, Eigen::Dynamic, 1> sigma(1);
+      sigma << 1.2;
+      std::vector<Eigen::Matrix<var, Eigen::Dynamic, 1>> mu(
+          num_groups, Eigen::Matrix<var, Eigen::Dynamic, 1>::Constant(1, 0.5));
+      var lp = stan::math::sum(
+          stan::math::map_rect<0, group_job>(sigma, mu, y, x_i));
+      lp.grad();
+      benchmark::DoNotOptimize(sigma(0).adj());
+      stan::math::recover_memory();
+    });
+  }
+}
+
+BENCHMARK(reduce_sum_in_reduce_sum)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(reduce_sum_in_map_rect)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,82 @@
+#include <stan/math.hpp>
+#include <benchmark/benchmark.h>
+
+// Solves with sensitivities of a damped oscillator observed at 100 to
+// 10000 times, as for densely sampled observations:
+//
+// - ckrk_dense, rk45_dense: adaptive steps, states and sensitivities at the
+//   output times from the interpolant of the steps
+// - ckrk_steps, rk45_steps: every output time ends a step
+//
+// Run with
+//   make benchmarks/ode_dense_output
+//   ./benchmarks/ode_dense_output
+
+namespace {
+
+struct damped_oscillator {
+  template <typename T0, typename T_y, typename T_theta>
+  Eigen::Matrix<stan::return_type_t<T0, T_y, T_theta>, Eigen::Dynamic, 1>
+  operator()(const T0& t, const Eigen::Matrix<T_y, Eigen::Dynamic, 1>& y,
+             std::ostream* msgs, const T_theta& theta) const {
+    Eigen::Matrix<stan::return_type_t<T0, T_y, T_theta>, Eigen::Dynamic, 1>
+        dy_dt(2);
+    dy_dt << y(1), -theta(1) * y(0) - theta(0) * y(1);
+    return dy_dt;
+  }
+};
+
+void solve(benchmark::State& state, bool cash_karp, bool dense_output) {
+  using stan::math::var;
+  const int n = state.range(0);
+  std::vector<double> ts(n);
+  for (int i = 0; i < n; ++i) {
+    ts[i] = 20.0 * (i + 1) / n;
+  }
+  Eigen::VectorXd y0(2);
+  y0 << 1.0, 0.0;
+  stan::math::ode_rk_control control;
+  control.dense_output = dense_output;
+  for (auto _ : state) {
+    Eigen::Matrix<var, Eigen::Dynamic, 1> theta(2);
+    theta << 0.1, 2.0;
+    auto y = cash_karp
+                 ? stan::math::ode_ckrk_tol(damped_oscillator(), y0, 0.0, ts,
+                                            control, nullptr, theta)
+                 : stan::math::ode_rk45_tol(damped_oscillator(), y0, 0.0, ts,
+                                            control, nullptr, theta);
+    benchmark::DoNotOptimize(y.back()(0).val());
+    stan::math::recover_memory();
+  }
+}
+
+}  // namespace
+
+static void ckrk_dense(benchmark::State& state) { solve(state, true, true); }
+
+static void ckrk_steps(benchmark::State& state) { solve(state, true, false); }
+
+static void rk45_dense(benchmark::State& state) { solve(state, false, true); }
+
+static void rk45_steps(benchmark::State& state) {
+  solve(state, false, false);
+}
+
+BENCHMARK(ckrk_dense)
+    ->RangeMultiplier(10)
+    ->Range(100, 10000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(ckrk_steps)
+    ->RangeMultiplier(10)
+    ->Range(100, 10000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(rk45_dense)
+    ->RangeMultiplier(10)
+    ->Range(100, 10000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(rk45_steps)
+    ->RangeMultiplier(10)
+    ->Range(100, 10000)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
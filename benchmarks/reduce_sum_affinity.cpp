@@ -0,0 +1,119 @@
+#include <stan/math.hpp>
+#include <benchmark/benchmark.h>
+#include <tbb/task_arena.h>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+// Memory-bound reduce_sum likelihood, a normal with one location
+// parameter per observation, evaluated by the given number of threads:
+//
+// - unpinned: workers placed by the operating system
+// - pinned_cores: every worker pinned to one core
+// - pinned_numa: every worker pinned to the cores of one NUMA node
+// - per_node_chains: one chain per NUMA node, run concurrently in the
+//   arena of its node (see stan::math::numa_task_arenas)
+//
+// Build with STAN_THREADS=true in make/local and run with
+//   make benchmarks/reduce_sum_affinity
+//   ./benchmarks/reduce_sum_affinity
+
+namespace {
+
+constexpr int num_obs = 1 << 20;
+
+struct normal_lpdf_partial {
+  template <typename T1, typename T2>
+  stan::return_type_t<T1, T2> operator()(const std::vector<T1>& mu_slice,
+                                         std::size_t start, std::size_t end,
+                                         std::ostream* msgs,
+                                         const std::vector<double>& y,
+                                         const T2& sigma) const {
+    const std::vector<double> y_slice(y.begin() + start, y.begin() + end + 1);
+    return stan::math::normal_lpdf(y_slice, mu_slice, sigma);
+  }
+};
+
+std::vector<double> make_data() {
+  std::vector<double> y(num_obs);
+  for (int i = 0; i < num_obs; ++i) {
+    y[i] = 0.001 * (i % 1000);
+  }
+  return y;
+}
+
+void run_chain(const std::vector<double>& y) {
+  using stan::math::var;
+  std::vector<var> mu(y.size(), 0.5);
+  var sigma = 1.2;
+  var lp = stan::math::reduce_sum<normal_lpdf_partial>(mu, 1024, nullptr, y,
+                                                       sigma);
+  lp.grad();
+  benchmark::DoNotOptimize(sigma.adj());
+  stan::math::recover_memory();
+}
+
+void run_pinned(benchmark::State& state, stan::math::thread_affinity affinity) {
+  const auto y = make_data();
+  std::vector<int> cpus;
+  for (const auto& node : stan::math::numa_topology()) {
+    cpus.insert(cpus.end(), node.cpus_.begin(), node.cpus_.end());
+  }
+  tbb::task_arena arena(state.range(0));
+  stan::math::thread_affinity_observer observer(arena, cpus, affinity);
+  for (auto _ : state) {
+    arena.execute([&] { run_chain(y); });
+  }
+}
+
+}  // namespace
+
+static void unpinned(benchmark::State& state) {
+  run_pinned(state, stan::math::thread_affinity::none);
+}
+
+static void pinned_cores(benchmark::State& state) {
+  run_pinned(state, stan::math::thread_affinity::cores);
+}
+
+static void pinned_numa(benchmark::State& state) {
+  run_pinned(state, stan::math::thread_affinity::numa);
+}
+
+static void per_node_chains(benchmark::State& state) {
+  const auto y = make_data();
+  stan::math::numa_task_arenas arenas(stan::math::numa_topology(),
+                                      stan::math::thread_affinity::cores);
+  for (auto _ : state) {
+    std::vector<std::thread> chains;
+    for (size_t i = 0; i < arenas.size(); ++i) {
+      chains.emplace_back([&, i] {
+        stan::math::ChainableStack thread_tape;
+        arenas[i].execute([&] { run_chain(y); });
+      });
+    }
+    for (auto& chain : chains) {
+      chain.join();
+    }
+  }
+  state.counters["chains"] = arenas.size();
+}
+
+BENCHMARK(unpinned)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(pinned_cores)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(pinned_numa)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(per_node_chains)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
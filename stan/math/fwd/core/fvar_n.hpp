@@ -0,0 +1,169 @@
+#ifndef STAN_MATH_FWD_CORE_FVAR_N_HPP
+#define STAN_MATH_FWD_CORE_FVAR_N_HPP
+
+#include <stan/math/prim/meta.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <ostream>
+#include <type_traits>
+
+namespace stan {
+namespace math {
+
+/**
+ * Scalar for forward-mode automatic differentiation in `N` directions
+ * at once. Like `fvar<T>` it holds a value, but its tangent is a
+ * vector of the `N` directional derivatives, so that one evaluation of
+ * a function computes the derivatives that `fvar<T>` computes with `N`
+ * evaluations. The tangents of an operation are computed by a single
+ * vector operation of size `N`.
+ *
+ * The tangent is an unaligned fixed-size Eigen array, so that the
+ * variables can be stored in any container.
+ *
+ * With `T = var` it computes `N` rows of a Hessian with one evaluation
+ * of the function; see `hessian<N>()`.
+ *
+ * @tparam T type of value and of the elements of the tangent
+ * @tparam N number of directions
+ */
+template <typename T, int N>
+struct fvar_n {
+  static_assert(N > 0, "fvar_n needs at least one direction");
+
+  /**
+   * Type of the tangent.
+   */
+  using tangent_t = Eigen::Array<T, N, 1, Eigen::DontAlign>;
+
+  /**
+   * The type of values and tangents.
+   */
+  using Scalar = T;
+
+  /**
+   * The value of this variable.
+   */
+  T val_;
+
+  /**
+   * The tangents (directional derivatives) of this variable.
+   */
+  tangent_t d_;
+
+  /**
+   * Return the value of this variable.
+   */
+  T val() const { return val_; }
+
+  /**
+   * Return the tangents of this variable.
+   */
+  const tangent_t& tangent() const { return d_; }
+
+  /**
+   * Construct a variable with zero value and tangents.
+   */
+  fvar_n() : val_(0), d_(tangent_t::Zero()) {}
+
+  fvar_n(const fvar_n<T, N>& x) = default;
+
+  /**
+   * Construct a variable with the specified value and zero tangents.
+   *
+   * @tparam V type of value, promotable to `T`
+   * @param[in] v value
+   */
+  template <typename V, typename = std::enable_if_t<ad_promotable<V, T>::value>>
+  fvar_n(const V& v) : val_(v), d_(tangent_t::Zero()) {}  // NOLINT
+
+  /**
+   * Construct a variable with the specified value and tangents.
+   *
+   * @tparam V type of value, promotable to `T`
+   * @tparam D type of tangents, an Eigen expression of size `N`
+   * @param[in] v value
+   * @param[in] d tangents
+   */
+  template <typename V, typename D>
+  fvar_n(const V& v, const D& d) : val_(v), d_(d) {}
+
+  /**
+   * Construct a variable with the specified value whose tangent is one
+   * in the specified direction and zero in the others.
+   *
+   * @param[in] v value
+   * @param[in] direction direction, in `[0, N)`, or -1 for none
+   * @return variable
+   */
+  static fvar_n<T, N> unit(const T& v, int direction) {
+    fvar_n<T, N> x(v);
+    if (direction >= 0) {
+      x.d_(direction) = 1;
+    }
+    return x;
+  }
+
+  fvar_n<T, N>& operator=(const fvar_n<T, N>& x) = default;
+
+  inline fvar_n<T, N>& operator+=(const fvar_n<T, N>& x2) {
+    val_ += x2.val_;
+    d_ += x2.d_;
+    return *this;
+  }
+
+  inline fvar_n<T, N>& operator+=(double x2) {
+    val_ += x2;
+    return *this;
+  }
+
+  inline fvar_n<T, N>& operator-=(const fvar_n<T, N>& x2) {
+    val_ -= x2.val_;
+    d_ -= x2.d_;
+    return *this;
+  }
+
+  inline fvar_n<T, N>& operator-=(double x2) {
+    val_ -= x2;
+    return *this;
+  }
+
+  inline fvar_n<T, N>& operator*=(const fvar_n<T, N>& x2) {
+    d_ = d_ * x2.val_ + val_ * x2.d_;
+    val_ *= x2.val_;
+    return *this;
+  }
+
+  inline fvar_n<T, N>& operator*=(double x2) {
+    val_ *= x2;
+    d_ *= x2;
+    return *this;
+  }
+
+  inline fvar_n<T, N>& operator/=(const fvar_n<T, N>& x2) {
+    const T inv_x2 = 1 / x2.val_;
+    val_ *= inv_x2;
+    d_ = (d_ - val_ * x2.d_) * inv_x2;
+    return *this;
+  }
+
+  inline fvar_n<T, N>& operator/=(double x2) {
+    val_ /= x2;
+    d_ /= x2;
+    return *this;
+  }
+
+  /**
+   * Write the value and tangents of the variable to the stream.
+   *
+   * @param[in, out] os stream
+   * @param[in] v variable
+   * @return stream
+   */
+  friend std::ostream& operator<<(std::ostream& os, const fvar_n<T, N>& v) {
+    return os << v.val_ << ':' << v.d_.transpose();
+  }
+};
+
+}  // namespace math
+}  // namespace stan
+#endif
@@ -0,0 +1,301 @@
+#ifndef STAN_MATH_FWD_CORE_FVAR_N_OPERATORS_HPP
+#define STAN_MATH_FWD_CORE_FVAR_N_OPERATORS_HPP
+
+#include <stan/math/prim/meta.hpp>
+#include <stan/math/fwd/core/fvar_n.hpp>
+
+namespace stan {
+namespace math {
+
+/**
+ * Return the sum of the two arguments.
+ *
+ * @tparam T value and tangent type for variables
+ * @tparam N number of directions
+ * @param[in] x first argument
+ * @param[in] y second argument
+ * @return sum of arguments
+ */
+template <typename T, int N>
+inline fvar_n<T, N> operator+(const fvar_n<T, N>& x, const fvar_n<T, N>& y) {
+  return fvar_n<T, N>(x.val_ + y.val_, x.d_ + y.d_);
+}
+
+template <typename T, int N, typename U, require_arithmetic_t<U>* = nullptr>
+inline fvar_n<T, N> operator+(const fvar_n<T, N>& x, U y) {
+  return fvar_n<T, N>(x.val_ + y, x.d_);
+}
+
+template <typename T, int N, typename U, require_arithmetic_t<U>* = nullptr>
+inline fvar_n<T, N> operator+(U x, const fvar_n<T, N>& y) {
+  return fvar_n<T, N>(x + y.val_, y.d_);
+}
+
+/**
+ * Return the difference of the two arguments.
+ *
+ * @tparam T value and tangent type for variables
+ * @tparam N number of directions
+ * @param[in] x first argument
+ * @param[in] y second argument
+ * @return difference of arguments
+ */
+template <typename T, int N>
+inline fvar_n<T, N> operator-(const fvar_n<T, N>& x, const fvar_n<T, N>& y) {
+  return fvar_n<T, N>(x.val_ - y.val_, x.d_ - y.d_);
+}
+
+template <typename T, int N, typename U, require_arithmetic_t<U>* = nullptr>
+inline fvar_n<T, N> operator-(const fvar_n<T, N>& x, U y) {
+  return fvar_n<T, N>(x.val_ - y, x.d_);
+}
+
+template <typename T, int N, typename U, require_arithmetic_t<U>* = nullptr>
+inline fvar_n<T, N> operator-(U x, const fvar_n<T, N>& y) {
+  return fvar_n<T, N>(x - y.val_, -y.d_);
+}
+
+/**
+ * Return the product of the two arguments.
+ *
+ * @tparam T value and tangent type for variables
+ * @tparam N number of directions
+ * @param[in] x first argument
+ * @param[in] y second argument
+ * @return product of arguments
+ */
+template <typename T, int N>
+inline fvar_n<T, N> operator*(const fvar_n<T, N>& x, const fvar_n<T, N>& y) {
+  return fvar_n<T, N>(x.val_ * y.val_, x.d_ * y.val_ + x.val_ * y.d_);
+}
+
+template <typename T, int N, typename U, require_arithmetic_t<U>* = nullptr>
+inline fvar_n<T, N> operator*(const fvar_n<T, N>& x, U y) {
+  return fvar_n<T, N>(x.val_ * y, x.d_ * static_cast<double>(y));
+}
+
+template <typename T, int N, typename U, require_arithmetic_t<U>* = nullptr>
+inline fvar_n<T, N> operator*(U x, const fvar_n<T, N>& y) {
+  return fvar_n<T, N>(x * y.val_, static_cast<double>(x) * y.d_);
+}
+
+/**
+ * Return the quotient of the two arguments.
+ *
+ * @tparam T value and tangent type for variables
+ * @tparam N number of directions
+ * @param[in] x first argument
+ * @param[in] y second argument
+ * @return quotient of arguments
+ */
+template <typename T, int N>
+inline fvar_n<T, N> operator/(const fvar_n<T, N>& x, const fvar_n<T, N>& y) {
+  const T inv_y = 1 / y.val_;
+  const T val = x.val_ * inv_y;
+  return fvar_n<T, N>(val, (x.d_ - val * y.d_) * inv_y);
+}
+
+template <typename T, int N, typename U, require_arithmetic_t<U>* = nullptr>
+inline fvar_n<T, N> operator/(const fvar_n<T, N>& x, U y) {
+  return fvar_n<T, N>(x.val_ / y, x.d_ / static_cast<double>(y));
+}
+
+template <typename T, int N, typename U, require_arithmetic_t<U>* = nullptr>
+inline fvar_n<T, N> operator/(U x, const fvar_n<T, N>& y) {
+  const T inv_y = 1 / y.val_;
+  const T val = x * inv_y;
+  return fvar_n<T, N>(val, -val * inv_y * y.d_);
+}
+
+/**
+ * Return the negation of the argument.
+ *
+ * @tparam T value and tangent type for variables
+ * @tparam N number of directions
+ * @param[in] x argument
+ * @return negation of argument
+ */
+template <typename T, int N>
+inline fvar_n<T, N> operator-(const fvar_n<T, N>& x) {
+  return fvar_n<T, N>(-x.val_, -x.d_);
+}
+
+/**
+ * Return the argument.
+ *
+ * @tparam T value and tangent type for variables
+ * @tparam N number of directions
+ * @param[in] x argument
+ * @return argument
+ */
+template <typename T, int N>
+inline fvar_n<T, N> operator+(const fvar_n<T, N>& x) {
+  return x;
+}
+
+/**
+ * Return the logical negation of the value of the argument.
+ *
+ * @tparam T value and tangent type for variables
+ * @tparam N number of directions
+ * @param[in] x argument
+ * @return true if the value of the argument is zero
+ */
+template <typename T, int N>
+inline bool operator!(const fvar_n<T, N>& x) {
+  return !x.val_;
+}
+
+/**
+ * Return true if the value of the first argument is less than the value
+ * of the second argument.
+ *
+ * @tparam T value and tangent type for variables
+ * @tparam N number of directions
+ * @param[in] x first argument
+ * @param[in] y second argument
+ * @return comparison of the values of the arguments
+ */
+template <typename T, int N>
+inline bool operator<(const fvar_n<T, N>& x, const fvar_n<T, N>& y) {
+  return x.val_ < y.val_;
+}
+
+template <typename T, int N, typename U, require_arithmetic_t<U>* = nullptr>
+inline bool operator<(const fvar_n<T, N>& x, U y) {
+  return x.val_ < y;
+}
+
+template <typename T, int N, typename U, require_arithmetic_t<U>* = nullptr>
+inline bool operator<(U x, const fvar_n<T, N>& y) {
+  return x < y.val_;
+}
+
+/**
+ * Return true if the value of the first argument is less than or equal
+ * to the value of the second argument.
+ *
+ * @tparam T value and tangent type for variables
+ * @tparam N number of directions
+ * @param[in] x first argument
+ * @param[in] y second argument
+ * @return comparison of the values of the arguments
+ */
+template <typename T, int N>
+inline bool operator<=(const fvar_n<T, N>& x, const fvar_n<T, N>& y) {
+  return x.val_ <= y.val_;
+}
+
+template <typename T, int N, typename U, require_arithmetic_t<U>* = nullptr>
+inline bool operator<=(const fvar_n<T, N>& x, U y) {
+  return x.val_ <= y;
+}
+
+template <typename T, int N, typename U, require_arithmetic_t<U>* = nullptr>
+inline bool operator<=(U x, const fvar_n<T, N>& y) {
+  return x <= y.val_;
+}
+
+/**
+ * Return true if the value of the first argument is greater than the
+ * value of the second argument.
+ *
+ * @tparam T value and tangent type for variables
+ * @tparam N number of directions
+ * @param[in] x first argument
+ * @param[in] y second argument
+ * @return comparison of the values of the arguments
+ */
+template <typename T, int N>
+inline bool operator>(const fvar_n<T, N>& x, const fvar_n<T, N>& y) {
+  return x.val_ > y.val_;
+}
+
+template <typename T, int N, typename U, require_arithmetic_t<U>* = nullptr>
+inline bool operator>(const fvar_n<T, N>& x, U y) {
+  return x.val_ > y;
+}
+
+template <typename T, int N, typename U, require_arithmetic_t<U>* = nullptr>
+inline bool operator>(U x, const fvar_n<T, N>& y) {
+  return x > y.val_;
+}
+
+/**
+ * Return true if the value of the first argument is greater than or
+ * equal to the value of the second argument.
+ *
+ * @tparam T value and tangent type for variables
+ * @tparam N number of directions
+ * @param[in] x first argument
+ * @param[in] y second argument
+ * @return comparison of the values of the arguments
+ */
+template <typename T, int N>
+inline bool operator>=(const fvar_n<T, N>& x, const fvar_n<T, N>& y) {
+  return x.val_ >= y.val_;
+}
+
+template <typename T, int N, typename U, require_arithmetic_t<U>* = nullptr>
+inline bool operator>=(const fvar_n<T, N>& x, U y) {
+  return x.val_ >= y;
+}
+
+template <typename T, int N, typename U, require_arithmetic_t<U>* = nullptr>
+inline bool operator>=(U x, const fvar_n<T, N>& y) {
+  return x >= y.val_;
+}
+
+/**
+ * Return true if the value of the first argument is equal to the value
+ * of the second argument.
+ *
+ * @tparam T value and tangent type for variables
+ * @tparam N number of directions
+ * @param[in] x first argument
+ * @param[in] y second argument
+ * @return comparison of the values of the arguments
+ */
+template <typename T, int N>
+inline bool operator==(const fvar_n<T, N>& x, const fvar_n<T, N>& y) {
+  return x.val_ == y.val_;
+}
+
+template <typename T, int N, typename U, require_arithmetic_t<U>* = nullptr>
+inline bool operator==(const fvar_n<T, N>& x, U y) {
+  return x.val_ == y;
+}
+
+template <typename T, int N, typename U, require_arithmetic_t<U>* = nullptr>
+inline bool operator==(U x, const fvar_n<T, N>& y) {
+  return x == y.val_;
+}
+
+/**
+ * Return true if the value of the first argument is not equal to the
+ * value of the second argument.
+ *
+ * @tparam T value and tangent type for variables
+ * @tparam N number of directions
+ * @param[in] x first argument
+ * @param[in] y second argument
+ * @return comparison of the values of the arguments
+ */
+template <typename T, int N>
+inline bool operator!=(const fvar_n<T, N>& x, const fvar_n<T, N>& y) {
+  return x.val_ != y.val_;
+}
+
+template <typename T, int N, typename U, require_arithmetic_t<U>* = nullptr>
+inline bool operator!=(const fvar_n<T, N>& x, U y) {
+  return x.val_ != y;
+}
+
+template <typename T, int N, typename U, require_arithmetic_t<U>* = nullptr>
+inline bool operator!=(U x, const fvar_n<T, N>& y) {
+  return x != y.val_;
+}
+
+}  // namespace math
+}  // namespace stan
+#endif
@@ -54,6 +54,71 @@ struct NumTraits<stan::math::fvar<T>> : GenericNumTraits<stan::math::fvar<T>> {
   static int digits10() { return std::numeric_limits<double>::digits10; }
 };
 
+/**
+ * Numerical traits template override for Eigen for multi-directional
+ * forward variables.
+ */
+template <typename T, int N>
+struct NumTraits<stan::math::fvar_n<T, N>>
+    : GenericNumTraits<stan::math::fvar_n<T, N>> {
+  enum {
+    /**
+     * stan::math::fvar_n requires initialization
+     */
+    RequireInitialization = 1,
+
+    /**
+     * cost to copy the value and the N tangents
+     */
+    ReadCost = (N + 1) * NumTraits<double>::ReadCost,
+
+    /**
+     * (N + 1) * AddCost
+     */
+    AddCost = (N + 1) * NumTraits<T>::AddCost,
+
+    /**
+     * (2 * N + 1) * MulCost + N * AddCost
+     */
+    MulCost = (2 * N + 1) * NumTraits<T>::MulCost + N * NumTraits<T>::AddCost
+  };
+
+  /**
+   * Return the number of decimal digits that can be represented
+   * without change.  Delegates to
+   * <code>std::numeric_limits<double>::digits10()</code>.
+   */
+  static int digits10() { return std::numeric_limits<double>::digits10; }
+};
+
+/**
+ * Traits specialization for Eigen binary operations for
+ * multi-directional forward variables and `double` arguments.
+ *
+ * @tparam T value and tangent type of the variable
+ * @tparam N number of directions
+ * @tparam BinaryOp type of binary operation for which traits are
+ * defined
+ */
+template <typename T, int N, typename BinaryOp>
+struct ScalarBinaryOpTraits<stan::math::fvar_n<T, N>, double, BinaryOp> {
+  using ReturnType = stan::math::fvar_n<T, N>;
+};
+
+/**
+ * Traits specialization for Eigen binary operations for `double` and
+ * multi-directional forward variables.
+ *
+ * @tparam T value and tangent type of the variable
+ * @tparam N number of directions
+ * @tparam BinaryOp type of binary operation for which traits are
+ * defined
+ */
+template <typename T, int N, typename BinaryOp>
+struct ScalarBinaryOpTraits<double, stan::math::fvar_n<T, N>, BinaryOp> {
+  using ReturnType = stan::math::fvar_n<T, N>;
+};
+
 /**
  * Traits specialization for Eigen binary operations for autodiff and
  * `double` arguments.
@@ -29,6 +29,20 @@ inline std::complex<fvar<T>> atan(const std::complex<fvar<T>>& z) {
   return internal::complex_atan(z);
 }
 
+/**
+ * Return the arc tangent of the specified multi-directional variable.
+ *
+ * @tparam T value and tangent type of the variable
+ * @tparam N number of directions
+ * @param x argument
+ * @return the arc tangent of the argument
+ */
+template <typename T, int N>
+inline fvar_n<T, N> atan(const fvar_n<T, N>& x) {
+  using std::atan;
+  return fvar_n<T, N>(atan(x.val_), x.d_ / (1 + square(x.val_)));
+}
+
 }  // namespace math
 }  // namespace stan
 #endif
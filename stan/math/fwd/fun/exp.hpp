@@ -27,6 +27,21 @@ inline std::complex<fvar<T>> exp(const std::complex<fvar<T>>& z) {
   return internal::complex_exp(z);
 }
 
+/**
+ * Return the exponential of the specified multi-directional variable.
+ *
+ * @tparam T value and tangent type of the variable
+ * @tparam N number of directions
+ * @param x argument
+ * @return the exponential of the argument
+ */
+template <typename T, int N>
+inline fvar_n<T, N> exp(const fvar_n<T, N>& x) {
+  using std::exp;
+  const T exp_x = exp(x.val_);
+  return fvar_n<T, N>(exp_x, x.d_ * exp_x);
+}
+
 }  // namespace math
 }  // namespace stan
 #endif
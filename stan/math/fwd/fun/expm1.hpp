@@ -15,6 +15,20 @@ inline fvar<T> expm1(const fvar<T>& x) {
   return fvar<T>(expm1(x.val_), x.d_ * exp(x.val_));
 }
 
+/**
+ * Return the exponential minus one of the specified multi-directional variable.
+ *
+ * @tparam T value and tangent type of the variable
+ * @tparam N number of directions
+ * @param x argument
+ * @return the exponential minus one of the argument
+ */
+template <typename T, int N>
+inline fvar_n<T, N> expm1(const fvar_n<T, N>& x) {
+  using std::exp;
+  return fvar_n<T, N>(expm1(x.val_), x.d_ * exp(x.val_));
+}
+
 }  // namespace math
 }  // namespace stan
 #endif
@@ -26,6 +26,22 @@ inline fvar<T> fabs(const fvar<T>& x) {
   }
 }
 
+/**
+ * Return the absolute value of the specified multi-directional variable.
+ *
+ * @tparam T value and tangent type of the variable
+ * @tparam N number of directions
+ * @param x argument
+ * @return the absolute value of the argument
+ */
+template <typename T, int N>
+inline fvar_n<T, N> fabs(const fvar_n<T, N>& x) {
+  if (x.val_ < 0) {
+    return -x;
+  }
+  return x;
+}
+
 }  // namespace math
 }  // namespace stan
 #endif
@@ -12,6 +12,20 @@ template <typename T>
 inline fvar<T> inv(const fvar<T>& x) {
   return fvar<T>(1 / x.val_, -x.d_ / square(x.val_));
 }
+/**
+ * Return the inverse of the specified multi-directional variable.
+ *
+ * @tparam T value and tangent type of the variable
+ * @tparam N number of directions
+ * @param x argument
+ * @return the inverse of the argument
+ */
+template <typename T, int N>
+inline fvar_n<T, N> inv(const fvar_n<T, N>& x) {
+  const T inv_x = 1 / x.val_;
+  return fvar_n<T, N>(inv_x, x.d_ * -(inv_x * inv_x));
+}
+
 }  // namespace math
 }  // namespace stan
 #endif
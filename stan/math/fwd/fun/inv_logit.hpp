@@ -24,6 +24,21 @@ inline fvar<T> inv_logit(const fvar<T>& x) {
                  x.d_ * inv_logit(x.val_) * (1 - inv_logit(x.val_)));
 }
 
+/**
+ * Return the inverse logit of the specified multi-directional variable.
+ *
+ * @tparam T value and tangent type of the variable
+ * @tparam N number of directions
+ * @param x argument
+ * @return the inverse logit of the argument
+ */
+template <typename T, int N>
+inline fvar_n<T, N> inv_logit(const fvar_n<T, N>& x) {
+  const T inv_logit_x = inv_logit(x.val_);
+  return fvar_n<T, N>(inv_logit_x,
+                      x.d_ * (inv_logit_x * (1 - inv_logit_x)));
+}
+
 }  // namespace math
 }  // namespace stan
 #endif
@@ -22,6 +22,20 @@ inline fvar<T> lgamma(const fvar<T>& x) {
   return fvar<T>(lgamma(x.val_), x.d_ * digamma(x.val_));
 }
 
+/**
+ * Return the natural logarithm of the gamma function of the specified
+ * multi-directional variable.
+ *
+ * @tparam T value and tangent type of the variable
+ * @tparam N number of directions
+ * @param x argument
+ * @return log gamma of the argument
+ */
+template <typename T, int N>
+inline fvar_n<T, N> lgamma(const fvar_n<T, N>& x) {
+  return fvar_n<T, N>(lgamma(x.val_), x.d_ * digamma(x.val_));
+}
+
 }  // namespace math
 }  // namespace stan
 #endif
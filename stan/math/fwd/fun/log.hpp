@@ -33,6 +33,20 @@ inline std::complex<fvar<T>> log(const std::complex<fvar<T>>& z) {
   return internal::complex_log(z);
 }
 
+/**
+ * Return the natural logarithm of the specified multi-directional variable.
+ *
+ * @tparam T value and tangent type of the variable
+ * @tparam N number of directions
+ * @param x argument
+ * @return the natural logarithm of the argument
+ */
+template <typename T, int N>
+inline fvar_n<T, N> log(const fvar_n<T, N>& x) {
+  using std::log;
+  return fvar_n<T, N>(log(x.val_), x.d_ / x.val_);
+}
+
 }  // namespace math
 }  // namespace stan
 #endif
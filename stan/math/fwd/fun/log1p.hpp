@@ -13,6 +13,20 @@ inline fvar<T> log1p(const fvar<T>& x) {
   return fvar<T>(log1p(x.val_), x.d_ / (1 + x.val_));
 }
 
+/**
+ * Return the natural logarithm of one plus the specified
+ * multi-directional variable.
+ *
+ * @tparam T value and tangent type of the variable
+ * @tparam N number of directions
+ * @param x argument
+ * @return natural logarithm of one plus the argument
+ */
+template <typename T, int N>
+inline fvar_n<T, N> log1p(const fvar_n<T, N>& x) {
+  return fvar_n<T, N>(log1p(x.val_), x.d_ / (1 + x.val_));
+}
+
 }  // namespace math
 }  // namespace stan
 #endif
@@ -36,6 +36,25 @@ inline fvar<T> log_sum_exp(const fvar<T>& x1, double x2) {
   return log_sum_exp(x2, x1);
 }
 
+/**
+ * Return the log of the sum of the exponentials of the specified
+ * multi-directional variables.
+ *
+ * @tparam T value and tangent type of the variables
+ * @tparam N number of directions
+ * @param x1 first argument
+ * @param x2 second argument
+ * @return log of the sum of the exponentials of the arguments
+ */
+template <typename T, int N>
+inline fvar_n<T, N> log_sum_exp(const fvar_n<T, N>& x1,
+                                const fvar_n<T, N>& x2) {
+  using std::exp;
+  const T w1 = 1 / (1 + exp(x2.val_ - x1.val_));
+  return fvar_n<T, N>(log_sum_exp(x1.val_, x2.val_),
+                      x1.d_ * w1 + x2.d_ * (1 - w1));
+}
+
 /**
  * Return the log of the sum of the exponentiated values of the specified
  * matrix of values.  The matrix may be a full matrix, a vector,
@@ -57,6 +57,41 @@ inline fvar<T> pow(const fvar<T>& x1, U x2) {
   return fvar<T>(pow(x1.val_, x2), x1.d_ * x2 * pow(x1.val_, x2 - 1));
 }
 
+/**
+ * Return the first argument raised to the power of the second argument,
+ * for multi-directional variables.
+ *
+ * @tparam T value and tangent type of the variables
+ * @tparam N number of directions
+ * @param x1 base
+ * @param x2 exponent
+ * @return base raised to the power of the exponent
+ */
+template <typename T, int N>
+inline fvar_n<T, N> pow(const fvar_n<T, N>& x1, const fvar_n<T, N>& x2) {
+  using std::log;
+  using std::pow;
+  const T pow_x1_x2 = pow(x1.val_, x2.val_);
+  return fvar_n<T, N>(
+      pow_x1_x2,
+      (x2.d_ * log(x1.val_) + x1.d_ * (x2.val_ / x1.val_)) * pow_x1_x2);
+}
+
+template <typename T, int N, typename U, typename = require_arithmetic_t<U>>
+inline fvar_n<T, N> pow(U x1, const fvar_n<T, N>& x2) {
+  using std::log;
+  using std::pow;
+  const T u = pow(x1, x2.val_);
+  return fvar_n<T, N>(u, x2.d_ * (log(x1) * u));
+}
+
+template <typename T, int N, typename U, typename = require_arithmetic_t<U>>
+inline fvar_n<T, N> pow(const fvar_n<T, N>& x1, U x2) {
+  using std::pow;
+  return fvar_n<T, N>(pow(x1.val_, x2),
+                      x1.d_ * (x2 * pow(x1.val_, x2 - 1)));
+}
+
 // must uniquely match all pairs of:
 //    { complex<fvar<V>>, complex<T>, fvar<V>, T }
 // with at least one fvar<V> and at least one complex, where T is arithmetic:
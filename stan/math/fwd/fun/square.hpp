@@ -12,6 +12,19 @@ template <typename T>
 inline fvar<T> square(const fvar<T>& x) {
   return fvar<T>(square(x.val_), x.d_ * 2 * x.val_);
 }
+/**
+ * Return the square of the specified multi-directional variable.
+ *
+ * @tparam T value and tangent type of the variable
+ * @tparam N number of directions
+ * @param x argument
+ * @return the square of the argument
+ */
+template <typename T, int N>
+inline fvar_n<T, N> square(const fvar_n<T, N>& x) {
+  return fvar_n<T, N>(square(x.val_), x.d_ * (2 * x.val_));
+}
+
 }  // namespace math
 }  // namespace stan
 #endif
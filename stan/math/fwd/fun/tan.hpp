@@ -28,6 +28,21 @@ inline std::complex<fvar<T>> tan(const std::complex<fvar<T>>& z) {
   return stan::math::internal::complex_tan(z);
 }
 
+/**
+ * Return the tangent of the specified multi-directional variable.
+ *
+ * @tparam T value and tangent type of the variable
+ * @tparam N number of directions
+ * @param x argument
+ * @return the tangent of the argument
+ */
+template <typename T, int N>
+inline fvar_n<T, N> tan(const fvar_n<T, N>& x) {
+  using std::tan;
+  const T tan_x = tan(x.val_);
+  return fvar_n<T, N>(tan_x, x.d_ * (1 + tan_x * tan_x));
+}
+
 }  // namespace math
 }  // namespace stan
 #endif
@@ -30,6 +30,21 @@ inline std::complex<fvar<T>> tanh(const std::complex<fvar<T>>& z) {
   return stan::math::internal::complex_tanh(z);
 }
 
+/**
+ * Return the hyperbolic tangent of the specified multi-directional variable.
+ *
+ * @tparam T value and tangent type of the variable
+ * @tparam N number of directions
+ * @param x argument
+ * @return the hyperbolic tangent of the argument
+ */
+template <typename T, int N>
+inline fvar_n<T, N> tanh(const fvar_n<T, N>& x) {
+  using std::tanh;
+  const T tanh_x = tanh(x.val_);
+  return fvar_n<T, N>(tanh_x, x.d_ * (1 - tanh_x * tanh_x));
+}
+
 }  // namespace math
 }  // namespace stan
 #endif
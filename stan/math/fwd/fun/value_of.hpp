@@ -19,6 +19,19 @@ inline T value_of(const fvar<T>& v) {
   return v.val_;
 }
 
+/**
+ * Return the value of the specified multi-directional variable.
+ *
+ * @tparam T value type of the fvar_n
+ * @tparam N number of directions
+ * @param v Variable.
+ * @return Value of variable.
+ */
+template <typename T, int N>
+inline T value_of(const fvar_n<T, N>& v) {
+  return v.val_;
+}
+
 }  // namespace math
 }  // namespace stan
 #endif
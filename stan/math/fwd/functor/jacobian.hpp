@@ -3,6 +3,7 @@
 
 #include <stan/math/fwd/core.hpp>
 #include <stan/math/prim/fun/Eigen.hpp>
+#include <algorithm>
 
 namespace stan {
 namespace math {
@@ -32,6 +33,52 @@ void jacobian(const F& f, const Eigen::Matrix<T, Eigen::Dynamic, 1>& x,
   }
 }
 
+/**
+ * Return the Jacobian of the specified function at the specified
+ * argument, along with its value, evaluating the function once for
+ * every `N` inputs with multi-directional forward variables.
+ *
+ * The function must accept a column vector of `fvar_n<T, N>`; see
+ * `fvar_n` for the functions implemented for it.
+ *
+ * @tparam N number of directions per evaluation
+ * @tparam T type of the argument
+ * @tparam F type of function
+ * @param[in] f function, taking and returning an Eigen column vector
+ * @param[in] x argument
+ * @param[out] fx value of the function
+ * @param[out] J Jacobian, with one row per output and one column per
+ * input
+ */
+template <int N, typename T, typename F>
+void jacobian(const F& f, const Eigen::Matrix<T, Eigen::Dynamic, 1>& x,
+              Eigen::Matrix<T, Eigen::Dynamic, 1>& fx,
+              Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>& J) {
+  using Eigen::Dynamic;
+  using Eigen::Matrix;
+  const int n = x.size();
+  Matrix<fvar_n<T, N>, Dynamic, 1> x_fvar(n);
+  for (int first = 0; first == 0 || first < n; first += N) {
+    for (int k = 0; k < n; ++k) {
+      const int direction = k >= first && k < first + N ? k - first : -1;
+      x_fvar(k) = fvar_n<T, N>::unit(x(k), direction);
+    }
+    Matrix<fvar_n<T, N>, Dynamic, 1> fx_fvar = f(x_fvar);
+    if (first == 0) {
+      fx.resize(fx_fvar.size());
+      J.resize(fx_fvar.size(), n);
+      for (int i = 0; i < fx_fvar.size(); ++i) {
+        fx(i) = fx_fvar(i).val_;
+      }
+    }
+    const int width = std::min(N, n - first);
+    for (int i = 0; i < fx_fvar.size(); ++i) {
+      J.row(i).segment(first, width)
+          = fx_fvar(i).d_.head(width).matrix().transpose();
+    }
+  }
+}
+
 }  // namespace math
 }  // namespace stan
 #endif
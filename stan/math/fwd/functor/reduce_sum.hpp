@@ -3,6 +3,7 @@
 
 #include <stan/math/prim/meta.hpp>
 #include <stan/math/prim/err.hpp>
+#include <stan/math/prim/functor/grainsize_tuner.hpp>
 
 #include <algorithm>
 #include <tuple>
@@ -27,6 +28,13 @@ struct reduce_sum_impl;
 template <typename ReduceFunction, typename Enable, typename ReturnType,
           typename Vec, typename... Args>
 struct reduce_sum_impl {
+  reduce_sum_impl() = default;
+
+  /**
+   * The evaluation is not parallelized, so no timings are recorded.
+   */
+  explicit reduce_sum_impl(chunk_timings* timings) {}
+
   /**
    * Call an instance of the function `ReduceFunction` on every element
    *   of an input sequence and sum these terms.
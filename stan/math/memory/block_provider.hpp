@@ -0,0 +1,275 @@
+#ifndef STAN_MATH_MEMORY_BLOCK_PROVIDER_HPP
+#define STAN_MATH_MEMORY_BLOCK_PROVIDER_HPP
+
+#include <stdint.h>
+#include <cstdlib>
+#include <cstddef>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define STAN_MATH_MEMORY_HAS_MMAP
+#endif
+
+namespace stan {
+namespace math {
+
+/**
+ * Return <code>true</code> if the specified pointer is aligned
+ * on the number of bytes.
+ *
+ * This doesn't really make sense other than for powers of 2.
+ *
+ * @param ptr Pointer to test.
+ * @param bytes_aligned Number of bytes of alignment required.
+ * @return <code>true</code> if pointer is aligned.
+ * @tparam Type of object to which pointer points.
+ */
+template <typename T>
+bool is_aligned(T* ptr, unsigned int bytes_aligned) {
+  return (reinterpret_cast<uintptr_t>(ptr) % bytes_aligned) == 0U;
+}
+
+namespace internal {
+const size_t HUGE_PAGE_NBYTES = 1 << 21;  // 2MB
+
+// FIXME: enforce alignment
+// big fun to inline, but only called twice
+inline char* eight_byte_aligned_malloc(size_t size) {
+  char* ptr = static_cast<char*>(malloc(size));
+  if (!ptr) {
+    return ptr;  // malloc failed to alloc
+  }
+  if (!is_aligned(ptr, 8U)) {
+    std::stringstream s;
+    s << "invalid alignment to 8 bytes, ptr="
+      << reinterpret_cast<uintptr_t>(ptr) << std::endl;
+    throw std::runtime_error(s.str());
+  }
+  return ptr;
+}
+
+/**
+ * Round the number of bytes up to a multiple of the specified
+ * (power of two) granularity.
+ *
+ * @param nbytes number of bytes
+ * @param granularity power of two to round up to
+ * @return rounded number of bytes
+ */
+inline size_t round_up_bytes(size_t nbytes, size_t granularity) {
+  return (nbytes + granularity - 1) & ~(granularity - 1);
+}
+
+/**
+ * Write to every page of a block so that it is backed by physical
+ * memory local to the calling thread.
+ *
+ * @param block pointer to the block
+ * @param nbytes size of the block
+ */
+inline void touch_block(char* block, size_t nbytes) {
+  const size_t stride = 4096;
+  for (size_t i = 0; i < nbytes; i += stride) {
+    block[i] = 0;
+  }
+}
+
+}  // namespace internal
+
+/**
+ * Interface of the sources of the memory blocks used by
+ * <code>stack_alloc</code>.
+ *
+ * A provider hands out blocks of at least the requested size and
+ * takes them back once the allocator frees them. Providers are
+ * shared between allocators (and threads) and must therefore be
+ * stateless or thread safe, and must outlive every allocator using
+ * them.
+ */
+class block_provider {
+ public:
+  virtual ~block_provider() {}
+
+  /**
+   * Allocate a block of memory aligned to at least 8 bytes.
+   *
+   * @param[in, out] nbytes number of bytes requested; the provider may
+   * round it up, in which case it is set to the usable size of the
+   * returned block
+   * @return pointer to the block or <code>nullptr</code> if no memory
+   * could be obtained
+   */
+  virtual char* allocate(size_t& nbytes) = 0;
+
+  /**
+   * Return a block to the provider.
+   *
+   * @param block pointer returned by <code>allocate()</code>
+   * @param nbytes usable size of the block as set by
+   * <code>allocate()</code>
+   */
+  virtual void release(char* block, size_t nbytes) noexcept = 0;
+
+  /**
+   * Give the physical memory backing a block back to the system while
+   * keeping the block allocated; its content is lost. The block must
+   * remain usable, its memory being provided again on first access.
+   *
+   * @param block pointer returned by <code>allocate()</code>
+   * @param nbytes usable size of the block as set by
+   * <code>allocate()</code>
+   * @return <code>true</code> if the memory was given back,
+   * <code>false</code> if the provider does not support it
+   */
+  virtual bool decommit(char* /* block */, size_t /* nbytes */) noexcept {
+    return false;
+  }
+
+  /**
+   * Return the name of the provider.
+   */
+  virtual const char* name() const noexcept = 0;
+};
+
+/**
+ * Block provider using the C heap. This is the default.
+ */
+class malloc_block_provider final : public block_provider {
+ public:
+  char* allocate(size_t& nbytes) final {
+    return internal::eight_byte_aligned_malloc(nbytes);
+  }
+
+  void release(char* block, size_t /* nbytes */) noexcept final {
+    free(block);
+  }
+
+  const char* name() const noexcept final { return "malloc"; }
+
+  /**
+   * Return the process wide instance of this provider.
+   */
+  static malloc_block_provider& instance() {
+    static malloc_block_provider provider;
+    return provider;
+  }
+};
+
+/**
+ * Block provider mapping anonymous memory directly from the operating
+ * system, optionally backed by huge pages.
+ *
+ * Blocks are rounded up to whole pages. With huge pages requested, the
+ * provider first asks for explicitly reserved huge pages
+ * (<code>MAP_HUGETLB</code>) in blocks rounded up to 2MB and, if none
+ * are available, falls back to regular pages in 2MB aligned blocks
+ * advised for transparent huge page backing
+ * (<code>madvise(MADV_HUGEPAGE)</code>). Both are hints only available
+ * on Linux; elsewhere regular pages are used. On systems without
+ * <code>mmap</code> the C heap is used.
+ */
+class mmap_block_provider final : public block_provider {
+  bool huge_pages_;
+
+ public:
+  explicit mmap_block_provider(bool huge_pages) : huge_pages_(huge_pages) {}
+
+  char* allocate(size_t& nbytes) final {
+#ifdef STAN_MATH_MEMORY_HAS_MMAP
+#ifdef MAP_HUGETLB
+    if (huge_pages_) {
+      const size_t huge_nbytes
+          = internal::round_up_bytes(nbytes, internal::HUGE_PAGE_NBYTES);
+      void* ptr = mmap(nullptr, huge_nbytes, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (ptr != MAP_FAILED) {
+        nbytes = huge_nbytes;
+        return static_cast<char*>(ptr);
+      }
+    }
+#endif
+    const size_t page_nbytes = sysconf(_SC_PAGESIZE);
+    const size_t mapped_nbytes = internal::round_up_bytes(
+        nbytes, huge_pages_ ? internal::HUGE_PAGE_NBYTES : page_nbytes);
+    // huge pages only back 2MB aligned ranges, so map one more huge page
+    // and unmap what lies outside the aligned block
+    const size_t slack_nbytes
+        = huge_pages_ ? internal::HUGE_PAGE_NBYTES - page_nbytes : 0;
+    void* ptr = mmap(nullptr, mapped_nbytes + slack_nbytes,
+                     PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1,
+                     0);
+    if (ptr == MAP_FAILED) {
+      return nullptr;
+    }
+    char* block = static_cast<char*>(ptr);
+    if (huge_pages_) {
+      const size_t head_nbytes
+          = internal::round_up_bytes(reinterpret_cast<uintptr_t>(block),
+                                     internal::HUGE_PAGE_NBYTES)
+            - reinterpret_cast<uintptr_t>(block);
+      if (head_nbytes > 0) {
+        munmap(block, head_nbytes);
+      }
+      if (slack_nbytes > head_nbytes) {
+        munmap(block + head_nbytes + mapped_nbytes,
+               slack_nbytes - head_nbytes);
+      }
+      block += head_nbytes;
+    }
+#ifdef MADV_HUGEPAGE
+    if (huge_pages_) {
+      madvise(block, mapped_nbytes, MADV_HUGEPAGE);
+    }
+#endif
+    nbytes = mapped_nbytes;
+    return block;
+#else
+    return internal::eight_byte_aligned_malloc(nbytes);
+#endif
+  }
+
+  void release(char* block, size_t nbytes) noexcept final {
+#ifdef STAN_MATH_MEMORY_HAS_MMAP
+    munmap(block, nbytes);
+#else
+    free(block);
+#endif
+  }
+
+  bool decommit(char* block, size_t nbytes) noexcept final {
+#if defined(STAN_MATH_MEMORY_HAS_MMAP) && defined(MADV_DONTNEED)
+    return madvise(block, nbytes, MADV_DONTNEED) == 0;
+#else
+    return false;
+#endif
+  }
+
+  const char* name() const noexcept final {
+    return huge_pages_ ? "hugepages" : "mmap";
+  }
+
+  /**
+   * Return the process wide instance of this provider using regular
+   * pages.
+   */
+  static mmap_block_provider& instance() {
+    static mmap_block_provider provider(false);
+    return provider;
+  }
+
+  /**
+   * Return the process wide instance of this provider using huge
+   * pages.
+   */
+  static mmap_block_provider& huge_pages_instance() {
+    static mmap_block_provider provider(true);
+    return provider;
+  }
+};
+
+}  // namespace math
+}  // namespace stan
+#endif
@@ -5,51 +5,262 @@
 //            is best we can do to get safe pointer casts to uints.
 #include <stdint.h>
 #include <stan/math/prim/meta.hpp>
+#include <stan/math/prim/err/invalid_argument.hpp>
+#include <stan/math/memory/block_provider.hpp>
+#include <boost/lexical_cast.hpp>
 #include <cstdlib>
 #include <cstddef>
 #include <sstream>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 namespace stan {
 namespace math {
 
 /**
- * Return <code>true</code> if the specified pointer is aligned
- * on the number of bytes.
- *
- * This doesn't really make sense other than for powers of 2.
+ * Alignment in bytes of arrays allocated on the arena for vectorized
+ * access, such as the storage of matrices; see
+ * <code>stack_alloc::alloc_array_aligned()</code>.  Defaults to a
+ * cache line, which covers the widest (AVX-512) vector registers.
+ */
+#ifndef STAN_ARENA_ALIGNMENT
+#define STAN_ARENA_ALIGNMENT 64
+#endif
+
+namespace internal {
+const size_t DEFAULT_INITIAL_NBYTES = 1 << 16;  // 64KB
+const double DEFAULT_GROWTH_FACTOR = 2.0;
+const size_t SMALL_ARRAY_ALIGNMENT
+    = EIGEN_MAX_ALIGN_BYTES > 8 ? EIGEN_MAX_ALIGN_BYTES : 8;
+const size_t LARGE_ARRAY_ALIGNMENT
+    = STAN_ARENA_ALIGNMENT > SMALL_ARRAY_ALIGNMENT ? STAN_ARENA_ALIGNMENT
+                                                   : SMALL_ARRAY_ALIGNMENT;
+
+/**
+ * Return the first address at or after the pointer which is aligned
+ * to the specified (power of two) number of bytes.
  *
- * @param ptr Pointer to test.
- * @param bytes_aligned Number of bytes of alignment required.
- * @return <code>true</code> if pointer is aligned.
- * @tparam Type of object to which pointer points.
+ * @param ptr pointer
+ * @param alignment alignment in bytes
+ * @return aligned pointer
  */
-template <typename T>
-bool is_aligned(T* ptr, unsigned int bytes_aligned) {
-  return (reinterpret_cast<uintptr_t>(ptr) % bytes_aligned) == 0U;
+inline char* align_up(char* ptr, size_t alignment) {
+  return reinterpret_cast<char*>(
+      (reinterpret_cast<uintptr_t>(ptr) + alignment - 1) & ~(alignment - 1));
 }
+}  // namespace internal
+
+/**
+ * Policy of a <code>stack_alloc</code> for giving memory back to the
+ * system when all of its memory is recovered.
+ *
+ * The allocator tracks how many of its blocks were used between
+ * consecutive calls to <code>recover_all()</code> over the last
+ * <code>window</code> such periods. The blocks beyond this rolling
+ * high-water mark are given back to their provider; with
+ * <code>decommit</code> set and a provider supporting it (see
+ * <code>block_provider::decommit()</code>) only the physical memory is
+ * given back while the address range is kept for reuse. A window of
+ * zero, the default, keeps all blocks until <code>free_all()</code>.
+ */
+struct stack_alloc_shrink_policy {
+  size_t window = 0;
+  bool decommit = false;
+};
+
+/**
+ * Configuration of a <code>stack_alloc</code>: the size of its first
+ * block, the factor by which each new block grows with respect to the
+ * previous one, where the blocks come from, and whether each new block
+ * is touched (page faulted in) by the allocating thread as soon as it
+ * is obtained.
+ *
+ * Touching a block right away places its pages on the NUMA node of
+ * the thread owning the allocator (first-touch policy) and moves the
+ * page fault cost out of the hot allocation path.
+ */
+struct stack_alloc_config {
+  size_t initial_nbytes = internal::DEFAULT_INITIAL_NBYTES;
+  double growth_factor = internal::DEFAULT_GROWTH_FACTOR;
+  block_provider* provider = &malloc_block_provider::instance();
+  bool first_touch = false;
+  stack_alloc_shrink_policy shrink_policy;
+};
 
 namespace internal {
-const size_t DEFAULT_INITIAL_NBYTES = 1 << 16;  // 64KB
 
-// FIXME: enforce alignment
-// big fun to inline, but only called twice
-inline char* eight_byte_aligned_malloc(size_t size) {
-  char* ptr = static_cast<char*>(malloc(size));
-  if (!ptr) {
-    return ptr;  // malloc failed to alloc
+/**
+ * Return the block provider with the specified name.
+ *
+ * @param name one of "malloc", "mmap" or "hugepages"
+ * @return block provider
+ * @throws std::invalid_argument if the name is unknown
+ */
+inline block_provider* get_block_provider(const std::string& name) {
+  if (name == "malloc") {
+    return &malloc_block_provider::instance();
+  } else if (name == "mmap") {
+    return &mmap_block_provider::instance();
+  } else if (name == "hugepages") {
+    return &mmap_block_provider::huge_pages_instance();
+  }
+  invalid_argument("get_block_provider", "STAN_STACK_ALLOC_PROVIDER",
+                   name.c_str(),
+                   "The STAN_STACK_ALLOC_PROVIDER environment variable is '",
+                   "' but it must be malloc, mmap or hugepages");
+  return nullptr;
+}
+
+/**
+ * Read the default stack allocator configuration from the
+ * environment. The following variables are used, falling back to the
+ * defaults of <code>stack_alloc_config</code> when not set:
+ *
+ * - STAN_STACK_ALLOC_INITIAL_BYTES: positive size of the first block
+ * - STAN_STACK_ALLOC_GROWTH: growth factor of blocks, at least 1
+ * - STAN_STACK_ALLOC_PROVIDER: one of malloc, mmap or hugepages
+ * - STAN_STACK_ALLOC_FIRST_TOUCH: 1 to touch new blocks, 0 otherwise
+ * - STAN_STACK_ALLOC_SHRINK_WINDOW: window of the shrink policy
+ * - STAN_STACK_ALLOC_DECOMMIT: 1 to decommit instead of free blocks
+ *   beyond the high-water mark, 0 otherwise
+ *
+ * @return configuration
+ * @throws std::invalid_argument if any of the variables is invalid
+ */
+inline stack_alloc_config get_env_stack_alloc_config() {
+  stack_alloc_config config;
+  const char* env_window = std::getenv("STAN_STACK_ALLOC_SHRINK_WINDOW");
+  if (env_window != nullptr) {
+    try {
+      const long long window  // NOLINT(runtime/int)
+          = boost::lexical_cast<long long>(env_window);  // NOLINT
+      if (window < 0) {
+        throw boost::bad_lexical_cast();
+      }
+      config.shrink_policy.window = window;
+    } catch (const boost::bad_lexical_cast&) {
+      invalid_argument(
+          "get_env_stack_alloc_config", "STAN_STACK_ALLOC_SHRINK_WINDOW",
+          env_window,
+          "The STAN_STACK_ALLOC_SHRINK_WINDOW environment variable is '",
+          "' but it must be a non-negative number");
+    }
+  }
+  const char* env_decommit = std::getenv("STAN_STACK_ALLOC_DECOMMIT");
+  if (env_decommit != nullptr) {
+    const std::string decommit(env_decommit);
+    if (decommit != "0" && decommit != "1") {
+      invalid_argument(
+          "get_env_stack_alloc_config", "STAN_STACK_ALLOC_DECOMMIT",
+          env_decommit,
+          "The STAN_STACK_ALLOC_DECOMMIT environment variable is '",
+          "' but it must be 0 or 1");
+    }
+    config.shrink_policy.decommit = decommit == "1";
+  }
+  const char* env_initial = std::getenv("STAN_STACK_ALLOC_INITIAL_BYTES");
+  if (env_initial != nullptr) {
+    try {
+      const long long initial  // NOLINT(runtime/int)
+          = boost::lexical_cast<long long>(env_initial);  // NOLINT
+      if (initial <= 0) {
+        throw boost::bad_lexical_cast();
+      }
+      config.initial_nbytes = initial;
+    } catch (const boost::bad_lexical_cast&) {
+      invalid_argument(
+          "get_env_stack_alloc_config", "STAN_STACK_ALLOC_INITIAL_BYTES",
+          env_initial,
+          "The STAN_STACK_ALLOC_INITIAL_BYTES environment variable is '",
+          "' but it must be a positive number");
+    }
   }
-  if (!is_aligned(ptr, 8U)) {
-    std::stringstream s;
-    s << "invalid alignment to 8 bytes, ptr="
-      << reinterpret_cast<uintptr_t>(ptr) << std::endl;
-    throw std::runtime_error(s.str());
+  const char* env_growth = std::getenv("STAN_STACK_ALLOC_GROWTH");
+  if (env_growth != nullptr) {
+    try {
+      config.growth_factor = boost::lexical_cast<double>(env_growth);
+      if (!(config.growth_factor >= 1.0)) {
+        throw boost::bad_lexical_cast();
+      }
+    } catch (const boost::bad_lexical_cast&) {
+      invalid_argument("get_env_stack_alloc_config", "STAN_STACK_ALLOC_GROWTH",
+                       env_growth,
+                       "The STAN_STACK_ALLOC_GROWTH environment variable is '",
+                       "' but it must be a number of at least 1");
+    }
   }
-  return ptr;
+  const char* env_provider = std::getenv("STAN_STACK_ALLOC_PROVIDER");
+  if (env_provider != nullptr) {
+    config.provider = get_block_provider(env_provider);
+  }
+  const char* env_touch = std::getenv("STAN_STACK_ALLOC_FIRST_TOUCH");
+  if (env_touch != nullptr) {
+    const std::string touch(env_touch);
+    if (touch != "0" && touch != "1") {
+      invalid_argument(
+          "get_env_stack_alloc_config", "STAN_STACK_ALLOC_FIRST_TOUCH",
+          env_touch,
+          "The STAN_STACK_ALLOC_FIRST_TOUCH environment variable is '",
+          "' but it must be 0 or 1");
+    }
+    config.first_touch = touch == "1";
+  }
+  return config;
+}
+
+/**
+ * Return a reference to the process wide default configuration, which
+ * is initialized from the environment on first use.
+ */
+inline stack_alloc_config& default_stack_alloc_config_ref() {
+  static stack_alloc_config config = get_env_stack_alloc_config();
+  return config;
 }
+
 }  // namespace internal
 
+/**
+ * Return the configuration used by default constructed stack
+ * allocators, such as the ones backing the AD tape of each thread.
+ *
+ * @return default configuration
+ * @throws std::invalid_argument on first use if the environment
+ * variables read by <code>internal::get_env_stack_alloc_config()</code>
+ * are invalid
+ */
+inline stack_alloc_config default_stack_alloc_config() {
+  return internal::default_stack_alloc_config_ref();
+}
+
+/**
+ * Set the configuration used by subsequently default constructed
+ * stack allocators. Allocators that already exist, including the AD
+ * tape of the calling thread, are not affected. This function is not
+ * thread safe and is meant to be called before any threads are
+ * started.
+ *
+ * @param config new default configuration
+ * @throws std::invalid_argument if the initial size is zero, the
+ * growth factor is less than 1, or the provider is null
+ */
+inline void set_default_stack_alloc_config(const stack_alloc_config& config) {
+  if (config.initial_nbytes == 0) {
+    invalid_argument("set_default_stack_alloc_config", "initial_nbytes", 0,
+                     "initial_nbytes is ", ", but must be positive");
+  }
+  if (!(config.growth_factor >= 1.0)) {
+    invalid_argument("set_default_stack_alloc_config", "growth_factor",
+                     config.growth_factor, "growth_factor is ",
+                     ", but must be at least 1");
+  }
+  if (config.provider == nullptr) {
+    throw std::invalid_argument(
+        "set_default_stack_alloc_config: provider must not be null");
+  }
+  internal::default_stack_alloc_config_ref() = config;
+}
+
 /**
  * An instance of this class provides a memory pool through
  * which blocks of raw memory may be allocated and then collected
@@ -60,9 +271,12 @@ inline char* eight_byte_aligned_malloc(size_t size) {
  * include objects whose destructors have no effect.
  *
  * Memory is allocated on a stack of blocks.  Each block allocated
- * is twice as large as the previous one.  The memory may be
- * recovered, with the blocks being reused, or all blocks may be
- * freed, resetting the stack of blocks to its original state.
+ * is larger than the previous one by a growth factor, which is two
+ * by default.  The memory may be recovered, with the blocks being
+ * reused, or all blocks may be freed, resetting the stack of blocks
+ * to its original state.  The blocks are obtained from a
+ * <code>block_provider</code>, by default the C heap; see
+ * <code>stack_alloc_config</code>.
  *
  * Alignment up to 8 byte boundaries guaranteed for the first malloc,
  * and after that it's up to the caller.  On 64-bit architectures,
@@ -82,6 +296,72 @@ class stack_alloc {
   std::vector<size_t> nested_cur_blocks_;
   std::vector<char*> nested_next_locs_;
   std::vector<char*> nested_cur_block_ends_;
+  block_provider* provider_;  // source of the blocks
+  double growth_factor_;      // size of a new block relative to the last
+  bool first_touch_;          // touch the pages of new blocks
+  // next for the shrink policy and its counters:
+  stack_alloc_shrink_policy shrink_policy_;
+  std::vector<bool> decommitted_;     // blocks given back but still mapped
+  std::vector<size_t> recent_usage_;  // max block index used per recovery
+  size_t recent_usage_pos_;           // next position in recent_usage_
+  size_t max_block_used_;             // max block index since recover_all
+  size_t bytes_released_;             // bytes given back by the policy
+
+  /**
+   * Obtain a new block of at least the specified size from the
+   * provider and push it on the stack of blocks.
+   *
+   * @param nbytes Minimal number of bytes of the block.
+   * @throws std::bad_alloc if the provider is out of memory.
+   */
+  void push_block(size_t nbytes) {
+    char* block = provider_->allocate(nbytes);
+    if (!block) {
+      throw std::bad_alloc();  // no msg allowed in bad_alloc ctor
+    }
+    if (first_touch_) {
+      internal::touch_block(block, nbytes);
+    }
+    blocks_.push_back(block);
+    sizes_.push_back(nbytes);
+    decommitted_.push_back(false);
+  }
+
+  /**
+   * Give the blocks beyond the rolling high-water mark of the shrink
+   * policy back to the system.
+   */
+  void shrink() {
+    if (recent_usage_.size() < shrink_policy_.window) {
+      recent_usage_.push_back(max_block_used_);
+    } else {
+      recent_usage_[recent_usage_pos_] = max_block_used_;
+    }
+    recent_usage_pos_ = (recent_usage_pos_ + 1) % shrink_policy_.window;
+    size_t high_water = 0;
+    for (auto used : recent_usage_) {
+      high_water = used > high_water ? used : high_water;
+    }
+    size_t keep = blocks_.size();
+    for (size_t i = blocks_.size(); i-- > high_water + 1;) {
+      if (decommitted_[i]) {
+        continue;
+      }
+      if (shrink_policy_.decommit
+          && provider_->decommit(blocks_[i], sizes_[i])) {
+        decommitted_[i] = true;
+      } else if (i + 1 == keep) {
+        provider_->release(blocks_[i], sizes_[i]);
+        keep = i;
+      } else {
+        continue;
+      }
+      bytes_released_ += sizes_[i];
+    }
+    blocks_.resize(keep);
+    sizes_.resize(keep);
+    decommitted_.resize(keep);
+  }
 
   /**
    * Moves us to the next block of memory, allocating that block
@@ -100,17 +380,17 @@ class stack_alloc {
     }
     // Allocate a new block if necessary.
     if (unlikely(cur_block_ >= blocks_.size())) {
-      // New block should be max(2*size of last block, len) bytes.
-      size_t newsize = sizes_.back() * 2;
+      // New block should be max(growth * size of last block, len) bytes.
+      size_t newsize = static_cast<size_t>(sizes_.back() * growth_factor_);
       if (newsize < len) {
         newsize = len;
       }
-      blocks_.push_back(internal::eight_byte_aligned_malloc(newsize));
-      if (!blocks_.back()) {
-        throw std::bad_alloc();
-      }
-      sizes_.push_back(newsize);
+      push_block(newsize);
+    }
+    if (unlikely(cur_block_ > max_block_used_)) {
+      max_block_used_ = cur_block_;
     }
+    decommitted_[cur_block_] = false;
     result = blocks_[cur_block_];
     // Get the object's state back in order.
     next_loc_ = result + len;
@@ -120,36 +400,62 @@ class stack_alloc {
 
  public:
   /**
-   * Construct a resizable stack allocator initially holding the
-   * specified number of bytes.
+   * Construct a resizable stack allocator with the specified
+   * configuration.
    *
-   * @param initial_nbytes Initial number of bytes for the
-   * allocator.  Defaults to <code>(1 << 16) = 64KB</code> initial bytes.
+   * @param config configuration of the allocator.
    * @throws std::runtime_error if the underlying malloc is not 8-byte
    * aligned.
    */
-  explicit stack_alloc(size_t initial_nbytes = internal::DEFAULT_INITIAL_NBYTES)
-      : blocks_(1, internal::eight_byte_aligned_malloc(initial_nbytes)),
-        sizes_(1, initial_nbytes),
-        cur_block_(0),
-        cur_block_end_(blocks_[0] + initial_nbytes),
-        next_loc_(blocks_[0]) {
-    if (!blocks_[0]) {
-      throw std::bad_alloc();  // no msg allowed in bad_alloc ctor
-    }
+  explicit stack_alloc(const stack_alloc_config& config)
+      : cur_block_(0),
+        provider_(config.provider),
+        growth_factor_(config.growth_factor),
+        first_touch_(config.first_touch),
+        shrink_policy_(config.shrink_policy),
+        recent_usage_pos_(0),
+        max_block_used_(0),
+        bytes_released_(0) {
+    push_block(config.initial_nbytes);
+    cur_block_end_ = blocks_[0] + sizes_[0];
+    next_loc_ = blocks_[0];
   }
 
   /**
-   * Destroy this memory allocator.
+   * Construct a resizable stack allocator with the default
+   * configuration, see <code>default_stack_alloc_config()</code>.
+   *
+   * @throws std::runtime_error if the underlying malloc is not 8-byte
+   * aligned.
+   */
+  stack_alloc() : stack_alloc(default_stack_alloc_config()) {}
+
+  /**
+   * Construct a resizable stack allocator initially holding the
+   * specified number of bytes and otherwise using the default
+   * configuration.
    *
-   * This is implemented as a no-op as there is no destruction
-   * required.
+   * @param initial_nbytes Initial number of bytes for the
+   * allocator.
+   * @throws std::runtime_error if the underlying malloc is not 8-byte
+   * aligned.
+   */
+  explicit stack_alloc(size_t initial_nbytes)
+      : stack_alloc([initial_nbytes]() {
+          stack_alloc_config config = default_stack_alloc_config();
+          config.initial_nbytes = initial_nbytes;
+          return config;
+        }()) {}
+
+  /**
+   * Destroy this memory allocator, returning all blocks to their
+   * provider.
    */
   ~stack_alloc() {
     // free ALL blocks
-    for (auto& block : blocks_) {
-      if (block) {
-        free(block);
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+      if (blocks_[i]) {
+        provider_->release(blocks_[i], sizes_[i]);
       }
     }
   }
@@ -190,13 +496,62 @@ class stack_alloc {
     return static_cast<T*>(alloc(n * sizeof(T)));
   }
 
+  /**
+   * Return a newly allocated block of memory of the appropriate
+   * size managed by the stack allocator, aligned to the specified
+   * number of bytes.  Up to <code>alignment - 1</code> bytes are
+   * skipped in front of the returned memory.
+   *
+   * @param len Number of bytes to allocate.
+   * @param alignment Alignment in bytes, a power of two.
+   * @return A pointer to the allocated memory.
+   */
+  inline void* alloc_aligned(size_t len, size_t alignment) {
+    char* result = internal::align_up(next_loc_, alignment);
+    next_loc_ = result + len;
+    if (unlikely(next_loc_ >= cur_block_end_)) {
+      // ask for enough space to align within the next block
+      result = internal::align_up(move_to_next_block(len + alignment - 1),
+                                  alignment);
+      next_loc_ = result + len;
+    }
+    return reinterpret_cast<void*>(result);
+  }
+
+  /**
+   * Allocate an array on the arena of the specified size to hold
+   * values of the specified template parameter type, aligned for
+   * vectorized access.  Arrays of at least
+   * <code>STAN_ARENA_ALIGNMENT</code> bytes are aligned to that many
+   * bytes, smaller ones to the largest alignment Eigen requires
+   * (<code>EIGEN_MAX_ALIGN_BYTES</code>) or 8 bytes, whichever is
+   * larger.  Eigen maps to such arrays may thus be declared
+   * <code>Eigen::AlignedMax</code>.
+   *
+   * @tparam T type of entries in allocated array.
+   * @param[in] n size of array to allocate.
+   * @return new array allocated on the arena.
+   */
+  template <typename T>
+  inline T* alloc_array_aligned(size_t n) {
+    const size_t len = n * sizeof(T);
+    return static_cast<T*>(
+        alloc_aligned(len, len < STAN_ARENA_ALIGNMENT
+                               ? internal::SMALL_ARRAY_ALIGNMENT
+                               : internal::LARGE_ARRAY_ALIGNMENT));
+  }
+
   /**
    * Recover all the memory used by the stack allocator.  The stack
    * of memory blocks allocated so far will be available for further
    * allocations.  To free memory back to the system, use the
-   * function free_all().
+   * function free_all() or set a shrink policy.
    */
   inline void recover_all() {
+    if (unlikely(shrink_policy_.window > 0)) {
+      shrink();
+    }
+    max_block_used_ = 0;
     cur_block_ = 0;
     next_loc_ = blocks_[0];
     cur_block_end_ = next_loc_ + sizes_[0];
@@ -239,11 +594,15 @@ class stack_alloc {
     // frees all BUT the first (index 0) block
     for (size_t i = 1; i < blocks_.size(); ++i) {
       if (blocks_[i]) {
-        free(blocks_[i]);
+        provider_->release(blocks_[i], sizes_[i]);
       }
     }
     sizes_.resize(1);
     blocks_.resize(1);
+    decommitted_.resize(1);
+    recent_usage_.clear();
+    recent_usage_pos_ = 0;
+    max_block_used_ = 0;
     recover_all();
   }
 
@@ -265,6 +624,83 @@ class stack_alloc {
     return sum;
   }
 
+  /**
+   * Return the number of blocks reserved by this instance, whether
+   * currently in use or not.
+   *
+   * @return number of blocks
+   */
+  inline size_t blocks_reserved() const { return blocks_.size(); }
+
+  /**
+   * Return the number of bytes reserved by this instance from its
+   * block provider, whether currently in use or not.  In contrast to
+   * <code>bytes_allocated()</code> this includes the blocks beyond the
+   * current one which are kept for reuse.
+   *
+   * @return number of bytes reserved
+   */
+  inline size_t bytes_reserved() const {
+    size_t sum = 0;
+    for (size_t i = 0; i < sizes_.size(); ++i) {
+      if (!decommitted_[i]) {
+        sum += sizes_[i];
+      }
+    }
+    return sum;
+  }
+
+  /**
+   * Return the number of bytes currently handed out by this instance,
+   * including the space wasted at the end of blocks which were left
+   * for the next one.
+   *
+   * @return number of bytes in use
+   */
+  inline size_t bytes_in_use() const {
+    size_t sum = next_loc_ - blocks_[cur_block_];
+    for (size_t i = 0; i < cur_block_; ++i) {
+      sum += sizes_[i];
+    }
+    return sum;
+  }
+
+  /**
+   * Return the total number of bytes given back to the system by the
+   * shrink policy of this instance so far.
+   *
+   * @return number of bytes released
+   */
+  inline size_t bytes_released() const { return bytes_released_; }
+
+  /**
+   * Set the shrink policy of this instance.  The usage history of the
+   * previous policy is discarded.
+   *
+   * @param policy shrink policy
+   */
+  inline void set_shrink_policy(const stack_alloc_shrink_policy& policy) {
+    shrink_policy_ = policy;
+    recent_usage_.clear();
+    recent_usage_pos_ = 0;
+  }
+
+  /**
+   * Return the shrink policy of this instance.
+   *
+   * @return shrink policy
+   */
+  inline const stack_alloc_shrink_policy& shrink_policy() const {
+    return shrink_policy_;
+  }
+
+  /**
+   * Return the provider of the blocks of this instance.
+   *
+   * @return block provider
+   */
+  inline const block_provider& provider() const { return *provider_; }
+
   /**
    * Indicates whether the memory in the pointer
    * is in the stack.
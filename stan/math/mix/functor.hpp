@@ -10,5 +10,6 @@
 #include <stan/math/mix/functor/hessian.hpp>
 #include <stan/math/mix/functor/hessian_times_vector.hpp>
 #include <stan/math/mix/functor/partial_derivative.hpp>
+#include <stan/math/mix/functor/sparse_hessian.hpp>
 
 #endif
@@ -2,8 +2,10 @@
 #define STAN_MATH_MIX_FUNCTOR_GRADIENT_DOT_VECTOR_HPP
 
 #include <stan/math/fwd/core.hpp>
+#include <stan/math/prim/err/check_size_match.hpp>
 #include <stan/math/prim/fun/Eigen.hpp>
 #include <stan/math/rev/core.hpp>
+#include <algorithm>
 #include <vector>
 
 namespace stan {
@@ -24,6 +26,50 @@ void gradient_dot_vector(const F& f,
   grad_fx_dot_v = fx_fvar.d_;
 }
 
+/**
+ * Calculate the value of the specified function and the products of
+ * its gradient with the columns of the specified matrix, evaluating the
+ * function once for every `N` columns with multi-directional forward
+ * variables (`fvar_n<T1, N>`).
+ *
+ * @tparam N number of directions per evaluation
+ * @tparam T1 type of the argument and of the results
+ * @tparam T2 type of the directions
+ * @tparam F type of function
+ * @param[in] f function, accepting a column vector of `fvar_n<T1, N>`
+ * @param[in] x argument
+ * @param[in] v matrix whose columns are the directions
+ * @param[out] fx value of the function
+ * @param[out] grad_fx_dot_v products of the gradient with the columns of
+ * `v`
+ */
+template <int N, typename T1, typename T2, typename F>
+void gradient_dot_vector(
+    const F& f, const Eigen::Matrix<T1, Eigen::Dynamic, 1>& x,
+    const Eigen::Matrix<T2, Eigen::Dynamic, Eigen::Dynamic>& v, T1& fx,
+    Eigen::Matrix<T1, Eigen::Dynamic, 1>& grad_fx_dot_v) {
+  using Eigen::Matrix;
+  check_size_match("gradient_dot_vector", "rows of v", v.rows(),
+                   "size of x", x.size());
+  const int m = v.cols();
+  grad_fx_dot_v.resize(m);
+  Matrix<fvar_n<T1, N>, Eigen::Dynamic, 1> x_fvar(x.size());
+  for (int first = 0; first == 0 || first < m; first += N) {
+    const int width = std::min(N, m - first);
+    for (int i = 0; i < x.size(); ++i) {
+      x_fvar(i) = fvar_n<T1, N>(x(i));
+      for (int k = 0; k < width; ++k) {
+        x_fvar(i).d_(k) = v(i, first + k);
+      }
+    }
+    fvar_n<T1, N> fx_fvar = f(x_fvar);
+    if (first == 0) {
+      fx = fx_fvar.val_;
+    }
+    grad_fx_dot_v.segment(first, width) = fx_fvar.d_.head(width).matrix();
+  }
+}
+
 }  // namespace math
 }  // namespace stan
 #endif
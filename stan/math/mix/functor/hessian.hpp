@@ -4,6 +4,8 @@
 #include <stan/math/fwd/core.hpp>
 #include <stan/math/prim/fun/Eigen.hpp>
 #include <stan/math/rev/core.hpp>
+#include <stan/math/rev/functor/edge_pushing_hessian.hpp>
+#include <algorithm>
 #include <stdexcept>
 
 namespace stan {
@@ -70,6 +72,127 @@ void hessian(const F& f, const Eigen::Matrix<double, Eigen::Dynamic, 1>& x,
   }
 }
 
+/**
+ * Calculate the value, the gradient, and the Hessian, of the specified
+ * function at the specified argument, evaluating the function once for
+ * every `N` rows of the Hessian with multi-directional forward
+ * variables (`fvar_n<var, N>`) instead of once per row.
+ *
+ * The rows of a chunk are computed by one reverse pass each over the
+ * tape of the evaluation.
+ *
+ * The functor must implement
+ *
+ * <code>
+ * fvar_n<var, N>
+ * operator()(const Eigen::Matrix<fvar_n<var, N>, Eigen::Dynamic, 1>&)
+ * </code>
+ *
+ * using only the operations implemented for `fvar_n`.
+ *
+ * @tparam N number of directions per evaluation
+ * @tparam F type of function
+ * @param[in] f function
+ * @param[in] x argument to function
+ * @param[out] fx function applied to argument
+ * @param[out] grad gradient of function at argument
+ * @param[out] H Hessian of function at argument
+ */
+template <int N, typename F>
+void hessian(const F& f, const Eigen::Matrix<double, Eigen::Dynamic, 1>& x,
+             double& fx, Eigen::Matrix<double, Eigen::Dynamic, 1>& grad,
+             Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>& H) {
+  H.resize(x.size(), x.size());
+  grad.resize(x.size());
+
+  // need to compute fx even with size = 0
+  if (x.size() == 0) {
+    fx = f(x);
+    return;
+  }
+  const int n = x.size();
+  for (int first = 0; first < n; first += N) {
+    // Run nested autodiff in this scope
+    nested_rev_autodiff nested;
+
+    Eigen::Matrix<fvar_n<var, N>, Eigen::Dynamic, 1> x_fvar(n);
+    for (int j = 0; j < n; ++j) {
+      const int direction = j >= first && j < first + N ? j - first : -1;
+      x_fvar(j) = fvar_n<var, N>::unit(x(j), direction);
+    }
+    fvar_n<var, N> fx_fvar = f(x_fvar);
+    if (first == 0) {
+      fx = fx_fvar.val_.val();
+    }
+    const int width = std::min(N, n - first);
+    for (int k = 0; k < width; ++k) {
+      grad(first + k) = fx_fvar.d_(k).val();
+      if (k > 0) {
+        nested.set_zero_all_adjoints();
+      }
+      stan::math::grad(fx_fvar.d_(k).vi_);
+      for (int j = 0; j < n; ++j) {
+        H(first + k, j) = x_fvar(j).val_.adj();
+      }
+    }
+  }
+}
+
+/**
+ * Algorithms computing Hessians.
+ */
+enum class hessian_method {
+  /// one evaluation with `fvar<var>` and one reverse pass per row
+  forward_over_reverse,
+  /// one evaluation with `var` and one second order reverse sweep
+  /// (edge pushing), if the tape supports it; needs `STAN_COMPACT_TAPE`
+  /// and is `forward_over_reverse` without it
+  edge_pushing
+};
+
+/**
+ * Calculate the value, the gradient, and the Hessian, of the specified
+ * function at the specified argument with the specified algorithm.
+ *
+ * With `hessian_method::edge_pushing` the function is evaluated once
+ * with `var` and the Hessian is computed by a single second order
+ * reverse sweep over its tape (see `internal::edge_pushing_hessian()`),
+ * which costs about as much as a few gradients when the Hessian is
+ * sparse, instead of one forward and reverse pass per variable. The
+ * second order sweep needs the second partials of every operation,
+ * which are only recorded, for the arithmetic operators and for `exp`,
+ * `log`, `sqrt` and `square`, when the whole program is compiled with
+ * `STAN_COMPACT_TAPE` (see the Compact Tape page of the documentation).
+ * Without it `hessian_method::edge_pushing` computes the Hessian like
+ * `hessian()`, without evaluating the function with `var`; with it, the
+ * Hessian of a function using any other operation is computed like
+ * `hessian()` after the first evaluation.
+ *
+ * The functor must then be callable with vectors of both `var` and
+ * `fvar<var>`.
+ *
+ * @tparam F type of function
+ * @param[in] f function
+ * @param[in] x argument to function
+ * @param[out] fx function applied to argument
+ * @param[out] grad gradient of function at argument
+ * @param[out] H Hessian of function at argument
+ * @param[in] method algorithm
+ */
+template <typename F>
+void hessian(const F& f, const Eigen::Matrix<double, Eigen::Dynamic, 1>& x,
+             double& fx, Eigen::Matrix<double, Eigen::Dynamic, 1>& grad,
+             Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>& H,
+             hessian_method method) {
+#ifdef STAN_COMPACT_TAPE
+  if (method == hessian_method::edge_pushing && x.size() > 0
+      && internal::edge_pushing_hessian(f, x, fx, grad, H)) {
+    return;
+  }
+#endif
+  hessian(f, x, fx, grad, H);
+}
+
 }  // namespace math
 }  // namespace stan
 #endif
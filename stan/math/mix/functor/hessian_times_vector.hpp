@@ -3,7 +3,10 @@
 
 #include <stan/math/fwd/core.hpp>
 #include <stan/math/prim/fun/Eigen.hpp>
+#include <stan/math/prim/err.hpp>
 #include <stan/math/rev/core.hpp>
+#include <stan/math/rev/core/compact_tape_lanes.hpp>
+#include <algorithm>
 #include <stdexcept>
 #include <vector>
 
@@ -47,6 +50,146 @@ void hessian_times_vector(const F& f,
   Hv = H * v;
 }
 
+/**
+ * Calculate the value of the specified function at the specified
+ * argument and the product of its Hessian with every column of the
+ * specified matrix.
+ *
+ * When the whole program is compiled with `STAN_COMPACT_TAPE` (see the
+ * Compact Tape page of the documentation), the function is evaluated
+ * once with `var`, and when its tape consists of compact tape
+ * operations, whose second partials are known, the products are
+ * computed `N` columns at
+ * a time by second order adjoint sweeps over this single tape: a
+ * forward sweep propagates `N` lanes of tangents, the columns, from the
+ * argument to every result, and a reverse sweep propagates `N` lanes of
+ * second order adjoints, the products, back to the argument. This
+ * replaces one evaluation with `fvar<var>` and one reverse pass per
+ * column.
+ *
+ * Otherwise, and always without `STAN_COMPACT_TAPE`, every column is
+ * multiplied by a call to the single vector `hessian_times_vector()`.
+ *
+ * The functor must be callable with vectors of both `var` and
+ * `fvar<var>`.
+ *
+ * @tparam N number of columns per sweep
+ * @tparam F type of function
+ * @param[in] f function
+ * @param[in] x argument to function
+ * @param[in] V matrix with one direction per column
+ * @param[out] fx function applied to argument
+ * @param[out] HV product of the Hessian of the function at the
+ * argument with `V`
+ * @throw std::invalid_argument if `V` does not have one row per
+ * element of `x`
+ */
+template <int N = 8, typename F>
+void hessian_times_vector(
+    const F& f, const Eigen::Matrix<double, Eigen::Dynamic, 1>& x,
+    const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>& V,
+    double& fx, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>& HV) {
+  check_size_match("hessian_times_vector", "rows of directions", V.rows(),
+                   "size of argument", x.size());
+  const int n = x.size();
+  const int num_directions = V.cols();
+  HV.resize(n, num_directions);
+#ifdef STAN_COMPACT_TAPE
+  {
+    using lanes_t = Eigen::Matrix<double, N, Eigen::Dynamic>;
+    // Run nested autodiff in this scope
+    nested_rev_autodiff nested;
+
+    Eigen::Matrix<var, Eigen::Dynamic, 1> x_var(x);
+    var fx_var = f(x_var);
+    fx = fx_var.val();
+    internal::compact_tape_lanes tape;
+    if (num_directions == 0) {
+      return;
+    }
+    if (tape.linearize_nested(true)) {
+      const int out = tape.slot(fx_var.vi_);
+      if (out < 0) {
+        HV.setZero();
+        return;
+      }
+      std::vector<int> x_slots(n);
+      for (int i = 0; i < n; ++i) {
+        x_slots[i] = tape.slot(x_var(i).vi_);
+      }
+      const size_t num_ops = tape.num_ops();
+      std::vector<double> adj(tape.num_slots(), 0.0);
+      adj[out] = 1;
+      for (size_t op = num_ops; op-- > 0;) {
+        const double adj_res = adj[tape.result(op)];
+        adj[tape.first_operand(op)] += tape.first_partial(op) * adj_res;
+        if (tape.second_operand(op) >= 0) {
+          adj[tape.second_operand(op)] += tape.second_partial(op) * adj_res;
+        }
+      }
+
+      lanes_t tangents(N, tape.num_slots());
+      lanes_t adj_tangents(N, tape.num_slots());
+      for (int first = 0; first < num_directions; first += N) {
+        const int width = std::min(N, num_directions - first);
+        tangents.setZero();
+        adj_tangents.setZero();
+        for (int i = 0; i < n; ++i) {
+          tangents.col(x_slots[i]).head(width)
+              = V.row(i).segment(first, width).transpose();
+        }
+        for (size_t op = 0; op < num_ops; ++op) {
+          const int b = tape.second_operand(op);
+          tangents.col(tape.result(op))
+              = tape.first_partial(op) * tangents.col(tape.first_operand(op));
+          if (b >= 0) {
+            tangents.col(tape.result(op))
+                += tape.second_partial(op) * tangents.col(b);
+          }
+        }
+        for (size_t op = num_ops; op-- > 0;) {
+          const int v = tape.result(op);
+          const int a = tape.first_operand(op);
+          const int b = tape.second_operand(op);
+          double daa, dab, dbb;
+          tape.second_partials(op, daa, dab, dbb);
+          const Eigen::Matrix<double, N, 1> adj_tangent = adj_tangents.col(v);
+          const double adj_v = adj[v];
+          adj_tangents.col(a)
+              += tape.first_partial(op) * adj_tangent
+                 + (adj_v * daa) * tangents.col(a);
+          if (b >= 0) {
+            adj_tangents.col(a) += (adj_v * dab) * tangents.col(b);
+            adj_tangents.col(b)
+                += tape.second_partial(op) * adj_tangent
+                   + (adj_v * dab) * tangents.col(a)
+                   + (adj_v * dbb) * tangents.col(b);
+          }
+        }
+        for (int i = 0; i < n; ++i) {
+          HV.row(i).segment(first, width)
+              = adj_tangents.col(x_slots[i]).head(width).transpose();
+        }
+      }
+      return;
+    }
+  }
+#else
+  if (num_directions == 0) {
+    nested_rev_autodiff nested;
+    Eigen::Matrix<var, Eigen::Dynamic, 1> x_var(x);
+    fx = f(x_var).val();
+    return;
+  }
+#endif
+  Eigen::Matrix<double, Eigen::Dynamic, 1> Hv;
+  for (int j = 0; j < num_directions; ++j) {
+    const Eigen::Matrix<double, Eigen::Dynamic, 1> v = V.col(j);
+    hessian_times_vector(f, x, v, fx, Hv);
+    HV.col(j) = Hv;
+  }
+}
+
 }  // namespace math
 }  // namespace stan
 #endif
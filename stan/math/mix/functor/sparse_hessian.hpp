@@ -0,0 +1,165 @@
+#ifndef STAN_MATH_MIX_FUNCTOR_SPARSE_HESSIAN_HPP
+#define STAN_MATH_MIX_FUNCTOR_SPARSE_HESSIAN_HPP
+
+#include <stan/math/fwd/core.hpp>
+#include <stan/math/mix/functor/hessian.hpp>
+#include <stan/math/prim/err.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <stan/math/prim/functor/sparse_coloring.hpp>
+#include <stan/math/rev/core.hpp>
+#include <vector>
+
+namespace stan {
+namespace math {
+
+/**
+ * Return the sparsity pattern of the Hessian of the specified function
+ * at the specified argument, as the nonzeros of its dense Hessian.
+ *
+ * The pattern is meant to be computed once and passed to
+ * `sparse_hessian()` for many evaluations of the Hessian. Derivatives
+ * which happen to be zero at `x` are missing from the pattern, so `x`
+ * should be a generic point, or the pattern should be built from the
+ * structure of the function.
+ *
+ * @tparam F type of function
+ * @param[in] f function, as for `hessian()`
+ * @param[in] x argument
+ * @return symmetric pattern with a one for every nonzero
+ */
+template <typename F>
+Eigen::SparseMatrix<double> hessian_sparsity(
+    const F& f, const Eigen::Matrix<double, Eigen::Dynamic, 1>& x) {
+  double fx;
+  Eigen::Matrix<double, Eigen::Dynamic, 1> grad;
+  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> H;
+  hessian(f, x, fx, grad, H);
+  Eigen::SparseMatrix<double> pattern(x.size(), x.size());
+  std::vector<Eigen::Triplet<double>> nonzeros;
+  for (int j = 0; j < x.size(); ++j) {
+    for (int i = 0; i < x.size(); ++i) {
+      if (H(i, j) != 0 || H(j, i) != 0) {
+        nonzeros.emplace_back(i, j, 1.0);
+      }
+    }
+  }
+  pattern.setFromTriplets(nonzeros.begin(), nonzeros.end());
+  return pattern;
+}
+
+/**
+ * Calculate the value, the gradient, and the sparse Hessian of the
+ * specified function at the specified argument, given the sparsity
+ * pattern of the Hessian.
+ *
+ * The variables are star colored (see `internal::star_color()`), and
+ * the product of the Hessian with the sum of the unit vectors of the
+ * variables of every color is computed like a row of `hessian()`, by
+ * one evaluation of the function with `fvar<var>` and one reverse pass.
+ * Every nonzero of the Hessian is then read from one of these products,
+ * exploiting its symmetry. The number of evaluations is the number of
+ * colors, which for banded, block structured or arrowhead Hessians is
+ * small and independent of the number of variables.
+ *
+ * The functor must be usable by `hessian()`. Nonzeros of the Hessian
+ * outside of the pattern are silently added to other elements.
+ *
+ * @tparam F type of function
+ * @param[in] f function
+ * @param[in] x argument to function
+ * @param[in] pattern sparsity pattern of the Hessian, whose stored
+ * elements are the nonzeros; it is symmetrized, so the lower or upper
+ * triangle is enough; for example from `hessian_sparsity()`
+ * @param[out] fx function applied to argument
+ * @param[out] grad gradient of function at argument
+ * @param[out] H Hessian of function at argument, with the nonzeros of
+ * the symmetrized pattern
+ * @throw std::invalid_argument if the pattern is not square with one
+ * row per variable
+ */
+template <typename F>
+void sparse_hessian(const F& f,
+                    const Eigen::Matrix<double, Eigen::Dynamic, 1>& x,
+                    const Eigen::SparseMatrix<double>& pattern, double& fx,
+                    Eigen::Matrix<double, Eigen::Dynamic, 1>& grad,
+                    Eigen::SparseMatrix<double>& H) {
+  static const char* function = "sparse_hessian";
+  check_size_match(function, "rows of pattern", pattern.rows(),
+                   "size of argument", x.size());
+  check_size_match(function, "columns of pattern", pattern.cols(),
+                   "size of argument", x.size());
+  const int n = x.size();
+  grad.resize(n);
+  H.resize(n, n);
+
+  // need to compute fx even with size = 0
+  if (n == 0) {
+    fx = f(x);
+    return;
+  }
+  const auto adjacency = internal::symmetric_adjacency(pattern);
+  std::vector<int> colors;
+  const int num_colors = internal::star_color(adjacency, colors);
+
+  // column c holds the product of the Hessian with the seed of color c
+  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> compressed(
+      n, num_colors);
+  for (int c = 0; c < num_colors; ++c) {
+    // Run nested autodiff in this scope
+    nested_rev_autodiff nested;
+
+    Eigen::Matrix<fvar<var>, Eigen::Dynamic, 1> x_fvar(n);
+    for (int j = 0; j < n; ++j) {
+      x_fvar(j) = fvar<var>(x(j), colors[j] == c);
+    }
+    fvar<var> fx_fvar = f(x_fvar);
+    if (c == 0) {
+      fx = fx_fvar.val_.val();
+      stan::math::grad(fx_fvar.val_.vi_);
+      for (int j = 0; j < n; ++j) {
+        grad(j) = x_fvar(j).val_.adj();
+      }
+      nested.set_zero_all_adjoints();
+    }
+    stan::math::grad(fx_fvar.d_.vi_);
+    for (int j = 0; j < n; ++j) {
+      compressed(j, c) = x_fvar(j).val_.adj();
+    }
+  }
+
+  std::vector<bool> diagonal(n, false);
+  for (int j = 0; j < pattern.outerSize(); ++j) {
+    for (Eigen::SparseMatrix<double>::InnerIterator it(pattern, j); it;
+         ++it) {
+      if (it.row() == j) {
+        diagonal[j] = true;
+      }
+    }
+  }
+  // H(i, j) is the element i of the product of color j if j is the only
+  // neighbour of i with its color, and else the element j of the
+  // product of color i
+  std::vector<int> count(num_colors, 0);
+  std::vector<Eigen::Triplet<double>> nonzeros;
+  for (int i = 0; i < n; ++i) {
+    for (int j : adjacency[i]) {
+      ++count[colors[j]];
+    }
+    if (diagonal[i]) {
+      nonzeros.emplace_back(i, i, compressed(i, colors[i]));
+    }
+    for (int j : adjacency[i]) {
+      nonzeros.emplace_back(i, j,
+                            count[colors[j]] == 1 ? compressed(i, colors[j])
+                                                  : compressed(j, colors[i]));
+    }
+    for (int j : adjacency[i]) {
+      count[colors[j]] = 0;
+    }
+  }
+  H.setFromTriplets(nonzeros.begin(), nonzeros.end());
+}
+
+}  // namespace math
+}  // namespace stan
+#endif
@@ -10,5 +10,7 @@
 #include <stan/math/prim/core/operator_not_equal.hpp>
 #include <stan/math/prim/core/operator_plus.hpp>
 #include <stan/math/prim/core/operator_subtraction.hpp>
+#include <stan/math/prim/core/parallel_region.hpp>
+#include <stan/math/prim/core/thread_affinity.hpp>
 
 #endif
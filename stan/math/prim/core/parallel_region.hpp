@@ -0,0 +1,110 @@
+#ifndef STAN_MATH_PRIM_CORE_PARALLEL_REGION_HPP
+#define STAN_MATH_PRIM_CORE_PARALLEL_REGION_HPP
+
+#include <tbb/task_arena.h>
+
+#include <utility>
+
+namespace stan {
+namespace math {
+
+namespace internal {
+
+/**
+ * What the calling thread executes with respect to the parallel
+ * functors.
+ */
+enum class parallel_task_kind {
+  /// not a task of a parallel functor
+  none,
+  /// a task of a parallel functor whose nested parallel algorithms
+  /// share its region
+  shared,
+  /// a task of a parallel functor whose nested parallel algorithms are
+  /// isolated
+  isolated
+};
+
+/**
+ * Return what the calling thread executes.
+ */
+inline parallel_task_kind& current_parallel_task() {
+  static thread_local parallel_task_kind kind = parallel_task_kind::none;
+  return kind;
+}
+
+}  // namespace internal
+
+/**
+ * Marks the calling thread as executing a task of a parallel functor
+ * for the lifetime of the object.
+ *
+ * Tasks must leave the AD tape of the thread executing them as they
+ * found it, by recording their work in a nested AD tape
+ * (`nested_rev_autodiff`) or on their own tape (`ScopedChainableStack`),
+ * and must not wait for nested parallel algorithms while their own tape
+ * is swapped in by `ScopedChainableStack::execute` if that tape can be
+ * used by another task of the same region.
+ */
+class parallel_task_scope {
+  internal::parallel_task_kind parent_;
+
+ public:
+  /**
+   * @param share_region if true, the nested parallel algorithms called
+   * by the task share its region, otherwise they are isolated, which
+   * keeps the order of evaluation of deterministic algorithms
+   */
+  explicit parallel_task_scope(bool share_region = true)
+      : parent_(internal::current_parallel_task()) {
+    internal::current_parallel_task()
+        = share_region ? internal::parallel_task_kind::shared
+                       : internal::parallel_task_kind::isolated;
+  }
+
+  ~parallel_task_scope() { internal::current_parallel_task() = parent_; }
+
+  parallel_task_scope(const parallel_task_scope&) = delete;
+  parallel_task_scope& operator=(const parallel_task_scope&) = delete;
+};
+
+/**
+ * Run the parallel algorithm of a parallel functor.
+ *
+ * Every thread has its own AD tape, on which the tasks of the parallel
+ * functors record their work nested. A thread waiting for the tasks of
+ * a parallel algorithm may execute other tasks of the TBB arena. When
+ * called outside of the tasks of the parallel functors, the algorithm
+ * is run in its own isolated region (see `tbb::this_task_arena::isolate`),
+ * so that a waiting thread never executes unrelated work, like the
+ * gradient of another chain, which would record on its AD tape below
+ * the nested work of the region.
+ *
+ * When called from a task of a parallel functor, for example by
+ * `reduce_sum` within a job of `map_rect` or within the partial sum of
+ * another `reduce_sum`, the algorithm runs in the region of the
+ * enclosing functor. The nested tasks are then executed by the threads
+ * of the arena like the tasks of the enclosing algorithm, and a thread
+ * waiting anywhere in the hierarchy may execute any task of the region,
+ * each of which leaves its AD tape as it found it. This avoids both
+ * idle threads, which wait in isolated inner regions, and
+ * oversubscription, since all the functors share one arena.
+ *
+ * @tparam F type of the algorithm
+ * @param f algorithm, called without arguments
+ */
+template <typename F>
+inline void run_parallel_region(F&& f) {
+  if (internal::current_parallel_task()
+      == internal::parallel_task_kind::shared) {
+    f();
+  } else {
+    const parallel_task_scope outside_of_tasks(true);
+    tbb::this_task_arena::isolate(std::forward<F>(f));
+  }
+}
+
+}  // namespace math
+}  // namespace stan
+
+#endif
@@ -0,0 +1,484 @@
+#ifndef STAN_MATH_PRIM_CORE_THREAD_AFFINITY_HPP
+#define STAN_MATH_PRIM_CORE_THREAD_AFFINITY_HPP
+
+#include <stan/math/prim/err/invalid_argument.hpp>
+#include <stan/math/prim/core/init_threadpool_tbb.hpp>
+
+#include <tbb/task_arena.h>
+#include <tbb/task_scheduler_observer.h>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace stan {
+namespace math {
+
+/**
+ * Placement of the worker threads of the TBB on the cores of the
+ * machine.
+ */
+enum class thread_affinity {
+  /// workers are placed by the operating system
+  none,
+  /// every worker is pinned to one core
+  cores,
+  /// every worker is pinned to the cores of one NUMA node
+  numa
+};
+
+/**
+ * A NUMA node of the machine and the cores of it available to the
+ * process.
+ */
+struct numa_node {
+  /// index of the node
+  int id_;
+  /// cores of the node available to the process
+  std::vector<int> cpus_;
+};
+
+namespace internal {
+
+/**
+ * Parse a list of cores in the format of the Linux sysfs, like
+ * "0-3,8,10-11".
+ *
+ * @param list list of cores
+ * @return cores, in increasing order
+ * @throw std::invalid_argument if the list is malformed
+ */
+inline std::vector<int> parse_cpu_list(const std::string& list) {
+  std::vector<int> cpus;
+  std::stringstream ranges(list);
+  std::string range;
+  while (std::getline(ranges, range, ',')) {
+    range.erase(std::remove_if(range.begin(), range.end(),
+                               [](char c) { return std::isspace(c); }),
+                range.end());
+    if (range.empty()) {
+      continue;
+    }
+    const size_t dash = range.find('-');
+    try {
+      size_t end_first = 0;
+      const int first = std::stoi(range.substr(0, dash), &end_first);
+      int last = first;
+      if (dash != std::string::npos) {
+        size_t end_last = 0;
+        last = std::stoi(range.substr(dash + 1), &end_last);
+        if (end_last != range.size() - dash - 1) {
+          throw std::invalid_argument("trailing characters");
+        }
+      } else if (end_first != range.size()) {
+        throw std::invalid_argument("trailing characters");
+      }
+      if (first < 0 || last < first) {
+        throw std::invalid_argument("bad range");
+      }
+      for (int cpu = first; cpu <= last; ++cpu) {
+        cpus.push_back(cpu);
+      }
+    } catch (const std::logic_error&) {
+      invalid_argument("parse_cpu_list", "list", list.c_str(),
+                       "The list of cores is '",
+                       "' but it must be ranges like 0-3,8");
+    }
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return cpus;
+}
+
+/**
+ * Return the cores the calling thread may run on, or all cores if they
+ * cannot be determined.
+ */
+inline std::vector<int> allowed_cpus() {
+  std::vector<int> cpus;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+#endif
+  if (cpus.empty()) {
+    const int num_cpus = std::max(1u, std::thread::hardware_concurrency());
+    for (int cpu = 0; cpu < num_cpus; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+/**
+ * Read the NUMA nodes of the machine from the Linux sysfs, keeping the
+ * cores available to the process. If the nodes cannot be read, all
+ * available cores are returned as a single node.
+ *
+ * @param sysfs_node_dir directory of the nodes in the sysfs
+ * @return NUMA nodes having available cores
+ */
+inline std::vector<numa_node> read_numa_topology(
+    const std::string& sysfs_node_dir = "/sys/devices/system/node") {
+  const std::vector<int> allowed = allowed_cpus();
+  std::vector<numa_node> nodes;
+  std::vector<int> online{0};
+  std::ifstream online_file(sysfs_node_dir + "/online");
+  std::string online_list;
+  if (online_file && std::getline(online_file, online_list)) {
+    try {
+      online = parse_cpu_list(online_list);
+    } catch (const std::invalid_argument&) {
+      online.clear();
+    }
+  }
+  for (int id : online) {
+    std::ifstream cpulist_file(sysfs_node_dir + "/node" + std::to_string(id)
+                               + "/cpulist");
+    std::string cpulist;
+    if (!cpulist_file || !std::getline(cpulist_file, cpulist)) {
+      continue;
+    }
+    std::vector<int> cpus;
+    try {
+      cpus = parse_cpu_list(cpulist);
+    } catch (const std::invalid_argument&) {
+      continue;
+    }
+    numa_node node{id, {}};
+    std::set_intersection(cpus.begin(), cpus.end(), allowed.begin(),
+                          allowed.end(), std::back_inserter(node.cpus_));
+    if (!node.cpus_.empty()) {
+      nodes.push_back(std::move(node));
+    }
+  }
+  if (nodes.empty()) {
+    nodes.push_back({0, allowed});
+  }
+  return nodes;
+}
+
+/**
+ * Return the NUMA node of the core, or -1 if unknown.
+ *
+ * @param nodes NUMA nodes
+ * @param cpu core
+ */
+inline int numa_node_of(const std::vector<numa_node>& nodes, int cpu) {
+  for (const auto& node : nodes) {
+    if (std::binary_search(node.cpus_.begin(), node.cpus_.end(), cpu)) {
+      return node.id_;
+    }
+  }
+  return -1;
+}
+
+/**
+ * Return the NUMA node the calling thread was last pinned to, or -1.
+ */
+inline int& current_thread_numa_node() {
+  static thread_local int node = -1;
+  return node;
+}
+
+/**
+ * Type of the function called on a thread pinned to another NUMA node.
+ */
+using numa_node_change_hook_t = void (*)();
+
+/**
+ * Return the function called on a thread after it was pinned to a NUMA
+ * node other than the one it was on before. The AD library sets it to
+ * release the memory of the AD tape of the thread, so that it is
+ * allocated again on its new node.
+ */
+inline numa_node_change_hook_t& numa_node_change_hook() {
+  static numa_node_change_hook_t hook = nullptr;
+  return hook;
+}
+
+/**
+ * Pin the calling thread to the specified cores of a NUMA node. If the
+ * node differs from the one the thread was pinned to before, the
+ * `numa_node_change_hook()` is called.
+ *
+ * @param cpus cores
+ * @param node NUMA node of the cores
+ * @return true if the thread was pinned, false if pinning is not
+ * supported or failed
+ */
+inline bool pin_current_thread(const std::vector<int>& cpus, int node) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &set);
+    }
+  }
+  if (CPU_COUNT(&set) == 0 || sched_setaffinity(0, sizeof(set), &set) != 0) {
+    return false;
+  }
+  if (node != current_thread_numa_node()) {
+    current_thread_numa_node() = node;
+    if (numa_node_change_hook() != nullptr) {
+      numa_node_change_hook()();
+    }
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * Get the placement of the worker threads from the environment
+ * variable STAN_THREAD_AFFINITY, which is one of "none" (the default
+ * when not set), "cores" or "numa".
+ *
+ * @return placement of the workers
+ * @throw std::invalid_argument if the variable has another value
+ */
+inline thread_affinity get_thread_affinity() {
+  const char* env = std::getenv("STAN_THREAD_AFFINITY");
+  if (env == nullptr) {
+    return thread_affinity::none;
+  }
+  const std::string affinity(env);
+  if (affinity == "none") {
+    return thread_affinity::none;
+  } else if (affinity == "cores") {
+    return thread_affinity::cores;
+  } else if (affinity == "numa") {
+    return thread_affinity::numa;
+  }
+  invalid_argument("get_thread_affinity", "STAN_THREAD_AFFINITY", env,
+                   "The STAN_THREAD_AFFINITY environment variable is '",
+                   "' but it must be none, cores or numa");
+  return thread_affinity::none;
+}
+
+}  // namespace internal
+
+/**
+ * Return the NUMA nodes of the machine having cores available to the
+ * process. The topology is read once, from the Linux sysfs; on other
+ * systems all cores form a single node.
+ */
+inline const std::vector<numa_node>& numa_topology() {
+  static const std::vector<numa_node> nodes = internal::read_numa_topology();
+  return nodes;
+}
+
+/**
+ * TBB observer pinning the worker threads entering the observed arena,
+ * or any arena for a global observer, to a set of cores.
+ *
+ * With `thread_affinity::cores` every worker is pinned to its own core,
+ * assigned round robin over the cores in the order in which the workers
+ * first enter. With `thread_affinity::numa` every worker is pinned to
+ * all the cores of the NUMA node of its core. The threads calling into
+ * an arena are not pinned.
+ */
+class thread_affinity_observer final : public tbb::task_scheduler_observer {
+  std::vector<int> cpus_;
+  thread_affinity affinity_;
+  std::atomic<size_t> next_cpu_{0};
+
+  inline void pin(size_t index) {
+    const auto& nodes = numa_topology();
+    const int cpu = cpus_[index % cpus_.size()];
+    const int node = internal::numa_node_of(nodes, cpu);
+    if (affinity_ == thread_affinity::numa) {
+      for (const auto& n : nodes) {
+        if (n.id_ == node) {
+          std::vector<int> node_cpus;
+          std::set_intersection(n.cpus_.begin(), n.cpus_.end(), cpus_.begin(),
+                                cpus_.end(), std::back_inserter(node_cpus));
+          internal::pin_current_thread(node_cpus, node);
+          return;
+        }
+      }
+    }
+    internal::pin_current_thread({cpu}, node);
+  }
+
+ public:
+  /**
+   * Construct a global observer.
+   *
+   * @param cpus cores to place the workers on
+   * @param affinity placement of the workers
+   */
+  thread_affinity_observer(std::vector<int> cpus, thread_affinity affinity)
+      : tbb::task_scheduler_observer(),
+        cpus_(std::move(cpus)),
+        affinity_(affinity) {
+    std::sort(cpus_.begin(), cpus_.end());
+    observe(affinity_ != thread_affinity::none && !cpus_.empty());
+  }
+
+  /**
+   * Construct an observer of the specified arena.
+   *
+   * @param arena arena whose workers are pinned
+   * @param cpus cores to place the workers on
+   * @param affinity placement of the workers
+   */
+  thread_affinity_observer(tbb::task_arena& arena, std::vector<int> cpus,
+                           thread_affinity affinity)
+      : tbb::task_scheduler_observer(arena),
+        cpus_(std::move(cpus)),
+        affinity_(affinity) {
+    std::sort(cpus_.begin(), cpus_.end());
+    observe(affinity_ != thread_affinity::none && !cpus_.empty());
+  }
+
+  ~thread_affinity_observer() { observe(false); }
+
+  void on_scheduler_entry(bool worker) override {
+    if (!worker) {
+      return;
+    }
+    static thread_local const thread_affinity_observer* pinned_by = nullptr;
+    static thread_local size_t index = 0;
+    if (pinned_by != this) {
+      pinned_by = this;
+      index = next_cpu_++;
+    }
+    pin(index);
+  }
+};
+
+/**
+ * Initialize the Intel TBB threadpool as `init_threadpool_tbb` and pin
+ * its workers as specified by the environment variable
+ * STAN_THREAD_AFFINITY (see `internal::get_thread_affinity`).
+ *
+ * With "cores" every worker is pinned to one of the cores available to
+ * the process, with "numa" to all the cores of one NUMA node. The cores
+ * are assigned in order of the NUMA nodes, so that the workers fill
+ * one node after the other, and their AD tapes are kept on the memory of
+ * their node by the first-touch policy of the operating system.
+ *
+ * @param n_threads number of threads, see `init_threadpool_tbb`
+ * @return reference to the static tbb::task_arena
+ * @throw std::invalid_argument if STAN_THREAD_AFFINITY is invalid
+ */
+#ifdef TBB_INTERFACE_NEW
+inline tbb::task_arena& init_threadpool_tbb_pinned(int n_threads = 0) {
+#else
+inline tbb::task_scheduler_init& init_threadpool_tbb_pinned(
+    int n_threads = 0) {
+#endif
+  const thread_affinity affinity = internal::get_thread_affinity();
+  std::vector<int> cpus;
+  for (const auto& node : numa_topology()) {
+    cpus.insert(cpus.end(), node.cpus_.begin(), node.cpus_.end());
+  }
+  // the first core is left to the thread calling into the arena
+  if (cpus.size() > 1) {
+    std::rotate(cpus.begin(), cpus.begin() + 1, cpus.end());
+  }
+  static thread_affinity_observer observer(cpus, affinity);
+  return init_threadpool_tbb(n_threads);
+}
+
+/**
+ * Task arenas, one per NUMA node, whose workers are pinned to the cores
+ * of their node. Independent work, like the chains of a sampler, can
+ * be run in the arena of a node with `tbb::task_arena::execute`; the
+ * parallel functors it calls then use the workers of that node only,
+ * whose AD tapes stay on the memory of the node.
+ */
+class numa_task_arenas {
+  std::vector<std::unique_ptr<tbb::task_arena>> arenas_;
+  std::vector<std::unique_ptr<thread_affinity_observer>> observers_;
+  std::vector<numa_node> nodes_;
+
+ public:
+  /**
+   * Create the arenas.
+   *
+   * @param nodes NUMA nodes
+   * @param affinity placement of the workers within their node, either
+   * `thread_affinity::cores` or `thread_affinity::numa`
+   * @param threads_per_node number of threads of every arena, including
+   * the thread calling into it, or 0 for the number of cores of the node
+   * @throw std::invalid_argument if threads_per_node is negative or the
+   * affinity is `thread_affinity::none`
+   */
+  explicit numa_task_arenas(const std::vector<numa_node>& nodes,
+                            thread_affinity affinity = thread_affinity::numa,
+                            int threads_per_node = 0)
+      : nodes_(nodes) {
+    if (threads_per_node < 0) {
+      invalid_argument("numa_task_arenas", "threads_per_node",
+                       threads_per_node, "The number of threads is '",
+                       "' but it must be non-negative");
+    }
+    if (affinity == thread_affinity::none) {
+      throw std::invalid_argument(
+          "numa_task_arenas: the workers must be pinned to cores or nodes");
+    }
+    for (const auto& node : nodes_) {
+      const int num_threads = threads_per_node > 0
+                                  ? threads_per_node
+                                  : static_cast<int>(node.cpus_.size());
+      arenas_.emplace_back(std::make_unique<tbb::task_arena>(num_threads, 1));
+      arenas_.back()->initialize();
+      observers_.emplace_back(std::make_unique<thread_affinity_observer>(
+          *arenas_.back(), node.cpus_, affinity));
+    }
+  }
+
+  numa_task_arenas(const numa_task_arenas&) = delete;
+  numa_task_arenas& operator=(const numa_task_arenas&) = delete;
+
+  ~numa_task_arenas() {
+    observers_.clear();
+    arenas_.clear();
+  }
+
+  /**
+   * Return the number of arenas.
+   */
+  inline size_t size() const noexcept { return arenas_.size(); }
+
+  /**
+   * Return the arena of the specified node.
+   *
+   * @param i index of the node in the list of nodes
+   */
+  inline tbb::task_arena& operator[](size_t i) { return *arenas_[i]; }
+
+  /**
+   * Return the node of the specified arena.
+   *
+   * @param i index of the node in the list of nodes
+   */
+  inline const numa_node& node(size_t i) const { return nodes_[i]; }
+};
+
+}  // namespace math
+}  // namespace stan
+
+#endif
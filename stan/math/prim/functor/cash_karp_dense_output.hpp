@@ -0,0 +1,211 @@
+#ifndef STAN_MATH_PRIM_FUNCTOR_CASH_KARP_DENSE_OUTPUT_HPP
+#define STAN_MATH_PRIM_FUNCTOR_CASH_KARP_DENSE_OUTPUT_HPP
+
+#include <boost/numeric/odeint.hpp>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace math {
+namespace internal {
+
+/**
+ * Dense output stepper of Boost.Odeint for the adaptive Cash-Karp 5(4)
+ * method, so that `integrate_times()` steps freely and interpolates the
+ * solution at the output times.
+ *
+ * Cash-Karp has no continuous extension of its own. The cubic Hermite
+ * interpolant of the states and derivatives at the ends of a step is
+ * only third order, with errors far above the tolerances of the steps,
+ * so the solution within a step is the quartic polynomial which also
+ * matches the derivative at a quarter of the step, evaluated at the
+ * cubic Hermite interpolant there. Like the continuous extension of
+ * Dormand-Prince, it is fourth order. The derivative at the end of a
+ * step is the first stage of the next one, so the interpolant only costs
+ * the evaluation of the right hand side at a quarter of every step
+ * containing output times.
+ * Applied to the coupled ODE system it interpolates the sensitivities
+ * the same way as the states.
+ *
+ * @tparam System type of ODE system
+ */
+template <typename System>
+class cash_karp_dense_output {
+ public:
+  using state_type = std::vector<double>;
+  using value_type = double;
+  using deriv_type = std::vector<double>;
+  using time_type = double;
+  using stepper_category = boost::numeric::odeint::dense_output_stepper_tag;
+
+ private:
+  using error_stepper_type
+      = boost::numeric::odeint::runge_kutta_cash_karp54<state_type, double,
+                                                         deriv_type, double>;
+  using controlled_stepper_type
+      = boost::numeric::odeint::controlled_runge_kutta<error_stepper_type>;
+
+  controlled_stepper_type controlled_;
+  System& system_;
+  state_type x_;
+  state_type x_old_;
+  deriv_type dxdt_;
+  deriv_type dxdt_old_;
+  double t_ = 0;
+  double t_old_ = 0;
+  double dt_ = 0;
+  bool dxdt_current_ = false;
+  mutable state_type x_node_;
+  mutable deriv_type dxdt_node_;
+  mutable bool dxdt_node_current_ = false;
+
+  /**
+   * Return the cubic Hermite interpolant of an element of the state
+   * within the last step.
+   *
+   * @param i index of the element
+   * @param theta position within the step, between 0 and 1
+   * @param h size of the step
+   */
+  double cubic_hermite(std::size_t i, double theta, double h) const {
+    const double theta1 = theta - 1;
+    const double dx = x_[i] - x_old_[i];
+    return x_old_[i] + theta * dx
+           + theta * theta1
+                 * ((1 - 2 * theta) * dx + theta1 * h * dxdt_old_[i]
+                    + theta * h * dxdt_[i]);
+  }
+
+ public:
+  /**
+   * Construct the stepper from the ODE system it integrates, which
+   * evaluates the derivatives within the steps, and the tolerances of
+   * its error control.
+   *
+   * @param system ODE system
+   * @param absolute_tolerance absolute tolerance
+   * @param relative_tolerance relative tolerance
+   */
+  cash_karp_dense_output(System& system, double absolute_tolerance,
+                         double relative_tolerance)
+      : controlled_(boost::numeric::odeint::make_controlled(
+            absolute_tolerance, relative_tolerance, error_stepper_type())),
+        system_(system) {}
+
+  /**
+   * Start the integration at the specified state and time.
+   *
+   * @param x0 state
+   * @param t0 time
+   * @param dt0 size of the first step attempted
+   */
+  void initialize(const state_type& x0, double t0, double dt0) {
+    x_ = x0;
+    t_ = t0;
+    dt_ = dt0;
+    dxdt_.resize(x_.size());
+    dxdt_current_ = false;
+    dxdt_node_current_ = false;
+  }
+
+  /**
+   * Take a step of the size allowed by the error control.
+   *
+   * @tparam SystemRef type of ODE system, or reference wrapper of it
+   * @param system ODE system
+   * @return start and end time of the step
+   */
+  template <typename SystemRef>
+  std::pair<double, double> do_step(SystemRef system) {
+    typename boost::numeric::odeint::unwrap_reference<SystemRef>::type& sys
+        = system;
+    if (!dxdt_current_) {
+      sys(x_, dxdt_, t_);
+    }
+    std::swap(x_, x_old_);
+    std::swap(dxdt_, dxdt_old_);
+    x_.resize(x_old_.size());
+    dxdt_.resize(x_old_.size());
+    t_old_ = t_;
+    boost::numeric::odeint::failed_step_checker fail_checker;
+    while (controlled_.try_step(system, x_old_, dxdt_old_, t_, x_, dt_)
+           == boost::numeric::odeint::fail) {
+      fail_checker();
+    }
+    sys(x_, dxdt_, t_);
+    dxdt_current_ = true;
+    dxdt_node_current_ = false;
+    return std::make_pair(t_old_, t_);
+  }
+
+  /**
+   * Evaluate the interpolant of the last step at the specified time.
+   *
+   * @param t time within the last step
+   * @param[out] x state at time t
+   */
+  void calc_state(double t, state_type& x) const {
+    const double h = t_ - t_old_;
+    const std::size_t n = x_.size();
+    // position within the step of the derivative matched by the
+    // interpolant, not the middle, where it would not determine it
+    const double theta_node = 0.25;
+    if (!dxdt_node_current_) {
+      x_node_.resize(n);
+      dxdt_node_.resize(n);
+      for (std::size_t i = 0; i < n; ++i) {
+        x_node_[i] = cubic_hermite(i, theta_node, h);
+      }
+      system_(x_node_, dxdt_node_, t_old_ + theta_node * h);
+      dxdt_node_current_ = true;
+    }
+    // x(theta) = x_old + theta h dxdt_old + a theta^2 + b theta^3
+    //            + c theta^4 with x(1) = x, x'(1) = h dxdt and
+    //            x'(1/4) = h dxdt_node
+    const double theta = (t - t_old_) / h;
+    for (std::size_t i = 0; i < n; ++i) {
+      const double slope_old = h * dxdt_old_[i];
+      const double d = x_[i] - x_old_[i] - slope_old;
+      const double e = h * dxdt_[i] - slope_old;
+      const double m = h * dxdt_node_[i] - slope_old;
+      const double c = (5 * e + 16 * m - 18 * d) / 3;
+      const double b = e - 2 * d - 2 * c;
+      const double a = d - b - c;
+      x[i] = x_old_[i]
+             + theta * (slope_old + theta * (a + theta * (b + theta * c)));
+    }
+  }
+
+  const state_type& current_state() const { return x_; }
+
+  double current_time() const { return t_; }
+
+  const state_type& previous_state() const { return x_old_; }
+
+  double previous_time() const { return t_old_; }
+
+  double current_time_step() const { return dt_; }
+};
+
+/**
+ * Return the dense output stepper of the adaptive Cash-Karp 5(4) method
+ * for the specified ODE system.
+ *
+ * @tparam System type of ODE system
+ * @param system ODE system, which must outlive the stepper
+ * @param absolute_tolerance absolute tolerance
+ * @param relative_tolerance relative tolerance
+ * @return stepper
+ */
+template <typename System>
+cash_karp_dense_output<System> make_cash_karp_dense_output(
+    System& system, double absolute_tolerance, double relative_tolerance) {
+  return cash_karp_dense_output<System>(system, absolute_tolerance,
+                                        relative_tolerance);
+}
+
+}  // namespace internal
+}  // namespace math
+}  // namespace stan
+#endif
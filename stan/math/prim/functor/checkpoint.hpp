@@ -0,0 +1,33 @@
+#ifndef STAN_MATH_PRIM_FUNCTOR_CHECKPOINT_HPP
+#define STAN_MATH_PRIM_FUNCTOR_CHECKPOINT_HPP
+
+#include <stan/math/prim/meta.hpp>
+#include <ostream>
+
+namespace stan {
+namespace math {
+
+/**
+ * Return the result of applying the function to the arguments, storing
+ * only the arguments on the AD tape and recomputing the function in
+ * the reverse pass.
+ *
+ * This overload, for arguments without vars, calls the function.
+ *
+ * @tparam F Type of function
+ * @tparam Args Types of arguments
+ * @param f Function
+ * @param[in, out] msgs the print stream for warning messages
+ * @param args arguments to pass to f
+ * @return `f(msgs, args...)`
+ */
+template <typename F, typename... Args,
+          require_all_not_st_var<Args...>* = nullptr>
+inline auto checkpoint(const F& f, std::ostream* msgs, const Args&... args) {
+  return f(msgs, args...);
+}
+
+}  // namespace math
+}  // namespace stan
+
+#endif
@@ -0,0 +1,282 @@
+#ifndef STAN_MATH_PRIM_FUNCTOR_GRAINSIZE_TUNER_HPP
+#define STAN_MATH_PRIM_FUNCTOR_GRAINSIZE_TUNER_HPP
+
+#include <boost/core/demangle.hpp>
+#include <tbb/task_arena.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+
+namespace stan {
+namespace math {
+
+/**
+ * Timings of the chunks of work evaluated by a parallel algorithm. The
+ * sums kept are those needed to fit the time of a chunk as a linear
+ * function of its number of terms.
+ */
+struct chunk_timings {
+  double num_chunks_{0.0};
+  double sum_terms_{0.0};
+  double sum_terms_sq_{0.0};
+  double sum_time_{0.0};
+  double sum_terms_time_{0.0};
+
+  /**
+   * Add the timing of a chunk.
+   *
+   * @param num_terms number of terms of the chunk
+   * @param time time spent on the chunk, in seconds
+   */
+  inline void add(double num_terms, double time) {
+    num_chunks_ += 1.0;
+    sum_terms_ += num_terms;
+    sum_terms_sq_ += num_terms * num_terms;
+    sum_time_ += time;
+    sum_terms_time_ += num_terms * time;
+  }
+
+  inline chunk_timings& operator+=(const chunk_timings& other) {
+    num_chunks_ += other.num_chunks_;
+    sum_terms_ += other.sum_terms_;
+    sum_terms_sq_ += other.sum_terms_sq_;
+    sum_time_ += other.sum_time_;
+    sum_terms_time_ += other.sum_terms_time_;
+    return *this;
+  }
+
+  /**
+   * Multiply the weight of the timings added so far.
+   *
+   * @param factor weight
+   */
+  inline void scale(double factor) {
+    num_chunks_ *= factor;
+    sum_terms_ *= factor;
+    sum_terms_sq_ *= factor;
+    sum_time_ *= factor;
+    sum_terms_time_ *= factor;
+  }
+};
+
+/**
+ * Chooses the grainsize of a parallel reduction from the measured cost
+ * of its chunks of work.
+ *
+ * The time of a chunk of `n` terms is modeled as `o + c * n`, where `c`
+ * is the cost of a term and `o` the fixed overhead of a chunk, and both
+ * are fitted by least squares to the chunks timed so far. The grainsize
+ * is chosen so that a chunk takes at least `target_chunk_time` seconds
+ * and the overhead is at most `max_overhead_fraction` of its time, but
+ * leaving at least `min_chunks_per_thread` chunks per thread of the
+ * task arena for load balancing.
+ *
+ * The grainsize is first tuned after the first evaluation, which uses a
+ * grainsize of 1, then after evaluations 2, 4, 8, ... and eventually
+ * every `max_tuning_interval` evaluations. At every tuning the weight of
+ * the older timings is halved, so that the grainsize follows changes in
+ * the cost of the terms, for example as a sampler moves through the
+ * parameter space.
+ *
+ * The tuner can be updated concurrently from several threads.
+ */
+class grainsize_tuner {
+ public:
+  /**
+   * State of a tuner.
+   */
+  struct summary {
+    /// current grainsize
+    int grainsize_;
+    /// number of evaluations
+    size_t num_evaluations_;
+    /// fitted cost of a term, in seconds
+    double cost_per_term_;
+    /// fitted overhead of a chunk, in seconds
+    double overhead_per_chunk_;
+  };
+
+  /// minimal time of a chunk, in seconds
+  static constexpr double target_chunk_time = 5e-5;
+  /// maximal fraction of the time of a chunk spent in its overhead
+  static constexpr double max_overhead_fraction = 0.1;
+  /// minimal number of chunks for every thread of the task arena
+  static constexpr int min_chunks_per_thread = 4;
+  /// maximal number of evaluations between two tunings
+  static constexpr size_t max_tuning_interval = 256;
+
+ private:
+  mutable std::mutex mutex_;
+  std::atomic<int> grainsize_{1};
+  size_t num_evaluations_{0};
+  size_t next_tuning_{1};
+  chunk_timings timings_;
+  double cost_per_term_{0.0};
+  double overhead_per_chunk_{0.0};
+
+  /**
+   * Fit the cost of a term and the overhead of a chunk to the timings.
+   * If all chunks had the same size, or the fit is not meaningful, the
+   * overhead is taken to be zero.
+   */
+  inline void fit() {
+    const chunk_timings& t = timings_;
+    const double det = t.num_chunks_ * t.sum_terms_sq_
+                       - t.sum_terms_ * t.sum_terms_;
+    double cost = 0.0;
+    double overhead = 0.0;
+    if (t.num_chunks_ >= 2.0 && det > 1e-8 * t.num_chunks_ * t.sum_terms_sq_) {
+      cost = (t.num_chunks_ * t.sum_terms_time_ - t.sum_terms_ * t.sum_time_)
+             / det;
+      overhead = (t.sum_time_ - cost * t.sum_terms_) / t.num_chunks_;
+    }
+    if (!(cost > 0.0) || !(overhead >= 0.0)) {
+      cost = t.sum_time_ / t.sum_terms_;
+      overhead = 0.0;
+    }
+    cost_per_term_ = cost;
+    overhead_per_chunk_ = overhead;
+  }
+
+ public:
+  grainsize_tuner() = default;
+  grainsize_tuner(const grainsize_tuner&) = delete;
+  grainsize_tuner& operator=(const grainsize_tuner&) = delete;
+
+  /**
+   * Return the grainsize to use for the next evaluation.
+   */
+  inline int grainsize() const noexcept {
+    return grainsize_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Record the timings of the chunks of an evaluation and tune the
+   * grainsize if it is due.
+   *
+   * @param num_terms number of terms of the evaluation
+   * @param timings timings of its chunks
+   */
+  inline void update(size_t num_terms, const chunk_timings& timings) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++num_evaluations_;
+    timings_ += timings;
+    if (num_evaluations_ < next_tuning_ || !(timings_.sum_terms_ > 0.0)) {
+      return;
+    }
+    // the constants are copied so that they are not odr-used
+    const size_t max_interval = max_tuning_interval;
+    next_tuning_ = num_evaluations_ + std::min(num_evaluations_, max_interval);
+
+    fit();
+    const double min_chunk_time = target_chunk_time;
+    const double chunk_time = std::max(
+        min_chunk_time, overhead_per_chunk_ / max_overhead_fraction);
+    const double cost = std::max(cost_per_term_, 1e-12);
+    const double max_grainsize = std::max(
+        1.0, std::floor(static_cast<double>(num_terms)
+                        / (min_chunks_per_thread
+                           * tbb::this_task_arena::max_concurrency())));
+    const double grainsize
+        = std::min(max_grainsize, std::max(1.0, std::ceil(chunk_time / cost)));
+    grainsize_.store(static_cast<int>(grainsize), std::memory_order_relaxed);
+    timings_.scale(0.5);
+  }
+
+  /**
+   * Return the state of the tuner.
+   */
+  inline summary get_summary() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {grainsize(), num_evaluations_, cost_per_term_, overhead_per_chunk_};
+  }
+
+  /**
+   * Forget the timings and restart tuning from a grainsize of 1.
+   */
+  inline void reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    grainsize_.store(1, std::memory_order_relaxed);
+    num_evaluations_ = 0;
+    next_tuning_ = 1;
+    timings_ = chunk_timings();
+    cost_per_term_ = 0.0;
+    overhead_per_chunk_ = 0.0;
+  }
+};
+
+namespace internal {
+
+/**
+ * Registry of the grainsize tuners by name.
+ */
+struct grainsize_tuner_registry {
+  std::mutex mutex_;
+  std::map<std::string, std::unique_ptr<grainsize_tuner>> tuners_;
+
+  static inline grainsize_tuner_registry& instance() {
+    static grainsize_tuner_registry registry;
+    return registry;
+  }
+};
+
+/**
+ * Return the grainsize tuner of the reducer function, registered under
+ * the name of its type.
+ *
+ * @tparam ReduceFunction type of reducer function
+ */
+template <typename ReduceFunction>
+inline grainsize_tuner& get_grainsize_tuner() {
+  static grainsize_tuner* tuner = [] {
+    auto& registry = grainsize_tuner_registry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex_);
+    const std::string name
+        = boost::core::demangle(typeid(ReduceFunction).name());
+    auto& t = registry.tuners_[name];
+    if (!t) {
+      t = std::make_unique<grainsize_tuner>();
+    }
+    return t.get();
+  }();
+  return *tuner;
+}
+
+}  // namespace internal
+
+/**
+ * Return the state of the grainsize tuners of `reduce_sum_adaptive`, by
+ * the name of the type of reducer function.
+ */
+inline std::map<std::string, grainsize_tuner::summary> adaptive_grainsizes() {
+  auto& registry = internal::grainsize_tuner_registry::instance();
+  std::lock_guard<std::mutex> lock(registry.mutex_);
+  std::map<std::string, grainsize_tuner::summary> summaries;
+  for (const auto& tuner : registry.tuners_) {
+    summaries.emplace(tuner.first, tuner.second->get_summary());
+  }
+  return summaries;
+}
+
+/**
+ * Reset the grainsize tuners of `reduce_sum_adaptive`.
+ */
+inline void reset_adaptive_grainsizes() {
+  auto& registry = internal::grainsize_tuner_registry::instance();
+  std::lock_guard<std::mutex> lock(registry.mutex_);
+  for (auto& tuner : registry.tuners_) {
+    tuner.second->reset();
+  }
+}
+
+}  // namespace math
+}  // namespace stan
+
+#endif
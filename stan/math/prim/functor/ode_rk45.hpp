@@ -4,6 +4,7 @@
 #include <stan/math/prim/meta.hpp>
 #include <stan/math/prim/functor/apply.hpp>
 #include <stan/math/prim/functor/coupled_ode_system.hpp>
+#include <stan/math/prim/functor/ode_rk_control.hpp>
 #include <stan/math/prim/functor/ode_store_sensitivities.hpp>
 #include <stan/math/prim/fun/Eigen.hpp>
 #include <boost/numeric/odeint.hpp>
@@ -44,10 +45,7 @@ namespace math {
  * @param t0 Initial time
  * @param ts Times at which to solve the ODE at. All values must be sorted and
  *   greater than t0.
- * @param relative_tolerance Relative tolerance passed to Boost
- * @param absolute_tolerance Absolute tolerance passed to Boost
- * @param max_num_steps Upper limit on the number of integration steps to
- *   take between each output (error if exceeded)
+ * @param control Options of the solver (see `ode_rk_control`)
  * @param[in, out] msgs the print stream for warning messages
  * @param args Extra arguments passed unmodified through to ODE right hand side
  * @return Solution to ODE at times \p ts
@@ -58,9 +56,8 @@ std::vector<Eigen::Matrix<stan::return_type_t<T_y0, T_t0, T_ts, Args...>,
                           Eigen::Dynamic, 1>>
 ode_rk45_tol_impl(const char* function_name, const F& f, const T_y0& y0_arg,
                   T_t0 t0, const std::vector<T_ts>& ts,
-                  double relative_tolerance, double absolute_tolerance,
-                  long int max_num_steps,  // NOLINT(runtime/int)
-                  std::ostream* msgs, const Args&... args) {
+                  const ode_rk_control& control, std::ostream* msgs,
+                  const Args&... args) {
   using boost::numeric::odeint::integrate_times;
   using boost::numeric::odeint::make_dense_output;
   using boost::numeric::odeint::max_step_checker;
@@ -95,10 +92,10 @@ ode_rk45_tol_impl(const char* function_name, const F& f, const T_y0& y0_arg,
   check_less(function_name, "initial time", t0, ts[0]);
 
   check_positive_finite(function_name, "relative_tolerance",
-                        relative_tolerance);
+                        control.relative_tolerance);
   check_positive_finite(function_name, "absolute_tolerance",
-                        absolute_tolerance);
-  check_positive(function_name, "max_num_steps", max_num_steps);
+                        control.absolute_tolerance);
+  check_positive(function_name, "max_num_steps", control.max_num_steps);
 
   using return_t = return_type_t<T_y0, T_t0, T_ts, Args...>;
   // creates basic or coupled system by template specializations
@@ -140,15 +137,25 @@ ode_rk45_tol_impl(const char* function_name, const F& f, const T_y0& y0_arg,
   // the coupled system creates the coupled initial state
   std::vector<double> initial_coupled_state = coupled_system.initial_state();
 
+  using stepper = runge_kutta_dopri5<std::vector<double>, double,
+                                     std::vector<double>, double>;
   const double step_size = 0.1;
+  // with dense output the steps do not end at the output times, whose
+  // states are interpolated
+  auto integrate = [&](auto&& integration_stepper) {
+    integrate_times(integration_stepper, std::ref(coupled_system),
+                    initial_coupled_state, std::begin(ts_vec), std::end(ts_vec),
+                    step_size, filtered_observer,
+                    max_step_checker(control.max_num_steps));
+  };
   try {
-    integrate_times(
-        make_dense_output(absolute_tolerance, relative_tolerance,
-                          runge_kutta_dopri5<std::vector<double>, double,
-                                             std::vector<double>, double>()),
-        std::ref(coupled_system), initial_coupled_state, std::begin(ts_vec),
-        std::end(ts_vec), step_size, filtered_observer,
-        max_step_checker(max_num_steps));
+    if (control.dense_output) {
+      integrate(make_dense_output(control.absolute_tolerance,
+                                  control.relative_tolerance, stepper()));
+    } else {
+      integrate(make_controlled(control.absolute_tolerance,
+                                control.relative_tolerance, stepper()));
+    }
   } catch (const no_progress_error& e) {
     throw_domain_error(function_name, "", ts_vec[time_index + 1],
                        "Failed to integrate to next output time (",
@@ -158,6 +165,65 @@ ode_rk45_tol_impl(const char* function_name, const F& f, const T_y0& y0_arg,
   return y;
 }
 
+/**
+ * Solve the ODE initial value problem y' = f(t, y), y(t0) = y0 at a set of
+ * times, { t1, t2, t3, ... } using the non-stiff Runge-Kutta 45 solver in
+ * Boost.
+ *
+ * The states at the output times are computed with the continuous
+ * extension of the Dormand-Prince steps (see `ode_rk_control`).
+ *
+ * If the system of equations is stiff, <code>ode_bdf</code> will likely be
+ * faster.
+ *
+ * \p f must define an operator() with the signature as:
+ *   template<typename T_t, typename T_y, typename... T_Args>
+ *   Eigen::Matrix<stan::return_type_t<T_t, T_y, T_Args...>, Eigen::Dynamic, 1>
+ *     operator()(const T_t& t, const Eigen::Matrix<T_y, Eigen::Dynamic, 1>& y,
+ *     std::ostream* msgs, const T_Args&... args);
+ *
+ * t is the time, y is the vector-valued state, msgs is a stream for error
+ * messages, and args are optional arguments passed to the ODE solve function
+ * (which are passed through to \p f without modification).
+ *
+ * @tparam F Type of ODE right hand side
+ * @tparam T_y0 Type of initial condition
+ * @tparam T_t0 Type of initial time
+ * @tparam T_ts Type of output times
+ * @tparam T_Args Types of pass-through parameters
+ *
+ * @param function_name Calling function name (for printing debugging messages)
+ * @param f Right hand side of the ODE
+ * @param y0_arg Initial state
+ * @param t0 Initial time
+ * @param ts Times at which to solve the ODE at. All values must be sorted and
+ *   greater than t0.
+ * @param relative_tolerance Relative tolerance passed to Boost
+ * @param absolute_tolerance Absolute tolerance passed to Boost
+ * @param max_num_steps Upper limit on the number of integration steps to
+ *   take between each output (error if exceeded)
+ * @param[in, out] msgs the print stream for warning messages
+ * @param args Extra arguments passed unmodified through to ODE right hand side
+ * @return Solution to ODE at times \p ts
+ */
+template <typename F, typename T_y0, typename T_t0, typename T_ts,
+          typename... Args, require_eigen_vector_t<T_y0>* = nullptr>
+std::vector<Eigen::Matrix<stan::return_type_t<T_y0, T_t0, T_ts, Args...>,
+                          Eigen::Dynamic, 1>>
+ode_rk45_tol_impl(const char* function_name, const F& f, const T_y0& y0_arg,
+                  T_t0 t0, const std::vector<T_ts>& ts,
+                  double relative_tolerance, double absolute_tolerance,
+                  long int max_num_steps,  // NOLINT(runtime/int)
+                  std::ostream* msgs, const Args&... args) {
+  ode_rk_control control;
+  control.relative_tolerance = relative_tolerance;
+  control.absolute_tolerance = absolute_tolerance;
+  control.max_num_steps = max_num_steps;
+  control.dense_output = true;
+  return ode_rk45_tol_impl(function_name, f, y0_arg, t0, ts, control, msgs,
+                           args...);
+}
+
 /**
  * Solve the ODE initial value problem y' = f(t, y), y(t0) = y0 at a set of
  * times, { t1, t2, t3, ... } using the non-stiff Runge-Kutta 45 solver in
@@ -208,6 +274,54 @@ ode_rk45_tol(const F& f, const T_y0& y0_arg, T_t0 t0,
                            max_num_steps, msgs, args...);
 }
 
+/**
+ * Solve the ODE initial value problem y' = f(t, y), y(t0) = y0 at a set of
+ * times, { t1, t2, t3, ... } using the non-stiff Runge-Kutta 45 solver in
+ * Boost.
+ *
+ * With `control.dense_output` the solver takes the steps its error control
+ * allows and interpolates the states and sensitivities at the output times,
+ * which is much faster for densely sampled output times.
+ *
+ * If the system of equations is stiff, <code>ode_bdf</code> will likely be
+ * faster.
+ *
+ * \p f must define an operator() with the signature as:
+ *   template<typename T_t, typename T_y, typename... T_Args>
+ *   Eigen::Matrix<stan::return_type_t<T_t, T_y, T_Args...>, Eigen::Dynamic, 1>
+ *     operator()(const T_t& t, const Eigen::Matrix<T_y, Eigen::Dynamic, 1>& y,
+ *     std::ostream* msgs, const T_Args&... args);
+ *
+ * t is the time, y is the vector-valued state, msgs is a stream for error
+ * messages, and args are optional arguments passed to the ODE solve function
+ * (which are passed through to \p f without modification).
+ *
+ * @tparam F Type of ODE right hand side
+ * @tparam T_0 Type of initial time
+ * @tparam T_ts Type of output times
+ * @tparam T_Args Types of pass-through parameters
+ *
+ * @param f Right hand side of the ODE
+ * @param y0_arg Initial state
+ * @param t0 Initial time
+ * @param ts Times at which to solve the ODE at. All values must be sorted and
+ *   greater than t0.
+ * @param control Options of the solver (see `ode_rk_control`)
+ * @param[in, out] msgs the print stream for warning messages
+ * @param args Extra arguments passed unmodified through to ODE right hand side
+ * @return Solution to ODE at times \p ts
+ */
+template <typename F, typename T_y0, typename T_t0, typename T_ts,
+          typename... Args, require_eigen_vector_t<T_y0>* = nullptr>
+std::vector<Eigen::Matrix<stan::return_type_t<T_y0, T_t0, T_ts, Args...>,
+                          Eigen::Dynamic, 1>>
+ode_rk45_tol(const F& f, const T_y0& y0_arg, T_t0 t0,
+             const std::vector<T_ts>& ts, const ode_rk_control& control,
+             std::ostream* msgs, const Args&... args) {
+  return ode_rk45_tol_impl("ode_rk45_tol", f, y0_arg, t0, ts, control, msgs,
+                           args...);
+}
+
 /**
  * Solve the ODE initial value problem y' = f(t, y), y(t0) = y0 at a set of
  * times, { t1, t2, t3, ... } using the non-stiff Runge-Kutta 45 solver in Boost
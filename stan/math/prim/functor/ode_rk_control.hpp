@@ -0,0 +1,46 @@
+#ifndef STAN_MATH_PRIM_FUNCTOR_ODE_RK_CONTROL_HPP
+#define STAN_MATH_PRIM_FUNCTOR_ODE_RK_CONTROL_HPP
+
+namespace stan {
+namespace math {
+
+/**
+ * Options of the Runge-Kutta integrators `ode_rk45_tol()` and
+ * `ode_ckrk_tol()`: the tolerances and number of steps, and how the
+ * solution at the output times is computed.
+ *
+ * With dense output the integrator takes the steps its error control
+ * allows and evaluates the solution, and the sensitivities, at the output
+ * times with the interpolant of the step containing them. Otherwise every
+ * output time ends a step, which for densely sampled output times
+ * shrinks the steps far below what the tolerances need.
+ */
+struct ode_rk_control {
+  /**
+   * Relative tolerance passed to Boost.
+   */
+  double relative_tolerance = 1e-6;
+  /**
+   * Absolute tolerance passed to Boost.
+   */
+  double absolute_tolerance = 1e-6;
+  /**
+   * Upper limit on the number of integration steps to take between each
+   * output (error if exceeded).
+   */
+  long int max_num_steps = 1000000;  // NOLINT(runtime/int)
+  /**
+   * Compute the solution at the output times with the interpolant of the
+   * steps (the continuous extension of Dormand-Prince for `ode_rk45`, a
+   * quartic Hermite interpolant for `ode_ckrk`, both fourth order)
+   * instead of ending a step at each of them. Its error is of the order
+   * of the tolerances, but larger than that of the steps ending at the
+   * output times, which are much shorter when the output times are
+   * dense.
+   */
+  bool dense_output = true;
+};
+
+}  // namespace math
+}  // namespace stan
+#endif
@@ -0,0 +1,82 @@
+#ifndef STAN_MATH_PRIM_FUNCTOR_PARALLEL_MAP_HPP
+#define STAN_MATH_PRIM_FUNCTOR_PARALLEL_MAP_HPP
+
+#include <stan/math/prim/meta.hpp>
+#include <stan/math/prim/err.hpp>
+#include <stan/math/prim/core/parallel_region.hpp>
+
+#include <tbb/task_arena.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+#include <algorithm>
+#include <ostream>
+#include <sstream>
+#include <vector>
+
+namespace stan {
+namespace math {
+
+/**
+ * Return the results of applying the function to every job index,
+ * `f(i, msgs, args...)` for `i` in `[0, num_jobs)`.
+ *
+ * The jobs are split in chunks of `grainsize` consecutive jobs,
+ * evaluated in parallel on the TBB arena if `STAN_THREADS` is defined.
+ * The messages of the chunks are written to `msgs` in the order of the
+ * jobs.
+ *
+ * @tparam F Type of function returning a scalar
+ * @tparam Args Types of shared arguments
+ * @param f Function
+ * @param num_jobs number of jobs
+ * @param grainsize number of consecutive jobs evaluated together
+ * @param[in, out] msgs the print stream for warning messages
+ * @param args shared arguments
+ * @return results of the jobs
+ * @throw std::domain_error if grainsize is not positive
+ */
+template <typename F, typename... Args,
+          require_all_not_st_var<Args...>* = nullptr>
+inline std::vector<double> parallel_map(const F& f, int num_jobs,
+                                        int grainsize, std::ostream* msgs,
+                                        const Args&... args) {
+  static constexpr const char* function = "parallel_map";
+  check_nonnegative(function, "number of jobs", num_jobs);
+  check_positive(function, "grainsize", grainsize);
+  const int num_chunks = (num_jobs + grainsize - 1) / grainsize;
+  std::vector<double> res(num_jobs);
+  std::vector<std::stringstream> chunk_msgs(num_chunks);
+  auto execute_chunk = [&](int k) {
+    const parallel_task_scope task;
+    const int end = std::min(num_jobs, (k + 1) * grainsize);
+    for (int i = k * grainsize; i < end; ++i) {
+      res[i] = f(i, &chunk_msgs[k], args...);
+    }
+  };
+#ifdef STAN_THREADS
+  run_parallel_region([&] {
+    tbb::parallel_for(tbb::blocked_range<int>(0, num_chunks),
+                      [&](const tbb::blocked_range<int>& r) {
+                        for (int k = r.begin(); k != r.end(); ++k) {
+                          execute_chunk(k);
+                        }
+                      });
+  });
+#else
+  for (int k = 0; k < num_chunks; ++k) {
+    execute_chunk(k);
+  }
+#endif
+  if (msgs) {
+    for (const auto& chunk_msg : chunk_msgs) {
+      *msgs << chunk_msg.str();
+    }
+  }
+  return res;
+}
+
+}  // namespace math
+}  // namespace stan
+
+#endif
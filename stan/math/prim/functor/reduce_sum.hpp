@@ -3,12 +3,15 @@
 
 #include <stan/math/prim/meta.hpp>
 #include <stan/math/prim/err.hpp>
+#include <stan/math/prim/core/parallel_region.hpp>
+#include <stan/math/prim/functor/grainsize_tuner.hpp>
 
 #include <tbb/task_arena.h>
 #include <tbb/parallel_reduce.h>
 #include <tbb/blocked_range.h>
 
 #include <algorithm>
+#include <chrono>
 #include <tuple>
 #include <vector>
 
@@ -43,13 +46,19 @@ struct reduce_sum_impl<ReduceFunction, require_arithmetic_t<ReturnType>,
    * @note see link [here](https://tinyurl.com/vp7xw2t) for requirements.
    */
   struct recursive_reducer {
+    const bool time_chunks_;
+    const bool share_region_;
     Vec vmapped_;
     std::stringstream msgs_;
     std::tuple<Args...> args_tuple_;
     return_type_t<Vec, Args...> sum_{0.0};
+    chunk_timings timings_;
 
-    recursive_reducer(Vec&& vmapped, std::ostream* msgs, Args&&... args)
-        : vmapped_(std::forward<Vec>(vmapped)),
+    recursive_reducer(bool time_chunks, bool share_region, Vec&& vmapped,
+                      std::ostream* msgs, Args&&... args)
+        : time_chunks_(time_chunks),
+          share_region_(share_region),
+          vmapped_(std::forward<Vec>(vmapped)),
           args_tuple_(std::forward<Args>(args)...) {}
 
     /**
@@ -59,7 +68,10 @@ struct reduce_sum_impl<ReduceFunction, require_arithmetic_t<ReturnType>,
      *   partial sum.
      */
     recursive_reducer(recursive_reducer& other, tbb::split)
-        : vmapped_(other.vmapped_), args_tuple_(other.args_tuple_) {}
+        : time_chunks_(other.time_chunks_),
+          share_region_(other.share_region_),
+          vmapped_(other.vmapped_),
+          args_tuple_(other.args_tuple_) {}
 
     /**
      * Compute the value and of `ReduceFunction` over the range defined by r
@@ -74,6 +86,10 @@ struct reduce_sum_impl<ReduceFunction, require_arithmetic_t<ReturnType>,
         return;
       }
 
+      const parallel_task_scope task(share_region_);
+      using clock = std::chrono::steady_clock;
+      const auto start = time_chunks_ ? clock::now() : clock::time_point();
+
       std::decay_t<Vec> sub_slice;
       sub_slice.reserve(r.size());
       for (size_t i = r.begin(); i < r.end(); ++i) {
@@ -86,6 +102,12 @@ struct reduce_sum_impl<ReduceFunction, require_arithmetic_t<ReturnType>,
                                     args...);
           },
           args_tuple_);
+
+      if (time_chunks_) {
+        timings_.add(
+            r.size(),
+            std::chrono::duration<double>(clock::now() - start).count());
+      }
     }
 
     /**
@@ -96,9 +118,23 @@ struct reduce_sum_impl<ReduceFunction, require_arithmetic_t<ReturnType>,
     inline void join(const recursive_reducer& rhs) {
       sum_ += rhs.sum_;
       msgs_ << rhs.msgs_.str();
+      timings_ += rhs.timings_;
     }
   };
 
+  /// timings of the chunks of work, recorded if not null
+  chunk_timings* timings_{nullptr};
+
+  reduce_sum_impl() = default;
+
+  /**
+   * Construct an implementation which records the timings of the
+   * chunks of work it evaluates.
+   *
+   * @param[out] timings timings of the chunks
+   */
+  explicit reduce_sum_impl(chunk_timings* timings) : timings_(timings) {}
+
   /**
    * Call an instance of the function `ReduceFunction` on every element
    *   of an input sequence and sum these terms.
@@ -132,6 +168,11 @@ struct reduce_sum_impl<ReduceFunction, require_arithmetic_t<ReturnType>,
    *  than or equal to grainsize and accumulate all the partial sums
    *  in the same order. This still may not achieve bitwise reproducibility.
    *
+   * Called from the partial sums of another parallel functor, the work
+   *  is shared with the enclosing functor (see `run_parallel_region`).
+   *  Without auto partitioning, the parallel functors called from the
+   *  partial sums are isolated to keep the order of the partial sums.
+   *
    * grainsize must be greater than or equal to 1
    *
    * @param vmapped Vector containing one element per term of sum
@@ -148,21 +189,27 @@ struct reduce_sum_impl<ReduceFunction, require_arithmetic_t<ReturnType>,
     if (vmapped.empty()) {
       return 0.0;
     }
-    recursive_reducer worker(std::forward<Vec>(vmapped), msgs,
+    recursive_reducer worker(timings_ != nullptr, auto_partitioning,
+                             std::forward<Vec>(vmapped), msgs,
                              std::forward<Args>(args)...);
 
-    if (auto_partitioning) {
-      tbb::parallel_reduce(
-          tbb::blocked_range<std::size_t>(0, num_terms, grainsize), worker);
-    } else {
-      tbb::simple_partitioner partitioner;
-      tbb::parallel_deterministic_reduce(
-          tbb::blocked_range<std::size_t>(0, num_terms, grainsize), worker,
-          partitioner);
-    }
+    run_parallel_region([&] {
+      if (auto_partitioning) {
+        tbb::parallel_reduce(
+            tbb::blocked_range<std::size_t>(0, num_terms, grainsize), worker);
+      } else {
+        tbb::simple_partitioner partitioner;
+        tbb::parallel_deterministic_reduce(
+            tbb::blocked_range<std::size_t>(0, num_terms, grainsize), worker,
+            partitioner);
+      }
+    });
     if (msgs) {
       *msgs << worker.msgs_.str();
     }
+    if (timings_) {
+      *timings_ += worker.timings_;
+    }
 
     return worker.sum_;
   }
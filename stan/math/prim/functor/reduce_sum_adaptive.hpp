@@ -0,0 +1,70 @@
+#ifndef STAN_MATH_PRIM_FUNCTOR_REDUCE_SUM_ADAPTIVE_HPP
+#define STAN_MATH_PRIM_FUNCTOR_REDUCE_SUM_ADAPTIVE_HPP
+
+#include <stan/math/prim/meta.hpp>
+#include <stan/math/prim/functor/grainsize_tuner.hpp>
+#include <stan/math/prim/functor/reduce_sum.hpp>
+
+#include <ostream>
+#include <utility>
+
+namespace stan {
+namespace math {
+
+/**
+ * Call an instance of the function `ReduceFunction` on every element
+ *   of an input sequence and sum these terms, choosing the grainsize
+ *   automatically.
+ *
+ * This is `reduce_sum` with a grainsize tuned from the measured cost
+ * of the chunks of work of the previous calls with the same
+ * `ReduceFunction` (see `grainsize_tuner`). The first call uses a
+ * grainsize of 1. The chosen grainsizes can be inspected with
+ * `adaptive_grainsizes()`.
+ *
+ * ReduceFunction must define an operator() with the same signature as:
+ *   T f(Vec&& vmapped_subset, int start, int end, std::ostream* msgs, Args&&...
+ * args)
+ *
+ * `ReduceFunction` must be default constructible without any arguments
+ *
+ * If STAN_THREADS is not defined, do all the work with one ReduceFunction call.
+ *
+ * @tparam ReduceFunction Type of reducer function
+ * @tparam Vec Type of sliced argument
+ * @tparam Args Types of shared arguments
+ * @param vmapped Vector containing one element per term of sum
+ * @param[in, out] msgs The print stream for warning messages
+ * @param args Shared arguments used in every sum term
+ * @return Sum of terms
+ */
+template <typename ReduceFunction, typename Vec,
+          typename = require_vector_like_t<Vec>, typename... Args>
+inline auto reduce_sum_adaptive(Vec&& vmapped, std::ostream* msgs,
+                                Args&&... args) {
+  using return_type = return_type_t<Vec, Args...>;
+
+#ifdef STAN_THREADS
+  grainsize_tuner& tuner = internal::get_grainsize_tuner<ReduceFunction>();
+  const size_t num_terms = vmapped.size();
+  chunk_timings timings;
+  return_type sum = internal::reduce_sum_impl<ReduceFunction, void, return_type,
+                                              Vec, ref_type_t<Args&&>...>(
+      &timings)(std::forward<Vec>(vmapped), true, tuner.grainsize(), msgs,
+                std::forward<Args>(args)...);
+  tuner.update(num_terms, timings);
+  return sum;
+#else
+  if (vmapped.empty()) {
+    return return_type(0.0);
+  }
+
+  return ReduceFunction()(std::forward<Vec>(vmapped), 0, vmapped.size() - 1,
+                          msgs, std::forward<Args>(args)...);
+#endif
+}
+
+}  // namespace math
+}  // namespace stan
+
+#endif
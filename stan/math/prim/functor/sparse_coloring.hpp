@@ -0,0 +1,192 @@
+#ifndef STAN_MATH_PRIM_FUNCTOR_SPARSE_COLORING_HPP
+#define STAN_MATH_PRIM_FUNCTOR_SPARSE_COLORING_HPP
+
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace stan {
+namespace math {
+namespace internal {
+
+/**
+ * Return the indices of the vertices of a graph in order of decreasing
+ * degree, which is the order in which they are colored greedily.
+ *
+ * @param degree degree of every vertex
+ * @return indices of the vertices
+ */
+inline std::vector<int> largest_first_order(const std::vector<int>& degree) {
+  std::vector<int> order(degree.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](int i, int j) { return degree[i] > degree[j]; });
+  return order;
+}
+
+/**
+ * Color the columns of a sparsity pattern such that no two columns of
+ * the same color have a nonzero in the same row.
+ *
+ * The sum of the columns of one color of a matrix with this pattern
+ * holds every nonzero of these columns in a row of its own. The matrix
+ * is thus recovered from its products with one seed vector per color,
+ * whose elements are one for the columns of the color and zero
+ * otherwise. The rows are colored by coloring the columns of the
+ * transposed pattern.
+ *
+ * The columns are colored greedily with the smallest color not used by
+ * the columns sharing a row with them, in order of decreasing number of
+ * nonzeros, which usually uses few colors more than the minimum.
+ *
+ * @param pattern sparsity pattern, whose stored elements are the
+ * nonzeros; their values are ignored
+ * @param[out] colors color of every column, in `[0, number of colors)`
+ * @return number of colors
+ */
+inline int color_columns(const Eigen::SparseMatrix<double>& pattern,
+                         std::vector<int>& colors) {
+  using col_iterator = Eigen::SparseMatrix<double>::InnerIterator;
+  using row_iterator
+      = Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator;
+  const Eigen::SparseMatrix<double, Eigen::RowMajor> by_row = pattern;
+  const int n = pattern.cols();
+  std::vector<int> degree(n, 0);
+  for (int j = 0; j < n; ++j) {
+    for (col_iterator it(pattern, j); it; ++it) {
+      ++degree[j];
+    }
+  }
+  colors.assign(n, -1);
+  std::vector<int> forbidden(n, -1);
+  int num_colors = 0;
+  for (int j : largest_first_order(degree)) {
+    for (col_iterator it(pattern, j); it; ++it) {
+      for (row_iterator jt(by_row, it.row()); jt; ++jt) {
+        if (colors[jt.col()] >= 0) {
+          forbidden[colors[jt.col()]] = j;
+        }
+      }
+    }
+    int color = 0;
+    while (forbidden[color] == j) {
+      ++color;
+    }
+    colors[j] = color;
+    num_colors = std::max(num_colors, color + 1);
+  }
+  return num_colors;
+}
+
+/**
+ * Return the adjacency lists of the graph of a symmetric sparsity
+ * pattern, whose vertices are the rows and columns and whose edges are
+ * the off-diagonal nonzeros. The pattern is symmetrized, so either
+ * triangle or both may be given.
+ *
+ * @param pattern square sparsity pattern
+ * @return sorted indices of the neighbours of every vertex
+ */
+inline std::vector<std::vector<int>> symmetric_adjacency(
+    const Eigen::SparseMatrix<double>& pattern) {
+  std::vector<std::vector<int>> adjacency(pattern.cols());
+  for (int j = 0; j < pattern.outerSize(); ++j) {
+    for (Eigen::SparseMatrix<double>::InnerIterator it(pattern, j); it;
+         ++it) {
+      if (it.row() != j) {
+        adjacency[it.row()].push_back(j);
+        adjacency[j].push_back(it.row());
+      }
+    }
+  }
+  for (auto& neighbours : adjacency) {
+    std::sort(neighbours.begin(), neighbours.end());
+    neighbours.erase(std::unique(neighbours.begin(), neighbours.end()),
+                     neighbours.end());
+  }
+  return adjacency;
+}
+
+/**
+ * Star color the graph of a symmetric sparsity pattern: adjacent
+ * vertices have different colors, and every path of four vertices
+ * uses at least three colors.
+ *
+ * For a symmetric matrix with this pattern, every nonzero `(i, j)` is
+ * then the only nonzero of row `i` among the columns of the color of
+ * `j`, or the only nonzero of row `j` among the columns of the color of
+ * `i`. The matrix is thus recovered from its products with one seed
+ * vector per color, like with `color_columns()`, but usually with fewer
+ * colors since the symmetry is exploited; for example, an arrowhead
+ * pattern needs two colors instead of one per column.
+ *
+ * The vertices are colored greedily in order of decreasing degree with
+ * the smallest color that neither is used by a neighbour nor closes a
+ * path of four vertices with two colors.
+ *
+ * @param adjacency adjacency lists, as returned by
+ * `symmetric_adjacency()`
+ * @param[out] colors color of every vertex, in `[0, number of colors)`
+ * @return number of colors
+ */
+inline int star_color(const std::vector<std::vector<int>>& adjacency,
+                      std::vector<int>& colors) {
+  const int n = adjacency.size();
+  std::vector<int> degree(n);
+  for (int v = 0; v < n; ++v) {
+    degree[v] = adjacency[v].size();
+  }
+  colors.assign(n, -1);
+  std::vector<int> forbidden(n + 1, -1);
+  std::vector<int> count(n + 1, 0);
+  int num_colors = 0;
+  for (int v : largest_first_order(degree)) {
+    for (int w : adjacency[v]) {
+      if (colors[w] >= 0) {
+        forbidden[colors[w]] = v;
+        ++count[colors[w]];
+      }
+    }
+    for (int w : adjacency[v]) {
+      if (colors[w] < 0) {
+        continue;
+      }
+      // another neighbour a of v with the color of w: a - v - w - x
+      const bool repeated = count[colors[w]] > 1;
+      for (int x : adjacency[w]) {
+        if (x == v || colors[x] < 0 || forbidden[colors[x]] == v) {
+          continue;
+        }
+        if (repeated) {
+          forbidden[colors[x]] = v;
+          continue;
+        }
+        // a neighbour y of x with the color of w: v - w - x - y
+        for (int y : adjacency[x]) {
+          if (y != w && colors[y] == colors[w]) {
+            forbidden[colors[x]] = v;
+            break;
+          }
+        }
+      }
+    }
+    for (int w : adjacency[v]) {
+      if (colors[w] >= 0) {
+        count[colors[w]] = 0;
+      }
+    }
+    int color = 0;
+    while (forbidden[color] == v) {
+      ++color;
+    }
+    colors[v] = color;
+    num_colors = std::max(num_colors, color + 1);
+  }
+  return num_colors;
+}
+
+}  // namespace internal
+}  // namespace math
+}  // namespace stan
+#endif
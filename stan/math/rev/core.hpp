@@ -9,9 +9,12 @@
 #include <stan/math/rev/core/chainable_alloc.hpp>
 #include <stan/math/rev/core/chainable_object.hpp>
 #include <stan/math/rev/core/chainablestack.hpp>
+#include <stan/math/rev/core/compact_tape.hpp>
+#include <stan/math/rev/core/compact_tape_lanes.hpp>
 #include <stan/math/rev/core/count_vars.hpp>
 #include <stan/math/rev/core/callback_vari.hpp>
 #include <stan/math/rev/core/init_chainablestack.hpp>
+#include <stan/math/rev/core/independent_tape_segments.hpp>
 #include <stan/math/rev/core/std_iterator_traits.hpp>
 #include <stan/math/rev/core/ddv_vari.hpp>
 #include <stan/math/rev/core/deep_copy_vars.hpp>
@@ -50,6 +53,7 @@
 #include <stan/math/rev/core/precomp_vvv_vari.hpp>
 #include <stan/math/rev/core/precomputed_gradients.hpp>
 #include <stan/math/rev/core/print_stack.hpp>
+#include <stan/math/rev/core/profile_registry.hpp>
 #include <stan/math/rev/core/profiling.hpp>
 #include <stan/math/rev/core/read_var.hpp>
 #include <stan/math/rev/core/recover_memory.hpp>
@@ -57,6 +61,7 @@
 #include <stan/math/rev/core/scoped_chainablestack.hpp>
 #include <stan/math/rev/core/set_zero_all_adjoints.hpp>
 #include <stan/math/rev/core/set_zero_all_adjoints_nested.hpp>
+#include <stan/math/rev/core/tape_statistics.hpp>
 #include <stan/math/rev/core/start_nested.hpp>
 #include <stan/math/rev/core/std_complex.hpp>
 #include <stan/math/rev/core/std_isinf.hpp>
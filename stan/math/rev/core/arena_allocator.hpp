@@ -2,6 +2,7 @@
 #define STAN_MATH_REV_CORE_ARENA_ALLOCATOR_HPP
 
 #include <stan/math/rev/core/chainablestack.hpp>
+#include <type_traits>
 
 namespace stan {
 namespace math {
@@ -15,13 +16,14 @@ struct arena_allocator {
   using value_type = T;
 
   /**
-   * Allocates space for `n` items of type `T`.
+   * Allocates space for `n` items of type `T`. Arrays of arithmetic
+   * types are aligned for vectorized access.
    *
    * @param n number of items to allocate space for
    * @return pointer to allocated space
    */
   T* allocate(std::size_t n) {
-    return ChainableStack::instance_->memalloc_.alloc_array<T>(n);
+    return allocate(n, std::is_arithmetic<T>{});
   }
 
   /**
@@ -43,6 +45,22 @@ struct arena_allocator {
   constexpr bool operator!=(const arena_allocator&) const noexcept {
     return false;
   }
+
+ private:
+  /**
+   * Allocates space for `n` items of arithmetic type `T`, aligned for
+   * vectorized access.
+   */
+  T* allocate(std::size_t n, std::true_type /* is_arithmetic */) {
+    return ChainableStack::instance_->memalloc_.alloc_array_aligned<T>(n);
+  }
+
+  /**
+   * Allocates space for `n` items of non-arithmetic type `T`.
+   */
+  T* allocate(std::size_t n, std::false_type /* is_arithmetic */) {
+    return ChainableStack::instance_->memalloc_.alloc_array<T>(n);
+  }
 };
 
 }  // namespace math
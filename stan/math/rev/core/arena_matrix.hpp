@@ -4,6 +4,7 @@
 #include <stan/math/prim/fun/Eigen.hpp>
 #include <stan/math/rev/core/chainable_alloc.hpp>
 #include <stan/math/rev/core/chainablestack.hpp>
+#include <stdexcept>
 
 namespace stan {
 namespace math {
@@ -39,9 +40,10 @@ class arena_matrix : public Eigen::Map<MatrixType> {
    * @param cols number of columns
    */
   arena_matrix(Eigen::Index rows, Eigen::Index cols)
-      : Base::Map(ChainableStack::instance_->memalloc_.alloc_array<Scalar>(
-                      rows * cols),
-                  rows, cols) {}
+      : Base::Map(
+            ChainableStack::instance_->memalloc_.alloc_array_aligned<Scalar>(
+                rows * cols),
+            rows, cols) {}
 
   /**
    * Constructs `arena_matrix` with given size. This only works if
@@ -50,7 +52,8 @@ class arena_matrix : public Eigen::Map<MatrixType> {
    */
   explicit arena_matrix(Eigen::Index size)
       : Base::Map(
-            ChainableStack::instance_->memalloc_.alloc_array<Scalar>(size),
+            ChainableStack::instance_->memalloc_.alloc_array_aligned<Scalar>(
+                size),
             size) {}
 
   /**
@@ -60,7 +63,7 @@ class arena_matrix : public Eigen::Map<MatrixType> {
   template <typename T, require_eigen_t<T>* = nullptr>
   arena_matrix(const T& other)  // NOLINT
       : Base::Map(
-            ChainableStack::instance_->memalloc_.alloc_array<Scalar>(
+            ChainableStack::instance_->memalloc_.alloc_array_aligned<Scalar>(
                 other.size()),
             (RowsAtCompileTime == 1 && T::ColsAtCompileTime == 1)
                     || (ColsAtCompileTime == 1 && T::RowsAtCompileTime == 1)
@@ -70,7 +73,7 @@ class arena_matrix : public Eigen::Map<MatrixType> {
                     || (ColsAtCompileTime == 1 && T::RowsAtCompileTime == 1)
                 ? other.rows()
                 : other.cols()) {
-    *this = other;
+    Base::operator=(other);
   }
 
   /**
@@ -117,12 +120,14 @@ class arena_matrix : public Eigen::Map<MatrixType> {
         || (ColsAtCompileTime == 1 && T::RowsAtCompileTime == 1)) {
       // placement new changes what data map points to - there is no allocation
       new (this) Base(
-          ChainableStack::instance_->memalloc_.alloc_array<Scalar>(a.size()),
+          ChainableStack::instance_->memalloc_.alloc_array_aligned<Scalar>(
+              a.size()),
           a.cols(), a.rows());
 
     } else {
       new (this) Base(
-          ChainableStack::instance_->memalloc_.alloc_array<Scalar>(a.size()),
+          ChainableStack::instance_->memalloc_.alloc_array_aligned<Scalar>(
+              a.size()),
           a.rows(), a.cols());
     }
     Base::operator=(a);
@@ -130,6 +135,31 @@ class arena_matrix : public Eigen::Map<MatrixType> {
   }
 };
 
+/**
+ * Return a map to the storage of an `arena_matrix` which is declared
+ * aligned to `EIGEN_MAX_ALIGN_BYTES`, so that Eigen uses aligned
+ * vectorized loads and stores on it. The storage allocated by
+ * `arena_matrix` itself is always aligned (see
+ * `stack_alloc::alloc_array_aligned()`), but an `arena_matrix`
+ * constructed from an arbitrary `Eigen::Map` need not be.
+ *
+ * @tparam MatrixType Eigen matrix type of the `arena_matrix`
+ * @param x `arena_matrix` to map
+ * @return aligned map to the storage of `x`
+ * @throw std::invalid_argument if the storage of `x` is not aligned
+ */
+template <typename MatrixType>
+inline Eigen::Map<MatrixType, Eigen::AlignedMax> as_aligned_map(
+    const arena_matrix<MatrixType>& x) {
+  if (internal::SMALL_ARRAY_ALIGNMENT > 8
+      && !is_aligned(x.data(), internal::SMALL_ARRAY_ALIGNMENT)) {
+    throw std::invalid_argument(
+        "as_aligned_map: arena_matrix storage is not aligned");
+  }
+  return Eigen::Map<MatrixType, Eigen::AlignedMax>(
+      const_cast<value_type_t<MatrixType>*>(x.data()), x.rows(), x.cols());
+}
+
 }  // namespace math
 }  // namespace stan
 
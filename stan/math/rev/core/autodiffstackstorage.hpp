@@ -7,6 +7,8 @@
 namespace stan {
 namespace math {
 
+class tape_statistics;
+
 // Internal macro used to modify global pointer definition to the
 // global AD instance.
 #ifdef STAN_THREADS
@@ -110,6 +112,12 @@ struct AutodiffStackSingleton {
     std::vector<size_t> nested_var_stack_sizes_;
     std::vector<size_t> nested_var_nochain_stack_sizes_;
     std::vector<size_t> nested_var_alloc_stack_starts_;
+
+    // range of the compact tape open for appending (see compact_tape.hpp)
+    ChainableT *compact_range_{nullptr};
+
+    // statistics recorded on this tape, if any
+    tape_statistics *tape_statistics_{nullptr};
   };
 
   explicit AutodiffStackSingleton(AutodiffStackSingleton_t const &) = delete;
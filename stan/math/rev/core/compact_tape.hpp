@@ -0,0 +1,334 @@
+#ifndef STAN_MATH_REV_CORE_COMPACT_TAPE_HPP
+#define STAN_MATH_REV_CORE_COMPACT_TAPE_HPP
+
+#include <stan/math/rev/core/chainablestack.hpp>
+#include <stan/math/rev/core/var.hpp>
+#include <stan/math/rev/core/vari.hpp>
+#include <cmath>
+#include <cstddef>
+#include <new>
+
+// The compact tape records arithmetic only if STAN_COMPACT_TAPE is defined,
+// which changes the inline definitions of the operators using it. It is a
+// build-wide option: define it the same way in every translation unit (see
+// the Compact Tape page of the documentation and make/compiler_flags).
+
+namespace stan {
+namespace math {
+namespace internal {
+
+/**
+ * Operations recorded on the compact tape. For operations with one
+ * arithmetic operand (suffixes `_vd` and `_dv`) the arithmetic operand
+ * is stored in place of the partial of the missing variable operand.
+ */
+enum class compact_op : unsigned char {
+  add_vv,
+  add_vd,
+  subtract_vv,
+  subtract_vd,
+  subtract_dv,
+  multiply_vv,
+  multiply_vd,
+  divide_vv,
+  divide_vd,
+  divide_dv,
+  negate,
+  exp,
+  log,
+  sqrt,
+  square
+};
+
+/**
+ * Result of an operation recorded on the compact tape. Its adjoint is
+ * propagated and reset by the range of the compact tape holding it.
+ */
+class compact_vari final : public vari {
+ public:
+  explicit compact_vari(double x) noexcept : vari(x, unstacked_t{}) {}
+};
+
+/**
+ * Storage of the compact tape: scalar operations stored as a structure
+ * of arrays in the arena.
+ *
+ * For each operation the segment holds its opcode, its result, the
+ * varis of its (one or two) operands and the partials of the result
+ * with respect to them. The segment is not on the var_stack itself: its
+ * operations are chained by the ranges of it that are (see
+ * `compact_tape_range`).
+ */
+class compact_tape_segment {
+ public:
+  compact_op* op_;
+  compact_vari* res_;
+  vari** a_;
+  vari** b_;
+  double* da_;
+  double* db_;
+  size_t size_;
+  size_t capacity_;
+
+  /**
+   * Construct an empty segment for the specified number of operations.
+   *
+   * @param capacity maximal number of operations
+   */
+  explicit compact_tape_segment(size_t capacity)
+      : op_(ChainableStack::instance_->memalloc_.alloc_array<compact_op>(
+          capacity)),
+        res_(ChainableStack::instance_->memalloc_.alloc_array<compact_vari>(
+            capacity)),
+        a_(ChainableStack::instance_->memalloc_.alloc_array<vari*>(capacity)),
+        b_(ChainableStack::instance_->memalloc_.alloc_array<vari*>(capacity)),
+        da_(ChainableStack::instance_->memalloc_.alloc_array<double>(
+            capacity)),
+        db_(ChainableStack::instance_->memalloc_.alloc_array<double>(
+            capacity)),
+        size_(0),
+        capacity_(capacity) {}
+
+  /**
+   * Allocate an empty segment in the arena of the AD tape.
+   *
+   * @param capacity maximal number of operations
+   * @return segment
+   */
+  static inline compact_tape_segment* allocate(size_t capacity) {
+    void* memory = ChainableStack::instance_->memalloc_.alloc(
+        sizeof(compact_tape_segment));
+    return ::new (memory) compact_tape_segment(capacity);
+  }
+
+  inline bool full() const noexcept { return size_ == capacity_; }
+
+  /**
+   * Append an operation to the segment, which must not be full.
+   *
+   * @param op operation
+   * @param val value of the result
+   * @param a first variable operand
+   * @param b second variable operand or `nullptr`
+   * @param da partial of the result with respect to `a`
+   * @param db partial of the result with respect to `b`, or the
+   * arithmetic operand if `b` is `nullptr`
+   * @return vari of the result
+   */
+  inline vari* push(compact_op op, double val, vari* a, vari* b, double da,
+                    double db) noexcept {
+    const size_t i = size_++;
+    op_[i] = op;
+    a_[i] = a;
+    b_[i] = b;
+    da_[i] = da;
+    db_[i] = db;
+    return ::new (static_cast<void*>(res_ + i)) compact_vari(val);
+  }
+};
+
+/**
+ * A range of consecutive operations of a compact tape segment, recorded
+ * without anything else being pushed on the var_stack in between.
+ *
+ * The range is a single entry of the var_stack; its reverse pass is one
+ * loop over the arrays of its segment instead of a virtual `chain()`
+ * call per operation, and its results are reset by its own
+ * `set_zero_adjoint()` instead of being on a stack.
+ *
+ * Operations are appended to the range on top of the var_stack. When
+ * anything else was pushed on the var_stack since, the next operation
+ * opens a new range at the end of the same segment, so that operations
+ * interleaved with other varis only cost the range and their entries of
+ * the segment.
+ */
+class compact_tape_range final : public vari_base {
+ public:
+  compact_tape_segment* segment_;
+  size_t begin_;
+  size_t end_;
+
+  /**
+   * Construct an empty range at the end of the specified segment and put
+   * it on the var_stack.
+   *
+   * @param segment segment
+   */
+  explicit compact_tape_range(compact_tape_segment* segment)
+      : segment_(segment), begin_(segment->size_), end_(segment->size_) {
+    ChainableStack::instance_->var_stack_.push_back(this);
+  }
+
+  inline void chain() final {
+    const compact_tape_segment& s = *segment_;
+    for (size_t i = end_; i-- > begin_;) {
+      const double adj = s.res_[i].adj_;
+      s.a_[i]->adj_ += s.da_[i] * adj;
+      if (s.b_[i] != nullptr) {
+        s.b_[i]->adj_ += s.db_[i] * adj;
+      }
+    }
+  }
+
+  inline void set_zero_adjoint() final {
+    for (size_t i = begin_; i < end_; ++i) {
+      segment_->res_[i].adj_ = 0.0;
+    }
+  }
+
+  /**
+   * Recompute the values and partials of the operations of the range in
+   * place from the current values of their operands, as if they were
+   * recorded again, and reset the adjoints of their results. Ranges must
+   * be replayed in the order of the var_stack.
+   */
+  inline void replay() noexcept {
+    compact_tape_segment& s = *segment_;
+    for (size_t i = begin_; i < end_; ++i) {
+      const double a = s.a_[i]->val_;
+      double val;
+      switch (s.op_[i]) {
+        case compact_op::add_vv:
+          val = a + s.b_[i]->val_;
+          break;
+        case compact_op::add_vd:
+          val = a + s.db_[i];
+          break;
+        case compact_op::subtract_vv:
+          val = a - s.b_[i]->val_;
+          break;
+        case compact_op::subtract_vd:
+          val = a - s.db_[i];
+          break;
+        case compact_op::subtract_dv:
+          val = s.db_[i] - a;
+          break;
+        case compact_op::multiply_vv:
+          val = a * s.b_[i]->val_;
+          s.da_[i] = s.b_[i]->val_;
+          s.db_[i] = a;
+          break;
+        case compact_op::multiply_vd:
+          val = a * s.db_[i];
+          break;
+        case compact_op::divide_vv:
+          val = a / s.b_[i]->val_;
+          s.da_[i] = 1.0 / s.b_[i]->val_;
+          s.db_[i] = -val / s.b_[i]->val_;
+          break;
+        case compact_op::divide_vd:
+          val = a / s.db_[i];
+          break;
+        case compact_op::divide_dv:
+          val = s.db_[i] / a;
+          s.da_[i] = -val / a;
+          break;
+        case compact_op::negate:
+          val = -a;
+          break;
+        case compact_op::exp:
+          val = std::exp(a);
+          s.da_[i] = val;
+          break;
+        case compact_op::log:
+          val = std::log(a);
+          s.da_[i] = 1.0 / a;
+          break;
+        case compact_op::sqrt:
+          val = std::sqrt(a);
+          s.da_[i] = 0.5 / val;
+          break;
+        case compact_op::square:
+        default:
+          val = a * a;
+          s.da_[i] = 2.0 * a;
+          break;
+      }
+      ::new (static_cast<void*>(s.res_ + i)) compact_vari(val);
+    }
+  }
+};
+
+constexpr size_t COMPACT_SEGMENT_MIN_CAPACITY = 16;
+constexpr size_t COMPACT_SEGMENT_MAX_CAPACITY = 1024;
+
+/**
+ * Open a new range of the compact tape of the current AD tape, at the
+ * end of the segment of the last range if it is not full, and else of a
+ * new segment of twice its capacity.
+ *
+ * @param last last range or `nullptr`
+ * @return range
+ */
+inline compact_tape_range* open_compact_range(compact_tape_range* last) {
+  compact_tape_segment* segment;
+  if (last == nullptr) {
+    segment = compact_tape_segment::allocate(COMPACT_SEGMENT_MIN_CAPACITY);
+  } else if (last->segment_->full()) {
+    segment = compact_tape_segment::allocate(
+        last->segment_->capacity_ < COMPACT_SEGMENT_MAX_CAPACITY
+            ? 2 * last->segment_->capacity_
+            : COMPACT_SEGMENT_MAX_CAPACITY);
+  } else {
+    segment = last->segment_;
+  }
+  auto* range = new compact_tape_range(segment);
+  ChainableStack::instance_->compact_range_ = range;
+  return range;
+}
+
+/**
+ * Record an operation on the compact tape of the current AD tape,
+ * appending it to the range on top of the var_stack if its segment has
+ * room.
+ *
+ * @param op operation
+ * @param val value of the result
+ * @param a first variable operand
+ * @param b second variable operand or `nullptr`
+ * @param da partial of the result with respect to `a`
+ * @param db partial of the result with respect to `b`, or the
+ * arithmetic operand if `b` is `nullptr`
+ * @return result
+ */
+inline var compact_record(compact_op op, double val, vari* a, vari* b,
+                          double da, double db) {
+  auto& stack = *ChainableStack::instance_;
+  auto* range = static_cast<compact_tape_range*>(stack.compact_range_);
+  if (unlikely(range == nullptr || stack.var_stack_.back() != range
+               || range->segment_->full())) {
+    range = open_compact_range(range);
+  }
+  ++range->end_;
+  return var(range->segment_->push(op, val, a, b, da, db));
+}
+
+/**
+ * Record an operation with two variable operands on the compact tape.
+ */
+inline var compact_binary(compact_op op, double val, vari* a, vari* b,
+                          double da, double db) {
+  return compact_record(op, val, a, b, da, db);
+}
+
+/**
+ * Record an operation with a variable and an arithmetic operand on
+ * the compact tape.
+ */
+inline var compact_binary(compact_op op, double val, vari* a, double da,
+                          double c) {
+  return compact_record(op, val, a, nullptr, da, c);
+}
+
+/**
+ * Record an operation with a single variable operand on the compact
+ * tape.
+ */
+inline var compact_unary(compact_op op, double val, vari* a, double da) {
+  return compact_record(op, val, a, nullptr, da, 0.0);
+}
+
+}  // namespace internal
+}  // namespace math
+}  // namespace stan
+#endif
@@ -0,0 +1,299 @@
+#ifndef STAN_MATH_REV_CORE_COMPACT_TAPE_LANES_HPP
+#define STAN_MATH_REV_CORE_COMPACT_TAPE_LANES_HPP
+
+#include <stan/math/rev/core/chainablestack.hpp>
+#include <stan/math/rev/core/compact_tape.hpp>
+#include <stan/math/rev/core/vari.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <typeinfo>
+#include <vector>
+
+namespace stan {
+namespace math {
+namespace internal {
+
+/**
+ * The nested AD tape, when it consists only of ranges of the compact
+ * tape and of independent variables, as a linear map from the adjoints of
+ * its results to the adjoints of its operands, to be applied to `K`
+ * vectors of adjoints (lanes) in a single reverse sweep.
+ *
+ * Every independent variable and every result of a compact operation
+ * is given a slot, and the lanes of the adjoints are stored as a
+ * `K x num_slots()` matrix, so that the `K` adjoints of a slot are
+ * contiguous and every operation of the reverse sweep is a vector
+ * operation of size `K`. A sweep with `K` lanes replaces `K` reverse
+ * passes over the tape and the zeroing of the adjoints between them,
+ * for example to compute `K` rows of a Jacobian at once.
+ *
+ * Operands recorded outside of the nested tape share a single slot
+ * whose adjoints are accumulated but meaningless.
+ *
+ * The linearized operations, and on request their second partials,
+ * can also be read one by one, for example by the second order reverse
+ * sweep of `internal::edge_pushing_hessian()`.
+ */
+class compact_tape_lanes {
+  struct slot_range {
+    const char* begin_;
+    const char* end_;
+    int first_slot_;
+  };
+
+  std::vector<slot_range> ranges_;
+  std::vector<int> res_;
+  std::vector<int> a_;
+  std::vector<int> b_;
+  std::vector<double> da_;
+  std::vector<double> db_;
+  std::vector<double> daa_;
+  std::vector<double> dab_;
+  std::vector<double> dbb_;
+  int num_slots_{0};
+  int external_slot_{0};
+
+  inline const slot_range* find_range(const void* vi) const {
+    const char* p = static_cast<const char*>(vi);
+    auto it = std::upper_bound(
+        ranges_.begin(), ranges_.end(), p,
+        [](const char* q, const slot_range& r) { return q < r.begin_; });
+    if (it == ranges_.begin()) {
+      return nullptr;
+    }
+    --it;
+    return p < it->end_ ? &*it : nullptr;
+  }
+
+  inline int find_slot(const void* vi, const slot_range*& hint) const {
+    const char* p = static_cast<const char*>(vi);
+    if (hint == nullptr || p < hint->begin_ || p >= hint->end_) {
+      hint = find_range(vi);
+      if (hint == nullptr) {
+        return -1;
+      }
+    }
+    return hint->first_slot_
+           + static_cast<int>((p - hint->begin_) / sizeof(compact_vari));
+  }
+
+  /**
+   * Store the second partials of an operation of a segment with
+   * respect to its operands.
+   */
+  inline void set_second_partials(const compact_tape_segment& segment,
+                                  size_t i, size_t op) {
+    const double res = segment.res_[i].val_;
+    const double a = segment.a_[i]->val_;
+    daa_[op] = 0;
+    dab_[op] = 0;
+    dbb_[op] = 0;
+    switch (segment.op_[i]) {
+      case compact_op::multiply_vv:
+        dab_[op] = 1;
+        break;
+      case compact_op::divide_vv: {
+        const double b = segment.b_[i]->val_;
+        dab_[op] = -1 / (b * b);
+        dbb_[op] = 2 * res / (b * b);
+        break;
+      }
+      case compact_op::divide_dv:
+        daa_[op] = 2 * res / (a * a);
+        break;
+      case compact_op::exp:
+        daa_[op] = res;
+        break;
+      case compact_op::log:
+        daa_[op] = -1 / (a * a);
+        break;
+      case compact_op::sqrt:
+        daa_[op] = -0.25 / (a * res);
+        break;
+      case compact_op::square:
+        daa_[op] = 2;
+        break;
+      default:
+        break;
+    }
+  }
+
+ public:
+  /**
+   * Linearize the nested AD tape.
+   *
+   * @param second_order if true, also store the second partials of the
+   * operations
+   * @return false if the nested tape holds anything else than ranges of
+   * the compact tape and independent variables, in which case the reverse
+   * sweep must be done by `grad()`
+   */
+  inline bool linearize_nested(bool second_order = false) {
+    const auto& stack = *ChainableStack::instance_;
+    const size_t begin = stack.nested_var_stack_sizes_.empty()
+                             ? 0
+                             : stack.nested_var_stack_sizes_.back();
+    std::vector<const compact_tape_range*> compact_ranges;
+    ranges_.clear();
+    num_slots_ = 0;
+    size_t num_ops = 0;
+    for (size_t i = begin; i < stack.var_stack_.size(); ++i) {
+      const vari_base* entry = stack.var_stack_[i];
+      const std::type_info& type = typeid(*entry);
+      if (type == typeid(compact_tape_range)) {
+        const auto* range = static_cast<const compact_tape_range*>(entry);
+        const size_t size = range->end_ - range->begin_;
+        const char* res = reinterpret_cast<const char*>(range->segment_->res_
+                                                        + range->begin_);
+        ranges_.push_back({res, res + size * sizeof(compact_vari), num_slots_});
+        num_slots_ += size;
+        num_ops += size;
+        compact_ranges.push_back(range);
+      } else if (type == typeid(vari)) {
+        const char* leaf = reinterpret_cast<const char*>(entry);
+        ranges_.push_back({leaf, leaf + 1, num_slots_});
+        ++num_slots_;
+      } else {
+        return false;
+      }
+    }
+    const size_t nochain_begin
+        = stack.nested_var_nochain_stack_sizes_.empty()
+              ? 0
+              : stack.nested_var_nochain_stack_sizes_.back();
+    for (size_t i = nochain_begin; i < stack.var_nochain_stack_.size(); ++i) {
+      const char* leaf
+          = reinterpret_cast<const char*>(stack.var_nochain_stack_[i]);
+      ranges_.push_back({leaf, leaf + 1, num_slots_});
+      ++num_slots_;
+    }
+    std::sort(ranges_.begin(), ranges_.end(),
+              [](const slot_range& x, const slot_range& y) {
+                return x.begin_ < y.begin_;
+              });
+    external_slot_ = num_slots_++;
+
+    res_.resize(num_ops);
+    a_.resize(num_ops);
+    b_.resize(num_ops);
+    da_.resize(num_ops);
+    db_.resize(num_ops);
+    if (second_order) {
+      daa_.resize(num_ops);
+      dab_.resize(num_ops);
+      dbb_.resize(num_ops);
+    }
+    const slot_range* hint = nullptr;
+    size_t op = 0;
+    for (const auto* range : compact_ranges) {
+      const compact_tape_segment* segment = range->segment_;
+      for (size_t i = range->begin_; i < range->end_; ++i, ++op) {
+        res_[op] = find_slot(segment->res_ + i, hint);
+        const int a = find_slot(segment->a_[i], hint);
+        a_[op] = a < 0 ? external_slot_ : a;
+        if (segment->b_[i] != nullptr) {
+          const int b = find_slot(segment->b_[i], hint);
+          b_[op] = b < 0 ? external_slot_ : b;
+        } else {
+          b_[op] = -1;
+        }
+        da_[op] = segment->da_[i];
+        db_[op] = segment->db_[i];
+        if (second_order) {
+          set_second_partials(*segment, i, op);
+        }
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Return the number of slots.
+   */
+  inline int num_slots() const noexcept { return num_slots_; }
+
+  /**
+   * Return the number of linearized operations.
+   */
+  inline size_t num_ops() const noexcept { return res_.size(); }
+
+  /**
+   * Return the slot of the result of an operation.
+   */
+  inline int result(size_t op) const { return res_[op]; }
+
+  /**
+   * Return the slot of the first operand of an operation.
+   */
+  inline int first_operand(size_t op) const { return a_[op]; }
+
+  /**
+   * Return the slot of the second operand of an operation, or -1 if it
+   * has a single variable operand.
+   */
+  inline int second_operand(size_t op) const { return b_[op]; }
+
+  /**
+   * Return the partial of the result of an operation with respect to
+   * its first operand.
+   */
+  inline double first_partial(size_t op) const { return da_[op]; }
+
+  /**
+   * Return the partial of the result of an operation with respect to
+   * its second operand; only meaningful if it has one.
+   */
+  inline double second_partial(size_t op) const { return db_[op]; }
+
+  /**
+   * Return the second partials of the result of an operation with
+   * respect to its first operand twice, to both operands and to its
+   * second operand twice. Requires linearizing with `second_order`.
+   *
+   * @param op operation
+   * @param[out] daa second partial with respect to the first operand
+   * @param[out] dab mixed second partial
+   * @param[out] dbb second partial with respect to the second operand
+   */
+  inline void second_partials(size_t op, double& daa, double& dab,
+                              double& dbb) const {
+    daa = daa_[op];
+    dab = dab_[op];
+    dbb = dbb_[op];
+  }
+
+  /**
+   * Return the slot of a result or of an independent variable of the
+   * nested tape, or -1 for other varis.
+   *
+   * @param vi vari
+   */
+  inline int slot(const vari* vi) const {
+    const slot_range* hint = nullptr;
+    return find_slot(vi, hint);
+  }
+
+  /**
+   * Propagate the lanes of adjoints from the results of the operations
+   * to their operands, in reverse order of the operations.
+   *
+   * @tparam K number of lanes
+   * @param[in, out] lanes `K x num_slots()` matrix of adjoints
+   */
+  template <int K>
+  inline void sweep(Eigen::Matrix<double, K, Eigen::Dynamic>& lanes) const {
+    for (size_t i = res_.size(); i-- > 0;) {
+      const Eigen::Matrix<double, K, 1> adj = lanes.col(res_[i]);
+      lanes.col(a_[i]) += da_[i] * adj;
+      if (b_[i] >= 0) {
+        lanes.col(b_[i]) += db_[i] * adj;
+      }
+    }
+  }
+};
+
+}  // namespace internal
+}  // namespace math
+}  // namespace stan
+#endif
@@ -5,6 +5,7 @@
 #include <stan/math/rev/core/chainablestack.hpp>
 #include <stan/math/rev/core/empty_nested.hpp>
 #include <stan/math/rev/core/nested_size.hpp>
+#include <stan/math/rev/core/tape_statistics.hpp>
 #include <stan/math/rev/core/vari.hpp>
 #include <vector>
 
@@ -26,6 +27,16 @@ namespace math {
 static void grad() {
   size_t end = ChainableStack::instance_->var_stack_.size();
   size_t beginning = empty_nested() ? 0 : end - nested_size();
+  if (unlikely(ChainableStack::instance_->tape_statistics_ != nullptr)) {
+    size_t nochain_beginning
+        = empty_nested()
+              ? 0
+              : ChainableStack::instance_->nested_var_nochain_stack_sizes_
+                    .back();
+    ChainableStack::instance_->tape_statistics_->record_reverse_pass(
+        *ChainableStack::instance_, beginning, end, nochain_beginning);
+    return;
+  }
   for (size_t i = end; i-- > beginning;) {
     ChainableStack::instance_->var_stack_[i]->chain();
   }
@@ -0,0 +1,225 @@
+#ifndef STAN_MATH_REV_CORE_INDEPENDENT_TAPE_SEGMENTS_HPP
+#define STAN_MATH_REV_CORE_INDEPENDENT_TAPE_SEGMENTS_HPP
+
+#include <stan/math/prim/core/parallel_region.hpp>
+#include <stan/math/rev/core/chainable_alloc.hpp>
+#include <stan/math/rev/core/chainablestack.hpp>
+#include <stan/math/rev/core/empty_nested.hpp>
+#include <stan/math/rev/core/grad.hpp>
+#include <stan/math/rev/core/recover_memory.hpp>
+#include <stan/math/rev/core/scoped_chainablestack.hpp>
+#include <stan/math/rev/core/set_zero_all_adjoints.hpp>
+#include <stan/math/rev/core/vari.hpp>
+
+#include <tbb/task_arena.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace math {
+
+/**
+ * A segment of the AD tape recorded on its own stack, independent of
+ * the other segments: it only reads the shared inputs through copies
+ * of their varis, and its outputs are only read through other varis
+ * on the main AD tape.
+ */
+struct independent_tape_segment {
+  /// stack holding the tape of the segment
+  ScopedChainableStack stack_;
+  /// copies on the segment tape of the shared inputs
+  std::vector<vari*> local_inputs_;
+  /// outputs on the segment tape
+  std::vector<vari*> local_outputs_;
+  /// varis on the main AD tape for the outputs
+  std::vector<vari*> outputs_;
+};
+
+namespace internal {
+
+/**
+ * Return the segments recovered on the calling thread and kept for
+ * reuse, so that the stacks of the segments, and the memory of their
+ * arenas, are allocated once per thread as the AD tapes of the
+ * threads are rather than on every call.
+ */
+inline std::vector<std::unique_ptr<independent_tape_segment>>&
+independent_tape_segment_pool() {
+  static thread_local std::vector<std::unique_ptr<independent_tape_segment>>
+      pool;
+  return pool;
+}
+
+}  // namespace internal
+
+/**
+ * Independent segments of the AD tape whose reverse passes run
+ * concurrently.
+ *
+ * The segments are recorded (possibly concurrently) on their own
+ * stacks with `record()`, after which `finish()` puts a single vari
+ * on the main AD tape. When the reverse pass reaches this vari, it
+ * propagates the adjoints of the outputs of every segment through the
+ * tape of the segment, running the segments in parallel on the TBB
+ * arena if `STAN_THREADS` is defined, and then adds the adjoints of
+ * the copies of the shared inputs to the adjoints of the inputs. The
+ * adjoints are joined serially in the order of the segments, so the
+ * result does not depend on the scheduling.
+ *
+ * The object lives on the AD tape and is freed when its memory is
+ * recovered; it must be allocated with `new` and not deleted. The
+ * segments are taken from the pool of the thread constructing the
+ * object and, once their stacks are recovered, returned to the pool of
+ * the thread freeing it.
+ */
+class independent_tape_segments : public chainable_alloc {
+  std::vector<std::unique_ptr<independent_tape_segment>> segments_;
+  std::vector<vari*> inputs_;
+
+  class reverse_pass_vari final : public vari_base {
+    independent_tape_segments& segments_;
+
+   public:
+    explicit reverse_pass_vari(independent_tape_segments& segments)
+        : segments_(segments) {
+      ChainableStack::instance_->var_stack_.push_back(this);
+    }
+
+    inline void chain() final { segments_.chain(); }
+    inline void set_zero_adjoint() final {}
+  };
+
+ public:
+  /**
+   * Construct segments reading the specified shared inputs.
+   *
+   * @param num_segments number of segments
+   * @param inputs varis of the shared inputs on the main AD tape
+   * @param num_inputs number of shared inputs
+   */
+  independent_tape_segments(size_t num_segments, vari** inputs,
+                            size_t num_inputs)
+      : inputs_(inputs, inputs + num_inputs) {
+    auto& pool = internal::independent_tape_segment_pool();
+    segments_.reserve(num_segments);
+    for (size_t k = 0; k < num_segments; ++k) {
+      if (pool.empty()) {
+        segments_.emplace_back(std::make_unique<independent_tape_segment>());
+      } else {
+        segments_.emplace_back(std::move(pool.back()));
+        pool.pop_back();
+      }
+    }
+  }
+
+  /**
+   * Recover the stacks of the segments and return the segments to the
+   * pool of the calling thread. A segment whose stack still has nested
+   * scopes, which only happens if its recording threw, is freed.
+   */
+  ~independent_tape_segments() {
+    for (auto& segment : segments_) {
+      const bool recovered = segment->stack_.execute([] {
+        if (!empty_nested()) {
+          return false;
+        }
+        recover_memory();
+        return true;
+      });
+      if (recovered) {
+        segment->local_inputs_.clear();
+        segment->local_outputs_.clear();
+        segment->outputs_.clear();
+        internal::independent_tape_segment_pool().emplace_back(
+            std::move(segment));
+      }
+    }
+  }
+
+  inline size_t size() const noexcept { return segments_.size(); }
+
+  /**
+   * Record a segment on its own stack. The functor is called on the
+   * stack of the segment with the segment as argument and must fill
+   * in its local inputs and outputs; the local inputs must be copies
+   * of the shared inputs in the same order.
+   *
+   * Different segments can be recorded concurrently.
+   *
+   * @tparam F type of functor
+   * @param k index of the segment
+   * @param f functor recording the segment
+   */
+  template <typename F>
+  void record(size_t k, F&& f) {
+    independent_tape_segment& segment = *segments_[k];
+    segment.stack_.execute([&] { f(segment); });
+  }
+
+  /**
+   * Create the outputs of the segments on the main AD tape, followed by
+   * the vari running the reverse pass of the segments, and return the
+   * outputs in the order of the segments.
+   *
+   * @return varis of the outputs
+   */
+  std::vector<vari*> finish() {
+    std::vector<vari*> outputs;
+    for (auto& segment : segments_) {
+      segment->outputs_.clear();
+      for (vari* local_output : segment->local_outputs_) {
+        vari* output = new vari(local_output->val_, false);
+        segment->outputs_.push_back(output);
+        outputs.push_back(output);
+      }
+    }
+    new reverse_pass_vari(*this);
+    return outputs;
+  }
+
+ private:
+  inline void chain_segment(size_t k) {
+    independent_tape_segment& segment = *segments_[k];
+    segment.stack_.execute([&] {
+      set_zero_all_adjoints();
+      for (size_t i = 0; i < segment.outputs_.size(); ++i) {
+        segment.local_outputs_[i]->adj_ += segment.outputs_[i]->adj_;
+      }
+      grad();
+    });
+  }
+
+  inline void chain() {
+#ifdef STAN_THREADS
+    // isolate the tasks as in reduce_sum, since the thread local AD
+    // tape of the calling thread is in use
+    run_parallel_region([&] {
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, segments_.size()),
+                        [&](const tbb::blocked_range<size_t>& r) {
+                          const parallel_task_scope task;
+                          for (size_t k = r.begin(); k != r.end(); ++k) {
+                            chain_segment(k);
+                          }
+                        });
+    });
+#else
+    for (size_t k = 0; k < segments_.size(); ++k) {
+      chain_segment(k);
+    }
+#endif
+    for (auto& segment : segments_) {
+      for (size_t i = 0; i < inputs_.size(); ++i) {
+        inputs_[i]->adj_ += segment->local_inputs_[i]->adj_;
+      }
+    }
+  }
+};
+
+}  // namespace math
+}  // namespace stan
+#endif
@@ -2,6 +2,7 @@
 #define STAN_MATH_REV_CORE_INIT_CHAINABLESTACK_HPP
 
 #include <stan/math/rev/core/chainablestack.hpp>
+#include <stan/math/prim/core/thread_affinity.hpp>
 
 #include <tbb/task_scheduler_observer.h>
 
@@ -10,6 +11,7 @@
 #include <utility>
 #include <thread>
 #include <tuple>
+#include <vector>
 
 namespace stan {
 namespace math {
@@ -61,9 +63,41 @@ class ad_tape_observer final : public tbb::task_scheduler_observer {
   std::mutex thread_tape_map_mutex_;
 };
 
+namespace internal {
+
+/**
+ * Release the memory of the AD tape of the calling thread if the tape
+ * is not in use, so that it is allocated again, and first touched, on
+ * the NUMA node the thread now runs on. The initial block of the arena
+ * stays where it was allocated.
+ */
+inline void rehome_ad_tape() {
+  auto* tape = ChainableStack::instance_;
+  if (tape == nullptr || !tape->var_stack_.empty()
+      || !tape->var_nochain_stack_.empty() || !tape->var_alloc_stack_.empty()
+      || !tape->nested_var_stack_sizes_.empty()) {
+    return;
+  }
+  tape->memalloc_.free_all();
+  std::vector<vari_base*>().swap(tape->var_stack_);
+  std::vector<vari_base*>().swap(tape->var_nochain_stack_);
+  std::vector<chainable_alloc*>().swap(tape->var_alloc_stack_);
+}
+
+/**
+ * Register `rehome_ad_tape` as the `numa_node_change_hook`.
+ */
+inline bool register_rehome_ad_tape() {
+  numa_node_change_hook() = &rehome_ad_tape;
+  return true;
+}
+
+}  // namespace internal
+
 namespace {
 
 ad_tape_observer global_observer;
+const bool rehome_ad_tape_registered = internal::register_rehome_ad_tape();
 
 }  // namespace
 }  // namespace math
@@ -3,6 +3,7 @@
 
 #include <stan/math/rev/meta.hpp>
 #include <stan/math/rev/core/var.hpp>
+#include <stan/math/rev/core/compact_tape.hpp>
 #include <stan/math/prim/err/check_matching_dims.hpp>
 #include <stan/math/rev/core/callback_vari.hpp>
 #include <stan/math/prim/fun/as_column_vector_or_scalar.hpp>
@@ -51,11 +52,17 @@ namespace math {
  * @return Variable result of adding two variables.
  */
 inline var operator+(const var& a, const var& b) {
+#ifdef STAN_COMPACT_TAPE
+  return internal::compact_binary(internal::compact_op::add_vv,
+                                  a.vi_->val_ + b.vi_->val_, a.vi_, b.vi_,
+                                  1.0, 1.0);
+#else
   return make_callback_vari(a.vi_->val_ + b.vi_->val_,
                             [avi = a.vi_, bvi = b.vi_](const auto& vi) mutable {
                               avi->adj_ += vi.adj_;
                               bvi->adj_ += vi.adj_;
                             });
+#endif
 }
 
 /**
@@ -75,9 +82,14 @@ inline var operator+(const var& a, Arith b) {
   if (unlikely(b == 0.0)) {
     return a;
   }
+#ifdef STAN_COMPACT_TAPE
+  return internal::compact_binary(internal::compact_op::add_vd,
+                                  a.vi_->val_ + b, a.vi_, 1.0, b);
+#else
   return make_callback_vari(
       a.vi_->val_ + b,
       [avi = a.vi_, b](const auto& vi) mutable { avi->adj_ += vi.adj_; });
+#endif
 }
 
 /**
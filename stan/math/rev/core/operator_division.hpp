@@ -6,6 +6,7 @@
 #include <stan/math/prim/fun/constants.hpp>
 #include <stan/math/prim/fun/is_any_nan.hpp>
 #include <stan/math/rev/core/var.hpp>
+#include <stan/math/rev/core/compact_tape.hpp>
 #include <stan/math/rev/core/std_complex.hpp>
 #include <stan/math/rev/core/vv_vari.hpp>
 #include <stan/math/rev/core/vd_vari.hpp>
@@ -88,7 +89,14 @@ class divide_dv_vari final : public op_dv_vari {
  * second.
  */
 inline var operator/(const var& dividend, const var& divisor) {
+#ifdef STAN_COMPACT_TAPE
+  const double val = dividend.vi_->val_ / divisor.vi_->val_;
+  return internal::compact_binary(
+      internal::compact_op::divide_vv, val, dividend.vi_, divisor.vi_,
+      1.0 / divisor.vi_->val_, -val / divisor.vi_->val_);
+#else
   return {new internal::divide_vv_vari(dividend.vi_, divisor.vi_)};
+#endif
 }
 
 /**
@@ -109,7 +117,13 @@ inline var operator/(const var& dividend, Arith divisor) {
   if (divisor == 1.0) {
     return dividend;
   }
+#ifdef STAN_COMPACT_TAPE
+  return internal::compact_binary(internal::compact_op::divide_vd,
+                                  dividend.vi_->val_ / divisor, dividend.vi_,
+                                  1.0 / divisor, divisor);
+#else
   return {new internal::divide_vd_vari(dividend.vi_, divisor)};
+#endif
 }
 
 /**
@@ -126,7 +140,14 @@ inline var operator/(const var& dividend, Arith divisor) {
  */
 template <typename Arith, require_arithmetic_t<Arith>* = nullptr>
 inline var operator/(Arith dividend, const var& divisor) {
+#ifdef STAN_COMPACT_TAPE
+  const double val = dividend / divisor.vi_->val_;
+  return internal::compact_binary(internal::compact_op::divide_dv, val,
+                                  divisor.vi_, -val / divisor.vi_->val_,
+                                  dividend);
+#else
   return {new internal::divide_dv_vari(dividend, divisor.vi_)};
+#endif
 }
 
 inline std::complex<var> operator/(const std::complex<var>& x1,
@@ -3,6 +3,7 @@
 
 #include <stan/math/prim/meta.hpp>
 #include <stan/math/rev/core/var.hpp>
+#include <stan/math/rev/core/compact_tape.hpp>
 #include <stan/math/rev/core/vv_vari.hpp>
 #include <stan/math/rev/core/vd_vari.hpp>
 #include <stan/math/prim/fun/constants.hpp>
@@ -69,7 +70,13 @@ class multiply_vd_vari final : public op_vd_vari {
  * @return Variable result of multiplying operands.
  */
 inline var operator*(const var& a, const var& b) {
+#ifdef STAN_COMPACT_TAPE
+  return internal::compact_binary(internal::compact_op::multiply_vv,
+                                  a.vi_->val_ * b.vi_->val_, a.vi_, b.vi_,
+                                  b.vi_->val_, a.vi_->val_);
+#else
   return {new internal::multiply_vv_vari(a.vi_, b.vi_)};
+#endif
 }
 
 /**
@@ -89,7 +96,12 @@ inline var operator*(const var& a, Arith b) {
   if (b == 1.0) {
     return a;
   }
+#ifdef STAN_COMPACT_TAPE
+  return internal::compact_binary(internal::compact_op::multiply_vd,
+                                  a.vi_->val_ * b, a.vi_, b, b);
+#else
   return {new internal::multiply_vd_vari(a.vi_, b)};
+#endif
 }
 
 /**
@@ -109,7 +121,12 @@ inline var operator*(Arith a, const var& b) {
   if (a == 1.0) {
     return b;
   }
+#ifdef STAN_COMPACT_TAPE
+  return internal::compact_binary(internal::compact_op::multiply_vd,
+                                  a * b.vi_->val_, b.vi_, a, a);
+#else
   return {new internal::multiply_vd_vari(b.vi_, a)};  // by symmetry
+#endif
 }
 
 }  // namespace math
@@ -0,0 +1,654 @@
+#ifndef STAN_MATH_REV_CORE_PROFILE_REGISTRY_HPP
+#define STAN_MATH_REV_CORE_PROFILE_REGISTRY_HPP
+
+#include <stan/math/rev/meta.hpp>
+#include <stan/math/rev/core/reverse_pass_callback.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define STAN_MATH_PROFILE_HAS_TSC
+#endif
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define STAN_MATH_PROFILE_HAS_PERF_EVENTS
+#endif
+
+namespace stan {
+namespace math {
+
+namespace internal {
+
+/**
+ * Return the current value of the clock used by the profile scopes:
+ * the time stamp counter where available, nanoseconds of the steady
+ * clock otherwise.
+ */
+inline uint64_t profile_ticks() noexcept {
+#ifdef STAN_MATH_PROFILE_HAS_TSC
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+/// number of hardware counters read by the profile scopes
+constexpr size_t NUM_PROFILE_COUNTERS = 3;
+
+using profile_counters = std::array<uint64_t, NUM_PROFILE_COUNTERS>;
+
+/**
+ * Hardware counters (cycles, instructions and cache misses) of the
+ * thread opening them, read through `perf_event_open` on Linux.
+ */
+class profile_hw_counters {
+  std::array<int, NUM_PROFILE_COUNTERS> fds_{{-1, -1, -1}};
+
+  void close_all() noexcept {
+#ifdef STAN_MATH_PROFILE_HAS_PERF_EVENTS
+    for (int& fd : fds_) {
+      if (fd >= 0) {
+        close(fd);
+      }
+      fd = -1;
+    }
+#endif
+  }
+
+ public:
+  profile_hw_counters() = default;
+  profile_hw_counters(const profile_hw_counters&) = delete;
+  profile_hw_counters& operator=(const profile_hw_counters&) = delete;
+  ~profile_hw_counters() { close_all(); }
+
+  /**
+   * Open the counters for the calling thread.
+   *
+   * @return true if the counters could be opened
+   */
+  bool open() noexcept {
+#ifdef STAN_MATH_PROFILE_HAS_PERF_EVENTS
+    const uint64_t configs[NUM_PROFILE_COUNTERS]
+        = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+           PERF_COUNT_HW_CACHE_MISSES};
+    for (size_t i = 0; i < NUM_PROFILE_COUNTERS; ++i) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = configs[i];
+      attr.disabled = i == 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP;
+      const int group_fd = i == 0 ? -1 : fds_[0];
+      fds_[i] = static_cast<int>(
+          syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+      if (fds_[i] < 0) {
+        close_all();
+        return false;
+      }
+    }
+    ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  bool is_open() const noexcept { return fds_[0] >= 0; }
+
+  /**
+   * Read the counters, which must be open.
+   *
+   * @param[out] values counter values
+   */
+  void read(profile_counters& values) const noexcept {
+#ifdef STAN_MATH_PROFILE_HAS_PERF_EVENTS
+    struct {
+      uint64_t nr;
+      uint64_t values[NUM_PROFILE_COUNTERS];
+    } buffer;
+    if (::read(fds_[0], &buffer, sizeof(buffer))
+        == static_cast<ssize_t>(sizeof(buffer))) {
+      for (size_t i = 0; i < NUM_PROFILE_COUNTERS; ++i) {
+        values[i] = buffer.values[i];
+      }
+    }
+#endif
+  }
+};
+
+/**
+ * Node of the tree of profile regions of a thread: a region entered
+ * from the region of its parent node.
+ */
+struct profile_node {
+  int region_;
+  size_t parent_;
+  std::vector<size_t> children_;
+  size_t num_fwd_passes_{0};
+  size_t num_rev_passes_{0};
+  uint64_t fwd_ticks_{0};
+  uint64_t rev_ticks_{0};
+  profile_counters fwd_counters_{};
+  profile_counters rev_counters_{};
+  uint64_t fwd_start_ticks_{0};
+  uint64_t rev_start_ticks_{0};
+  profile_counters fwd_start_counters_{};
+  profile_counters rev_start_counters_{};
+
+  profile_node(int region, size_t parent) : region_(region), parent_(parent) {}
+};
+
+/**
+ * Profile regions entered by one thread. Only the owning thread writes
+ * to it, so no locking is needed: the reverse passes of the regions
+ * are recorded by the thread running them (see `profile_scope`).
+ */
+class profile_thread_data {
+ public:
+  std::thread::id thread_id_;
+  /// nodes of the region tree; node 0 is the root
+  std::deque<profile_node> nodes_;
+  /// node of the innermost region entered
+  size_t current_{0};
+  /// number of times the regions were reset, which invalidates nodes
+  size_t generation_{0};
+  profile_hw_counters counters_;
+  bool counters_tried_{false};
+
+  explicit profile_thread_data(std::thread::id thread_id)
+      : thread_id_(thread_id) {
+    nodes_.emplace_back(-1, 0);
+  }
+
+  /**
+   * Return the node of the region as a child of the region of a node,
+   * creating it if needed.
+   *
+   * @param parent node of the parent region
+   * @param region region id
+   * @return node of the region
+   */
+  inline size_t child(size_t parent, int region) {
+    for (size_t child : nodes_[parent].children_) {
+      if (nodes_[child].region_ == region) {
+        return child;
+      }
+    }
+    const size_t node = nodes_.size();
+    nodes_.emplace_back(region, parent);
+    nodes_[parent].children_.push_back(node);
+    return node;
+  }
+
+  /**
+   * Enter the region as a child of the current region.
+   *
+   * @param region region id
+   * @return node of the region
+   */
+  inline size_t enter(int region) {
+    current_ = child(current_, region);
+    return current_;
+  }
+
+  /**
+   * Return the node of the region path, the ids of the nested regions
+   * from the outermost one, creating it if needed.
+   *
+   * @param path region ids
+   * @param depth number of regions in the path
+   * @return node of the innermost region
+   */
+  inline size_t find(const int* path, size_t depth) {
+    size_t node = 0;
+    for (size_t i = 0; i < depth; ++i) {
+      node = child(node, path[i]);
+    }
+    return node;
+  }
+
+  /**
+   * Return the number of regions in the path of a node, its own
+   * included.
+   */
+  inline size_t depth(size_t node) const noexcept {
+    size_t depth = 0;
+    for (; node != 0; node = nodes_[node].parent_) {
+      ++depth;
+    }
+    return depth;
+  }
+
+  /**
+   * Leave the region of the node, going back to its parent.
+   */
+  inline void leave(size_t node) noexcept { current_ = nodes_[node].parent_; }
+
+  inline void read_counters(profile_counters& values) const noexcept {
+    if (counters_.is_open()) {
+      counters_.read(values);
+    }
+  }
+
+  inline void start_fwd(size_t node) noexcept {
+    profile_node& n = nodes_[node];
+    read_counters(n.fwd_start_counters_);
+    n.fwd_start_ticks_ = profile_ticks();
+  }
+
+  inline void stop_fwd(size_t node) noexcept {
+    const uint64_t ticks = profile_ticks();
+    profile_node& n = nodes_[node];
+    n.fwd_ticks_ += ticks - n.fwd_start_ticks_;
+    if (counters_.is_open()) {
+      profile_counters values;
+      counters_.read(values);
+      for (size_t i = 0; i < NUM_PROFILE_COUNTERS; ++i) {
+        n.fwd_counters_[i] += values[i] - n.fwd_start_counters_[i];
+      }
+    }
+    ++n.num_fwd_passes_;
+  }
+
+  inline void start_rev(size_t node) noexcept {
+    profile_node& n = nodes_[node];
+    read_counters(n.rev_start_counters_);
+    n.rev_start_ticks_ = profile_ticks();
+  }
+
+  inline void stop_rev(size_t node) noexcept {
+    const uint64_t ticks = profile_ticks();
+    profile_node& n = nodes_[node];
+    n.rev_ticks_ += ticks - n.rev_start_ticks_;
+    if (counters_.is_open()) {
+      profile_counters values;
+      counters_.read(values);
+      for (size_t i = 0; i < NUM_PROFILE_COUNTERS; ++i) {
+        n.rev_counters_[i] += values[i] - n.rev_start_counters_[i];
+      }
+    }
+    ++n.num_rev_passes_;
+  }
+
+  /**
+   * Reset all the regions. Nodes obtained before are invalidated and
+   * must be checked against `generation_` before being used again.
+   */
+  void clear() {
+    nodes_.clear();
+    nodes_.emplace_back(-1, 0);
+    current_ = 0;
+    ++generation_;
+  }
+};
+
+/**
+ * Reverse pass of a profile scope, allocated in the arena of the AD
+ * tape: the path of its region, and the node it resolved to in the
+ * profile data of the thread running the reverse pass.
+ */
+struct profile_rev_pass {
+  int* path_;
+  size_t depth_;
+  profile_thread_data* data_{nullptr};
+  size_t node_{0};
+  size_t generation_{0};
+
+  profile_rev_pass(int* path, size_t depth) : path_(path), depth_(depth) {}
+};
+
+}  // namespace internal
+
+/**
+ * Profile of a region, identified by the path of the regions it was
+ * entered from. The times include the times of the nested regions.
+ */
+struct profile_region_stats {
+  size_t num_fwd_passes_{0};
+  size_t num_rev_passes_{0};
+  double fwd_time_{0.0};
+  double rev_time_{0.0};
+  /// cycles, instructions and cache misses in the forward passes
+  internal::profile_counters fwd_counters_{};
+  /// cycles, instructions and cache misses in the reverse passes
+  internal::profile_counters rev_counters_{};
+
+  profile_region_stats& operator+=(const profile_region_stats& other) {
+    num_fwd_passes_ += other.num_fwd_passes_;
+    num_rev_passes_ += other.num_rev_passes_;
+    fwd_time_ += other.fwd_time_;
+    rev_time_ += other.rev_time_;
+    for (size_t i = 0; i < internal::NUM_PROFILE_COUNTERS; ++i) {
+      fwd_counters_[i] += other.fwd_counters_[i];
+      rev_counters_[i] += other.rev_counters_[i];
+    }
+    return *this;
+  }
+};
+
+/**
+ * Profiles by region path, the names of the nested regions separated
+ * by '/'.
+ */
+using profile_region_map = std::map<std::string, profile_region_stats>;
+
+/**
+ * Registry of the hierarchical profile regions.
+ *
+ * Regions are registered once, by name, and then identified by an
+ * integer id, so entering a region (see `profile_scope`) neither
+ * hashes nor compares strings. Each thread records the regions it
+ * enters in its own tree of nested regions, without any locking; the
+ * trees of all threads are merged on demand. The registry must only be
+ * read (or cleared) while no thread enters or leaves a region.
+ *
+ * Hardware counters are read around every region if enabled, either
+ * with `enable_hardware_counters()` or by setting the environment
+ * variable `STAN_PROFILE_HW_COUNTERS` to a non-zero value. They are
+ * only available on Linux, when `perf_event_open` is permitted.
+ */
+class profile_registry {
+  mutable std::mutex mutex_;
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, int> ids_;
+  std::vector<std::unique_ptr<internal::profile_thread_data>> threads_;
+  std::atomic<bool> counters_enabled_;
+  std::chrono::steady_clock::time_point start_time_;
+  uint64_t start_ticks_;
+
+  profile_registry()
+      : counters_enabled_(false),
+        start_time_(std::chrono::steady_clock::now()),
+        start_ticks_(internal::profile_ticks()) {
+    const char* env = std::getenv("STAN_PROFILE_HW_COUNTERS");
+    counters_enabled_ = env != nullptr && std::string(env) != "0";
+  }
+
+  internal::profile_thread_data* new_thread_data() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    threads_.emplace_back(std::make_unique<internal::profile_thread_data>(
+        std::this_thread::get_id()));
+    return threads_.back().get();
+  }
+
+  /**
+   * Add the regions below a node of a thread tree to the map.
+   */
+  void merge_node(const internal::profile_thread_data& data, size_t node,
+                  const std::string& path, double seconds_per_tick,
+                  profile_region_map& regions) const {
+    for (size_t child : data.nodes_[node].children_) {
+      const internal::profile_node& n = data.nodes_[child];
+      std::string child_path = path.empty()
+                                   ? names_[n.region_]
+                                   : path + "/" + names_[n.region_];
+      profile_region_stats stats;
+      stats.num_fwd_passes_ = n.num_fwd_passes_;
+      stats.num_rev_passes_ = n.num_rev_passes_;
+      stats.fwd_time_ = n.fwd_ticks_ * seconds_per_tick;
+      stats.rev_time_ = n.rev_ticks_ * seconds_per_tick;
+      stats.fwd_counters_ = n.fwd_counters_;
+      stats.rev_counters_ = n.rev_counters_;
+      regions[child_path] += stats;
+      merge_node(data, child, child_path, seconds_per_tick, regions);
+    }
+  }
+
+ public:
+  profile_registry(const profile_registry&) = delete;
+  profile_registry& operator=(const profile_registry&) = delete;
+
+  /**
+   * Return the process wide registry.
+   */
+  static profile_registry& instance() {
+    static profile_registry registry;
+    return registry;
+  }
+
+  /**
+   * Return the id of the region with the specified name, registering
+   * it if needed. Thread safe.
+   *
+   * @param name name of the region
+   * @return id of the region
+   * @throw std::invalid_argument if the name contains '/'
+   */
+  int register_region(const std::string& name) {
+    if (name.find('/') != std::string::npos) {
+      throw std::invalid_argument("profile region name '" + name
+                                  + "' must not contain '/'");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    if (it != ids_.end()) {
+      return it->second;
+    }
+    const int id = names_.size();
+    names_.push_back(name);
+    ids_.emplace(name, id);
+    return id;
+  }
+
+  /**
+   * Return the name of the region with the specified id.
+   */
+  std::string region_name(int id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return names_.at(id);
+  }
+
+  /**
+   * Enable or disable the hardware counters for the threads entering
+   * their first region from now on.
+   */
+  void enable_hardware_counters(bool enable) noexcept {
+    counters_enabled_ = enable;
+  }
+
+  bool hardware_counters_enabled() const noexcept { return counters_enabled_; }
+
+  /**
+   * Return the profile data of the calling thread, creating it on
+   * first use.
+   */
+  internal::profile_thread_data& thread_data() {
+    static thread_local internal::profile_thread_data* data = nullptr;
+    if (unlikely(data == nullptr)) {
+      data = new_thread_data();
+    }
+    if (unlikely(!data->counters_tried_ && counters_enabled_)) {
+      data->counters_tried_ = true;
+      data->counters_.open();
+    }
+    return *data;
+  }
+
+  /**
+   * Return the number of seconds per tick of the profile clock.
+   */
+  double seconds_per_tick() const {
+#ifdef STAN_MATH_PROFILE_HAS_TSC
+    const double elapsed = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start_time_)
+                               .count();
+    const uint64_t ticks = internal::profile_ticks() - start_ticks_;
+    return ticks == 0 ? 0.0 : elapsed / ticks;
+#else
+    return 1e-9;
+#endif
+  }
+
+  /**
+   * Return the profiles of every thread which entered a region, by
+   * thread, in the order in which the threads entered their first
+   * region.
+   */
+  std::vector<std::pair<std::thread::id, profile_region_map>> per_thread()
+      const {
+    const double spt = seconds_per_tick();
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::pair<std::thread::id, profile_region_map>> result;
+    for (const auto& data : threads_) {
+      profile_region_map regions;
+      merge_node(*data, 0, "", spt, regions);
+      result.emplace_back(data->thread_id_, std::move(regions));
+    }
+    return result;
+  }
+
+  /**
+   * Return the profiles aggregated over all threads.
+   */
+  profile_region_map aggregate() const {
+    const double spt = seconds_per_tick();
+    std::lock_guard<std::mutex> lock(mutex_);
+    profile_region_map regions;
+    for (const auto& data : threads_) {
+      merge_node(*data, 0, "", spt, regions);
+    }
+    return regions;
+  }
+
+  /**
+   * Reset the profiles of all threads. Registered regions are kept.
+   * Scopes still open, and reverse passes started before, are not
+   * recorded; reverse passes of scopes closed before are recorded anew.
+   */
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& data : threads_) {
+      data->clear();
+    }
+  }
+
+  /**
+   * Write the aggregated profiles as CSV, one line per region path.
+   *
+   * @param o stream to write to
+   */
+  void write_csv(std::ostream& o) const {
+    o << "region,fwd_passes,rev_passes,fwd_time,rev_time,fwd_cycles,"
+         "fwd_instructions,fwd_cache_misses,rev_cycles,rev_instructions,"
+         "rev_cache_misses\n";
+    for (const auto& region : aggregate()) {
+      const profile_region_stats& s = region.second;
+      o << "\"" << region.first << "\"," << s.num_fwd_passes_ << ","
+        << s.num_rev_passes_ << "," << s.fwd_time_ << "," << s.rev_time_;
+      for (uint64_t c : s.fwd_counters_) {
+        o << "," << c;
+      }
+      for (uint64_t c : s.rev_counters_) {
+        o << "," << c;
+      }
+      o << "\n";
+    }
+  }
+};
+
+/**
+ * Profiles the region identified by a registered id while the object
+ * is in scope, as a child of the region of the enclosing scope of the
+ * same thread, if any.
+ *
+ * Like `profile`, when T is var the reverse pass of the region is
+ * profiled too, with callbacks placed on the AD tape.
+ *
+ * The id is typically registered once per call site:
+ *
+ * <code>
+ * static const int region
+ *     = profile_registry::instance().register_region("likelihood");
+ * profile_scope<T> scope(region);
+ * </code>
+ *
+ * @tparam T type of profile class. If var, the created object is used
+ * to profile reverse mode AD. Only profiles the forward pass otherwise.
+ */
+template <typename T>
+class profile_scope {
+  internal::profile_thread_data* data_;
+  size_t node_;
+  size_t generation_;
+  internal::profile_rev_pass* rev_{nullptr};
+
+ public:
+  explicit profile_scope(int region)
+      : data_(&profile_registry::instance().thread_data()),
+        node_(data_->enter(region)),
+        generation_(data_->generation_) {
+    data_->start_fwd(node_);
+    if (!is_constant<T>::value) {
+      // The reverse pass may run on another thread, for instance in a
+      // segment of parallel_map, so its callbacks resolve the path of
+      // the region in the data of the thread running them.
+      auto& memalloc = ChainableStack::instance_->memalloc_;
+      const size_t depth = data_->depth(node_);
+      int* path = memalloc.alloc_array<int>(depth);
+      for (size_t i = depth, node = node_; i-- > 0;) {
+        path[i] = data_->nodes_[node].region_;
+        node = data_->nodes_[node].parent_;
+      }
+      auto* rev = new (memalloc.alloc(sizeof(internal::profile_rev_pass)))
+          internal::profile_rev_pass(path, depth);
+      reverse_pass_callback([rev]() {
+        if (rev->data_ != nullptr
+            && rev->data_->generation_ == rev->generation_) {
+          rev->data_->stop_rev(rev->node_);
+        }
+      });
+      rev_ = rev;
+    }
+  }
+
+  profile_scope(const profile_scope&) = delete;
+  profile_scope& operator=(const profile_scope&) = delete;
+
+  ~profile_scope() {
+    if (data_->generation_ == generation_) {
+      data_->stop_fwd(node_);
+      data_->leave(node_);
+    }
+    if (!is_constant<T>::value) {
+      reverse_pass_callback([rev = rev_]() {
+        internal::profile_thread_data& data
+            = profile_registry::instance().thread_data();
+        rev->data_ = &data;
+        rev->generation_ = data.generation_;
+        rev->node_ = data.find(rev->path_, rev->depth_);
+        data.start_rev(rev->node_);
+      });
+    }
+  }
+};
+
+}  // namespace math
+}  // namespace stan
+#endif
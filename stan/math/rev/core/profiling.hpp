@@ -8,8 +8,15 @@
 #include <stan/math/rev/fun/value_of.hpp>
 #include <stan/math/prim/err.hpp>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <sstream>
+#include <string>
 #include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace stan {
 namespace math {
@@ -48,6 +55,24 @@ class profile_info {
         start_chain_stack_size_(0),
         start_nochain_stack_size_(0) {}
 
+  /**
+   * Add the passes, times and stack sizes of another profile, for
+   * example of the same region in another thread.
+   *
+   * @param other profile
+   * @return this profile
+   */
+  profile_info& operator+=(const profile_info& other) {
+    fwd_pass_time_ += other.fwd_pass_time_;
+    rev_pass_time_ += other.rev_pass_time_;
+    n_fwd_AD_passes_ += other.n_fwd_AD_passes_;
+    n_fwd_no_AD_passes_ += other.n_fwd_no_AD_passes_;
+    n_rev_passes_ += other.n_rev_passes_;
+    chain_stack_size_sum_ += other.chain_stack_size_sum_;
+    nochain_stack_size_sum_ += other.nochain_stack_size_sum_;
+    return *this;
+  }
+
   bool is_active() const noexcept { return active_; }
 
   template <typename T>
@@ -117,6 +142,104 @@ using profile_key = std::pair<std::string, std::thread::id>;
 
 using profile_map = std::map<profile_key, profile_info>;
 
+namespace internal {
+
+/**
+ * Profiles recorded by one thread, by the address of their map and by
+ * name. Only the owning thread (and reverse passes of its AD tape)
+ * write to them, so no locking is needed; `merge_profiles()` moves them
+ * into their maps. The elements of an `std::unordered_map` stay in place
+ * when others are inserted, and records are only ever reset, so the
+ * pointers to them held by profiles stay valid.
+ */
+struct profile_thread_records {
+  std::thread::id thread_id_;
+  std::unordered_map<const profile_map*,
+                     std::unordered_map<std::string, profile_info>>
+      maps_;
+
+  explicit profile_thread_records(std::thread::id thread_id)
+      : thread_id_(thread_id) {}
+};
+
+/**
+ * Return the mutex guarding the list of the records of all threads.
+ */
+inline std::mutex& profile_threads_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+/**
+ * Return the records of all threads which profiled, in the order in
+ * which they profiled first. Records outlive their threads, so that
+ * they can be merged after the threads ended.
+ */
+inline std::vector<std::unique_ptr<profile_thread_records>>&
+profile_threads() {
+  static std::vector<std::unique_ptr<profile_thread_records>> threads;
+  return threads;
+}
+
+/**
+ * Return the profile of the calling thread with the specified name for
+ * the map, creating it if needed.
+ *
+ * The profile lives in the records of the thread, not in the map, so it
+ * is found and inserted without locking, and without reading or writing
+ * the map, which may be modified in any way meanwhile. Only the first
+ * use of profiling by a thread locks, to register its records.
+ *
+ * @param name name of the profile
+ * @param profiles map the profile is merged into
+ * @return profile
+ */
+inline profile_info& thread_profile(const std::string& name,
+                                    const profile_map& profiles) {
+  static thread_local profile_thread_records* records = nullptr;
+  if (unlikely(records == nullptr)) {
+    std::lock_guard<std::mutex> lock(profile_threads_mutex());
+    profile_threads().emplace_back(
+        std::make_unique<profile_thread_records>(std::this_thread::get_id()));
+    records = profile_threads().back().get();
+  }
+  return records->maps_[&profiles][name];
+}
+
+}  // namespace internal
+
+/**
+ * Add the profiles recorded by all threads for the map since they were
+ * last merged to the profiles of the map, by name and thread id, and
+ * reset them.
+ *
+ * Profiles are recorded in storage owned by the threads and only reach
+ * their map when it is merged: this must be done before reading the map,
+ * while no thread profiles into it and after the reverse passes of the
+ * profiled regions. `aggregate_profiles()` and `write_profiles_csv()`
+ * merge the map themselves. Profiles of a map destroyed before being
+ * merged are merged into the next map merged at the same address.
+ *
+ * @param profiles profiles of all threads
+ */
+inline void merge_profiles(profile_map& profiles) {
+  std::lock_guard<std::mutex> lock(internal::profile_threads_mutex());
+  for (auto& records : internal::profile_threads()) {
+    auto it = records->maps_.find(&profiles);
+    if (it == records->maps_.end()) {
+      continue;
+    }
+    for (auto& p : it->second) {
+      if (p.second.get_num_fwd_passes() == 0
+          && p.second.get_num_rev_passes() == 0) {
+        continue;
+      }
+      profiles[{p.first, records->thread_id_}] += p.second;
+      p.second = profile_info();
+    }
+  }
+}
+
 /**
  * Profiles C++ lines where the object is in scope.
  * When T is var, the constructor starts the profile for the forward pass
@@ -125,26 +248,24 @@ using profile_map = std::map<profile_key, profile_info>;
  * places a var with a callback to start the profile for the reverse pass.
  * When T is not var, the constructor and destructor only profile the
  *
+ * Every thread records into its own profiles, without locking (see
+ * `internal::thread_profile()`), so profiles may be used by the tasks
+ * of the parallel functors. The profiles are added to the map by
+ * `merge_profiles()`.
  *
  * @tparam T type of profile class. If var, the created object is used
  * to profile reverse mode AD. Only profiles the forward pass otherwise.
  */
 template <typename T>
 class profile {
-  profile_key key_;
   profile_info* profile_;
 
  public:
-  profile(std::string name, profile_map& profiles)
-      : key_({name, std::this_thread::get_id()}) {
-    profile_map::iterator p = profiles.find(key_);
-    if (p == profiles.end()) {
-      profiles[key_] = profile_info();
-    }
-    profile_ = &profiles[key_];
+  profile(const std::string& name, profile_map& profiles)
+      : profile_(&internal::thread_profile(name, profiles)) {
     if (profile_->is_active()) {
       std::ostringstream msg;
-      msg << "Profile '" << key_.first << "' already started!";
+      msg << "Profile '" << name << "' already started!";
       throw std::runtime_error(msg.str());
     }
     profile_->fwd_pass_start<T>();
@@ -162,6 +283,60 @@ class profile {
   }
 };
 
+/**
+ * Return the profiles of the map aggregated over the threads, by name,
+ * after merging the profiles recorded since (see `merge_profiles()`).
+ *
+ * @param profiles profiles of all threads
+ * @return sums of the profiles of every name
+ */
+inline std::map<std::string, profile_info> aggregate_profiles(
+    profile_map& profiles) {
+  merge_profiles(profiles);
+  std::map<std::string, profile_info> aggregated;
+  for (const auto& p : profiles) {
+    aggregated[p.first.first] += p.second;
+  }
+  return aggregated;
+}
+
+namespace internal {
+
+inline void write_profile_csv_row(std::ostream& o, const std::string& name,
+                                  const std::string& thread,
+                                  const profile_info& p) {
+  o << '"' << name << "\"," << thread << ","
+    << p.get_fwd_time() + p.get_rev_time() << "," << p.get_fwd_time() << ","
+    << p.get_rev_time() << "," << p.get_chain_stack_used() << ","
+    << p.get_nochain_stack_used() << "," << p.get_num_AD_fwd_passes() << ","
+    << p.get_num_no_AD_fwd_passes() << "\n";
+}
+
+}  // namespace internal
+
+/**
+ * Write the profiles as CSV: one line per name and thread, followed by
+ * one line per name with the profiles aggregated over all threads,
+ * whose thread is `all`. The profiles recorded since the map was last
+ * merged are merged first (see `merge_profiles()`).
+ *
+ * @param o stream to write to
+ * @param profiles profiles of all threads
+ */
+inline void write_profiles_csv(std::ostream& o, profile_map& profiles) {
+  merge_profiles(profiles);
+  o << "name,thread_id,total_time,forward_time,reverse_time,chain_stack,"
+       "no_chain_stack,autodiff_calls,no_autodiff_calls\n";
+  for (const auto& p : profiles) {
+    std::ostringstream thread;
+    thread << p.first.second;
+    internal::write_profile_csv_row(o, p.first.first, thread.str(), p.second);
+  }
+  for (const auto& p : aggregate_profiles(profiles)) {
+    internal::write_profile_csv_row(o, p.first, "all", p.second);
+  }
+}
+
 }  // namespace math
 }  // namespace stan
 #endif
@@ -28,6 +28,7 @@ static inline void recover_memory() {
   }
   ChainableStack::instance_->var_alloc_stack_.clear();
   ChainableStack::instance_->memalloc_.recover_all();
+  ChainableStack::instance_->compact_range_ = nullptr;
 }
 
 }  // namespace math
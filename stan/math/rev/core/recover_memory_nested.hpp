@@ -45,6 +45,7 @@ static inline void recover_memory_nested() {
   ChainableStack::instance_->nested_var_alloc_stack_starts_.pop_back();
 
   ChainableStack::instance_->memalloc_.recover_nested();
+  ChainableStack::instance_->compact_range_ = nullptr;
 }
 
 }  // namespace math
@@ -0,0 +1,253 @@
+#ifndef STAN_MATH_REV_CORE_TAPE_STATISTICS_HPP
+#define STAN_MATH_REV_CORE_TAPE_STATISTICS_HPP
+
+#include <stan/math/rev/core/chainablestack.hpp>
+#include <boost/core/demangle.hpp>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+
+namespace stan {
+namespace math {
+
+/**
+ * Statistics of the varis on the AD tape, by vari type.
+ *
+ * While the statistics are started on the AD tape of the calling
+ * thread, every reverse pass (`grad()`) run on that tape records, for
+ * each type of vari in the part of the tape it covers, the number of
+ * calls and the time spent in their `chain()` methods. The first
+ * reverse pass covering a vari created while the statistics are started
+ * also counts it, as a chaining or non-chaining vari, and its arena
+ * bytes, so repeated reverse passes over the same tape count its varis
+ * once. The statistics accumulate over the reverse passes.
+ *
+ * The arena bytes only account for the vari objects themselves, not for
+ * the arena memory they point to.
+ *
+ * When no statistics are started, the only overhead is a test in
+ * `grad()` and in the allocation of varis. When they are started, every
+ * allocation of a vari and every call to `chain()` are instrumented,
+ * which slows down the forward and reverse passes considerably.
+ */
+class tape_statistics {
+ public:
+  /**
+   * Statistics of a vari type.
+   */
+  struct entry {
+    /// number of varis on the chaining stack
+    size_t num_chain_ = 0;
+    /// number of varis on the non-chaining stack
+    size_t num_nochain_ = 0;
+    /// arena bytes of the varis
+    size_t bytes_ = 0;
+    /// number of calls to chain()
+    size_t num_chain_calls_ = 0;
+    /// time spent in chain(), in seconds
+    double chain_time_ = 0.0;
+  };
+
+  using entry_map = std::map<std::string, entry>;
+
+ private:
+  ChainableStack::AutodiffStackStorage* stack_{nullptr};
+  // arena bytes of the varis created while started and not yet counted
+  std::unordered_map<const void*, size_t> vari_bytes_;
+  std::unordered_map<std::type_index, entry> entries_;
+  size_t num_rev_passes_{0};
+  double rev_pass_time_{0.0};
+
+  /**
+   * Count the vari in the statistics of its type if it was created while
+   * the statistics are started and is not counted yet.
+   *
+   * @param vi vari
+   * @param e statistics of the type of the vari
+   * @param num_varis number of chaining or non-chaining varis of the type
+   */
+  inline void count_once(const void* vi, entry& e, size_t& num_varis) {
+    auto it = vari_bytes_.find(vi);
+    if (it != vari_bytes_.end()) {
+      ++num_varis;
+      e.bytes_ += it->second;
+      vari_bytes_.erase(it);
+    }
+  }
+
+ public:
+  tape_statistics() = default;
+  tape_statistics(const tape_statistics&) = delete;
+  tape_statistics& operator=(const tape_statistics&) = delete;
+
+  ~tape_statistics() {
+    if (is_started()) {
+      stack_->tape_statistics_ = nullptr;
+    }
+  }
+
+  /**
+   * Start recording statistics on the AD tape of the calling thread.
+   *
+   * @throw std::logic_error if statistics are already recorded on the
+   * AD tape
+   */
+  void start() {
+    if (ChainableStack::instance_->tape_statistics_ != nullptr) {
+      throw std::logic_error(
+          "tape_statistics: statistics are already recorded on this tape");
+    }
+    stack_ = ChainableStack::instance_;
+    stack_->tape_statistics_ = this;
+  }
+
+  /**
+   * Stop recording statistics. The statistics recorded so far are
+   * kept.
+   */
+  void stop() noexcept {
+    if (is_started()) {
+      stack_->tape_statistics_ = nullptr;
+      stack_ = nullptr;
+    }
+    vari_bytes_.clear();
+  }
+
+  /**
+   * Return true if the statistics are being recorded.
+   */
+  bool is_started() const noexcept {
+    return stack_ != nullptr && stack_->tape_statistics_ == this;
+  }
+
+  /**
+   * Clear the statistics recorded so far.
+   */
+  void clear() noexcept {
+    entries_.clear();
+    num_rev_passes_ = 0;
+    rev_pass_time_ = 0.0;
+  }
+
+  /**
+   * Record the allocation of a vari. Called by `vari_base::operator
+   * new`, which cannot throw, so a vari whose record cannot be allocated
+   * is left out of the counts.
+   *
+   * @param ptr pointer to the vari
+   * @param nbytes size of the vari
+   */
+  inline void record_allocation(const void* ptr, size_t nbytes) noexcept {
+    try {
+      vari_bytes_[ptr] = nbytes;
+    } catch (const std::bad_alloc&) {
+    }
+  }
+
+  /**
+   * Run and record the reverse pass over the specified part of the
+   * chaining stack of the tape, and count the varis it covers on the
+   * non-chaining stack, starting at the specified position. Called by
+   * `grad()`.
+   *
+   * @tparam Stack type of the AD tape storage
+   * @param stack AD tape storage
+   * @param beginning first position on the chaining stack
+   * @param end end position on the chaining stack
+   * @param nochain_beginning first position on the non-chaining stack
+   */
+  template <typename Stack>
+  void record_reverse_pass(Stack& stack, size_t beginning, size_t end,
+                           size_t nochain_beginning) {
+    using clock = std::chrono::steady_clock;
+    const auto rev_pass_start = clock::now();
+    for (size_t i = end; i-- > beginning;) {
+      auto* vi = stack.var_stack_[i];
+      entry& e = entries_[std::type_index(typeid(*vi))];
+      const auto start = clock::now();
+      vi->chain();
+      e.chain_time_ += std::chrono::duration<double>(clock::now() - start)
+                           .count();
+      ++e.num_chain_calls_;
+      count_once(vi, e, e.num_chain_);
+    }
+    rev_pass_time_
+        += std::chrono::duration<double>(clock::now() - rev_pass_start)
+               .count();
+    for (size_t i = nochain_beginning; i < stack.var_nochain_stack_.size();
+         ++i) {
+      auto* vi = stack.var_nochain_stack_[i];
+      entry& e = entries_[std::type_index(typeid(*vi))];
+      count_once(vi, e, e.num_nochain_);
+    }
+    ++num_rev_passes_;
+  }
+
+  /**
+   * Return the number of recorded reverse passes.
+   */
+  size_t num_rev_passes() const noexcept { return num_rev_passes_; }
+
+  /**
+   * Return the total time of the recorded reverse passes, in seconds,
+   * including the instrumentation overhead.
+   */
+  double rev_pass_time() const noexcept { return rev_pass_time_; }
+
+  /**
+   * Return the statistics by demangled vari type name.
+   */
+  entry_map entries() const {
+    entry_map named;
+    for (const auto& e : entries_) {
+      named[boost::core::demangle(e.first.name())] = e.second;
+    }
+    return named;
+  }
+
+  /**
+   * Write the statistics as CSV, one line per vari type.
+   *
+   * @param o stream to write to
+   */
+  void write_csv(std::ostream& o) const {
+    o << "type,num_chain,num_nochain,bytes,num_chain_calls,chain_time\n";
+    for (const auto& e : entries()) {
+      o << "\"" << e.first << "\"," << e.second.num_chain_ << ","
+        << e.second.num_nochain_ << "," << e.second.bytes_ << ","
+        << e.second.num_chain_calls_ << "," << e.second.chain_time_ << "\n";
+    }
+  }
+
+  /**
+   * Write the statistics as a JSON object.
+   *
+   * @param o stream to write to
+   */
+  void write_json(std::ostream& o) const {
+    o << "{\"num_rev_passes\": " << num_rev_passes_
+      << ", \"rev_pass_time\": " << rev_pass_time_ << ", \"types\": [";
+    bool first = true;
+    for (const auto& e : entries()) {
+      o << (first ? "" : ", ") << "{\"type\": \"" << e.first
+        << "\", \"num_chain\": " << e.second.num_chain_
+        << ", \"num_nochain\": " << e.second.num_nochain_
+        << ", \"bytes\": " << e.second.bytes_
+        << ", \"num_chain_calls\": " << e.second.num_chain_calls_
+        << ", \"chain_time\": " << e.second.chain_time_ << "}";
+      first = false;
+    }
+    o << "]}";
+  }
+};
+
+}  // namespace math
+}  // namespace stan
+#endif
@@ -4,6 +4,7 @@
 #include <stan/math/rev/core/var_value_fwd_declare.hpp>
 #include <stan/math/rev/core/chainable_alloc.hpp>
 #include <stan/math/rev/core/chainablestack.hpp>
+#include <stan/math/rev/core/tape_statistics.hpp>
 #include <stan/math/rev/core/arena_matrix.hpp>
 #include <stan/math/prim/meta.hpp>
 #include <ostream>
@@ -16,6 +17,14 @@ namespace math {
 template <typename T, typename = void>
 class vari_value;
 
+namespace internal {
+/**
+ * Tag selecting the constructor of a `vari_value` which does not put
+ * the vari on any of the stacks.
+ */
+struct unstacked_t {};
+}  // namespace internal
+
 /**
  * Abstract base class that all `vari_value` and it's derived classes inherit.
  *
@@ -45,7 +54,12 @@ class vari_base {
    * @return Pointer to allocated bytes.
    */
   static inline void* operator new(size_t nbytes) noexcept {
-    return ChainableStack::instance_->memalloc_.alloc(nbytes);
+    void* ptr = ChainableStack::instance_->memalloc_.alloc(nbytes);
+    if (unlikely(ChainableStack::instance_->tape_statistics_ != nullptr)) {
+      ChainableStack::instance_->tape_statistics_->record_allocation(ptr,
+                                                                     nbytes);
+    }
+    return ptr;
   }
 
   /**
@@ -131,6 +145,18 @@ class vari_value<T, require_t<std::is_floating_point<T>>> : public vari_base {
     }
   }
 
+  /**
+   * Construct a variable implementation from a value which is put on
+   * neither the var_stack nor the nochain stack. Whoever constructs it
+   * is responsible for propagating its adjoint and setting it to zero;
+   * see `internal::compact_tape_range`.
+   *
+   * @tparam S a floating point type.
+   * @param x Value of the constructed variable.
+   */
+  template <typename S, require_convertible_t<S&, T>* = nullptr>
+  vari_value(S x, internal::unstacked_t) noexcept : val_(x) {}
+
   /**
    * Return a constant reference to the value of this vari.
    *
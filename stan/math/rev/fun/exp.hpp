@@ -39,9 +39,14 @@ namespace math {
  * @return Exponentiated variable.
  */
 inline var exp(const var& a) {
+#ifdef STAN_COMPACT_TAPE
+  const double val = std::exp(a.val());
+  return internal::compact_unary(internal::compact_op::exp, val, a.vi_, val);
+#else
   return make_callback_var(std::exp(a.val()), [a](auto& vi) mutable {
     a.adj() += vi.adj() * vi.val();
   });
+#endif
 }
 
 /**
@@ -45,9 +45,14 @@ namespace math {
  * @return Natural log of variable.
  */
 inline var log(const var& a) {
+#ifdef STAN_COMPACT_TAPE
+  return internal::compact_unary(internal::compact_op::log, std::log(a.val()),
+                                 a.vi_, 1.0 / a.val());
+#else
   return make_callback_var(std::log(a.val()), [a](auto& vi) mutable {
     a.adj() += vi.adj() / a.val();
   });
+#endif
 }
 
 /**
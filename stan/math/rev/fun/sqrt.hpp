@@ -42,9 +42,15 @@ namespace math {
  * @return Square root of variable.
  */
 inline var sqrt(const var& a) {
+#ifdef STAN_COMPACT_TAPE
+  const double val = std::sqrt(a.val());
+  return internal::compact_unary(internal::compact_op::sqrt, val, a.vi_,
+                                 0.5 / val);
+#else
   return make_callback_var(std::sqrt(a.val()), [a](auto& vi) mutable {
     a.adj() += vi.adj() / (2.0 * vi.val());
   });
+#endif
 }
 
 /**
@@ -33,9 +33,14 @@ namespace math {
  * @return Square of variable.
  */
 inline var square(const var& x) {
+#ifdef STAN_COMPACT_TAPE
+  return internal::compact_unary(internal::compact_op::square,
+                                 square(x.val()), x.vi_, 2.0 * x.val());
+#else
   return make_callback_var(square(x.val()), [x](auto& vi) mutable {
     x.adj() += vi.adj() * 2.0 * x.val();
   });
+#endif
 }
 
 /**
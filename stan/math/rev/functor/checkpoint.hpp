@@ -0,0 +1,113 @@
+#ifndef STAN_MATH_REV_FUNCTOR_CHECKPOINT_HPP
+#define STAN_MATH_REV_FUNCTOR_CHECKPOINT_HPP
+
+#include <stan/math/rev/meta.hpp>
+#include <stan/math/rev/core.hpp>
+#include <stan/math/prim/fun/eval.hpp>
+#include <stan/math/prim/fun/promote_scalar.hpp>
+#include <stan/math/prim/fun/value_of.hpp>
+#include <stan/math/prim/functor/apply.hpp>
+#include <stan/math/prim/functor/checkpoint.hpp>
+#include <algorithm>
+#include <ostream>
+#include <tuple>
+
+namespace stan {
+namespace math {
+
+/**
+ * Return the result of applying the function to the arguments, storing
+ * only the arguments on the AD tape and recomputing the function in
+ * the reverse pass.
+ *
+ * In the forward pass the function is evaluated on the values of the
+ * arguments, so nothing is recorded for it on the AD tape apart from
+ * its result and a single callback. When the reverse pass reaches the
+ * callback, the function is evaluated again on copies of the
+ * arguments in a nested autodiff scope, the adjoints of the result are
+ * propagated through this local tape to the arguments and the local
+ * tape is freed. Wrapping a long loop body, or any segment of a long
+ * computation, in a checkpoint therefore trades one extra evaluation
+ * of the segment for keeping its intermediate varis out of the AD tape
+ * until `grad()`.
+ *
+ * The function must have the signature
+ *
+ * <code>
+ * T f(std::ostream* msgs, const Args&... args)
+ * </code>
+ *
+ * and must accept both the arguments and their values (it is
+ * typically templated over the scalar types of its arguments). It
+ * must be deterministic, since its tape is recorded twice. The result
+ * may be a scalar, an Eigen type or a `std::vector`. The arguments
+ * may be any types supported by `count_vars()` and `deep_copy_vars()`.
+ *
+ * The function and the arguments are copied; the copies are freed
+ * when the memory of the AD tape is recovered.
+ *
+ * @tparam F Type of function
+ * @tparam Args Types of arguments
+ * @param f Function
+ * @param[in, out] msgs the print stream for warning messages
+ * @param args arguments to pass to f
+ * @return `f(msgs, args...)`
+ */
+template <typename F, typename... Args,
+          require_any_st_var<Args...>* = nullptr>
+inline auto checkpoint(const F& f, std::ostream* msgs, const Args&... args) {
+  using f_args_t = std::tuple<F, plain_type_t<Args>...>;
+  f_args_t* f_args = make_chainable_ptr(f_args_t(f, args...));
+
+  auto val = eval(f(msgs, eval(value_of(args))...));
+  promote_scalar_t<var, plain_type_t<decltype(val)>> res
+      = promote_scalar<var>(val);
+
+  const size_t num_res_vars = count_vars(res);
+  vari** res_varis
+      = ChainableStack::instance_->memalloc_.alloc_array<vari*>(num_res_vars);
+  save_varis(res_varis, res);
+
+  const size_t num_arg_vars = count_vars(args...);
+  vari** arg_varis
+      = ChainableStack::instance_->memalloc_.alloc_array<vari*>(num_arg_vars);
+  save_varis(arg_varis, args...);
+
+  reverse_pass_callback([f_args, msgs, res_varis, num_res_vars, arg_varis,
+                         num_arg_vars]() {
+    const nested_rev_autodiff nested;
+
+    auto local_args = apply(
+        [](const auto& /* f */, const auto&... args) {
+          return std::make_tuple(deep_copy_vars(args)...);
+        },
+        *f_args);
+    auto local_res = apply(
+        [&](const auto&... args) {
+          return std::get<0>(*f_args)(msgs, args...);
+        },
+        local_args);
+
+    vari** local_varis
+        = ChainableStack::instance_->memalloc_.alloc_array<vari*>(
+            std::max(num_res_vars, num_arg_vars));
+    save_varis(local_varis, local_res);
+    for (size_t i = 0; i < num_res_vars; ++i) {
+      local_varis[i]->adj_ += res_varis[i]->adj_;
+    }
+    grad();
+
+    apply([&](const auto&... args) { save_varis(local_varis, args...); },
+          local_args);
+    for (size_t i = 0; i < num_arg_vars; ++i) {
+      arg_varis[i]->adj_ += local_varis[i]->adj_;
+    }
+  });
+
+  return res;
+}
+
+}  // namespace math
+}  // namespace stan
+
+#endif
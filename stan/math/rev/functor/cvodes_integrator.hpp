@@ -2,20 +2,117 @@
 #define STAN_MATH_REV_FUNCTOR_INTEGRATE_ODE_CVODES_HPP
 
 #include <stan/math/rev/meta.hpp>
+#include <stan/math/rev/functor/cvodes_linear_solver.hpp>
 #include <stan/math/rev/functor/cvodes_utils.hpp>
 #include <stan/math/rev/functor/coupled_ode_system.hpp>
+#include <stan/math/rev/functor/jacobian.hpp>
 #include <stan/math/rev/functor/ode_store_sensitivities.hpp>
+#include <stan/math/rev/functor/sparse_jacobian.hpp>
+#include <stan/math/rev/functor/sundials_workspace_cache.hpp>
 #include <stan/math/prim/err.hpp>
 #include <stan/math/prim/fun/value_of.hpp>
 #include <cvodes/cvodes.h>
 #include <nvector/nvector_serial.h>
+#include <sunlinsol/sunlinsol_band.h>
 #include <sunlinsol/sunlinsol_dense.h>
+#include <sunlinsol/sunlinsol_spbcgs.h>
+#include <sunlinsol/sunlinsol_spgmr.h>
+#include <sunmatrix/sunmatrix_band.h>
+#include <sunmatrix/sunmatrix_sparse.h>
 #include <algorithm>
+#include <memory>
 #include <ostream>
+#include <tuple>
 #include <vector>
 
 namespace stan {
 namespace math {
+namespace internal {
+
+/**
+ * Workspace of a CVODES solve: the CVODES memory, the state and
+ * sensitivity vectors, whose data are the coupled state of the
+ * integrator using it, and the matrix and linear solver of the Newton
+ * iterations.
+ *
+ * The key is the method, the number of states, the number of
+ * sensitivities and the right hand side, which CVODES keeps from its
+ * initialization, so that a workspace is only reused by the
+ * integrators of the same ODE, which set the other callbacks the same
+ * way. A reused workspace is reinitialized with `CVodeReInit()` and
+ * `CVodeSensReInit()`.
+ *
+ * The user data of CVODES is the workspace, which points to the
+ * integrator using it, since CVODES copies the user data of the
+ * sensitivity right hand side at its initialization.
+ */
+struct cvodes_workspace {
+  using key_type = std::tuple<int, size_t, size_t, CVRhsFn>;
+
+  key_type key_;
+  void* mem_;
+  N_Vector nv_state_;
+  N_Vector* nv_state_sens_;
+  SUNMatrix A_;
+  SUNLinearSolver LS_;
+  bool initialized_;
+  /// integrator using the workspace, the user data of the callbacks
+  void* integrator_;
+
+  explicit cvodes_workspace(const key_type& key)
+      : key_(key),
+        mem_(CVodeCreate(std::get<0>(key))),
+        nv_state_(N_VNewEmpty_Serial(std::get<1>(key))),
+        nv_state_sens_(nullptr),
+        A_(nullptr),
+        LS_(nullptr),
+        initialized_(false),
+        integrator_(nullptr) {
+    if (mem_ == nullptr) {
+      N_VDestroy_Serial(nv_state_);
+      throw std::runtime_error("CVodeCreate failed to allocate memory");
+    }
+    CVodeSetUserData(mem_, this);
+    if (num_sens() > 0) {
+      nv_state_sens_ = N_VCloneVectorArrayEmpty_Serial(num_sens(), nv_state_);
+    }
+  }
+
+  ~cvodes_workspace() {
+    if (LS_ != nullptr) {
+      SUNLinSolFree(LS_);
+    }
+    if (A_ != nullptr) {
+      SUNMatDestroy(A_);
+    }
+    if (nv_state_sens_ != nullptr) {
+      N_VDestroyVectorArray_Serial(nv_state_sens_, num_sens());
+    }
+    N_VDestroy_Serial(nv_state_);
+    CVodeFree(&mem_);
+  }
+
+  cvodes_workspace(const cvodes_workspace&) = delete;
+  cvodes_workspace& operator=(const cvodes_workspace&) = delete;
+
+  const key_type& key() const { return key_; }
+
+  int num_sens() const { return std::get<2>(key_); }
+
+  /**
+   * Point the state and sensitivity vectors to the specified coupled
+   * state, the state followed by the sensitivities.
+   */
+  void set_coupled_state(std::vector<double>& coupled_state) {
+    const size_t N = std::get<1>(key_);
+    NV_DATA_S(nv_state_) = coupled_state.data();
+    for (int i = 0; i < num_sens(); ++i) {
+      NV_DATA_S(nv_state_sens_[i]) = coupled_state.data() + (i + 1) * N;
+    }
+  }
+};
+
+}  // namespace internal
 
 /**
  * Integrator interface for CVODES' ODE solvers (Adams & BDF
@@ -47,6 +144,15 @@ class cvodes_integrator {
   double relative_tolerance_;
   double absolute_tolerance_;
   long int max_num_steps_;  // NOLINT(runtime/int)
+  ode_linear_solver linear_solver_;
+  int upper_bandwidth_;
+  int lower_bandwidth_;
+  int max_krylov_dimension_;
+  Eigen::SparseMatrix<double> jacobian_pattern_;
+  Eigen::SparseMatrix<double> jacobian_;
+  double jacobian_t_{0};
+  Eigen::VectorXd jacobian_y_;
+  Eigen::VectorXd jacobian_diagonal_;
 
   const size_t num_y0_vars_;
   const size_t num_args_vars_;
@@ -54,17 +160,22 @@ class cvodes_integrator {
   coupled_ode_system<F, T_y0_t0, T_Args...> coupled_ode_;
 
   std::vector<double> coupled_state_;
-  N_Vector nv_state_;
-  N_Vector* nv_state_sens_;
-  SUNMatrix A_;
-  SUNLinearSolver LS_;
+
+  /**
+   * Return the integrator of the user data of the CVODES callbacks,
+   * which is its workspace.
+   */
+  static cvodes_integrator* of(void* user_data) {
+    return static_cast<cvodes_integrator*>(
+        static_cast<internal::cvodes_workspace*>(user_data)->integrator_);
+  }
 
   /**
    * Implements the function of type CVRhsFn which is the user-defined
    * ODE RHS passed to CVODES.
    */
   static int cv_rhs(realtype t, N_Vector y, N_Vector ydot, void* user_data) {
-    cvodes_integrator* integrator = static_cast<cvodes_integrator*>(user_data);
+    cvodes_integrator* integrator = of(user_data);
     integrator->rhs(t, NV_DATA_S(y), NV_DATA_S(ydot));
     return 0;
   }
@@ -76,7 +187,7 @@ class cvodes_integrator {
   static int cv_rhs_sens(int Ns, realtype t, N_Vector y, N_Vector ydot,
                          N_Vector* yS, N_Vector* ySdot, void* user_data,
                          N_Vector tmp1, N_Vector tmp2) {
-    cvodes_integrator* integrator = static_cast<cvodes_integrator*>(user_data);
+    cvodes_integrator* integrator = of(user_data);
     integrator->rhs_sens(t, NV_DATA_S(y), yS, ySdot);
     return 0;
   }
@@ -90,11 +201,73 @@ class cvodes_integrator {
   static int cv_jacobian_states(realtype t, N_Vector y, N_Vector fy,
                                 SUNMatrix J, void* user_data, N_Vector tmp1,
                                 N_Vector tmp2, N_Vector tmp3) {
-    cvodes_integrator* integrator = static_cast<cvodes_integrator*>(user_data);
+    cvodes_integrator* integrator = of(user_data);
     integrator->jacobian_states(t, NV_DATA_S(y), J);
     return 0;
   }
 
+  /**
+   * Implements the function of type CVLsPrecSetupFn which is the
+   * setup of the Jacobi preconditioner of the iterative linear solvers,
+   * the diagonal of the jacobian of the ode_rhs wrt to the states y,
+   * which is updated unless CVODES allows to reuse the last one.
+   */
+  static int cv_preconditioner_setup(realtype t, N_Vector y, N_Vector fy,
+                                     booleantype jok, booleantype* jcur,
+                                     realtype gamma, void* user_data) {
+    cvodes_integrator* integrator = of(user_data);
+    if (jok) {
+      *jcur = SUNFALSE;
+    } else {
+      integrator->update_jacobian(t, NV_DATA_S(y));
+      integrator->jacobian_diagonal_ = integrator->jacobian_.diagonal();
+      *jcur = SUNTRUE;
+    }
+    return 0;
+  }
+
+  /**
+   * Implements the function of type CVLsPrecSolveFn which solves with
+   * the diagonal of the Newton matrix I - gamma J.
+   */
+  static int cv_preconditioner_solve(realtype t, N_Vector y, N_Vector fy,
+                                     N_Vector r, N_Vector z, realtype gamma,
+                                     realtype delta, int lr, void* user_data) {
+    cvodes_integrator* integrator = of(user_data);
+    const size_t N = integrator->N_;
+    Eigen::Map<Eigen::VectorXd>(NV_DATA_S(z), N)
+        = Eigen::Map<const Eigen::VectorXd>(NV_DATA_S(r), N).array()
+          / (1.0 - gamma * integrator->jacobian_diagonal_.array());
+    return 0;
+  }
+
+  /**
+   * Implements the function of type CVLsJacTimesSetupFn which is called
+   * by the iterative linear solvers before every solve, at its state,
+   * where the jacobian of the ode_rhs wrt to the states y is updated.
+   */
+  static int cv_jacobian_times_setup(realtype t, N_Vector y, N_Vector fy,
+                                     void* user_data) {
+    of(user_data)->update_jacobian(t, NV_DATA_S(y));
+    return 0;
+  }
+
+  /**
+   * Implements the function of type CVLsJacTimesVecFn which is the
+   * product of the jacobian of the ode_rhs wrt to the states y with a
+   * vector, using the jacobian of the last setup.
+   */
+  static int cv_jacobian_times_vector(N_Vector v, N_Vector Jv, realtype t,
+                                      N_Vector y, N_Vector fy, void* user_data,
+                                      N_Vector tmp) {
+    cvodes_integrator* integrator = of(user_data);
+    const size_t N = integrator->N_;
+    Eigen::Map<Eigen::VectorXd>(NV_DATA_S(Jv), N)
+        = integrator->jacobian_
+          * Eigen::Map<const Eigen::VectorXd>(NV_DATA_S(v), N);
+    return 0;
+  }
+
   /**
    * Calculates the ODE RHS, dy_dt, using the user-supplied functor at
    * the given time t and state y.
@@ -114,9 +287,31 @@ class cvodes_integrator {
 
   /**
    * Calculates the jacobian of the ODE RHS wrt to its states y at the
-   * given time-point t and state y.
+   * given time-point t and state y into the matrix of the direct linear
+   * solver.
    */
   inline void jacobian_states(double t, const double y[], SUNMatrix J) const {
+    if (linear_solver_ != ode_linear_solver::dense) {
+      const Eigen::SparseMatrix<double> Jfy = sparse_jacobian_states(t, y);
+      if (linear_solver_ == ode_linear_solver::banded) {
+        for (int j = 0; j < Jfy.outerSize(); ++j) {
+          for (Eigen::SparseMatrix<double>::InnerIterator it(Jfy, j); it;
+               ++it) {
+            SM_ELEMENT_B(J, it.row(), j) = it.value();
+          }
+        }
+      } else {
+        // the structure is cleared by CVODES before every evaluation
+        std::copy(Jfy.outerIndexPtr(), Jfy.outerIndexPtr() + N_ + 1,
+                  SM_INDEXPTRS_S(J));
+        std::copy(Jfy.innerIndexPtr(), Jfy.innerIndexPtr() + Jfy.nonZeros(),
+                  SM_INDEXVALS_S(J));
+        std::copy(Jfy.valuePtr(), Jfy.valuePtr() + Jfy.nonZeros(),
+                  SM_DATA_S(J));
+      }
+      return;
+    }
+
     Eigen::VectorXd fy;
     Eigen::MatrixXd Jfy;
 
@@ -134,6 +329,57 @@ class cvodes_integrator {
     }
   }
 
+  /**
+   * Calculates the jacobian of the ODE RHS wrt to its states y at the
+   * given time-point t and state y for the iterative linear solvers,
+   * unless it was last calculated at the same time-point and state.
+   */
+  inline void update_jacobian(double t, const double y[]) {
+    const Eigen::Map<const Eigen::VectorXd> y_vec(y, N_);
+    if (jacobian_y_.size() == static_cast<Eigen::Index>(N_)
+        && t == jacobian_t_ && y_vec == jacobian_y_) {
+      return;
+    }
+    jacobian_ = sparse_jacobian_states(t, y);
+    jacobian_t_ = t;
+    jacobian_y_ = y_vec;
+  }
+
+  /**
+   * Calculates the jacobian of the ODE RHS wrt to its states y at the
+   * given time-point t and state y, with the nonzeros of the sparsity
+   * pattern of the linear solver, by one reverse sweep per color of its
+   * rows (see `sparse_jacobian()`).
+   */
+  inline Eigen::SparseMatrix<double> sparse_jacobian_states(
+      double t, const double y[]) const {
+    Eigen::VectorXd fy;
+    Eigen::SparseMatrix<double> Jfy;
+
+    auto f_wrapped = [&](const Eigen::Matrix<var, Eigen::Dynamic, 1>& y) {
+      return apply([&](auto&&... args) { return f_(t, y, msgs_, args...); },
+                   value_of_args_tuple_);
+    };
+
+    if (jacobian_pattern_.nonZeros() < N_ * N_) {
+      sparse_jacobian(f_wrapped, Eigen::Map<const Eigen::VectorXd>(y, N_),
+                      jacobian_pattern_, fy, Jfy);
+      return Jfy;
+    }
+
+    // coloring a dense pattern would only cost time
+    Eigen::MatrixXd Jfy_dense;
+    jacobian(f_wrapped, Eigen::Map<const Eigen::VectorXd>(y, N_), fy,
+             Jfy_dense);
+    Jfy = jacobian_pattern_;
+    for (int j = 0; j < Jfy.outerSize(); ++j) {
+      for (Eigen::SparseMatrix<double>::InnerIterator it(Jfy, j); it; ++it) {
+        it.valueRef() = Jfy_dense(it.row(), j);
+      }
+    }
+    return Jfy;
+  }
+
   /**
    * Calculates the RHS of the sensitivity ODE system which
    * corresponds to the coupled ode system from which the first N
@@ -189,6 +435,37 @@ class cvodes_integrator {
                     double relative_tolerance, double absolute_tolerance,
                     long int max_num_steps,  // NOLINT(runtime/int)
                     std::ostream* msgs, const T_Args&... args)
+      : cvodes_integrator(function_name, f, y0, t0, ts,
+                          ode_bdf_control{relative_tolerance,
+                                          absolute_tolerance, max_num_steps},
+                          msgs, args...) {}
+
+  /**
+   * Construct cvodes_integrator object with the specified options,
+   * including the linear solver of the Newton iterations.
+   *
+   * @param function_name Calling function name (for printing debugging
+   * messages)
+   * @param f Right hand side of the ODE
+   * @param y0 Initial state
+   * @param t0 Initial time
+   * @param ts Times at which to solve the ODE at. All values must be sorted and
+   *   not less than t0.
+   * @param control Tolerances, maximum number of steps and linear solver
+   * @param[in, out] msgs the print stream for warning messages
+   * @param args Extra arguments passed unmodified through to ODE right hand
+   * side function
+   * @throw <code>std::domain_error</code> if y0, t0, ts, theta, x are not
+   *   finite, all elements of ts are not greater than t0, or ts is not
+   *   sorted in strictly increasing order.
+   * @throw <code>std::invalid_argument</code> if arguments are the wrong
+   *   size or the options are out of range.
+   */
+  template <require_eigen_col_vector_t<T_y0>* = nullptr>
+  cvodes_integrator(const char* function_name, const F& f, const T_y0& y0,
+                    const T_t0& t0, const std::vector<T_ts>& ts,
+                    const ode_bdf_control& control, std::ostream* msgs,
+                    const T_Args&... args)
       : function_name_(function_name),
         f_(f),
         y0_(y0.template cast<T_y0_t0>()),
@@ -198,9 +475,13 @@ class cvodes_integrator {
         value_of_args_tuple_(value_of(args)...),
         N_(y0.size()),
         msgs_(msgs),
-        relative_tolerance_(relative_tolerance),
-        absolute_tolerance_(absolute_tolerance),
-        max_num_steps_(max_num_steps),
+        relative_tolerance_(control.relative_tolerance),
+        absolute_tolerance_(control.absolute_tolerance),
+        max_num_steps_(control.max_num_steps),
+        linear_solver_(control.linear_solver),
+        upper_bandwidth_(control.upper_bandwidth),
+        lower_bandwidth_(control.lower_bandwidth),
+        max_krylov_dimension_(control.max_krylov_dimension),
         num_y0_vars_(count_vars(y0_)),
         num_args_vars_(count_vars(args...)),
         coupled_ode_(f, y0_, msgs, args...),
@@ -228,28 +509,10 @@ class cvodes_integrator {
     check_positive_finite(function_name, "absolute_tolerance",
                           absolute_tolerance_);
     check_positive(function_name, "max_num_steps", max_num_steps_);
+    internal::check_ode_linear_solver(function_name, control, N_);
 
-    nv_state_ = N_VMake_Serial(N_, &coupled_state_[0]);
-    nv_state_sens_ = nullptr;
-    A_ = SUNDenseMatrix(N_, N_);
-    LS_ = SUNDenseLinearSolver(nv_state_, A_);
-
-    if (num_y0_vars_ + num_args_vars_ > 0) {
-      nv_state_sens_ = N_VCloneVectorArrayEmpty_Serial(
-          num_y0_vars_ + num_args_vars_, nv_state_);
-      for (std::size_t i = 0; i < num_y0_vars_ + num_args_vars_; i++) {
-        NV_DATA_S(nv_state_sens_[i]) = &coupled_state_[N_] + i * N_;
-      }
-    }
-  }
-
-  ~cvodes_integrator() {
-    SUNLinSolFree(LS_);
-    SUNMatDestroy(A_);
-    N_VDestroy_Serial(nv_state_);
-    if (num_y0_vars_ + num_args_vars_ > 0) {
-      N_VDestroyVectorArray_Serial(nv_state_sens_,
-                                   num_y0_vars_ + num_args_vars_);
+    if (linear_solver_ != ode_linear_solver::dense) {
+      jacobian_pattern_ = internal::ode_jacobian_pattern(control, N_);
     }
   }
 
@@ -262,87 +525,158 @@ class cvodes_integrator {
    *   solution time (excluding the initial state)
    */
   std::vector<Eigen::Matrix<T_Return, Eigen::Dynamic, 1>> operator()() {
+    using workspace_cache
+        = internal::sundials_workspace_cache<internal::cvodes_workspace>;
     std::vector<Eigen::Matrix<T_Return, Eigen::Dynamic, 1>> y;
 
-    void* cvodes_mem = CVodeCreate(Lmm);
-    if (cvodes_mem == nullptr) {
-      throw std::runtime_error("CVodeCreate failed to allocate memory");
+    // the dense solves of small systems are the ones whose setup costs
+    // matter, and the only ones whose workspace is cached
+    const internal::cvodes_workspace::key_type key(
+        Lmm, N_, num_y0_vars_ + num_args_vars_, &cvodes_integrator::cv_rhs);
+    std::unique_ptr<internal::cvodes_workspace> workspace
+        = linear_solver_ == ode_linear_solver::dense
+              ? workspace_cache::acquire(key)
+              : std::make_unique<internal::cvodes_workspace>(key);
+    void* cvodes_mem = workspace->mem_;
+    N_Vector nv_state = workspace->nv_state_;
+    N_Vector* nv_state_sens = workspace->nv_state_sens_;
+    workspace->set_coupled_state(coupled_state_);
+    workspace->integrator_ = this;
+
+    if (!workspace->initialized_) {
+      initialize(*workspace);
+    } else {
+      check_flag_sundials(CVodeReInit(cvodes_mem, value_of(t0_), nv_state),
+                          "CVodeReInit");
+      if (num_y0_vars_ + num_args_vars_ > 0) {
+        check_flag_sundials(
+            CVodeSensReInit(cvodes_mem, CV_STAGGERED, nv_state_sens),
+            "CVodeSensReInit");
+      }
     }
 
-    try {
-      check_flag_sundials(CVodeInit(cvodes_mem, &cvodes_integrator::cv_rhs,
-                                    value_of(t0_), nv_state_),
-                          "CVodeInit");
+    cvodes_set_options(cvodes_mem, relative_tolerance_, absolute_tolerance_,
+                       max_num_steps_);
 
-      // Assign pointer to this as user data
-      check_flag_sundials(
-          CVodeSetUserData(cvodes_mem, reinterpret_cast<void*>(this)),
-          "CVodeSetUserData");
+    if (num_y0_vars_ + num_args_vars_ > 0) {
+      check_flag_sundials(CVodeSetSensErrCon(cvodes_mem, SUNTRUE),
+                          "CVodeSetSensErrCon");
 
-      cvodes_set_options(cvodes_mem, relative_tolerance_, absolute_tolerance_,
-                         max_num_steps_);
+      check_flag_sundials(CVodeSensEEtolerances(cvodes_mem),
+                          "CVodeSensEEtolerances");
+    }
 
-      check_flag_sundials(CVodeSetLinearSolver(cvodes_mem, LS_, A_),
-                          "CVodeSetLinearSolver");
-      check_flag_sundials(
-          CVodeSetJacFn(cvodes_mem, &cvodes_integrator::cv_jacobian_states),
-          "CVodeSetJacFn");
+    double t_init = value_of(t0_);
+    for (size_t n = 0; n < ts_.size(); ++n) {
+      double t_final = value_of(ts_[n]);
 
-      // initialize forward sensitivity system of CVODES as needed
-      if (num_y0_vars_ + num_args_vars_ > 0) {
-        check_flag_sundials(
-            CVodeSensInit(
-                cvodes_mem, static_cast<int>(num_y0_vars_ + num_args_vars_),
-                CV_STAGGERED, &cvodes_integrator::cv_rhs_sens, nv_state_sens_),
-            "CVodeSensInit");
+      if (t_final != t_init) {
+        int error_code
+            = CVode(cvodes_mem, t_final, nv_state, &t_init, CV_NORMAL);
 
-        check_flag_sundials(CVodeSetSensErrCon(cvodes_mem, SUNTRUE),
-                            "CVodeSetSensErrCon");
+        if (error_code == CV_TOO_MUCH_WORK) {
+          throw_domain_error(function_name_, "", t_final,
+                             "Failed to integrate to next output time (",
+                             ") in less than max_num_steps steps");
+        } else {
+          check_flag_sundials(error_code, "CVode");
+        }
 
-        check_flag_sundials(CVodeSensEEtolerances(cvodes_mem),
-                            "CVodeSensEEtolerances");
+        if (num_y0_vars_ + num_args_vars_ > 0) {
+          check_flag_sundials(
+              CVodeGetSens(cvodes_mem, &t_init, nv_state_sens),
+              "CVodeGetSens");
+        }
       }
 
-      double t_init = value_of(t0_);
-      for (size_t n = 0; n < ts_.size(); ++n) {
-        double t_final = value_of(ts_[n]);
+      y.emplace_back(apply(
+          [&](auto&&... args) {
+            return ode_store_sensitivities(f_, coupled_state_, y0_, t0_,
+                                           ts_[n], msgs_, args...);
+          },
+          args_tuple_));
 
-        if (t_final != t_init) {
-          int error_code
-              = CVode(cvodes_mem, t_final, nv_state_, &t_init, CV_NORMAL);
-
-          if (error_code == CV_TOO_MUCH_WORK) {
-            throw_domain_error(function_name_, "", t_final,
-                               "Failed to integrate to next output time (",
-                               ") in less than max_num_steps steps");
-          } else {
-            check_flag_sundials(error_code, "CVode");
-          }
+      t_init = t_final;
+    }
 
-          if (num_y0_vars_ + num_args_vars_ > 0) {
-            check_flag_sundials(
-                CVodeGetSens(cvodes_mem, &t_init, nv_state_sens_),
-                "CVodeGetSens");
-          }
-        }
+    // a workspace is only reused after a successful solve, otherwise
+    // it is freed on the way out
+    if (linear_solver_ == ode_linear_solver::dense) {
+      workspace_cache::release(std::move(workspace));
+    }
 
-        y.emplace_back(apply(
-            [&](auto&&... args) {
-              return ode_store_sensitivities(f_, coupled_state_, y0_, t0_,
-                                             ts_[n], msgs_, args...);
-            },
-            args_tuple_));
+    return y;
+  }
 
-        t_init = t_final;
-      }
-    } catch (const std::exception& e) {
-      CVodeFree(&cvodes_mem);
-      throw;
+ private:
+  /**
+   * Initialize a new workspace: the CVODES memory, the linear solver of
+   * the Newton iterations and its callbacks, and the forward
+   * sensitivity system as needed.
+   *
+   * @param workspace workspace, whose vectors point to the coupled
+   * state
+   */
+  void initialize(internal::cvodes_workspace& workspace) {
+    void* cvodes_mem = workspace.mem_;
+    check_flag_sundials(CVodeInit(cvodes_mem, &cvodes_integrator::cv_rhs,
+                                  value_of(t0_), workspace.nv_state_),
+                        "CVodeInit");
+
+    switch (linear_solver_) {
+      case ode_linear_solver::dense:
+        workspace.A_ = SUNDenseMatrix(N_, N_);
+        workspace.LS_ = SUNDenseLinearSolver(workspace.nv_state_, workspace.A_);
+        break;
+      case ode_linear_solver::banded:
+        workspace.A_ = SUNBandMatrix(N_, upper_bandwidth_, lower_bandwidth_);
+        workspace.LS_ = SUNLinSol_Band(workspace.nv_state_, workspace.A_);
+        break;
+      case ode_linear_solver::sparse:
+        workspace.A_
+            = SUNSparseMatrix(N_, N_, jacobian_pattern_.nonZeros(), CSC_MAT);
+        workspace.LS_ = internal::eigen_sparse_lu_linear_solver();
+        break;
+      case ode_linear_solver::spgmr:
+        workspace.LS_ = SUNLinSol_SPGMR(workspace.nv_state_, PREC_LEFT,
+                                        max_krylov_dimension_);
+        break;
+      case ode_linear_solver::spbcgs:
+        workspace.LS_ = SUNLinSol_SPBCGS(
+            workspace.nv_state_, PREC_LEFT, max_krylov_dimension_);
+        break;
     }
 
-    CVodeFree(&cvodes_mem);
+    check_flag_sundials(
+        CVodeSetLinearSolver(cvodes_mem, workspace.LS_, workspace.A_),
+        "CVodeSetLinearSolver");
+    if (workspace.A_ != nullptr) {
+      check_flag_sundials(
+          CVodeSetJacFn(cvodes_mem, &cvodes_integrator::cv_jacobian_states),
+          "CVodeSetJacFn");
+    } else {
+      check_flag_sundials(
+          CVodeSetPreconditioner(cvodes_mem,
+                                 &cvodes_integrator::cv_preconditioner_setup,
+                                 &cvodes_integrator::cv_preconditioner_solve),
+          "CVodeSetPreconditioner");
+      check_flag_sundials(
+          CVodeSetJacTimes(cvodes_mem,
+                           &cvodes_integrator::cv_jacobian_times_setup,
+                           &cvodes_integrator::cv_jacobian_times_vector),
+          "CVodeSetJacTimes");
+    }
 
-    return y;
+    // initialize forward sensitivity system of CVODES as needed
+    if (num_y0_vars_ + num_args_vars_ > 0) {
+      check_flag_sundials(
+          CVodeSensInit(cvodes_mem,
+                        static_cast<int>(num_y0_vars_ + num_args_vars_),
+                        CV_STAGGERED, &cvodes_integrator::cv_rhs_sens,
+                        workspace.nv_state_sens_),
+          "CVodeSensInit");
+    }
+    workspace.initialized_ = true;
   }
 };  // cvodes integrator
 
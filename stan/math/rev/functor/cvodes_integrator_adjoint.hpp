@@ -0,0 +1,684 @@
+#ifndef STAN_MATH_REV_FUNCTOR_CVODES_INTEGRATOR_ADJOINT_HPP
+#define STAN_MATH_REV_FUNCTOR_CVODES_INTEGRATOR_ADJOINT_HPP
+
+#include <stan/math/rev/meta.hpp>
+#include <stan/math/rev/core.hpp>
+#include <stan/math/rev/core/reverse_pass_callback.hpp>
+#include <stan/math/rev/functor/cvodes_utils.hpp>
+#include <stan/math/rev/functor/jacobian.hpp>
+#include <stan/math/prim/err.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <stan/math/prim/fun/value_of.hpp>
+#include <stan/math/prim/functor/apply.hpp>
+#include <cvodes/cvodes.h>
+#include <nvector/nvector_serial.h>
+#include <sunlinsol/sunlinsol_dense.h>
+#include <cstring>
+#include <ostream>
+#include <tuple>
+#include <vector>
+
+namespace stan {
+namespace math {
+
+/**
+ * Integrator interface for the adjoint sensitivity method of CVODES
+ * (CVODEA).
+ *
+ * The forward solve integrates only the N states of the ODE and stores
+ * checkpoints of the solution every `num_steps_between_checkpoints`
+ * steps. The sensitivities are computed in the reverse pass of
+ * autodiff, registered with `reverse_pass_callback()`: the adjoint
+ * states (the N adjoints of the states) are integrated backwards from
+ * the last to the first output time, adding the adjoints of the
+ * outputs at every output time, and the M adjoints of the parameters
+ * are integrated alongside as quadratures. Both right hand sides are
+ * vector-Jacobian products, computed by one reverse sweep of a nested
+ * tape, so that the cost of the gradient grows like N + M instead of
+ * the N * (N + M) states of the forward sensitivity system of
+ * `cvodes_integrator`.
+ *
+ * The object owns the memory of CVODES, which must outlive the forward
+ * pass, and is therefore allocated as a `chainable_alloc` and freed by
+ * `recover_memory()`. If no argument is a `var`, the memory of CVODES is
+ * freed as soon as the forward solve is done.
+ *
+ * @tparam F Type of ODE right hand side
+ * @tparam T_y0 Type of initial state
+ * @tparam T_t0 Type of scalar of initial time point
+ * @tparam T_ts Type of time-points where ODE solution is returned
+ * @tparam T_Args Types of pass-through parameters
+ */
+template <typename F, typename T_y0, typename T_t0, typename T_ts,
+          typename... T_Args>
+class cvodes_integrator_adjoint : public chainable_alloc {
+  using T_Return = return_type_t<T_y0, T_t0, T_ts, T_Args...>;
+
+  const char* function_name_;
+  const F f_;
+  const size_t N_;
+  const Eigen::VectorXd y0_;
+  const double t0_;
+  const std::vector<double> ts_;
+  std::tuple<plain_type_t<decltype(value_of(std::declval<const T_Args&>()))>...>
+      value_of_args_tuple_;
+  std::tuple<std::decay_t<decltype(deep_copy_vars(
+      std::declval<const T_Args&>()))>...>
+      local_args_tuple_;
+  std::ostream* msgs_;
+  double relative_tolerance_forward_;
+  double absolute_tolerance_forward_;
+  double relative_tolerance_backward_;
+  double absolute_tolerance_backward_;
+  double relative_tolerance_quadrature_;
+  double absolute_tolerance_quadrature_;
+  long int max_num_steps_;                  // NOLINT(runtime/int)
+  long int num_steps_between_checkpoints_;  // NOLINT(runtime/int)
+  int interpolation_polynomial_;
+  int solver_forward_;
+  int solver_backward_;
+
+  const size_t num_y0_vars_;
+  const size_t num_args_vars_;
+  const bool is_var_t0_;
+  const bool is_var_ts_;
+  vari** y0_varis_;
+  vari** args_varis_;
+  vari* t0_vari_;
+  vari** ts_varis_;
+
+  std::vector<Eigen::VectorXd> y_;
+  std::vector<vari**> y_return_varis_;
+
+  void* cvodes_mem_;
+  int index_backward_;
+  bool backward_is_initialized_;
+  Eigen::VectorXd state_;
+  Eigen::VectorXd state_backward_;
+  Eigen::VectorXd quad_;
+  N_Vector nv_state_;
+  N_Vector nv_state_backward_;
+  N_Vector nv_quad_;
+  SUNMatrix A_forward_;
+  SUNLinearSolver LS_forward_;
+  SUNMatrix A_backward_;
+  SUNLinearSolver LS_backward_;
+
+  /**
+   * Return true if the adjoints of y0, t0 or the parameters are needed,
+   * which requires the backward solve.
+   */
+  inline bool needs_backward() const {
+    return num_y0_vars_ + num_args_vars_ > 0 || is_var_t0_;
+  }
+
+  /**
+   * Implements the function of type CVRhsFn which is the user-defined
+   * ODE RHS passed to CVODES.
+   */
+  static int cv_rhs(realtype t, N_Vector y, N_Vector ydot, void* user_data) {
+    cvodes_integrator_adjoint* integrator
+        = static_cast<cvodes_integrator_adjoint*>(user_data);
+    integrator->rhs(t, NV_DATA_S(y), NV_DATA_S(ydot));
+    return 0;
+  }
+
+  /**
+   * Implements the function of type CVRhsFnB which is the RHS of the
+   * backward ODE system of the adjoint states.
+   */
+  static int cv_rhs_adj(realtype t, N_Vector y, N_Vector yB, N_Vector yBdot,
+                        void* user_data) {
+    cvodes_integrator_adjoint* integrator
+        = static_cast<cvodes_integrator_adjoint*>(user_data);
+    integrator->rhs_adj(t, NV_DATA_S(y), NV_DATA_S(yB), NV_DATA_S(yBdot));
+    return 0;
+  }
+
+  /**
+   * Implements the function of type CVQuadRhsFnB which is the RHS of
+   * the backward ODE system of the adjoints of the parameters.
+   */
+  static int cv_quad_rhs_adj(realtype t, N_Vector y, N_Vector yB,
+                             N_Vector qBdot, void* user_data) {
+    cvodes_integrator_adjoint* integrator
+        = static_cast<cvodes_integrator_adjoint*>(user_data);
+    integrator->quad_rhs_adj(t, NV_DATA_S(y), NV_DATA_S(yB), NV_DATA_S(qBdot));
+    return 0;
+  }
+
+  /**
+   * Implements the function of type CVLsJacFn which is the
+   * user-defined callback for CVODES to calculate the jacobian of the
+   * ode_rhs wrt to the states y. The jacobian is stored in column
+   * major format.
+   */
+  static int cv_jacobian_states(realtype t, N_Vector y, N_Vector fy,
+                                SUNMatrix J, void* user_data, N_Vector tmp1,
+                                N_Vector tmp2, N_Vector tmp3) {
+    cvodes_integrator_adjoint* integrator
+        = static_cast<cvodes_integrator_adjoint*>(user_data);
+    integrator->jacobian_states(t, NV_DATA_S(y), J, false);
+    return 0;
+  }
+
+  /**
+   * Implements the function of type CVLsJacFnB which is the
+   * user-defined callback for CVODES to calculate the jacobian of the
+   * backward ODE system wrt to the adjoint states, which is the
+   * negative transposed jacobian of the ode_rhs wrt to the states y.
+   */
+  static int cv_jacobian_adj(realtype t, N_Vector y, N_Vector yB,
+                             N_Vector fyB, SUNMatrix J, void* user_data,
+                             N_Vector tmp1, N_Vector tmp2, N_Vector tmp3) {
+    cvodes_integrator_adjoint* integrator
+        = static_cast<cvodes_integrator_adjoint*>(user_data);
+    integrator->jacobian_states(t, NV_DATA_S(y), J, true);
+    return 0;
+  }
+
+  /**
+   * Calculates the ODE RHS, dy_dt, using the user-supplied functor at
+   * the given time t and state y.
+   */
+  inline void rhs(double t, const double y[], double dy_dt[]) const {
+    Eigen::Map<Eigen::VectorXd>(dy_dt, N_)
+        = rhs(t, Eigen::Map<const Eigen::VectorXd>(y, N_));
+  }
+
+  /**
+   * Return the ODE RHS at the given time t and state y.
+   */
+  inline Eigen::VectorXd rhs(double t, const Eigen::VectorXd& y) const {
+    Eigen::VectorXd dy_dt
+        = apply([&](auto&&... args) { return f_(t, y, msgs_, args...); },
+                value_of_args_tuple_);
+    check_size_match(function_name_, "dy_dt", dy_dt.size(), "states", N_);
+    return dy_dt;
+  }
+
+  /**
+   * Calculates the RHS of the adjoint states, -lambda^T J_y, where J_y
+   * is the jacobian of the ODE RHS wrt to the states y, by one reverse
+   * sweep.
+   */
+  inline void rhs_adj(double t, const double y[], const double lambda[],
+                      double dlambda_dt[]) const {
+    // Run nested autodiff in this scope
+    nested_rev_autodiff nested;
+
+    Eigen::Matrix<var, Eigen::Dynamic, 1> y_vars
+        = Eigen::Map<const Eigen::VectorXd>(y, N_);
+    Eigen::Matrix<var, Eigen::Dynamic, 1> f_y_t_vars
+        = apply([&](auto&&... args) { return f_(t, y_vars, msgs_, args...); },
+                value_of_args_tuple_);
+    check_size_match(function_name_, "dy_dt", f_y_t_vars.size(), "states",
+                     N_);
+    for (size_t i = 0; i < N_; ++i) {
+      f_y_t_vars.coeffRef(i).adj() = -lambda[i];
+    }
+    grad();
+    for (size_t i = 0; i < N_; ++i) {
+      dlambda_dt[i] = y_vars.coeffRef(i).adj();
+    }
+  }
+
+  /**
+   * Calculates the RHS of the adjoints of the parameters,
+   * -lambda^T J_p, where J_p is the jacobian of the ODE RHS wrt to the
+   * parameters, by one reverse sweep.
+   */
+  inline void quad_rhs_adj(double t, const double y[], const double lambda[],
+                           double dmu_dt[]) {
+    // Run nested autodiff in this scope
+    nested_rev_autodiff nested;
+
+    const Eigen::VectorXd y_vec = Eigen::Map<const Eigen::VectorXd>(y, N_);
+    Eigen::Matrix<var, Eigen::Dynamic, 1> f_y_t_vars
+        = apply([&](auto&&... args) { return f_(t, y_vec, msgs_, args...); },
+                local_args_tuple_);
+    check_size_match(function_name_, "dy_dt", f_y_t_vars.size(), "states",
+                     N_);
+    for (size_t i = 0; i < N_; ++i) {
+      f_y_t_vars.coeffRef(i).adj() = -lambda[i];
+    }
+    grad();
+
+    // memset was faster than Eigen setZero
+    std::memset(dmu_dt, 0, sizeof(double) * num_args_vars_);
+    apply([&](auto&&... args) { accumulate_adjoints(dmu_dt, args...); },
+          local_args_tuple_);
+
+    // The vars here do not live on the nested stack so must be zero'd
+    // separately
+    apply([&](auto&&... args) { zero_adjoints(args...); }, local_args_tuple_);
+  }
+
+  /**
+   * Calculates the jacobian of the ODE RHS wrt to its states y at the
+   * given time-point t and state y, or its negative transpose for the
+   * backward system.
+   */
+  inline void jacobian_states(double t, const double y[], SUNMatrix J,
+                              bool adjoint) const {
+    Eigen::VectorXd fy;
+    Eigen::MatrixXd Jfy;
+
+    auto f_wrapped = [&](const Eigen::Matrix<var, Eigen::Dynamic, 1>& y) {
+      return apply([&](auto&&... args) { return f_(t, y, msgs_, args...); },
+                   value_of_args_tuple_);
+    };
+
+    jacobian(f_wrapped, Eigen::Map<const Eigen::VectorXd>(y, N_), fy, Jfy);
+
+    for (size_t j = 0; j < Jfy.cols(); ++j) {
+      for (size_t i = 0; i < Jfy.rows(); ++i) {
+        if (adjoint) {
+          SM_ELEMENT_D(J, j, i) = -Jfy(i, j);
+        } else {
+          SM_ELEMENT_D(J, i, j) = Jfy(i, j);
+        }
+      }
+    }
+  }
+
+  /**
+   * Store a state of the solution as the output of the forward pass.
+   */
+  inline Eigen::VectorXd store_state(const Eigen::VectorXd& y, double) {
+    return y;
+  }
+
+  /**
+   * Store a state of the solution as the output of the forward pass,
+   * with new vars whose adjoints are read in the reverse pass.
+   */
+  inline Eigen::Matrix<var, Eigen::Dynamic, 1> store_state(
+      const Eigen::VectorXd& y, var) {
+    Eigen::Matrix<var, Eigen::Dynamic, 1> y_return(N_);
+    vari** varis
+        = ChainableStack::instance_->memalloc_.alloc_array<vari*>(N_);
+    for (size_t i = 0; i < N_; ++i) {
+      varis[i] = new vari(y.coeff(i), false);
+      y_return.coeffRef(i) = var(varis[i]);
+    }
+    y_return_varis_.push_back(varis);
+    return y_return;
+  }
+
+  /**
+   * Integrate the adjoint states and the adjoints of the parameters
+   * backwards from t_start to t_end, starting from the adjoint states
+   * in state_backward_, and accumulating into quad_.
+   */
+  inline void solve_backward(double t_start, double t_end) {
+    if (!backward_is_initialized_) {
+      check_flag_sundials(
+          CVodeCreateB(cvodes_mem_, solver_backward_, &index_backward_),
+          "CVodeCreateB");
+      check_flag_sundials(
+          CVodeInitB(cvodes_mem_, index_backward_,
+                     &cvodes_integrator_adjoint::cv_rhs_adj, t_start,
+                     nv_state_backward_),
+          "CVodeInitB");
+      CVodeSetErrHandlerFn(CVodeGetAdjCVodeBmem(cvodes_mem_, index_backward_),
+                           cvodes_err_handler, nullptr);
+      check_flag_sundials(
+          CVodeSetUserDataB(cvodes_mem_, index_backward_,
+                            reinterpret_cast<void*>(this)),
+          "CVodeSetUserDataB");
+      check_flag_sundials(
+          CVodeSStolerancesB(cvodes_mem_, index_backward_,
+                             relative_tolerance_backward_,
+                             absolute_tolerance_backward_),
+          "CVodeSStolerancesB");
+      check_flag_sundials(
+          CVodeSetMaxNumStepsB(cvodes_mem_, index_backward_, max_num_steps_),
+          "CVodeSetMaxNumStepsB");
+
+      A_backward_ = SUNDenseMatrix(N_, N_);
+      LS_backward_ = SUNDenseLinearSolver(nv_state_backward_, A_backward_);
+      check_flag_sundials(CVodeSetLinearSolverB(cvodes_mem_, index_backward_,
+                                                LS_backward_, A_backward_),
+                          "CVodeSetLinearSolverB");
+      check_flag_sundials(
+          CVodeSetJacFnB(cvodes_mem_, index_backward_,
+                         &cvodes_integrator_adjoint::cv_jacobian_adj),
+          "CVodeSetJacFnB");
+
+      if (num_args_vars_ > 0) {
+        check_flag_sundials(
+            CVodeQuadInitB(cvodes_mem_, index_backward_,
+                           &cvodes_integrator_adjoint::cv_quad_rhs_adj,
+                           nv_quad_),
+            "CVodeQuadInitB");
+        check_flag_sundials(
+            CVodeQuadSStolerancesB(cvodes_mem_, index_backward_,
+                                   relative_tolerance_quadrature_,
+                                   absolute_tolerance_quadrature_),
+            "CVodeQuadSStolerancesB");
+        check_flag_sundials(
+            CVodeSetQuadErrConB(cvodes_mem_, index_backward_, SUNTRUE),
+            "CVodeSetQuadErrConB");
+      }
+      backward_is_initialized_ = true;
+    } else {
+      check_flag_sundials(CVodeReInitB(cvodes_mem_, index_backward_, t_start,
+                                       nv_state_backward_),
+                          "CVodeReInitB");
+      if (num_args_vars_ > 0) {
+        check_flag_sundials(
+            CVodeQuadReInitB(cvodes_mem_, index_backward_, nv_quad_),
+            "CVodeQuadReInitB");
+      }
+    }
+
+    int error_code = CVodeB(cvodes_mem_, t_end, CV_NORMAL);
+    if (error_code == CV_TOO_MUCH_WORK) {
+      throw_domain_error(function_name_, "", t_end,
+                         "Failed to integrate backward to output time (",
+                         ") in less than max_num_steps steps");
+    } else {
+      check_flag_sundials(error_code, "CVodeB");
+    }
+
+    double t_reached;
+    check_flag_sundials(CVodeGetB(cvodes_mem_, index_backward_, &t_reached,
+                                  nv_state_backward_),
+                        "CVodeGetB");
+    if (num_args_vars_ > 0) {
+      check_flag_sundials(
+          CVodeGetQuadB(cvodes_mem_, index_backward_, &t_reached, nv_quad_),
+          "CVodeGetQuadB");
+    }
+  }
+
+  /**
+   * Propagate the adjoints of the outputs to the adjoints of y0, t0, ts
+   * and the parameters. It may be called several times for the same
+   * forward solve, for example by `jacobian()`.
+   */
+  inline void reverse_pass() {
+    state_backward_.setZero();
+    quad_.setZero();
+    Eigen::VectorXd y_adj(N_);
+    for (size_t n = ts_.size(); n-- > 0;) {
+      for (size_t i = 0; i < N_; ++i) {
+        y_adj.coeffRef(i) = y_return_varis_[n][i]->adj_;
+      }
+      if (is_var_ts_) {
+        ts_varis_[n]->adj_ += y_adj.dot(rhs(ts_[n], y_[n]));
+      }
+      if (!needs_backward()) {
+        continue;
+      }
+      state_backward_ += y_adj;
+
+      // Nothing to integrate while the adjoint states are zero
+      const double t_end = n > 0 ? ts_[n - 1] : t0_;
+      if (t_end != ts_[n] && !state_backward_.isZero(0)) {
+        solve_backward(ts_[n], t_end);
+      }
+    }
+
+    for (size_t i = 0; i < num_y0_vars_; ++i) {
+      y0_varis_[i]->adj_ += state_backward_.coeff(i);
+    }
+    for (size_t i = 0; i < num_args_vars_; ++i) {
+      args_varis_[i]->adj_ += quad_.coeff(i);
+    }
+    if (is_var_t0_) {
+      t0_vari_->adj_ -= state_backward_.dot(rhs(t0_, y0_));
+    }
+  }
+
+ public:
+  /**
+   * Construct cvodes_integrator_adjoint object. It must be allocated
+   * with `new`, its memory is freed by `recover_memory()`. The arguments
+   * are checked by `ode_adjoint_impl()` beforehand, since an exception
+   * thrown here would leave the object on the stack of
+   * `chainable_alloc`.
+   *
+   * @param function_name Calling function name (for printing debugging
+   * messages)
+   * @param f Right hand side of the ODE
+   * @param y0 Initial state
+   * @param t0 Initial time
+   * @param ts Times at which to solve the ODE at. All values must be sorted and
+   *   greater than t0.
+   * @param relative_tolerance_forward Relative tolerance of the forward
+   *   solve
+   * @param absolute_tolerance_forward Absolute tolerance of the forward
+   *   solve
+   * @param relative_tolerance_backward Relative tolerance of the adjoint
+   *   states in the backward solve
+   * @param absolute_tolerance_backward Absolute tolerance of the adjoint
+   *   states in the backward solve
+   * @param relative_tolerance_quadrature Relative tolerance of the
+   *   adjoints of the parameters in the backward solve
+   * @param absolute_tolerance_quadrature Absolute tolerance of the
+   *   adjoints of the parameters in the backward solve
+   * @param max_num_steps Upper limit on the number of integration steps to
+   *   take between each output (error if exceeded)
+   * @param num_steps_between_checkpoints Number of integration steps
+   *   between two checkpoints of the forward solve
+   * @param interpolation_polynomial Interpolation of the forward solution
+   *   between checkpoints in the backward solve (1: Hermite,
+   *   2: polynomial)
+   * @param solver_forward Method of the forward solve (1: Adams, 2: BDF)
+   * @param solver_backward Method of the backward solve (1: Adams,
+   *   2: BDF)
+   * @param[in, out] msgs the print stream for warning messages
+   * @param args Extra arguments passed unmodified through to ODE right hand
+   * side function
+   */
+  template <require_eigen_col_vector_t<T_y0>* = nullptr>
+  cvodes_integrator_adjoint(
+      const char* function_name, const F& f, const T_y0& y0, const T_t0& t0,
+      const std::vector<T_ts>& ts, double relative_tolerance_forward,
+      double absolute_tolerance_forward, double relative_tolerance_backward,
+      double absolute_tolerance_backward,
+      double relative_tolerance_quadrature,
+      double absolute_tolerance_quadrature,
+      long int max_num_steps,                  // NOLINT(runtime/int)
+      long int num_steps_between_checkpoints,  // NOLINT(runtime/int)
+      int interpolation_polynomial, int solver_forward, int solver_backward,
+      std::ostream* msgs, const T_Args&... args)
+      : function_name_(function_name),
+        f_(f),
+        N_(y0.size()),
+        y0_(value_of(y0)),
+        t0_(value_of(t0)),
+        ts_(value_of(ts)),
+        value_of_args_tuple_(value_of(args)...),
+        local_args_tuple_(deep_copy_vars(args)...),
+        msgs_(msgs),
+        relative_tolerance_forward_(relative_tolerance_forward),
+        absolute_tolerance_forward_(absolute_tolerance_forward),
+        relative_tolerance_backward_(relative_tolerance_backward),
+        absolute_tolerance_backward_(absolute_tolerance_backward),
+        relative_tolerance_quadrature_(relative_tolerance_quadrature),
+        absolute_tolerance_quadrature_(absolute_tolerance_quadrature),
+        max_num_steps_(max_num_steps),
+        num_steps_between_checkpoints_(num_steps_between_checkpoints),
+        interpolation_polynomial_(interpolation_polynomial),
+        solver_forward_(solver_forward),
+        solver_backward_(solver_backward),
+        num_y0_vars_(count_vars(y0)),
+        num_args_vars_(count_vars(args...)),
+        is_var_t0_(is_var<T_t0>::value),
+        is_var_ts_(is_var<T_ts>::value),
+        y0_varis_(nullptr),
+        args_varis_(nullptr),
+        t0_vari_(nullptr),
+        ts_varis_(nullptr),
+        cvodes_mem_(nullptr),
+        index_backward_(0),
+        backward_is_initialized_(false),
+        state_(value_of(y0)),
+        state_backward_(Eigen::VectorXd::Zero(N_)),
+        quad_(Eigen::VectorXd::Zero(num_args_vars_)),
+        nv_state_(nullptr),
+        nv_state_backward_(nullptr),
+        nv_quad_(nullptr),
+        A_forward_(nullptr),
+        LS_forward_(nullptr),
+        A_backward_(nullptr),
+        LS_backward_(nullptr) {
+    if (num_y0_vars_ > 0) {
+      y0_varis_
+          = ChainableStack::instance_->memalloc_.alloc_array<vari*>(N_);
+      save_varis(y0_varis_, y0);
+    }
+    if (num_args_vars_ > 0) {
+      args_varis_ = ChainableStack::instance_->memalloc_.alloc_array<vari*>(
+          num_args_vars_);
+      save_varis(args_varis_, args...);
+    }
+    if (is_var_t0_) {
+      save_varis(&t0_vari_, t0);
+    }
+    if (is_var_ts_) {
+      ts_varis_
+          = ChainableStack::instance_->memalloc_.alloc_array<vari*>(ts.size());
+      save_varis(ts_varis_, ts);
+    }
+
+    nv_state_ = N_VMake_Serial(N_, state_.data());
+    nv_state_backward_ = N_VMake_Serial(N_, state_backward_.data());
+    A_forward_ = SUNDenseMatrix(N_, N_);
+    LS_forward_ = SUNDenseLinearSolver(nv_state_, A_forward_);
+    if (num_args_vars_ > 0) {
+      nv_quad_ = N_VMake_Serial(num_args_vars_, quad_.data());
+    }
+  }
+
+  ~cvodes_integrator_adjoint() { free_sundials(); }
+
+  /**
+   * Solve the ODE initial value problem y' = f(t, y), y(t0) = y0 at a set of
+   * times, { t1, t2, t3, ... }, storing checkpoints of the solution for the
+   * backward solve if any of the arguments are vars.
+   *
+   * @return std::vector of Eigen::Matrix of the states of the ODE, one for each
+   *   solution time (excluding the initial state)
+   */
+  std::vector<Eigen::Matrix<T_Return, Eigen::Dynamic, 1>> operator()() {
+    std::vector<Eigen::Matrix<T_Return, Eigen::Dynamic, 1>> y;
+    y.reserve(ts_.size());
+
+    cvodes_mem_ = CVodeCreate(solver_forward_);
+    if (cvodes_mem_ == nullptr) {
+      throw std::runtime_error("CVodeCreate failed to allocate memory");
+    }
+
+    check_flag_sundials(CVodeInit(cvodes_mem_,
+                                  &cvodes_integrator_adjoint::cv_rhs, t0_,
+                                  nv_state_),
+                        "CVodeInit");
+
+    // Assign pointer to this as user data
+    check_flag_sundials(
+        CVodeSetUserData(cvodes_mem_, reinterpret_cast<void*>(this)),
+        "CVodeSetUserData");
+
+    cvodes_set_options(cvodes_mem_, relative_tolerance_forward_,
+                       absolute_tolerance_forward_, max_num_steps_);
+
+    check_flag_sundials(
+        CVodeSetLinearSolver(cvodes_mem_, LS_forward_, A_forward_),
+        "CVodeSetLinearSolver");
+    check_flag_sundials(
+        CVodeSetJacFn(cvodes_mem_,
+                      &cvodes_integrator_adjoint::cv_jacobian_states),
+        "CVodeSetJacFn");
+
+    if (needs_backward()) {
+      check_flag_sundials(
+          CVodeAdjInit(cvodes_mem_, num_steps_between_checkpoints_,
+                       interpolation_polynomial_),
+          "CVodeAdjInit");
+    }
+
+    double t_init = t0_;
+    for (size_t n = 0; n < ts_.size(); ++n) {
+      double t_final = ts_[n];
+
+      if (t_final != t_init) {
+        int error_code;
+        if (needs_backward()) {
+          int ncheck;
+          error_code = CVodeF(cvodes_mem_, t_final, nv_state_, &t_init,
+                              CV_NORMAL, &ncheck);
+        } else {
+          error_code
+              = CVode(cvodes_mem_, t_final, nv_state_, &t_init, CV_NORMAL);
+        }
+
+        if (error_code == CV_TOO_MUCH_WORK) {
+          throw_domain_error(function_name_, "", t_final,
+                             "Failed to integrate to next output time (",
+                             ") in less than max_num_steps steps");
+        } else {
+          check_flag_sundials(error_code,
+                              needs_backward() ? "CVodeF" : "CVode");
+        }
+      }
+
+      y.emplace_back(store_state(state_, T_Return()));
+      if (is_var<T_Return>::value) {
+        y_.push_back(state_);
+      }
+
+      t_init = t_final;
+    }
+
+    if (is_var<T_Return>::value) {
+      reverse_pass_callback([integrator = this]() {
+        integrator->reverse_pass();
+      });
+    } else {
+      free_sundials();
+    }
+
+    return y;
+  }
+
+ private:
+  /**
+   * Free the memory of CVODES and the vectors, matrices and linear
+   * solvers given to it.
+   */
+  void free_sundials() noexcept {
+    if (cvodes_mem_ != nullptr) {
+      CVodeFree(&cvodes_mem_);
+    }
+    if (LS_backward_ != nullptr) {
+      SUNLinSolFree(LS_backward_);
+      SUNMatDestroy(A_backward_);
+      LS_backward_ = nullptr;
+      A_backward_ = nullptr;
+    }
+    if (LS_forward_ != nullptr) {
+      SUNLinSolFree(LS_forward_);
+      SUNMatDestroy(A_forward_);
+      LS_forward_ = nullptr;
+      A_forward_ = nullptr;
+    }
+    if (nv_state_ != nullptr) {
+      N_VDestroy_Serial(nv_state_);
+      N_VDestroy_Serial(nv_state_backward_);
+      nv_state_ = nullptr;
+      nv_state_backward_ = nullptr;
+    }
+    if (nv_quad_ != nullptr) {
+      N_VDestroy_Serial(nv_quad_);
+      nv_quad_ = nullptr;
+    }
+  }
+};  // cvodes integrator adjoint
+
+}  // namespace math
+}  // namespace stan
+#endif
@@ -0,0 +1,286 @@
+#ifndef STAN_MATH_REV_FUNCTOR_CVODES_LINEAR_SOLVER_HPP
+#define STAN_MATH_REV_FUNCTOR_CVODES_LINEAR_SOLVER_HPP
+
+#include <stan/math/prim/err.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <nvector/nvector_serial.h>
+#include <sundials/sundials_linearsolver.h>
+#include <sunmatrix/sunmatrix_sparse.h>
+#include <Eigen/SparseLU>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace stan {
+namespace math {
+
+/**
+ * Linear solver of the Newton iterations of the CVODES integrators.
+ */
+enum class ode_linear_solver {
+  /**
+   * Dense LU factorization of the Jacobian, which is computed with one
+   * reverse sweep per state.
+   */
+  dense,
+  /**
+   * Banded LU factorization of the Jacobian, which is computed with one
+   * reverse sweep per diagonal of the band.
+   */
+  banded,
+  /**
+   * Sparse LU factorization of the Jacobian (Eigen's `SparseLU`), which
+   * is computed with one reverse sweep per color of the rows of its
+   * sparsity pattern.
+   */
+  sparse,
+  /**
+   * GMRES preconditioned with the diagonal of the Jacobian. Before every
+   * solve the Jacobian is computed at the state of the solve, with one
+   * reverse sweep per color of the rows of its sparsity pattern (one per
+   * state if there is none), and multiplied with the vectors of the
+   * iterations.
+   */
+  spgmr,
+  /**
+   * Bi-CGStab, whose products of the Jacobian with vectors and
+   * preconditioner are those of `spgmr`.
+   */
+  spbcgs
+};
+
+/**
+ * Options of the CVODES integrators: the tolerances and number of steps
+ * of `ode_bdf_tol()`, and the linear solver of the Newton iterations.
+ *
+ * The dense default factors the Jacobian of the ODE right hand side in
+ * O(N^3) operations. For large systems whose states only interact with
+ * few other states, the banded and sparse factorizations or the
+ * iterative solvers, whose cost follows the number of nonzeros of the
+ * Jacobian, are much faster.
+ */
+struct ode_bdf_control {
+  /**
+   * Relative tolerance passed to CVODES.
+   */
+  double relative_tolerance = 1e-10;
+  /**
+   * Absolute tolerance passed to CVODES.
+   */
+  double absolute_tolerance = 1e-10;
+  /**
+   * Upper limit on the number of integration steps to take between each
+   * output (error if exceeded).
+   */
+  long int max_num_steps = 100000000;  // NOLINT(runtime/int)
+  /**
+   * Linear solver of the Newton iterations.
+   */
+  ode_linear_solver linear_solver = ode_linear_solver::dense;
+  /**
+   * Number of diagonals above the main diagonal of the Jacobian with
+   * nonzeros, for `ode_linear_solver::banded`.
+   */
+  int upper_bandwidth = 0;
+  /**
+   * Number of diagonals below the main diagonal of the Jacobian with
+   * nonzeros, for `ode_linear_solver::banded`.
+   */
+  int lower_bandwidth = 0;
+  /**
+   * Sparsity pattern of the Jacobian of the ODE right hand side with
+   * respect to the states, whose stored elements are the nonzeros, for
+   * `ode_linear_solver::sparse` and the iterative solvers; for example
+   * from `jacobian_sparsity()`. If it is empty, they use a dense
+   * pattern.
+   */
+  Eigen::SparseMatrix<double> jacobian_pattern;
+  /**
+   * Maximum dimension of the Krylov subspace of the iterative solvers,
+   * or 0 for the default of SUNDIALS (5).
+   */
+  int max_krylov_dimension = 0;
+};
+
+namespace internal {
+
+/**
+ * Check the options of the linear solver of the CVODES integrators for a
+ * system of the specified size.
+ *
+ * @param function_name name of the calling function
+ * @param control options
+ * @param N number of states
+ * @throw std::domain_error if the bandwidths or the maximum dimension of
+ * the Krylov subspace are out of range
+ * @throw std::invalid_argument if the sparsity pattern is not empty or N
+ * by N
+ */
+inline void check_ode_linear_solver(const char* function_name,
+                                    const ode_bdf_control& control, int N) {
+  if (control.linear_solver == ode_linear_solver::banded) {
+    check_bounded(function_name, "upper_bandwidth", control.upper_bandwidth, 0,
+                  N - 1);
+    check_bounded(function_name, "lower_bandwidth", control.lower_bandwidth, 0,
+                  N - 1);
+  }
+  if (control.jacobian_pattern.size() > 0
+      || control.linear_solver == ode_linear_solver::sparse) {
+    check_size_match(function_name, "rows of jacobian_pattern",
+                     control.jacobian_pattern.rows(), "states", N);
+    check_size_match(function_name, "columns of jacobian_pattern",
+                     control.jacobian_pattern.cols(), "states", N);
+  }
+  check_nonnegative(function_name, "max_krylov_dimension",
+                    control.max_krylov_dimension);
+}
+
+/**
+ * Return the sparsity pattern of the Jacobian of an ODE right hand side
+ * used by the specified linear solver, with the diagonal, which the
+ * Newton matrix `I - gamma J` always has.
+ *
+ * @param control options of the linear solver
+ * @param N number of states
+ * @return the band for `ode_linear_solver::banded`, the user pattern for
+ * the others, or a dense pattern if it is empty
+ */
+inline Eigen::SparseMatrix<double> ode_jacobian_pattern(
+    const ode_bdf_control& control, int N) {
+  std::vector<Eigen::Triplet<double>> nonzeros;
+  for (int i = 0; i < N; ++i) {
+    nonzeros.emplace_back(i, i, 1.0);
+  }
+  if (control.linear_solver == ode_linear_solver::banded) {
+    for (int j = 0; j < N; ++j) {
+      for (int i = std::max(0, j - control.upper_bandwidth);
+           i <= std::min(N - 1, j + control.lower_bandwidth); ++i) {
+        nonzeros.emplace_back(i, j, 1.0);
+      }
+    }
+  } else if (control.jacobian_pattern.size() == 0) {
+    for (int j = 0; j < N; ++j) {
+      for (int i = 0; i < N; ++i) {
+        nonzeros.emplace_back(i, j, 1.0);
+      }
+    }
+  } else {
+    for (int j = 0; j < control.jacobian_pattern.outerSize(); ++j) {
+      for (Eigen::SparseMatrix<double>::InnerIterator it(
+               control.jacobian_pattern, j);
+           it; ++it) {
+        nonzeros.emplace_back(it.row(), j, 1.0);
+      }
+    }
+  }
+  Eigen::SparseMatrix<double> pattern(N, N);
+  pattern.setFromTriplets(nonzeros.begin(), nonzeros.end(),
+                          [](double a, double b) { return 1.0; });
+  pattern.makeCompressed();
+  return pattern;
+}
+
+/**
+ * Content of the SUNDIALS linear solver with the sparse LU factorization
+ * of Eigen. The ordering and symbolic factorization are computed at the
+ * first setup, since the pattern of the matrix does not change.
+ */
+struct eigen_sparse_lu_content {
+  using matrix_t = Eigen::SparseMatrix<double, Eigen::ColMajor, sunindextype>;
+  Eigen::SparseLU<matrix_t, Eigen::COLAMDOrdering<sunindextype>> lu_;
+  bool analyzed_ = false;
+  sunindextype last_flag_ = 0;
+
+  static eigen_sparse_lu_content& of(SUNLinearSolver S) {
+    return *static_cast<eigen_sparse_lu_content*>(S->content);
+  }
+
+  static Eigen::Map<const matrix_t> matrix(SUNMatrix A) {
+    return Eigen::Map<const matrix_t>(
+        SM_ROWS_S(A), SM_COLUMNS_S(A), SM_INDEXPTRS_S(A)[SM_COLUMNS_S(A)],
+        SM_INDEXPTRS_S(A), SM_INDEXVALS_S(A), SM_DATA_S(A));
+  }
+};
+
+extern "C" inline SUNLinearSolver_Type eigen_sparse_lu_gettype(
+    SUNLinearSolver S) {
+  return SUNLINEARSOLVER_DIRECT;
+}
+
+extern "C" inline SUNLinearSolver_ID eigen_sparse_lu_getid(SUNLinearSolver S) {
+  return SUNLINEARSOLVER_CUSTOM;
+}
+
+extern "C" inline int eigen_sparse_lu_initialize(SUNLinearSolver S) {
+  eigen_sparse_lu_content::of(S).last_flag_ = SUNLS_SUCCESS;
+  return SUNLS_SUCCESS;
+}
+
+extern "C" inline int eigen_sparse_lu_setup(SUNLinearSolver S, SUNMatrix A) {
+  auto& content = eigen_sparse_lu_content::of(S);
+  const auto matrix = eigen_sparse_lu_content::matrix(A);
+  if (!content.analyzed_) {
+    content.lu_.analyzePattern(matrix);
+    content.analyzed_ = true;
+  }
+  content.lu_.factorize(matrix);
+  // a positive flag is a recoverable failure: CVODES reduces the step
+  content.last_flag_ = content.lu_.info() == Eigen::Success
+                           ? SUNLS_SUCCESS
+                           : SUNLS_LUFACT_FAIL;
+  return content.last_flag_;
+}
+
+extern "C" inline int eigen_sparse_lu_solve(SUNLinearSolver S, SUNMatrix A,
+                                            N_Vector x, N_Vector b,
+                                            realtype tol) {
+  auto& content = eigen_sparse_lu_content::of(S);
+  const sunindextype N = SM_COLUMNS_S(A);
+  Eigen::Map<Eigen::VectorXd>(NV_DATA_S(x), N)
+      = content.lu_.solve(Eigen::Map<const Eigen::VectorXd>(NV_DATA_S(b), N));
+  content.last_flag_ = SUNLS_SUCCESS;
+  return SUNLS_SUCCESS;
+}
+
+extern "C" inline sunindextype eigen_sparse_lu_lastflag(SUNLinearSolver S) {
+  return eigen_sparse_lu_content::of(S).last_flag_;
+}
+
+extern "C" inline int eigen_sparse_lu_free(SUNLinearSolver S) {
+  if (S == nullptr) {
+    return SUNLS_SUCCESS;
+  }
+  delete static_cast<eigen_sparse_lu_content*>(S->content);
+  S->content = nullptr;
+  SUNLinSolFreeEmpty(S);
+  return SUNLS_SUCCESS;
+}
+
+/**
+ * Return a SUNDIALS direct linear solver for sparse CSC matrices
+ * (`SUNSparseMatrix`) with the sparse LU factorization of Eigen, which
+ * takes the place of KLU, which is not distributed with Stan. It is
+ * freed by `SUNLinSolFree()`.
+ *
+ * @return linear solver
+ */
+inline SUNLinearSolver eigen_sparse_lu_linear_solver() {
+  SUNLinearSolver S = SUNLinSolNewEmpty();
+  if (S == nullptr) {
+    throw std::runtime_error("SUNLinSolNewEmpty failed to allocate memory");
+  }
+  S->ops->gettype = eigen_sparse_lu_gettype;
+  S->ops->getid = eigen_sparse_lu_getid;
+  S->ops->initialize = eigen_sparse_lu_initialize;
+  S->ops->setup = eigen_sparse_lu_setup;
+  S->ops->solve = eigen_sparse_lu_solve;
+  S->ops->lastflag = eigen_sparse_lu_lastflag;
+  S->ops->free = eigen_sparse_lu_free;
+  S->content = new eigen_sparse_lu_content();
+  return S;
+}
+
+}  // namespace internal
+}  // namespace math
+}  // namespace stan
+#endif
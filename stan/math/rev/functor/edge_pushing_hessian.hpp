@@ -0,0 +1,184 @@
+#ifndef STAN_MATH_REV_FUNCTOR_EDGE_PUSHING_HESSIAN_HPP
+#define STAN_MATH_REV_FUNCTOR_EDGE_PUSHING_HESSIAN_HPP
+
+#include <stan/math/rev/meta.hpp>
+#include <stan/math/rev/core.hpp>
+#include <stan/math/rev/core/compact_tape_lanes.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace stan {
+namespace math {
+namespace internal {
+
+/**
+ * The symmetric matrix of second order adjoints of the edge pushing
+ * algorithm, stored as one map per slot from the slots it interacts
+ * with to the (symmetric) second order adjoint of the pair.
+ */
+class edge_pushing_weights {
+  std::vector<std::unordered_map<int, double>> rows_;
+
+ public:
+  explicit edge_pushing_weights(int num_slots) : rows_(num_slots) {}
+
+  inline const std::unordered_map<int, double>& row(int i) const {
+    return rows_[i];
+  }
+
+  /**
+   * Add to the weight of a pair of slots, in both of its rows.
+   */
+  inline void add(int i, int j, double w) {
+    if (w == 0) {
+      return;
+    }
+    rows_[i][j] += w;
+    if (i != j) {
+      rows_[j][i] += w;
+    }
+  }
+
+  /**
+   * Remove all the weights of a slot, returning its row.
+   */
+  inline std::unordered_map<int, double> remove(int i) {
+    std::unordered_map<int, double> row;
+    row.swap(rows_[i]);
+    for (const auto& entry : row) {
+      if (entry.first != i) {
+        rows_[entry.first].erase(i);
+      }
+    }
+    return row;
+  }
+};
+
+/**
+ * Calculate the value, the gradient and the Hessian of the specified
+ * function at the specified argument with the second order reverse
+ * sweep of the edge pushing algorithm (Gower and Mello, 2012), in one
+ * evaluation of the function and one reverse sweep over its tape.
+ *
+ * Each operation `v = phi(a, b)` is eliminated in reverse order: the
+ * second order adjoints of `v` are pushed to its operands through its
+ * partials, its adjoint creates second order adjoints between its
+ * operands through its second partials, and its adjoint is propagated
+ * to its operands as in the first order reverse sweep. Only the pairs
+ * of variables which interact nonlinearly are stored, so that the
+ * cost follows the sparsity of the Hessian instead of the number of
+ * variables.
+ *
+ * This requires the second partials of every operation on the tape,
+ * which are only available for the operations of the compact tape
+ * (`STAN_COMPACT_TAPE`). If the function records anything else, it
+ * returns false and the outputs are unspecified.
+ *
+ * @tparam F type of function, callable with a vector of `var`
+ * @param[in] f function
+ * @param[in] x argument to function
+ * @param[out] fx function applied to argument
+ * @param[out] grad gradient of function at argument
+ * @param[out] H Hessian of function at argument
+ * @return true if the Hessian has been computed
+ */
+template <typename F>
+inline bool edge_pushing_hessian(
+    const F& f, const Eigen::Matrix<double, Eigen::Dynamic, 1>& x,
+    double& fx, Eigen::Matrix<double, Eigen::Dynamic, 1>& grad,
+    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>& H) {
+  // Run nested autodiff in this scope
+  nested_rev_autodiff nested;
+
+  Eigen::Matrix<var, Eigen::Dynamic, 1> x_var(x);
+  var fx_var = f(x_var);
+  compact_tape_lanes tape;
+  if (!tape.linearize_nested(true)) {
+    return false;
+  }
+  fx = fx_var.val();
+  grad.setZero(x.size());
+  H.setZero(x.size(), x.size());
+  const int out = tape.slot(fx_var.vi_);
+  if (out < 0) {
+    return true;
+  }
+
+  std::vector<double> adj(tape.num_slots(), 0.0);
+  adj[out] = 1;
+  edge_pushing_weights weights(tape.num_slots());
+  int operands[2];
+  double d[2];
+  double d2[2][2];
+  for (size_t op = tape.num_ops(); op-- > 0;) {
+    const int v = tape.result(op);
+    if (adj[v] == 0 && weights.row(v).empty()) {
+      continue;
+    }
+    int num_operands = 1;
+    operands[0] = tape.first_operand(op);
+    d[0] = tape.first_partial(op);
+    tape.second_partials(op, d2[0][0], d2[0][1], d2[1][1]);
+    d2[1][0] = d2[0][1];
+    if (tape.second_operand(op) >= 0) {
+      if (tape.second_operand(op) == operands[0]) {
+        // phi(a, a) as a function of a single operand
+        d[0] += tape.second_partial(op);
+        d2[0][0] += 2 * d2[0][1] + d2[1][1];
+      } else {
+        operands[1] = tape.second_operand(op);
+        d[1] = tape.second_partial(op);
+        num_operands = 2;
+      }
+    }
+
+    // pushing
+    std::unordered_map<int, double> row = weights.remove(v);
+    double w_vv = 0;
+    for (const auto& entry : row) {
+      if (entry.first == v) {
+        w_vv = entry.second;
+        continue;
+      }
+      for (int k = 0; k < num_operands; ++k) {
+        weights.add(entry.first, operands[k],
+                    (entry.first == operands[k] ? 2 : 1) * d[k]
+                        * entry.second);
+      }
+    }
+    // pushing through the diagonal and creating
+    for (int k = 0; k < num_operands; ++k) {
+      for (int l = k; l < num_operands; ++l) {
+        weights.add(operands[k], operands[l],
+                    d[k] * d[l] * w_vv + adj[v] * d2[k][l]);
+      }
+    }
+    // adjoints
+    for (int k = 0; k < num_operands; ++k) {
+      adj[operands[k]] += d[k] * adj[v];
+    }
+    adj[v] = 0;
+  }
+
+  std::vector<int> index_of_slot(tape.num_slots(), -1);
+  for (int i = 0; i < x.size(); ++i) {
+    const int slot = tape.slot(x_var(i).vi_);
+    index_of_slot[slot] = i;
+    grad(i) = adj[slot];
+  }
+  for (int i = 0; i < x.size(); ++i) {
+    for (const auto& entry : weights.row(tape.slot(x_var(i).vi_))) {
+      const int j = index_of_slot[entry.first];
+      if (j >= 0) {
+        H(i, j) = entry.second;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace internal
+}  // namespace math
+}  // namespace stan
+#endif
@@ -51,6 +51,87 @@ void gradient(const F& f, const Eigen::Matrix<double, Eigen::Dynamic, 1>& x,
   grad_fx = x_var.adj();
 }
 
+namespace internal {
+
+/**
+ * Return the AD tape of the calling thread used by `gradient()` for
+ * arguments of fixed size. It is kept between calls so that its arena
+ * and stacks, once grown, are reused.
+ */
+inline ChainableStack::AutodiffStackStorage& small_gradient_tape() {
+  static thread_local ChainableStack::AutodiffStackStorage tape;
+  return tape;
+}
+
+}  // namespace internal
+
+/**
+ * Calculate the value and the gradient of the specified function
+ * at the specified argument of fixed size.
+ *
+ * The function is evaluated on a private AD tape of the calling
+ * thread, which is swapped in for the duration of the call instead of
+ * nesting on the current AD tape. Recovering its memory afterwards
+ * only resets its stacks and its arena, and no memory is requested
+ * once the tape has grown to the size of the expression graph. This
+ * removes most of the fixed cost of a call, which dominates for small
+ * functions. If called from within the function itself, the nested
+ * path of the dynamic size version is used instead.
+ *
+ * The functor must implement
+ *
+ * <code>
+ * var
+ * operator()(const
+ * Eigen::Matrix<var, N, 1>&)
+ * </code>
+ *
+ * with the same restrictions as for the dynamic size version.
+ *
+ * @tparam F Type of function
+ * @tparam N Size of the argument
+ * @param[in] f Function
+ * @param[in] x Argument to function
+ * @param[out] fx Function applied to argument
+ * @param[out] grad_fx Gradient of function at argument
+ */
+template <typename F, int N, std::enable_if_t<N != Eigen::Dynamic>* = nullptr>
+void gradient(const F& f, const Eigen::Matrix<double, N, 1>& x, double& fx,
+              Eigen::Matrix<double, N, 1>& grad_fx) {
+  auto& tape = internal::small_gradient_tape();
+  if (unlikely(ChainableStack::instance_ == &tape)) {
+    nested_rev_autodiff nested;
+    Eigen::Matrix<var, N, 1> x_var(x);
+    var fx_var = f(x_var);
+    fx = fx_var.val();
+    grad(fx_var.vi_);
+    grad_fx = x_var.adj();
+    return;
+  }
+
+  struct activate_tape {
+    ChainableStack::AutodiffStackStorage* parent_;
+    explicit activate_tape(ChainableStack::AutodiffStackStorage& tape)
+        : parent_(ChainableStack::instance_) {
+      ChainableStack::instance_ = &tape;
+    }
+    ~activate_tape() {
+      while (!empty_nested()) {
+        recover_memory_nested();
+      }
+      recover_memory();
+      ChainableStack::instance_ = parent_;
+    }
+  };
+  const activate_tape active(tape);
+
+  Eigen::Matrix<var, N, 1> x_var(x);
+  var fx_var = f(x_var);
+  fx = fx_var.val();
+  grad(fx_var.vi_);
+  grad_fx = x_var.adj();
+}
+
 }  // namespace math
 }  // namespace stan
 #endif
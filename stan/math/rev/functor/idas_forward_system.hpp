@@ -82,10 +82,12 @@ class idas_forward_system : public idas_system<F, Tyy, Typ, Tpar> {
   N_Vector* nv_yps() { return nv_yps_; }
 
   /**
-   * Convert to void pointer for IDAS callbacks
+   * Convert to void pointer for IDAS callbacks: the workspace of the
+   * system, pointing to the system.
    */
   void* to_user_data() {  // prepare to inject DAE info
-    return static_cast<void*>(this);
+    this->workspace().dae_ = static_cast<void*>(this);
+    return static_cast<void*>(&this->workspace());
   }
 
   /**
@@ -101,7 +103,8 @@ class idas_forward_system : public idas_system<F, Tyy, Typ, Tpar> {
       using Eigen::Dynamic;
 
       using DAE = idas_forward_system<F, Tyy, Typ, Tpar>;
-      DAE* dae = static_cast<DAE*>(user_data);
+      DAE* dae = static_cast<DAE*>(
+          static_cast<internal::idas_workspace*>(user_data)->dae_);
 
       static const char* caller = "sensitivity_residual";
       check_greater(caller, "number of parameters", ns, 0);
@@ -137,29 +137,27 @@ class idas_integrator {
     typename Dae::return_type res_yy(
         ts.size(), std::vector<typename Dae::scalar_type>(n, 0));
 
-    auto A = SUNDenseMatrix(n, n);
-    auto LS = SUNDenseLinearSolver(yy, A);
+    // the workspace is only reused if the solve succeeds
+    auto& workspace = dae.workspace();
+    workspace.reusable_ = false;
 
-    try {
-      CHECK_IDAS_CALL(IDASetUserData(mem, dae.to_user_data()));
+    CHECK_IDAS_CALL(IDASetUserData(mem, dae.to_user_data()));
 
+    if (!workspace.initialized_) {
       CHECK_IDAS_CALL(IDAInit(mem, dae.residual(), t0, yy, yp));
-      CHECK_IDAS_CALL(IDASetLinearSolver(mem, LS, A));
-      CHECK_IDAS_CALL(IDASStolerances(mem, rtol_, atol_));
-      CHECK_IDAS_CALL(IDASetMaxNumSteps(mem, max_num_steps_));
-
-      init_sensitivity(dae);
-
-      solve(dae, t0, ts, res_yy);
-    } catch (const std::exception& e) {
-      SUNLinSolFree(LS);
-      SUNMatDestroy(A);
-      throw;
+      CHECK_IDAS_CALL(IDASetLinearSolver(mem, workspace.LS_, workspace.A_));
+    } else {
+      CHECK_IDAS_CALL(IDAReInit(mem, t0, yy, yp));
     }
+    CHECK_IDAS_CALL(IDASStolerances(mem, rtol_, atol_));
+    CHECK_IDAS_CALL(IDASetMaxNumSteps(mem, max_num_steps_));
 
-    SUNLinSolFree(LS);
-    SUNMatDestroy(A);
+    init_sensitivity(dae);
+    workspace.initialized_ = true;
 
+    solve(dae, t0, ts, res_yy);
+
+    workspace.reusable_ = true;
     return res_yy;
   }
 };  // idas integrator
@@ -190,8 +188,12 @@ void idas_integrator::init_sensitivity(Dae& dae) {
         NV_Ith_S(yps[i + n], i) = 1.0;
       }
     }
-    CHECK_IDAS_CALL(IDASensInit(mem, dae.ns(), IDA_SIMULTANEOUS,
-                                dae.sensitivity_residual(), yys, yps));
+    if (!dae.workspace().initialized_) {
+      CHECK_IDAS_CALL(IDASensInit(mem, dae.ns(), IDA_SIMULTANEOUS,
+                                  dae.sensitivity_residual(), yys, yps));
+    } else {
+      CHECK_IDAS_CALL(IDASensReInit(mem, IDA_SIMULTANEOUS, yys, yps));
+    }
     CHECK_IDAS_CALL(IDASensEEtolerances(mem));
     CHECK_IDAS_CALL(IDAGetSensConsistentIC(mem, yys, yps));
   }
@@ -7,9 +7,15 @@
 #include <stan/math/prim/fun/dot_self.hpp>
 #include <stan/math/prim/fun/typedefs.hpp>
 #include <stan/math/prim/fun/value_of.hpp>
+#include <stan/math/rev/functor/sundials_workspace_cache.hpp>
 #include <idas/idas.h>
 #include <nvector/nvector_serial.h>
+#include <sunlinsol/sunlinsol_dense.h>
+#include <sunmatrix/sunmatrix_dense.h>
+#include <memory>
 #include <ostream>
+#include <stdexcept>
+#include <tuple>
 #include <vector>
 #include <cmath>
 
@@ -71,6 +77,65 @@ inline void matrix_d_to_NVarray(const Eigen::MatrixXd& mat, N_Vector* nv,
 
 namespace stan {
 namespace math {
+namespace internal {
+
+/**
+ * Workspace of an IDAS solve: the IDAS memory and the dense matrix and
+ * linear solver of the Newton iterations.
+ *
+ * The key is the number of states, the number of sensitivities and the
+ * residual, which IDAS keeps from its initialization, so that a
+ * workspace is only reused by the DAE systems of the same type. A
+ * reused workspace is reinitialized with `IDAReInit()` and
+ * `IDASensReInit()`. The user data of IDAS is the workspace, which
+ * points to the DAE system using it, since IDAS copies the user data of
+ * the sensitivity residual at its initialization.
+ */
+struct idas_workspace {
+  using key_type = std::tuple<size_t, size_t, IDAResFn>;
+
+  key_type key_;
+  void* mem_;
+  SUNMatrix A_;
+  SUNLinearSolver LS_;
+  /// true once IDAS and its sensitivity system are initialized
+  bool initialized_;
+  /// true after a successful solve, when the workspace can be reused
+  bool reusable_;
+  /// DAE system using the workspace, the user data of the callbacks
+  void* dae_;
+
+  explicit idas_workspace(const key_type& key)
+      : key_(key),
+        mem_(IDACreate()),
+        A_(SUNDenseMatrix(std::get<0>(key), std::get<0>(key))),
+        LS_(nullptr),
+        initialized_(false),
+        reusable_(false),
+        dae_(nullptr) {
+    if (mem_ == nullptr) {
+      SUNMatDestroy(A_);
+      throw std::runtime_error("IDACreate failed to allocate memory");
+    }
+    IDASetUserData(mem_, this);
+    N_Vector template_vector = N_VNewEmpty_Serial(std::get<0>(key));
+    LS_ = SUNDenseLinearSolver(template_vector, A_);
+    N_VDestroy_Serial(template_vector);
+  }
+
+  ~idas_workspace() {
+    SUNLinSolFree(LS_);
+    SUNMatDestroy(A_);
+    IDAFree(&mem_);
+  }
+
+  idas_workspace(const idas_workspace&) = delete;
+  idas_workspace& operator=(const idas_workspace&) = delete;
+
+  const key_type& key() const { return key_; }
+};
+
+}  // namespace internal
 
 /**
  * IDAS DAE system that contains information on residual
@@ -103,6 +168,7 @@ class idas_system {
   std::vector<double> rr_val_;  // workspace
   N_Vector nv_rr_;
   N_Vector id_;
+  std::unique_ptr<internal::idas_workspace> workspace_;
   void* mem_;
   std::ostream* msgs_;
 
@@ -149,17 +215,13 @@ class idas_system {
         rr_val_(N_, 0.0),
         nv_rr_(N_VMake_Serial(N_, rr_val_.data())),
         id_(N_VNew_Serial(N_)),
-        mem_(IDACreate()),
+        mem_(nullptr),
         msgs_(msgs) {
     try {
       if (nv_yy_ == NULL || nv_yp_ == NULL) {
         throw std::runtime_error("N_VMake_Serial failed to allocate memory");
       }
 
-      if (mem_ == NULL) {
-        throw std::runtime_error("IDACreate failed to allocate memory");
-      }
-
       static const char* caller = "idas_system";
       check_finite(caller, "initial state", yy0);
       check_finite(caller, "derivative initial state", yp0);
@@ -173,12 +235,15 @@ class idas_system {
                              "derivative-algebra id", eq_id);
       check_greater_or_equal(caller, "derivative-algebra id", eq_id, 0);
       check_less_or_equal(caller, "derivative-algebra id", eq_id, 1);
+
+      workspace_ = internal::sundials_workspace_cache<
+          internal::idas_workspace>::acquire({N_, ns_, residual()});
+      mem_ = workspace_->mem_;
     } catch (const std::exception& e) {
       N_VDestroy_Serial(nv_yy_);
       N_VDestroy_Serial(nv_yp_);
       N_VDestroy_Serial(nv_rr_);
       N_VDestroy_Serial(id_);
-      IDAFree(&mem_);
       throw;
     }
 
@@ -188,14 +253,19 @@ class idas_system {
   }
 
   /**
-   * Destructor to deallocate IDAS solution memory and workspace.
+   * Destructor to deallocate the vectors, which returns the IDAS
+   * workspace to the cache of the thread if the last solve succeeded,
+   * and frees it otherwise.
    */
   ~idas_system() {
     N_VDestroy_Serial(nv_yy_);
     N_VDestroy_Serial(nv_yp_);
     N_VDestroy_Serial(nv_rr_);
     N_VDestroy_Serial(id_);
-    IDAFree(&mem_);
+    if (workspace_->reusable_) {
+      internal::sundials_workspace_cache<internal::idas_workspace>::release(
+          std::move(workspace_));
+    }
   }
 
   /**
@@ -309,6 +379,12 @@ class idas_system {
    */
   void* mem() { return mem_; }
 
+  /**
+   * Return the IDAS workspace, with the memory, matrix and linear
+   * solver
+   */
+  internal::idas_workspace& workspace() { return *workspace_; }
+
   /**
    * Return reference to DAE functor
    */
@@ -321,7 +397,8 @@ class idas_system {
     return [](double t, N_Vector yy, N_Vector yp, N_Vector rr,
               void* user_data) -> int {
       using DAE = idas_system<F, Tyy, Typ, Tpar>;
-      DAE* dae = static_cast<DAE*>(user_data);
+      DAE* dae = static_cast<DAE*>(
+          static_cast<internal::idas_workspace*>(user_data)->dae_);
 
       size_t N = NV_LENGTH_S(yy);
       auto yy_val = N_VGetArrayPointer(yy);
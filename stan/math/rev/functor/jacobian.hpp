@@ -3,13 +3,85 @@
 
 #include <stan/math/rev/meta.hpp>
 #include <stan/math/rev/core.hpp>
+#include <stan/math/rev/core/compact_tape_lanes.hpp>
 #include <stan/math/prim/fun/Eigen.hpp>
+#include <algorithm>
 #include <stdexcept>
 #include <vector>
 
 namespace stan {
 namespace math {
+namespace internal {
 
+/**
+ * Number of rows of the Jacobian computed by one reverse sweep over a
+ * compact tape.
+ */
+constexpr int JACOBIAN_LANES = 8;
+
+/**
+ * Compute the Jacobian of the outputs with respect to the inputs of the
+ * nested tape, `JACOBIAN_LANES` rows per reverse sweep, if the nested
+ * tape consists only of compact tape operations.
+ *
+ * @param x_var inputs
+ * @param fx_var outputs
+ * @param[out] J Jacobian, with one row per output
+ * @return false if the nested tape cannot be linearized, in which case
+ * `J` is not set
+ */
+inline bool compact_tape_jacobian(
+    const Eigen::Matrix<var, Eigen::Dynamic, 1>& x_var,
+    const Eigen::Matrix<var, Eigen::Dynamic, 1>& fx_var,
+    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>& J) {
+  constexpr int K = JACOBIAN_LANES;
+  compact_tape_lanes tape;
+  if (!tape.linearize_nested()) {
+    return false;
+  }
+  std::vector<int> x_slots(x_var.size());
+  for (int j = 0; j < x_var.size(); ++j) {
+    x_slots[j] = tape.slot(x_var(j).vi_);
+  }
+  Eigen::Matrix<double, K, Eigen::Dynamic> lanes(K, tape.num_slots());
+  J.resize(fx_var.size(), x_var.size());
+  for (int first = 0; first < fx_var.size(); first += K) {
+    const int num_lanes = std::min(K, static_cast<int>(fx_var.size()) - first);
+    lanes.setZero();
+    for (int k = 0; k < num_lanes; ++k) {
+      const int out = tape.slot(fx_var(first + k).vi_);
+      if (out >= 0) {
+        lanes(k, out) = 1.0;
+      }
+    }
+    tape.sweep(lanes);
+    for (int j = 0; j < x_var.size(); ++j) {
+      J.col(j).segment(first, num_lanes)
+          = lanes.col(x_slots[j]).head(num_lanes);
+    }
+  }
+  return true;
+}
+
+}  // namespace internal
+
+/**
+ * Return the Jacobian of the specified function at the specified
+ * argument, along with its value.
+ *
+ * If the function records only compact tape operations (see
+ * `STAN_COMPACT_TAPE`), the rows of the Jacobian are computed
+ * `internal::JACOBIAN_LANES` at a time by a single reverse sweep with
+ * vectors of adjoints. Otherwise every row is computed by its own
+ * reverse pass.
+ *
+ * @tparam F type of function
+ * @param[in] f function, taking and returning an Eigen column vector
+ * @param[in] x argument
+ * @param[out] fx value of the function
+ * @param[out] J Jacobian, with one row per output and one column per
+ * input
+ */
 template <typename F>
 void jacobian(const F& f, const Eigen::Matrix<double, Eigen::Dynamic, 1>& x,
               Eigen::Matrix<double, Eigen::Dynamic, 1>& fx,
@@ -24,6 +96,9 @@ void jacobian(const F& f, const Eigen::Matrix<double, Eigen::Dynamic, 1>& x,
   fx.resize(fx_var.size());
   J.resize(x.size(), fx_var.size());
   fx = fx_var.val();
+  if (fx_var.size() > 1 && internal::compact_tape_jacobian(x_var, fx_var, J)) {
+    return;
+  }
   grad(fx_var(0).vi_);
   J.col(0) = x_var.adj();
   for (int i = 1; i < fx_var.size(); ++i) {
@@ -2,6 +2,7 @@
 #define STAN_MATH_REV_FUNCTOR_MAP_RECT_CONCURRENT_HPP
 
 #include <stan/math/prim/meta.hpp>
+#include <stan/math/prim/core/parallel_region.hpp>
 #include <stan/math/prim/fun/typedefs.hpp>
 #include <stan/math/prim/functor/map_rect_concurrent.hpp>
 #include <stan/math/prim/functor/map_rect_reduce.hpp>
@@ -37,6 +38,7 @@ map_rect_concurrent(
   std::vector<int> world_f_out(num_jobs, 0);
 
   auto execute_chunk = [&](std::size_t start, std::size_t end) -> void {
+    const parallel_task_scope task;
     for (std::size_t i = start; i != end; ++i) {
       job_output[i] = ReduceF()(shared_params_dbl, value_of(job_params[i]),
                                 x_r[i], x_i[i], msgs);
@@ -50,8 +52,10 @@ map_rect_concurrent(
   // this is to ensure that the thread local AD tape ressource is
   // not being modified from a different task which may happen
   // whenever this function is being used itself in a parallel
-  // context (like running multiple chains for Stan)
-  tbb::this_task_arena::isolate([&] {
+  // context (like running multiple chains for Stan). Nested calls
+  // from the jobs of other parallel functors share their isolated
+  // region, as do the parallel functors called by the jobs.
+  run_parallel_region([&] {
     tbb::parallel_for(tbb::blocked_range<std::size_t>(0, num_jobs),
                       [&](const tbb::blocked_range<size_t>& r) {
                         execute_chunk(r.begin(), r.end());
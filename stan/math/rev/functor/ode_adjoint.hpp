@@ -0,0 +1,285 @@
+#ifndef STAN_MATH_REV_FUNCTOR_ODE_ADJOINT_HPP
+#define STAN_MATH_REV_FUNCTOR_ODE_ADJOINT_HPP
+
+#include <stan/math/rev/meta.hpp>
+#include <stan/math/rev/functor/cvodes_integrator_adjoint.hpp>
+#include <stan/math/prim/err.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <ostream>
+#include <vector>
+
+namespace stan {
+namespace math {
+
+/**
+ * Solve the ODE initial value problem y' = f(t, y), y(t0) = y0 at a set of
+ * times, { t1, t2, t3, ... } using CVODES, computing the sensitivities
+ * with the adjoint method in the reverse pass of autodiff.
+ *
+ * \p f must define an operator() with the signature as:
+ *   template<typename T_t, typename T_y, typename... T_Args>
+ *   Eigen::Matrix<stan::return_type_t<T_t, T_y, T_Args...>, Eigen::Dynamic, 1>
+ *     operator()(const T_t& t, const Eigen::Matrix<T_y, Eigen::Dynamic, 1>& y,
+ *     std::ostream* msgs, const T_Args&... args);
+ *
+ * t is the time, y is the vector-valued state, msgs is a stream for error
+ * messages, and args are optional arguments passed to the ODE solve function
+ * (which are passed through to \p f without modification).
+ *
+ * @tparam F Type of ODE right hand side
+ * @tparam T_y0 Type of initial state
+ * @tparam T_t0 Type of initial time
+ * @tparam T_ts Type of output times
+ * @tparam T_Args Types of pass-through parameters
+ *
+ * @param function_name Calling function name (for printing debugging messages)
+ * @param f Right hand side of the ODE
+ * @param y0 Initial state
+ * @param t0 Initial time
+ * @param ts Times at which to solve the ODE at. All values must be sorted and
+ *   greater than t0.
+ * @param relative_tolerance_forward Relative tolerance of the forward solve
+ * @param absolute_tolerance_forward Absolute tolerance of the forward solve
+ * @param relative_tolerance_backward Relative tolerance of the adjoint
+ *   states in the backward solve
+ * @param absolute_tolerance_backward Absolute tolerance of the adjoint
+ *   states in the backward solve
+ * @param relative_tolerance_quadrature Relative tolerance of the adjoints
+ *   of the parameters in the backward solve
+ * @param absolute_tolerance_quadrature Absolute tolerance of the adjoints
+ *   of the parameters in the backward solve
+ * @param max_num_steps Upper limit on the number of integration steps to
+ *   take between each output (error if exceeded)
+ * @param num_steps_between_checkpoints Number of integration steps between
+ *   two checkpoints of the forward solve
+ * @param interpolation_polynomial Interpolation of the forward solution
+ *   between checkpoints (1: Hermite, 2: polynomial)
+ * @param solver_forward Method of the forward solve (1: Adams, 2: BDF)
+ * @param solver_backward Method of the backward solve (1: Adams, 2: BDF)
+ * @param[in, out] msgs the print stream for warning messages
+ * @param args Extra arguments passed unmodified through to ODE right hand side
+ * @return Solution to ODE at times \p ts
+ * @throw <code>std::domain_error</code> if y0, t0, ts, or args are not
+ *   finite, all elements of ts are not greater than t0, or ts is not
+ *   sorted.
+ * @throw <code>std::invalid_argument</code> if arguments are the wrong
+ *   size or tolerances, max_num_steps, num_steps_between_checkpoints,
+ *   interpolation_polynomial, solver_forward or solver_backward are
+ *   out of range.
+ */
+template <typename F, typename T_y0, typename T_t0, typename T_ts,
+          typename... T_Args, require_eigen_col_vector_t<T_y0>* = nullptr>
+std::vector<Eigen::Matrix<stan::return_type_t<T_y0, T_t0, T_ts, T_Args...>,
+                          Eigen::Dynamic, 1>>
+ode_adjoint_impl(const char* function_name, const F& f, const T_y0& y0,
+                 const T_t0& t0, const std::vector<T_ts>& ts,
+                 double relative_tolerance_forward,
+                 double absolute_tolerance_forward,
+                 double relative_tolerance_backward,
+                 double absolute_tolerance_backward,
+                 double relative_tolerance_quadrature,
+                 double absolute_tolerance_quadrature,
+                 long int max_num_steps,                  // NOLINT(runtime/int)
+                 long int num_steps_between_checkpoints,  // NOLINT(runtime/int)
+                 int interpolation_polynomial, int solver_forward,
+                 int solver_backward, std::ostream* msgs,
+                 const T_Args&... args) {
+  const auto& args_ref_tuple = std::make_tuple(to_ref(args)...);
+  return apply(
+      [&](const auto&... args_refs) {
+        check_finite(function_name, "initial state", y0);
+        check_finite(function_name, "initial time", t0);
+        check_finite(function_name, "times", ts);
+
+        // Code from: https://stackoverflow.com/a/17340003 . Should probably do
+        // something better
+        std::vector<int> unused_temp{
+            0, (check_finite(function_name, "ode parameters and data",
+                             args_refs),
+                0)...};
+
+        check_nonzero_size(function_name, "times", ts);
+        check_nonzero_size(function_name, "initial state", y0);
+        check_sorted(function_name, "times", ts);
+        check_less(function_name, "initial time", t0, ts[0]);
+        check_positive_finite(function_name, "relative_tolerance_forward",
+                              relative_tolerance_forward);
+        check_positive_finite(function_name, "absolute_tolerance_forward",
+                              absolute_tolerance_forward);
+        check_positive_finite(function_name, "relative_tolerance_backward",
+                              relative_tolerance_backward);
+        check_positive_finite(function_name, "absolute_tolerance_backward",
+                              absolute_tolerance_backward);
+        check_positive_finite(function_name, "relative_tolerance_quadrature",
+                              relative_tolerance_quadrature);
+        check_positive_finite(function_name, "absolute_tolerance_quadrature",
+                              absolute_tolerance_quadrature);
+        check_positive(function_name, "max_num_steps", max_num_steps);
+        check_positive(function_name, "num_steps_between_checkpoints",
+                       num_steps_between_checkpoints);
+        check_bounded(function_name, "interpolation_polynomial",
+                      interpolation_polynomial, CV_HERMITE, CV_POLYNOMIAL);
+        check_bounded(function_name, "solver_forward", solver_forward,
+                      CV_ADAMS, CV_BDF);
+        check_bounded(function_name, "solver_backward", solver_backward,
+                      CV_ADAMS, CV_BDF);
+
+        auto* integrator
+            = new cvodes_integrator_adjoint<F, plain_type_t<T_y0>, T_t0, T_ts,
+                                            ref_type_t<T_Args>...>(
+                function_name, f, y0, t0, ts, relative_tolerance_forward,
+                absolute_tolerance_forward, relative_tolerance_backward,
+                absolute_tolerance_backward, relative_tolerance_quadrature,
+                absolute_tolerance_quadrature, max_num_steps,
+                num_steps_between_checkpoints, interpolation_polynomial,
+                solver_forward, solver_backward, msgs, args_refs...);
+
+        return (*integrator)();
+      },
+      args_ref_tuple);
+}
+
+/**
+ * Solve the ODE initial value problem y' = f(t, y), y(t0) = y0 at a set of
+ * times, { t1, t2, t3, ... } using CVODES, computing the sensitivities
+ * with the adjoint method in the reverse pass of autodiff, with full
+ * control over the tolerances and the checkpointing of the backward
+ * solve.
+ *
+ * The forward sensitivities of `ode_bdf()` add N states per parameter or
+ * initial state to the N states of the ODE, while the adjoint method
+ * solves the ODE forward and then N adjoint states and one quadrature
+ * per parameter backward, so that it is much faster for large systems
+ * with many parameters.
+ *
+ * \p f must define an operator() with the signature as:
+ *   template<typename T_t, typename T_y, typename... T_Args>
+ *   Eigen::Matrix<stan::return_type_t<T_t, T_y, T_Args...>, Eigen::Dynamic, 1>
+ *     operator()(const T_t& t, const Eigen::Matrix<T_y, Eigen::Dynamic, 1>& y,
+ *     std::ostream* msgs, const T_Args&... args);
+ *
+ * t is the time, y is the vector-valued state, msgs is a stream for error
+ * messages, and args are optional arguments passed to the ODE solve function
+ * (which are passed through to \p f without modification).
+ *
+ * @tparam F Type of ODE right hand side
+ * @tparam T_y0 Type of initial state
+ * @tparam T_t0 Type of initial time
+ * @tparam T_ts Type of output times
+ * @tparam T_Args Types of pass-through parameters
+ *
+ * @param f Right hand side of the ODE
+ * @param y0 Initial state
+ * @param t0 Initial time
+ * @param ts Times at which to solve the ODE at. All values must be sorted and
+ *   greater than t0.
+ * @param relative_tolerance_forward Relative tolerance of the forward solve
+ * @param absolute_tolerance_forward Absolute tolerance of the forward solve
+ * @param relative_tolerance_backward Relative tolerance of the adjoint
+ *   states in the backward solve
+ * @param absolute_tolerance_backward Absolute tolerance of the adjoint
+ *   states in the backward solve
+ * @param relative_tolerance_quadrature Relative tolerance of the adjoints
+ *   of the parameters in the backward solve
+ * @param absolute_tolerance_quadrature Absolute tolerance of the adjoints
+ *   of the parameters in the backward solve
+ * @param max_num_steps Upper limit on the number of integration steps to
+ *   take between each output (error if exceeded)
+ * @param num_steps_between_checkpoints Number of integration steps between
+ *   two checkpoints of the forward solve
+ * @param interpolation_polynomial Interpolation of the forward solution
+ *   between checkpoints (1: Hermite, 2: polynomial)
+ * @param solver_forward Method of the forward solve (1: Adams, 2: BDF)
+ * @param solver_backward Method of the backward solve (1: Adams, 2: BDF)
+ * @param[in, out] msgs the print stream for warning messages
+ * @param args Extra arguments passed unmodified through to ODE right hand side
+ * @return Solution to ODE at times \p ts
+ */
+template <typename F, typename T_y0, typename T_t0, typename T_ts,
+          typename... T_Args, require_eigen_col_vector_t<T_y0>* = nullptr>
+std::vector<Eigen::Matrix<stan::return_type_t<T_y0, T_t0, T_ts, T_Args...>,
+                          Eigen::Dynamic, 1>>
+ode_adjoint_tol_ctl(const F& f, const T_y0& y0, const T_t0& t0,
+                    const std::vector<T_ts>& ts,
+                    double relative_tolerance_forward,
+                    double absolute_tolerance_forward,
+                    double relative_tolerance_backward,
+                    double absolute_tolerance_backward,
+                    double relative_tolerance_quadrature,
+                    double absolute_tolerance_quadrature,
+                    long int max_num_steps,  // NOLINT(runtime/int)
+                    long int num_steps_between_checkpoints,  // NOLINT
+                    int interpolation_polynomial, int solver_forward,
+                    int solver_backward, std::ostream* msgs,
+                    const T_Args&... args) {
+  return ode_adjoint_impl(
+      "ode_adjoint_tol_ctl", f, y0, t0, ts, relative_tolerance_forward,
+      absolute_tolerance_forward, relative_tolerance_backward,
+      absolute_tolerance_backward, relative_tolerance_quadrature,
+      absolute_tolerance_quadrature, max_num_steps,
+      num_steps_between_checkpoints, interpolation_polynomial, solver_forward,
+      solver_backward, msgs, args...);
+}
+
+/**
+ * Solve the ODE initial value problem y' = f(t, y), y(t0) = y0 at a set of
+ * times, { t1, t2, t3, ... } using the stiff backward differentiation formula
+ * (BDF) solver in CVODES, computing the sensitivities with the adjoint
+ * method in the reverse pass of autodiff.
+ *
+ * The backward solve uses the tolerances of the forward solve, BDF, and
+ * a Hermite interpolation of the forward solution between checkpoints
+ * which are 150 steps apart; see `ode_adjoint_tol_ctl()` to change
+ * these.
+ *
+ * \p f must define an operator() with the signature as:
+ *   template<typename T_t, typename T_y, typename... T_Args>
+ *   Eigen::Matrix<stan::return_type_t<T_t, T_y, T_Args...>, Eigen::Dynamic, 1>
+ *     operator()(const T_t& t, const Eigen::Matrix<T_y, Eigen::Dynamic, 1>& y,
+ *     std::ostream* msgs, const T_Args&... args);
+ *
+ * t is the time, y is the vector-valued state, msgs is a stream for error
+ * messages, and args are optional arguments passed to the ODE solve function
+ * (which are passed through to \p f without modification).
+ *
+ * @tparam F Type of ODE right hand side
+ * @tparam T_y0 Type of initial state
+ * @tparam T_t0 Type of initial time
+ * @tparam T_ts Type of output times
+ * @tparam T_Args Types of pass-through parameters
+ *
+ * @param f Right hand side of the ODE
+ * @param y0 Initial state
+ * @param t0 Initial time
+ * @param ts Times at which to solve the ODE at. All values must be sorted and
+ *   greater than t0.
+ * @param relative_tolerance Relative tolerance passed to CVODES
+ * @param absolute_tolerance Absolute tolerance passed to CVODES
+ * @param max_num_steps Upper limit on the number of integration steps to
+ *   take between each output (error if exceeded)
+ * @param[in, out] msgs the print stream for warning messages
+ * @param args Extra arguments passed unmodified through to ODE right hand side
+ * @return Solution to ODE at times \p ts
+ */
+template <typename F, typename T_y0, typename T_t0, typename T_ts,
+          typename... T_Args, require_eigen_col_vector_t<T_y0>* = nullptr>
+std::vector<Eigen::Matrix<stan::return_type_t<T_y0, T_t0, T_ts, T_Args...>,
+                          Eigen::Dynamic, 1>>
+ode_adjoint_tol(const F& f, const T_y0& y0, const T_t0& t0,
+                const std::vector<T_ts>& ts, double relative_tolerance,
+                double absolute_tolerance,
+                long int max_num_steps,  // NOLINT(runtime/int)
+                std::ostream* msgs, const T_Args&... args) {
+  long int num_steps_between_checkpoints = 150;  // NOLINT(runtime/int)
+
+  return ode_adjoint_impl("ode_adjoint_tol", f, y0, t0, ts, relative_tolerance,
+                          absolute_tolerance, relative_tolerance,
+                          absolute_tolerance, relative_tolerance,
+                          absolute_tolerance, max_num_steps,
+                          num_steps_between_checkpoints, CV_HERMITE, CV_BDF,
+                          CV_BDF, msgs, args...);
+}
+
+}  // namespace math
+}  // namespace stan
+#endif
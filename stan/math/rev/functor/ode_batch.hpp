@@ -0,0 +1,427 @@
+#ifndef STAN_MATH_REV_FUNCTOR_ODE_BATCH_HPP
+#define STAN_MATH_REV_FUNCTOR_ODE_BATCH_HPP
+
+#include <stan/math/rev/meta.hpp>
+#include <stan/math/rev/core.hpp>
+#include <stan/math/rev/functor/ode_bdf.hpp>
+#include <stan/math/prim/core/parallel_region.hpp>
+#include <stan/math/prim/err.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <stan/math/prim/functor/apply.hpp>
+#include <stan/math/prim/functor/ode_rk45.hpp>
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace stan {
+namespace math {
+namespace internal {
+
+/**
+ * Solution of the ODE of one subject of a batch, computed on a worker
+ * thread: the states at the output times and, if any argument is a
+ * `var`, the gradients of every state with respect to the `var`s of
+ * the arguments of the subject.
+ */
+struct ode_batch_solution {
+  std::vector<Eigen::VectorXd> values_;
+  // column major: the gradient of the kth output is the kth column
+  Eigen::MatrixXd gradients_;
+  std::string msgs_;
+};
+
+/**
+ * Store the solution of an ODE with `double` arguments.
+ *
+ * @param y states at the output times
+ * @param[out] solution solution of the subject
+ * @param args arguments of the solve
+ */
+template <typename... Args>
+inline void ode_batch_store(const std::vector<Eigen::VectorXd>& y,
+                            ode_batch_solution& solution,
+                            const Args&... args) {
+  solution.values_ = y;
+}
+
+/**
+ * Store the solution of an ODE with `var` arguments, with the gradients
+ * of the states.
+ *
+ * The states are the precomputed gradients varis of the sensitivities
+ * of the solver (see `ode_store_sensitivities()`), whose operands are
+ * the `var`s of the arguments, so the gradient of a state is read by
+ * chaining its vari alone into the zeroed adjoints of the arguments,
+ * without any reverse pass over the tape.
+ *
+ * @param y states at the output times
+ * @param[out] solution solution of the subject
+ * @param args `var`s of the solve, in the order of `count_vars()`
+ */
+template <typename... Args>
+inline void ode_batch_store(
+    const std::vector<Eigen::Matrix<var, Eigen::Dynamic, 1>>& y,
+    ode_batch_solution& solution, const Args&... args) {
+  const size_t num_vars = count_vars(args...);
+  const size_t N = y.empty() ? 0 : y[0].size();
+  std::vector<vari*> varis(num_vars);
+  save_varis(varis.data(), args...);
+  solution.values_.resize(y.size());
+  solution.gradients_.resize(num_vars, y.size() * N);
+  for (size_t n = 0; n < y.size(); ++n) {
+    solution.values_[n] = value_of(y[n]);
+    for (size_t i = 0; i < N; ++i) {
+      for (vari* vi : varis) {
+        vi->adj_ = 0.0;
+      }
+      vari* state = y[n].coeff(i).vi_;
+      state->adj_ = 1.0;
+      state->chain();
+      for (size_t k = 0; k < num_vars; ++k) {
+        solution.gradients_.coeffRef(k, n * N + i) = varis[k]->adj_;
+      }
+    }
+  }
+}
+
+/**
+ * Build the output of a subject of a batch with `double` arguments.
+ */
+template <typename T_return, typename... Args,
+          require_arithmetic_t<T_return>* = nullptr>
+inline std::vector<Eigen::VectorXd> ode_batch_output(
+    ode_batch_solution& solution, const Args&... args) {
+  return std::move(solution.values_);
+}
+
+/**
+ * Build the output of a subject of a batch with `var` arguments on the
+ * AD tape of the calling thread, whose states have the precomputed
+ * gradients with respect to the `var`s of the arguments of the subject.
+ *
+ * @param solution solution of the subject
+ * @param args arguments of the subject, in the order of `count_vars()`
+ */
+template <typename T_return, typename... Args,
+          require_var_t<T_return>* = nullptr>
+inline std::vector<Eigen::Matrix<var, Eigen::Dynamic, 1>> ode_batch_output(
+    const ode_batch_solution& solution, const Args&... args) {
+  const size_t num_vars = count_vars(args...);
+  const size_t num_outputs = solution.gradients_.cols();
+  vari** varis
+      = ChainableStack::instance_->memalloc_.alloc_array<vari*>(num_vars);
+  save_varis(varis, args...);
+  double* gradients = ChainableStack::instance_->memalloc_.alloc_array<double>(
+      num_vars * num_outputs);
+  Eigen::Map<Eigen::MatrixXd>(gradients, num_vars, num_outputs)
+      = solution.gradients_;
+
+  std::vector<Eigen::Matrix<var, Eigen::Dynamic, 1>> y(
+      solution.values_.size());
+  for (size_t n = 0; n < y.size(); ++n) {
+    const size_t N = solution.values_[n].size();
+    y[n].resize(N);
+    for (size_t i = 0; i < N; ++i) {
+      y[n](i) = new precomputed_gradients_vari(
+          solution.values_[n](i), num_vars, varis,
+          gradients + (n * N + i) * num_vars);
+    }
+  }
+  return y;
+}
+
+/**
+ * Solve a batch of independent ODE initial value problems in parallel.
+ *
+ * Every subject is solved by a task of the TBB on the AD tape of the
+ * thread which executes it, nested, so that the arena memory of the
+ * tape is reused by the next subjects of the thread. The arguments of
+ * the subject are copied onto the nested tape, and the sensitivities of
+ * its states are extracted into plain gradients before the nested tape
+ * is recovered. Once all the subjects are solved, their states are
+ * written onto the AD tape of the caller in one step, as precomputed
+ * gradients of the arguments. Without `STAN_THREADS`, the subjects are
+ * solved one after the other.
+ *
+ * @tparam Solve type of the solver of one subject
+ * @tparam T_y0 type of the initial states
+ * @tparam T_t0 type of the initial times
+ * @tparam T_ts type of the output times
+ * @tparam T_Args types of the pass-through arguments
+ * @param function_name name of the calling function
+ * @param solve solver of one subject, called with the initial state,
+ * initial time, output times, the print stream and the pass-through
+ * arguments of the subject
+ * @param y0 initial state of every subject
+ * @param t0 initial time of every subject
+ * @param ts output times of every subject
+ * @param[in, out] msgs the print stream for warning messages, to which
+ * the messages of the subjects are written in order
+ * @param args pass-through arguments of every subject
+ * @return states of every subject at its output times
+ * @throw std::invalid_argument if the numbers of subjects of the
+ * arguments do not match, and any exception of the solver
+ */
+template <typename Solve, typename T_y0, typename T_t0, typename T_ts,
+          typename... T_Args>
+std::vector<
+    std::vector<Eigen::Matrix<return_type_t<T_y0, T_t0, T_ts, T_Args...>,
+                              Eigen::Dynamic, 1>>>
+ode_batch_impl(const char* function_name, const Solve& solve,
+               const std::vector<T_y0>& y0, const std::vector<T_t0>& t0,
+               const std::vector<std::vector<T_ts>>& ts, std::ostream* msgs,
+               const std::vector<T_Args>&... args) {
+  using T_return = return_type_t<T_y0, T_t0, T_ts, T_Args...>;
+  const size_t num_subjects = y0.size();
+  check_size_match(function_name, "number of initial times", t0.size(),
+                   "number of initial states", num_subjects);
+  check_size_match(function_name, "number of output times", ts.size(),
+                   "number of initial states", num_subjects);
+  static_cast<void>(std::initializer_list<int>{
+      (check_size_match(function_name, "number of arguments", args.size(),
+                        "number of initial states", num_subjects),
+       0)...});
+
+  std::vector<ode_batch_solution> solutions(num_subjects);
+  auto execute_chunk = [&](size_t start, size_t end) {
+    const parallel_task_scope task;
+    for (size_t k = start; k != end; ++k) {
+      // Run nested autodiff in this scope
+      nested_rev_autodiff nested;
+      std::stringstream subject_msgs;
+      auto local_args = std::make_tuple(deep_copy_vars(y0[k]),
+                                        deep_copy_vars(t0[k]),
+                                        deep_copy_vars(ts[k]),
+                                        deep_copy_vars(args[k])...);
+      apply(
+          [&](const auto& y0_k, const auto& t0_k, const auto& ts_k,
+              const auto&... args_k) {
+            ode_batch_store(solve(y0_k, t0_k, ts_k,
+                                  msgs ? &subject_msgs : nullptr, args_k...),
+                            solutions[k], y0_k, t0_k, ts_k, args_k...);
+          },
+          local_args);
+      solutions[k].msgs_ = subject_msgs.str();
+    }
+  };
+
+#ifdef STAN_THREADS
+  // the subjects run in an isolated region, as in map_rect_concurrent
+  run_parallel_region([&] {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_subjects),
+                      [&](const tbb::blocked_range<size_t>& r) {
+                        execute_chunk(r.begin(), r.end());
+                      });
+  });
+#else
+  execute_chunk(0, num_subjects);
+#endif
+
+  std::vector<std::vector<Eigen::Matrix<T_return, Eigen::Dynamic, 1>>> y;
+  y.reserve(num_subjects);
+  for (size_t k = 0; k < num_subjects; ++k) {
+    if (msgs) {
+      *msgs << solutions[k].msgs_;
+    }
+    y.emplace_back(
+        ode_batch_output<T_return>(solutions[k], y0[k], t0[k], ts[k],
+                                   args[k]...));
+  }
+  return y;
+}
+
+}  // namespace internal
+
+/**
+ * Solve a batch of independent ODE initial value problems
+ * y_k' = f(t, y_k, args_k), y_k(t0_k) = y0_k, one per subject k, at the
+ * output times ts_k of every subject, using the stiff backward
+ * differentiation formula BDF solver from CVODES.
+ *
+ * The subjects are solved in parallel by the TBB if `STAN_THREADS` is
+ * defined, each on the AD tape of its thread, and their sensitivities
+ * are written onto the AD tape of the caller in one step (see
+ * `internal::ode_batch_impl()`). This replaces one call of
+ * `ode_bdf_tol()` per subject, which solves the subjects one after the
+ * other on the tape of the caller.
+ *
+ * \p f must be callable as for `ode_bdf_tol()`, with the arguments of
+ * one subject.
+ *
+ * @tparam F Type of ODE right hand side
+ * @tparam T_y0 Type of initial states
+ * @tparam T_t0 Type of initial times
+ * @tparam T_ts Type of output times
+ * @tparam T_Args Types of pass-through parameters
+ *
+ * @param f Right hand side of the ODE
+ * @param y0 Initial state of every subject
+ * @param t0 Initial time of every subject
+ * @param ts Times at which to solve the ODE of every subject. All values
+ *   must be sorted and not less than the initial time of the subject.
+ * @param relative_tolerance Relative tolerance passed to CVODES
+ * @param absolute_tolerance Absolute tolerance passed to CVODES
+ * @param max_num_steps Upper limit on the number of integration steps to
+ *   take between each output (error if exceeded)
+ * @param[in, out] msgs the print stream for warning messages
+ * @param args Extra arguments of every subject passed unmodified through
+ *   to ODE right hand side
+ * @return Solution of the ODE of every subject at its times
+ */
+template <typename F, typename T_y0, typename T_t0, typename T_ts,
+          typename... T_Args, require_eigen_col_vector_t<T_y0>* = nullptr>
+std::vector<
+    std::vector<Eigen::Matrix<return_type_t<T_y0, T_t0, T_ts, T_Args...>,
+                              Eigen::Dynamic, 1>>>
+ode_bdf_batch_tol(const F& f, const std::vector<T_y0>& y0,
+                  const std::vector<T_t0>& t0,
+                  const std::vector<std::vector<T_ts>>& ts,
+                  double relative_tolerance, double absolute_tolerance,
+                  long int max_num_steps,  // NOLINT(runtime/int)
+                  std::ostream* msgs, const std::vector<T_Args>&... args) {
+  return internal::ode_batch_impl(
+      "ode_bdf_batch_tol",
+      [&](const auto& y0_k, const auto& t0_k, const auto& ts_k,
+          std::ostream* msgs_k, const auto&... args_k) {
+        return ode_bdf_tol_impl("ode_bdf_batch_tol", f, y0_k, t0_k, ts_k,
+                                relative_tolerance, absolute_tolerance,
+                                max_num_steps, msgs_k, args_k...);
+      },
+      y0, t0, ts, msgs, args...);
+}
+
+/**
+ * Solve a batch of independent ODE initial value problems with the BDF
+ * solver of CVODES (see `ode_bdf_batch_tol()`) with the defaults of
+ * `ode_bdf()` for relative_tolerance, absolute_tolerance, and
+ * max_num_steps.
+ *
+ * @tparam F Type of ODE right hand side
+ * @tparam T_y0 Type of initial states
+ * @tparam T_t0 Type of initial times
+ * @tparam T_ts Type of output times
+ * @tparam T_Args Types of pass-through parameters
+ *
+ * @param f Right hand side of the ODE
+ * @param y0 Initial state of every subject
+ * @param t0 Initial time of every subject
+ * @param ts Times at which to solve the ODE of every subject
+ * @param[in, out] msgs the print stream for warning messages
+ * @param args Extra arguments of every subject passed unmodified through
+ *   to ODE right hand side
+ * @return Solution of the ODE of every subject at its times
+ */
+template <typename F, typename T_y0, typename T_t0, typename T_ts,
+          typename... T_Args, require_eigen_col_vector_t<T_y0>* = nullptr>
+std::vector<
+    std::vector<Eigen::Matrix<return_type_t<T_y0, T_t0, T_ts, T_Args...>,
+                              Eigen::Dynamic, 1>>>
+ode_bdf_batch(const F& f, const std::vector<T_y0>& y0,
+              const std::vector<T_t0>& t0,
+              const std::vector<std::vector<T_ts>>& ts, std::ostream* msgs,
+              const std::vector<T_Args>&... args) {
+  double relative_tolerance = 1e-10;
+  double absolute_tolerance = 1e-10;
+  long int max_num_steps = 1e8;  // NOLINT(runtime/int)
+
+  return ode_bdf_batch_tol(f, y0, t0, ts, relative_tolerance,
+                           absolute_tolerance, max_num_steps, msgs, args...);
+}
+
+/**
+ * Solve a batch of independent ODE initial value problems
+ * y_k' = f(t, y_k, args_k), y_k(t0_k) = y0_k, one per subject k, at the
+ * output times ts_k of every subject, using the non-stiff Runge-Kutta 45
+ * solver in Boost.
+ *
+ * The subjects are solved in parallel as by `ode_bdf_batch_tol()`.
+ *
+ * @tparam F Type of ODE right hand side
+ * @tparam T_y0 Type of initial states
+ * @tparam T_t0 Type of initial times
+ * @tparam T_ts Type of output times
+ * @tparam T_Args Types of pass-through parameters
+ *
+ * @param f Right hand side of the ODE
+ * @param y0 Initial state of every subject
+ * @param t0 Initial time of every subject
+ * @param ts Times at which to solve the ODE of every subject. All values
+ *   must be sorted and not less than the initial time of the subject.
+ * @param relative_tolerance Relative tolerance passed to Boost
+ * @param absolute_tolerance Absolute tolerance passed to Boost
+ * @param max_num_steps Upper limit on the number of integration steps to
+ *   take between each output (error if exceeded)
+ * @param[in, out] msgs the print stream for warning messages
+ * @param args Extra arguments of every subject passed unmodified through
+ *   to ODE right hand side
+ * @return Solution of the ODE of every subject at its times
+ */
+template <typename F, typename T_y0, typename T_t0, typename T_ts,
+          typename... T_Args, require_eigen_col_vector_t<T_y0>* = nullptr>
+std::vector<
+    std::vector<Eigen::Matrix<return_type_t<T_y0, T_t0, T_ts, T_Args...>,
+                              Eigen::Dynamic, 1>>>
+ode_rk45_batch_tol(const F& f, const std::vector<T_y0>& y0,
+                   const std::vector<T_t0>& t0,
+                   const std::vector<std::vector<T_ts>>& ts,
+                   double relative_tolerance, double absolute_tolerance,
+                   long int max_num_steps,  // NOLINT(runtime/int)
+                   std::ostream* msgs, const std::vector<T_Args>&... args) {
+  return internal::ode_batch_impl(
+      "ode_rk45_batch_tol",
+      [&](const auto& y0_k, const auto& t0_k, const auto& ts_k,
+          std::ostream* msgs_k, const auto&... args_k) {
+        return ode_rk45_tol_impl("ode_rk45_batch_tol", f, y0_k, t0_k, ts_k,
+                                 relative_tolerance, absolute_tolerance,
+                                 max_num_steps, msgs_k, args_k...);
+      },
+      y0, t0, ts, msgs, args...);
+}
+
+/**
+ * Solve a batch of independent ODE initial value problems with the
+ * Runge-Kutta 45 solver in Boost (see `ode_rk45_batch_tol()`) with the
+ * defaults of `ode_rk45()` for relative_tolerance, absolute_tolerance,
+ * and max_num_steps.
+ *
+ * @tparam F Type of ODE right hand side
+ * @tparam T_y0 Type of initial states
+ * @tparam T_t0 Type of initial times
+ * @tparam T_ts Type of output times
+ * @tparam T_Args Types of pass-through parameters
+ *
+ * @param f Right hand side of the ODE
+ * @param y0 Initial state of every subject
+ * @param t0 Initial time of every subject
+ * @param ts Times at which to solve the ODE of every subject
+ * @param[in, out] msgs the print stream for warning messages
+ * @param args Extra arguments of every subject passed unmodified through
+ *   to ODE right hand side
+ * @return Solution of the ODE of every subject at its times
+ */
+template <typename F, typename T_y0, typename T_t0, typename T_ts,
+          typename... T_Args, require_eigen_col_vector_t<T_y0>* = nullptr>
+std::vector<
+    std::vector<Eigen::Matrix<return_type_t<T_y0, T_t0, T_ts, T_Args...>,
+                              Eigen::Dynamic, 1>>>
+ode_rk45_batch(const F& f, const std::vector<T_y0>& y0,
+               const std::vector<T_t0>& t0,
+               const std::vector<std::vector<T_ts>>& ts, std::ostream* msgs,
+               const std::vector<T_Args>&... args) {
+  double relative_tolerance = 1e-6;
+  double absolute_tolerance = 1e-6;
+  long int max_num_steps = 1e6;  // NOLINT(runtime/int)
+
+  return ode_rk45_batch_tol(f, y0, t0, ts, relative_tolerance,
+                            absolute_tolerance, max_num_steps, msgs, args...);
+}
+
+}  // namespace math
+}  // namespace stan
+#endif
@@ -0,0 +1,119 @@
+#ifndef STAN_MATH_REV_FUNCTOR_PARALLEL_MAP_HPP
+#define STAN_MATH_REV_FUNCTOR_PARALLEL_MAP_HPP
+
+#include <stan/math/prim/meta.hpp>
+#include <stan/math/prim/err.hpp>
+#include <stan/math/prim/core/parallel_region.hpp>
+#include <stan/math/prim/functor/apply.hpp>
+#include <stan/math/prim/functor/parallel_map.hpp>
+#include <stan/math/rev/core.hpp>
+
+#include <tbb/task_arena.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+#include <algorithm>
+#include <ostream>
+#include <sstream>
+#include <tuple>
+#include <vector>
+
+namespace stan {
+namespace math {
+
+/**
+ * Return the results of applying the function to every job index,
+ * `f(i, msgs, args...)` for `i` in `[0, num_jobs)`.
+ *
+ * The jobs are split in chunks of `grainsize` consecutive jobs. Each
+ * chunk is recorded on its own AD tape, using its own copies of the
+ * shared arguments, and the chunks are independent segments of the AD
+ * tape (see `independent_tape_segments`): both their forward passes
+ * and, when the gradient is computed, their reverse passes run in
+ * parallel on the TBB arena if `STAN_THREADS` is defined. The
+ * adjoints of the shared arguments are accumulated in the order of the
+ * chunks, so the gradients do not depend on the scheduling.
+ *
+ * Unlike `reduce_sum`, which computes the gradient of each partial sum
+ * during the forward pass, the reverse passes of the chunks are only
+ * run when the gradient is computed, so the results can be used as
+ * any other var.
+ *
+ * @tparam F Type of function returning a scalar
+ * @tparam Args Types of shared arguments
+ * @param f Function
+ * @param num_jobs number of jobs
+ * @param grainsize number of consecutive jobs evaluated together
+ * @param[in, out] msgs the print stream for warning messages
+ * @param args shared arguments
+ * @return results of the jobs
+ * @throw std::domain_error if grainsize is not positive
+ */
+template <typename F, typename... Args,
+          require_any_st_var<Args...>* = nullptr>
+inline std::vector<var> parallel_map(const F& f, int num_jobs, int grainsize,
+                                     std::ostream* msgs, const Args&... args) {
+  static constexpr const char* function = "parallel_map";
+  check_nonnegative(function, "number of jobs", num_jobs);
+  check_positive(function, "grainsize", grainsize);
+
+  const int num_chunks = (num_jobs + grainsize - 1) / grainsize;
+  const size_t num_inputs = count_vars(args...);
+  vari** inputs
+      = ChainableStack::instance_->memalloc_.alloc_array<vari*>(num_inputs);
+  save_varis(inputs, args...);
+  auto* segments
+      = new independent_tape_segments(num_chunks, inputs, num_inputs);
+
+  std::vector<std::stringstream> chunk_msgs(num_chunks);
+  auto execute_chunk = [&](int k) {
+    const parallel_task_scope task;
+    segments->record(k, [&](independent_tape_segment& segment) {
+      auto local_args = std::make_tuple(deep_copy_vars(args)...);
+      segment.local_inputs_.resize(num_inputs);
+      apply(
+          [&](const auto&... local_args) {
+            save_varis(segment.local_inputs_.data(), local_args...);
+          },
+          local_args);
+      const int end = std::min(num_jobs, (k + 1) * grainsize);
+      for (int i = k * grainsize; i < end; ++i) {
+        var res = apply(
+            [&](const auto&... local_args) {
+              return f(i, &chunk_msgs[k], local_args...);
+            },
+            local_args);
+        segment.local_outputs_.push_back(res.vi_);
+      }
+    });
+  };
+#ifdef STAN_THREADS
+  // we must use task isolation as in reduce_sum, since the AD tape of
+  // a thread is swapped while it records a chunk
+  run_parallel_region([&] {
+    tbb::parallel_for(tbb::blocked_range<int>(0, num_chunks),
+                      [&](const tbb::blocked_range<int>& r) {
+                        for (int k = r.begin(); k != r.end(); ++k) {
+                          execute_chunk(k);
+                        }
+                      });
+  });
+#else
+  for (int k = 0; k < num_chunks; ++k) {
+    execute_chunk(k);
+  }
+#endif
+  if (msgs) {
+    for (const auto& chunk_msg : chunk_msgs) {
+      *msgs << chunk_msg.str();
+    }
+  }
+
+  std::vector<vari*> outputs = segments->finish();
+  return std::vector<var>(outputs.begin(), outputs.end());
+}
+
+}  // namespace math
+}  // namespace stan
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef STAN_MATH_REV_FUNCTOR_PRIVATE_TAPE_GRADIENT_HPP
+#define STAN_MATH_REV_FUNCTOR_PRIVATE_TAPE_GRADIENT_HPP
+
+#include <stan/math/rev/meta.hpp>
+#include <stan/math/rev/core.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <cmath>
+#include <cstddef>
+#include <typeinfo>
+#include <vector>
+
+namespace stan {
+namespace math {
+
+/**
+ * Functor computing the value and gradient of a function repeatedly,
+ * for new arguments, by replaying an expression graph recorded once on
+ * an AD tape owned by the functor.
+ *
+ * The first evaluation records the expression graph of the function on
+ * the private tape of the functor. If the graph consists only of the
+ * operations of the compact tape (see `STAN_COMPACT_TAPE`) applied to
+ * the argument, later evaluations for an argument of the same size
+ * replay it: the values of the argument and the values and partials of
+ * the recorded operations are updated in place, in the order in which
+ * they were recorded, and the reverse pass is run over the same tape.
+ * No vari is constructed, no memory is requested and only one virtual
+ * call per range of the compact tape is made.
+ *
+ * Replaying assumes that the function records the same operations for
+ * every argument. To fall back to recording safely when it does not, for
+ * instance because it branches on the values of its argument, every
+ * evaluation also applies the function to the <code>double</code>
+ * argument, which checks the argument as usual, and the graph is
+ * recorded again if the replayed value differs from the value of the
+ * function (up to a relative tolerance of 1e-12). Graphs which cannot be
+ * replayed, because they use other operations or the build does not
+ * define `STAN_COMPACT_TAPE`, are recorded again on every evaluation,
+ * still on the private tape, whose arena blocks and stacks are then
+ * reused as they are. Neither the global (or thread local) AD tape nor
+ * its nesting state is touched.
+ *
+ * The functor must implement
+ *
+ * <code>
+ * T operator()(const Eigen::Matrix<T, Eigen::Dynamic, 1>&)
+ * </code>
+ *
+ * for <code>T</code> being <code>var</code> as described for
+ * <code>gradient()</code> and <code>double</code>.
+ *
+ * Instances are not thread safe; use one instance per thread.
+ *
+ * @tparam F Type of function
+ */
+template <typename F>
+class private_tape_gradient {
+  F f_;
+  ScopedChainableStack tape_;
+  std::vector<vari*> x_vi_;
+  vari* fx_vi_{nullptr};
+  bool replayable_{false};
+  size_t n_evaluations_{0};
+  size_t n_recordings_{0};
+
+ public:
+  /**
+   * Construct the functor for the specified function. The tape is
+   * empty until the first evaluation.
+   *
+   * @param[in] f Function
+   */
+  explicit private_tape_gradient(const F& f) : f_(f) {}
+
+  /**
+   * Calculate the value and the gradient of the function at the
+   * specified argument.
+   *
+   * @param[in] x Argument to function
+   * @param[out] fx Function applied to argument
+   * @param[out] grad_fx Gradient of function at argument
+   */
+  void operator()(const Eigen::Matrix<double, Eigen::Dynamic, 1>& x,
+                  double& fx,
+                  Eigen::Matrix<double, Eigen::Dynamic, 1>& grad_fx) {
+    ++n_evaluations_;
+    const double fx_check = f_(x);
+    tape_.execute([&]() {
+      if (!(replayable_ && static_cast<size_t>(x.size()) == x_vi_.size()
+            && replay(x, fx_check))) {
+        record(x);
+      }
+      fx = fx_vi_->val_;
+      grad(fx_vi_);
+      grad_fx.resize(x.size());
+      for (Eigen::Index i = 0; i < x.size(); ++i) {
+        grad_fx.coeffRef(i) = x_vi_[i]->adj_;
+      }
+    });
+  }
+
+  /**
+   * Return the number of evaluations.
+   */
+  size_t num_evaluations() const noexcept { return n_evaluations_; }
+
+  /**
+   * Return the number of evaluations which recorded the expression graph
+   * instead of replaying it.
+   */
+  size_t num_recordings() const noexcept { return n_recordings_; }
+
+  /**
+   * Return whether the expression graph recorded last can be replayed.
+   */
+  bool replayable() const noexcept { return replayable_; }
+
+ private:
+  /**
+   * Record the expression graph of the function at the specified
+   * argument on the tape, which must be active, replacing the previous
+   * one.
+   *
+   * @param x argument
+   */
+  void record(const Eigen::Matrix<double, Eigen::Dynamic, 1>& x) {
+    ++n_recordings_;
+    // the graph stays incomplete if the function throws
+    replayable_ = false;
+    recover_memory();
+    x_vi_.resize(x.size());
+    for (Eigen::Index i = 0; i < x.size(); ++i) {
+      x_vi_[i] = new vari(x.coeff(i));
+    }
+    Eigen::Matrix<var, Eigen::Dynamic, 1> x_var(x.size());
+    for (Eigen::Index i = 0; i < x.size(); ++i) {
+      x_var.coeffRef(i) = var(x_vi_[i]);
+    }
+    fx_vi_ = f_(x_var).vi_;
+    replayable_ = is_replayable();
+  }
+
+  /**
+   * Return whether the var_stack of the tape, which must be active,
+   * holds only the argument followed by ranges of the compact tape and
+   * nothing is on the stack of non-chaining varis.
+   */
+  bool is_replayable() const {
+    const auto& stack = *ChainableStack::instance_;
+    if (!stack.var_nochain_stack_.empty()
+        || stack.var_stack_.size() < x_vi_.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < x_vi_.size(); ++i) {
+      if (stack.var_stack_[i] != x_vi_[i]) {
+        return false;
+      }
+    }
+    for (size_t i = x_vi_.size(); i < stack.var_stack_.size(); ++i) {
+      if (typeid(*stack.var_stack_[i])
+          != typeid(internal::compact_tape_range)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Replay the expression graph on the tape, which must be active, at the
+   * specified argument and reset all adjoints.
+   *
+   * @param x argument of the same size as the recorded one
+   * @param fx_check value of the function at the argument
+   * @return whether the replayed value matches the value of the function
+   */
+  bool replay(const Eigen::Matrix<double, Eigen::Dynamic, 1>& x,
+              double fx_check) {
+    for (Eigen::Index i = 0; i < x.size(); ++i) {
+      ::new (static_cast<void*>(x_vi_[i]))
+          vari(x.coeff(i), internal::unstacked_t{});
+    }
+    const auto& var_stack = ChainableStack::instance_->var_stack_;
+    for (size_t i = x_vi_.size(); i < var_stack.size(); ++i) {
+      static_cast<internal::compact_tape_range*>(var_stack[i])->replay();
+    }
+    return std::fabs(fx_vi_->val_ - fx_check)
+           <= 1e-12 * std::fmax(1.0, std::fabs(fx_check));
+  }
+};
+
+}  // namespace math
+}  // namespace stan
+#endif
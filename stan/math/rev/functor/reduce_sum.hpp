@@ -2,13 +2,16 @@
 #define STAN_MATH_REV_FUNCTOR_REDUCE_SUM_HPP
 
 #include <stan/math/prim/meta.hpp>
+#include <stan/math/prim/core/parallel_region.hpp>
 #include <stan/math/prim/functor.hpp>
 #include <stan/math/rev/core.hpp>
 
 #include <tbb/task_arena.h>
 #include <tbb/parallel_reduce.h>
 #include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
 
+#include <chrono>
 #include <tuple>
 #include <memory>
 #include <utility>
@@ -30,6 +33,12 @@ template <typename ReduceFunction, typename ReturnType, typename Vec,
           typename... Args>
 struct reduce_sum_impl<ReduceFunction, require_var_t<ReturnType>, ReturnType,
                        Vec, Args...> {
+  /**
+   * Copy of the shared arguments on its own AD tape. The adjoints of the
+   * copy accumulate over all the ranges evaluated with it and are only
+   * summed into the adjoints of the shared arguments at the end, so a
+   * range only touches the adjoints of the shared arguments it uses.
+   */
   struct scoped_args_tuple {
     ScopedChainableStack stack_;
     using args_tuple_t
@@ -37,8 +46,47 @@ struct reduce_sum_impl<ReduceFunction, require_var_t<ReturnType>, ReturnType,
     std::unique_ptr<args_tuple_t> args_tuple_holder_;
 
     scoped_args_tuple() : stack_(), args_tuple_holder_(nullptr) {}
+
+    /**
+     * Return the copy of the shared arguments, making it on first use.
+     *
+     * @param args_tuple shared arguments
+     */
+    inline args_tuple_t& get(const std::tuple<Args...>& args_tuple) {
+      if (!args_tuple_holder_) {
+        stack_.execute([&]() {
+          apply(
+              [&](auto&&... args) {
+                args_tuple_holder_
+                    = std::make_unique<args_tuple_t>(deep_copy_vars(args)...);
+              },
+              args_tuple);
+        });
+      }
+      return *args_tuple_holder_;
+    }
+
+    /**
+     * Add the adjoints of the copy of the shared arguments, if made, to
+     * the specified adjoints.
+     *
+     * @param[in, out] args_adjoints adjoints of the shared arguments
+     */
+    inline void add_adjoints_to(Eigen::VectorXd& args_adjoints) const {
+      if (!args_tuple_holder_) {
+        return;
+      }
+      apply(
+          [&](auto&&... args) {
+            accumulate_adjoints(args_adjoints.data(), args...);
+          },
+          *args_tuple_holder_);
+    }
   };
 
+  /// copies of the shared arguments for every thread
+  using thread_args_t = tbb::enumerable_thread_specific<scoped_args_tuple>;
+
   /**
    * This struct is used by the TBB to accumulate partial
    *  sums over consecutive ranges of the input. To distribute the workload,
@@ -49,25 +97,37 @@ struct reduce_sum_impl<ReduceFunction, require_var_t<ReturnType>, ReturnType,
    * @note see link [here](https://tinyurl.com/vp7xw2t) for requirements.
    */
   struct recursive_reducer {
+    const bool time_chunks_;
+    const bool share_region_;
     const size_t num_vars_per_term_;
     const size_t num_vars_shared_terms_;  // Number of vars in shared arguments
     double* sliced_partials_;  // Points to adjoints of the partial calculations
     Vec vmapped_;
     std::stringstream msgs_;
     std::tuple<Args...> args_tuple_;
+    // Copies of the shared arguments for every thread if not null,
+    // otherwise the reducer uses its own copy
+    thread_args_t* thread_args_;
     scoped_args_tuple local_args_tuple_scope_;
     double sum_{0.0};
+    // Adjoints of the shared arguments from the joined reducers
     Eigen::VectorXd args_adjoints_{0};
+    chunk_timings timings_;
 
     template <typename VecT, typename... ArgsT>
-    recursive_reducer(size_t num_vars_per_term, size_t num_vars_shared_terms,
-                      double* sliced_partials, VecT&& vmapped, ArgsT&&... args)
-        : num_vars_per_term_(num_vars_per_term),
+    recursive_reducer(bool time_chunks, bool share_region,
+                      size_t num_vars_per_term, size_t num_vars_shared_terms,
+                      double* sliced_partials, thread_args_t* thread_args,
+                      VecT&& vmapped, ArgsT&&... args)
+        : time_chunks_(time_chunks),
+          share_region_(share_region),
+          num_vars_per_term_(num_vars_per_term),
           num_vars_shared_terms_(num_vars_shared_terms),
           sliced_partials_(sliced_partials),
           vmapped_(std::forward<VecT>(vmapped)),
-          local_args_tuple_scope_(),
-          args_tuple_(std::forward<ArgsT>(args)...) {}
+          args_tuple_(std::forward<ArgsT>(args)...),
+          thread_args_(thread_args),
+          local_args_tuple_scope_() {}
 
     /*
      * This is the copy operator as required for tbb::parallel_reduce
@@ -76,23 +136,27 @@ struct reduce_sum_impl<ReduceFunction, require_var_t<ReturnType>, ReturnType,
      *   an independent partial sum.
      */
     recursive_reducer(recursive_reducer& other, tbb::split)
-        : num_vars_per_term_(other.num_vars_per_term_),
+        : time_chunks_(other.time_chunks_),
+          share_region_(other.share_region_),
+          num_vars_per_term_(other.num_vars_per_term_),
           num_vars_shared_terms_(other.num_vars_shared_terms_),
           sliced_partials_(other.sliced_partials_),
           vmapped_(other.vmapped_),
-          local_args_tuple_scope_(),
-          args_tuple_(other.args_tuple_) {}
+          args_tuple_(other.args_tuple_),
+          thread_args_(other.thread_args_),
+          local_args_tuple_scope_() {}
 
     /**
      * Compute, using nested autodiff, the value and Jacobian of
      *  `ReduceFunction` called over the range defined by r and accumulate those
-     *  in member variable sum_ (for the value) and args_adjoints_ (for the
-     *  Jacobian). The nested autodiff uses deep copies of the involved operands
-     *  ensuring that no side effects are implied to the adjoints of the input
-     *  operands which reside potentially on a autodiff tape stored in a
-     *  different thread other than the current thread of execution. This
-     * function may be called multiple times per object instantiation (so the
-     * sum_ and args_adjoints_ must be accumulated, not just assigned).
+     *  in member variable sum_ (for the value) and the adjoints of the copy of
+     *  the shared arguments (for the Jacobian). The nested autodiff uses deep
+     *  copies of the involved operands ensuring that no side effects are
+     *  implied to the adjoints of the input operands which reside potentially
+     *  on a autodiff tape stored in a different thread other than the current
+     *  thread of execution. This function may be called multiple times per
+     *  object instantiation (so the sum_ and the adjoints must be accumulated,
+     *  not just assigned).
      *
      * @param r Range over which to compute reduce_sum
      */
@@ -101,33 +165,17 @@ struct reduce_sum_impl<ReduceFunction, require_var_t<ReturnType>, ReturnType,
         return;
       }
 
-      if (args_adjoints_.size() == 0) {
-        args_adjoints_ = Eigen::VectorXd::Zero(num_vars_shared_terms_);
-      }
+      const parallel_task_scope task(share_region_);
+      using clock = std::chrono::steady_clock;
+      const auto start = time_chunks_ ? clock::now() : clock::time_point();
 
       // Obtain reference to a local copy of all shared arguments that do
-      // not point
-      //   back to main autodiff stack
-
-      if (!local_args_tuple_scope_.args_tuple_holder_) {
-        // shared arguments need to be copied to reducer-specific
-        // scope. In this case no need for zeroing adjoints, since the
-        // fresh copy has all adjoints set to zero.
-        local_args_tuple_scope_.stack_.execute([&]() {
-          apply(
-              [&](auto&&... args) {
-                local_args_tuple_scope_.args_tuple_holder_ = std::make_unique<
-                    typename scoped_args_tuple::args_tuple_t>(
-                    deep_copy_vars(args)...);
-              },
-              args_tuple_);
-        });
-      } else {
-        // set adjoints of shared arguments to zero
-        local_args_tuple_scope_.stack_.execute([] { set_zero_all_adjoints(); });
-      }
-
-      auto& args_tuple_local = *(local_args_tuple_scope_.args_tuple_holder_);
+      // not point back to main autodiff stack. Its adjoints are not
+      // zeroed, the adjoints of the ranges evaluated with it accumulate
+      // until they are collected at the end.
+      scoped_args_tuple& scope
+          = thread_args_ ? thread_args_->local() : local_args_tuple_scope_;
+      auto& args_tuple_local = scope.get(args_tuple_);
 
       // Initialize nested autodiff stack
       const nested_rev_autodiff begin_nest;
@@ -158,17 +206,18 @@ struct reduce_sum_impl<ReduceFunction, require_var_t<ReturnType>, ReturnType,
       accumulate_adjoints(sliced_partials_ + r.begin() * num_vars_per_term_,
                           std::move(local_sub_slice));
 
-      // Accumulate adjoints of shared_arguments
-      apply(
-          [&](auto&&... args) {
-            accumulate_adjoints(args_adjoints_.data(), args...);
-          },
-          args_tuple_local);
+      if (time_chunks_) {
+        timings_.add(
+            r.size(),
+            std::chrono::duration<double>(clock::now() - start).count());
+      }
     }
 
     /**
      * Join reducers. Accumuluate the value (sum_) and Jacobian (arg_adoints_)
-     *   of the other reducer.
+     *   of the other reducer. If the reducers use their own copies of the
+     *   shared arguments, the adjoints of the copy of the other reducer
+     *   are collected as it is about to be destroyed.
      *
      * @param rhs Another partial sum
      */
@@ -179,10 +228,30 @@ struct reduce_sum_impl<ReduceFunction, require_var_t<ReturnType>, ReturnType,
       } else if (args_adjoints_.size() == 0 && rhs.args_adjoints_.size() != 0) {
         args_adjoints_ = rhs.args_adjoints_;
       }
+      if (rhs.local_args_tuple_scope_.args_tuple_holder_) {
+        if (args_adjoints_.size() == 0) {
+          args_adjoints_ = Eigen::VectorXd::Zero(num_vars_shared_terms_);
+        }
+        rhs.local_args_tuple_scope_.add_adjoints_to(args_adjoints_);
+      }
       msgs_ << rhs.msgs_.str();
+      timings_ += rhs.timings_;
     }
   };
 
+  /// timings of the chunks of work, recorded if not null
+  chunk_timings* timings_{nullptr};
+
+  reduce_sum_impl() = default;
+
+  /**
+   * Construct an implementation which records the timings of the
+   * chunks of work it evaluates.
+   *
+   * @param[out] timings timings of the chunks
+   */
+  explicit reduce_sum_impl(chunk_timings* timings) : timings_(timings) {}
+
   /**
    * Call an instance of the function `ReduceFunction` on every element
    *   of an input sequence and sum these terms.
@@ -207,6 +276,20 @@ struct reduce_sum_impl<ReduceFunction, require_var_t<ReturnType>, ReturnType,
    * of that sum over multiple threads by coordinating calls to `ReduceFunction`
    * instances. Results are stored as precomputed varis in the autodiff tree.
    *
+   * The shared arguments are copied once for every thread (with auto
+   *  partitioning) or for every reducer created by the TBB (without it),
+   *  and the adjoints of the copies are only summed once all terms are
+   *  computed. A range of terms thus only touches the adjoints of the
+   *  shared arguments it uses, instead of zeroing and accumulating all of
+   *  them. Without auto partitioning the reducers are split and joined in
+   *  the same order every time, so the sums do not depend on the
+   *  scheduling of the threads.
+   *
+   * Called from the partial sums of another parallel functor, the work
+   *  is shared with the enclosing functor (see `run_parallel_region`).
+   *  Without auto partitioning, the parallel functors called from the
+   *  partial sums are isolated to keep the order of the partial sums.
+   *
    * If auto partitioning is true, break work into pieces automatically,
    *  taking grainsize as a recommended work size. The partitioning is
    *  not deterministic nor is the order guaranteed in which partial
@@ -246,7 +329,10 @@ struct reduce_sum_impl<ReduceFunction, require_var_t<ReturnType>, ReturnType,
       partials[i] = 0.0;
     }
 
-    recursive_reducer worker(num_vars_per_term, num_vars_shared_terms, partials,
+    thread_args_t thread_args;
+    recursive_reducer worker(timings_ != nullptr, auto_partitioning,
+                             num_vars_per_term, num_vars_shared_terms, partials,
+                             auto_partitioning ? &thread_args : nullptr,
                              std::forward<Vec>(vmapped),
                              std::forward<Args>(args)...);
 
@@ -255,8 +341,10 @@ struct reduce_sum_impl<ReduceFunction, require_var_t<ReturnType>, ReturnType,
     // this is to ensure that the thread local AD tape ressource is
     // not being modified from a different task which may happen
     // whenever this function is being used itself in a parallel
-    // context (like running multiple chains for Stan)
-    tbb::this_task_arena::isolate([&] {
+    // context (like running multiple chains for Stan). Nested calls
+    // from the partial sums of other parallel functors share their
+    // isolated region.
+    run_parallel_region([&] {
       if (auto_partitioning) {
         tbb::parallel_reduce(
             tbb::blocked_range<std::size_t>(0, num_terms, grainsize), worker);
@@ -268,13 +356,25 @@ struct reduce_sum_impl<ReduceFunction, require_var_t<ReturnType>, ReturnType,
       }
     });
 
+    Eigen::VectorXd args_adjoints
+        = Eigen::VectorXd::Zero(num_vars_shared_terms);
+    if (worker.args_adjoints_.size() != 0) {
+      args_adjoints += worker.args_adjoints_;
+    }
+    worker.local_args_tuple_scope_.add_adjoints_to(args_adjoints);
+    for (const auto& scope : thread_args) {
+      scope.add_adjoints_to(args_adjoints);
+    }
     for (size_t i = 0; i < num_vars_shared_terms; ++i) {
-      partials[num_vars_sliced_terms + i] = worker.args_adjoints_.coeff(i);
+      partials[num_vars_sliced_terms + i] = args_adjoints.coeff(i);
     }
 
     if (msgs) {
       *msgs << worker.msgs_.str();
     }
+    if (timings_) {
+      *timings_ += worker.timings_;
+    }
 
     return var(new precomputed_gradients_vari(
         worker.sum_, num_vars_sliced_terms + num_vars_shared_terms, varis,
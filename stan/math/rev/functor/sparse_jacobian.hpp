@@ -0,0 +1,130 @@
+#ifndef STAN_MATH_REV_FUNCTOR_SPARSE_JACOBIAN_HPP
+#define STAN_MATH_REV_FUNCTOR_SPARSE_JACOBIAN_HPP
+
+#include <stan/math/rev/meta.hpp>
+#include <stan/math/rev/core.hpp>
+#include <stan/math/rev/functor/jacobian.hpp>
+#include <stan/math/prim/err.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <stan/math/prim/functor/sparse_coloring.hpp>
+#include <vector>
+
+namespace stan {
+namespace math {
+
+/**
+ * Return the sparsity pattern of the Jacobian of the specified function
+ * at the specified argument, as the nonzeros of its dense Jacobian.
+ *
+ * The pattern is meant to be computed once and passed to
+ * `sparse_jacobian()` for the many evaluations of the Jacobian of a
+ * solver or integrator. Derivatives which happen to be zero at `x`
+ * are missing from the pattern, so `x` should be a generic point, or
+ * the pattern should be built from the structure of the function.
+ *
+ * @tparam F type of function
+ * @param[in] f function, as for `jacobian()`
+ * @param[in] x argument
+ * @return pattern, with one row per output and one column per input
+ * and a one for every nonzero
+ */
+template <typename F>
+Eigen::SparseMatrix<double> jacobian_sparsity(
+    const F& f, const Eigen::Matrix<double, Eigen::Dynamic, 1>& x) {
+  Eigen::Matrix<double, Eigen::Dynamic, 1> fx;
+  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> J;
+  jacobian(f, x, fx, J);
+  Eigen::SparseMatrix<double> pattern(J.rows(), J.cols());
+  std::vector<Eigen::Triplet<double>> nonzeros;
+  for (int j = 0; j < J.cols(); ++j) {
+    for (int i = 0; i < J.rows(); ++i) {
+      if (J(i, j) != 0) {
+        nonzeros.emplace_back(i, j, 1.0);
+      }
+    }
+  }
+  pattern.setFromTriplets(nonzeros.begin(), nonzeros.end());
+  return pattern;
+}
+
+/**
+ * Return the value and the sparse Jacobian of the specified function
+ * at the specified argument, given the sparsity pattern of the
+ * Jacobian.
+ *
+ * The rows of the pattern are colored such that no two rows of the same
+ * color have a nonzero in the same column (see
+ * `internal::color_columns()`). The function is evaluated once, and
+ * the tape is swept in reverse once per color, seeded with the
+ * adjoints of all the outputs of the color at once, so that every
+ * sweep computes all the rows of its color. The number of sweeps is
+ * the number of colors, which for banded or block structured
+ * Jacobians is about the largest number of nonzeros of a column
+ * instead of the number of outputs.
+ *
+ * The functor must be usable by `jacobian()`. Nonzeros of the Jacobian
+ * outside of the pattern are silently added to other elements.
+ *
+ * @tparam F type of function
+ * @param[in] f function
+ * @param[in] x argument
+ * @param[in] pattern sparsity pattern of the Jacobian, with one row per
+ * output and one column per input, whose stored elements are the
+ * nonzeros; for example from `jacobian_sparsity()`
+ * @param[out] fx value of the function
+ * @param[out] J Jacobian, with the nonzeros of the pattern
+ * @throw std::invalid_argument if the pattern does not have one row
+ * per output and one column per input
+ */
+template <typename F>
+void sparse_jacobian(const F& f,
+                     const Eigen::Matrix<double, Eigen::Dynamic, 1>& x,
+                     const Eigen::SparseMatrix<double>& pattern,
+                     Eigen::Matrix<double, Eigen::Dynamic, 1>& fx,
+                     Eigen::SparseMatrix<double>& J) {
+  using Eigen::Dynamic;
+  using Eigen::Matrix;
+  static const char* function = "sparse_jacobian";
+  check_size_match(function, "columns of pattern", pattern.cols(),
+                   "size of argument", x.size());
+  // Run nested autodiff in this scope
+  nested_rev_autodiff nested;
+
+  Matrix<var, Dynamic, 1> x_var(x);
+  Matrix<var, Dynamic, 1> fx_var = f(x_var);
+  check_size_match(function, "rows of pattern", pattern.rows(),
+                   "size of function value", fx_var.size());
+  fx = fx_var.val();
+
+  std::vector<int> row_colors;
+  const Eigen::SparseMatrix<double> pattern_t = pattern.transpose();
+  const int num_colors = internal::color_columns(pattern_t, row_colors);
+  std::vector<std::vector<int>> rows_of_color(num_colors);
+  for (int i = 0; i < fx_var.size(); ++i) {
+    rows_of_color[row_colors[i]].push_back(i);
+  }
+  // column c holds the sum of the rows of color c
+  Matrix<double, Dynamic, Dynamic> compressed(x.size(), num_colors);
+  for (int c = 0; c < num_colors; ++c) {
+    if (c > 0) {
+      nested.set_zero_all_adjoints();
+    }
+    for (int i : rows_of_color[c]) {
+      fx_var(i).vi_->adj_ = 1;
+    }
+    grad();
+    compressed.col(c) = x_var.adj();
+  }
+
+  J = pattern;
+  J.makeCompressed();
+  for (int j = 0; j < J.outerSize(); ++j) {
+    for (Eigen::SparseMatrix<double>::InnerIterator it(J, j); it; ++it) {
+      it.valueRef() = compressed(j, row_colors[it.row()]);
+    }
+  }
+}
+
+}  // namespace math
+}  // namespace stan
+#endif
@@ -0,0 +1,94 @@
+#ifndef STAN_MATH_REV_FUNCTOR_SUNDIALS_WORKSPACE_CACHE_HPP
+#define STAN_MATH_REV_FUNCTOR_SUNDIALS_WORKSPACE_CACHE_HPP
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <utility>
+
+namespace stan {
+namespace math {
+namespace internal {
+
+/**
+ * Cache of the workspaces of the SUNDIALS integrators of the calling
+ * thread: the integrator memory, vectors, matrix and linear solver of a
+ * solve, which the next solve of a system with the same key reuses
+ * after reinitializing it (`CVodeReInit()`, `IDAReInit()`) instead of
+ * allocating and setting up new ones.
+ *
+ * A workspace is taken out of the cache for the duration of a solve,
+ * so nested solves, like solves within the right hand side of an ODE,
+ * never share one. The cache is thread local, so it is safe under
+ * `STAN_THREADS` without locking, and holds at most `capacity`
+ * workspaces, dropping the least recently used ones.
+ *
+ * @tparam Workspace type of workspace, constructible from its key, with
+ * a `key_type` and a `key()` comparable with `==`
+ */
+template <typename Workspace>
+class sundials_workspace_cache {
+  using key_type = typename Workspace::key_type;
+
+  /**
+   * Return the workspaces of the calling thread, the most recently
+   * used first.
+   */
+  static std::list<std::unique_ptr<Workspace>>& workspaces() {
+    static thread_local std::list<std::unique_ptr<Workspace>> workspaces;
+    return workspaces;
+  }
+
+ public:
+  /**
+   * Maximum number of workspaces kept per thread.
+   */
+  static constexpr std::size_t capacity = 8;
+
+  /**
+   * Take the workspace of the specified key out of the cache, or make
+   * a new one if there is none.
+   *
+   * @param key key of the workspace
+   * @return workspace
+   */
+  static std::unique_ptr<Workspace> acquire(const key_type& key) {
+    auto& cached = workspaces();
+    for (auto it = cached.begin(); it != cached.end(); ++it) {
+      if ((*it)->key() == key) {
+        std::unique_ptr<Workspace> workspace = std::move(*it);
+        cached.erase(it);
+        return workspace;
+      }
+    }
+    return std::make_unique<Workspace>(key);
+  }
+
+  /**
+   * Return a workspace to the cache after a successful solve.
+   *
+   * @param workspace workspace
+   */
+  static void release(std::unique_ptr<Workspace> workspace) {
+    auto& cached = workspaces();
+    cached.push_front(std::move(workspace));
+    if (cached.size() > capacity) {
+      cached.pop_back();
+    }
+  }
+
+  /**
+   * Return the number of workspaces in the cache of the calling thread.
+   */
+  static std::size_t size() { return workspaces().size(); }
+
+  /**
+   * Free all the workspaces of the cache of the calling thread.
+   */
+  static void clear() { workspaces().clear(); }
+};
+
+}  // namespace internal
+}  // namespace math
+}  // namespace stan
+#endif
@@ -0,0 +1,205 @@
+#include <stan/math/fwd.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+
+namespace {
+
+using fvar3 = stan::math::fvar_n<double, 3>;
+
+fvar3 make_fvar3(double val, double d0, double d1, double d2) {
+  fvar3::tangent_t d;
+  d << d0, d1, d2;
+  return fvar3(val, d);
+}
+
+/**
+ * Check that a function of fvar_n computes the same value and tangents
+ * as the function of fvar in each direction.
+ */
+template <typename F>
+void expect_matches_fvar(const F& f, const fvar3& x) {
+  const fvar3 y = f(x);
+  for (int i = 0; i < 3; ++i) {
+    const stan::math::fvar<double> yi
+        = f(stan::math::fvar<double>(x.val_, x.d_(i)));
+    EXPECT_FLOAT_EQ(yi.val_, y.val_);
+    EXPECT_FLOAT_EQ(yi.d_, y.d_(i)) << "direction " << i;
+  }
+}
+
+template <typename F>
+void expect_matches_fvar(const F& f, const fvar3& x1, const fvar3& x2) {
+  const fvar3 y = f(x1, x2);
+  for (int i = 0; i < 3; ++i) {
+    const stan::math::fvar<double> yi
+        = f(stan::math::fvar<double>(x1.val_, x1.d_(i)),
+            stan::math::fvar<double>(x2.val_, x2.d_(i)));
+    EXPECT_FLOAT_EQ(yi.val_, y.val_);
+    EXPECT_FLOAT_EQ(yi.d_, y.d_(i)) << "direction " << i;
+  }
+}
+
+}  // namespace
+
+TEST(AgradFwdFvarN, construct) {
+  fvar3 a;
+  EXPECT_FLOAT_EQ(0.0, a.val());
+  EXPECT_FLOAT_EQ(0.0, a.tangent().abs().sum());
+  fvar3 b = 2;
+  EXPECT_FLOAT_EQ(2.0, b.val());
+  EXPECT_FLOAT_EQ(0.0, b.tangent().abs().sum());
+  fvar3 c = fvar3::unit(1.5, 1);
+  EXPECT_FLOAT_EQ(1.5, c.val());
+  EXPECT_FLOAT_EQ(0.0, c.d_(0));
+  EXPECT_FLOAT_EQ(1.0, c.d_(1));
+  EXPECT_FLOAT_EQ(0.0, c.d_(2));
+  EXPECT_FLOAT_EQ(0.0, fvar3::unit(1.5, -1).tangent().abs().sum());
+  EXPECT_FLOAT_EQ(1.5, stan::math::value_of(c));
+
+  std::stringstream ss;
+  ss << c;
+  EXPECT_EQ(0, ss.str().find("1.5:"));
+
+  std::vector<fvar3> v(5, c);
+  EXPECT_FLOAT_EQ(1.0, v[4].d_(1));
+}
+
+TEST(AgradFwdFvarN, operators) {
+  const fvar3 x = make_fvar3(1.3, 1.0, -0.5, 2.0);
+  const fvar3 y = make_fvar3(0.7, 0.3, 1.5, -1.0);
+  expect_matches_fvar([](const auto& a, const auto& b) { return a + b; }, x,
+                      y);
+  expect_matches_fvar([](const auto& a, const auto& b) { return a - b; }, x,
+                      y);
+  expect_matches_fvar([](const auto& a, const auto& b) { return a * b; }, x,
+                      y);
+  expect_matches_fvar([](const auto& a, const auto& b) { return a / b; }, x,
+                      y);
+  expect_matches_fvar([](const auto& a) { return a + 2.5; }, x);
+  expect_matches_fvar([](const auto& a) { return 2 + a; }, x);
+  expect_matches_fvar([](const auto& a) { return a - 2.5; }, x);
+  expect_matches_fvar([](const auto& a) { return 2.5 - a; }, x);
+  expect_matches_fvar([](const auto& a) { return a * 2.5; }, x);
+  expect_matches_fvar([](const auto& a) { return 3 * a; }, x);
+  expect_matches_fvar([](const auto& a) { return a / 2.5; }, x);
+  expect_matches_fvar([](const auto& a) { return 2.5 / a; }, x);
+  expect_matches_fvar([](const auto& a) { return -a; }, x);
+  expect_matches_fvar([](const auto& a) { return +a; }, x);
+  expect_matches_fvar(
+      [](const auto& a, const auto& b) {
+        auto c = a;
+        c += b;
+        c *= a;
+        c -= 0.5;
+        c /= b;
+        c *= 2.0;
+        c -= a;
+        c += 1.0;
+        c /= 3.0;
+        return c;
+      },
+      x, y);
+
+  EXPECT_TRUE(x > y);
+  EXPECT_TRUE(y < x);
+  EXPECT_TRUE(x >= 1.3);
+  EXPECT_TRUE(1.3 <= x);
+  EXPECT_TRUE(x == 1.3);
+  EXPECT_TRUE(x != y);
+  EXPECT_FALSE(!x);
+}
+
+TEST(AgradFwdFvarN, functions) {
+  using stan::math::exp;
+  using stan::math::log;
+  const fvar3 x = make_fvar3(0.8, 1.0, -0.5, 2.0);
+  const fvar3 y = make_fvar3(1.7, 0.3, 1.5, -1.0);
+  expect_matches_fvar([](const auto& a) { return stan::math::exp(a); }, x);
+  expect_matches_fvar([](const auto& a) { return stan::math::log(a); }, x);
+  expect_matches_fvar([](const auto& a) { return stan::math::sqrt(a); }, x);
+  expect_matches_fvar([](const auto& a) { return stan::math::square(a); }, x);
+  expect_matches_fvar([](const auto& a) { return stan::math::sin(a); }, x);
+  expect_matches_fvar([](const auto& a) { return stan::math::cos(a); }, x);
+  expect_matches_fvar([](const auto& a) { return stan::math::tan(a); }, x);
+  expect_matches_fvar([](const auto& a) { return stan::math::tanh(a); }, x);
+  expect_matches_fvar([](const auto& a) { return stan::math::inv_logit(a); },
+                      x);
+  expect_matches_fvar([](const auto& a) { return stan::math::log1p(a); }, x);
+  expect_matches_fvar([](const auto& a) { return stan::math::expm1(a); }, x);
+  expect_matches_fvar([](const auto& a) { return stan::math::fabs(a); }, x);
+  expect_matches_fvar([](const auto& a) { return stan::math::fabs(a); }, -x);
+  expect_matches_fvar([](const auto& a) { return stan::math::atan(a); }, x);
+  expect_matches_fvar([](const auto& a) { return stan::math::inv(a); }, x);
+  expect_matches_fvar([](const auto& a) { return stan::math::lgamma(a); }, x);
+  expect_matches_fvar([](const auto& a) { return stan::math::pow(a, 3); }, x);
+  expect_matches_fvar([](const auto& a) { return stan::math::pow(1.5, a); },
+                      x);
+  expect_matches_fvar(
+      [](const auto& a, const auto& b) { return stan::math::pow(a, b); }, x,
+      y);
+  expect_matches_fvar(
+      [](const auto& a, const auto& b) {
+        return stan::math::log_sum_exp(a, b);
+      },
+      x, y);
+}
+
+TEST(AgradFwdFvarN, eigen) {
+  Eigen::Matrix<fvar3, Eigen::Dynamic, 1> v(2);
+  v << make_fvar3(1.0, 1.0, 0.0, 0.0), make_fvar3(2.0, 0.0, 1.0, 0.0);
+  const fvar3 s = v.sum();
+  EXPECT_FLOAT_EQ(3.0, s.val_);
+  EXPECT_FLOAT_EQ(1.0, s.d_(0));
+  EXPECT_FLOAT_EQ(1.0, s.d_(1));
+  const fvar3 dot = v.dot(v);
+  EXPECT_FLOAT_EQ(5.0, dot.val_);
+  EXPECT_FLOAT_EQ(2.0, dot.d_(0));
+  EXPECT_FLOAT_EQ(4.0, dot.d_(1));
+  EXPECT_FLOAT_EQ(0.0, dot.d_(2));
+}
+
+TEST(AgradFwdFvarN, jacobian) {
+  auto f = [](const auto& x) {
+    using T = typename std::decay_t<decltype(x)>::Scalar;
+    Eigen::Matrix<T, Eigen::Dynamic, 1> y(5);
+    y(0) = x(0) * x(1) + stan::math::exp(x(2));
+    y(1) = stan::math::log(x(3)) / x(4);
+    y(2) = stan::math::square(x(0)) - 2.0 * x(4);
+    y(3) = stan::math::sin(x(1) * x(2));
+    y(4) = x(3);
+    return y;
+  };
+  Eigen::VectorXd x(5);
+  x << 0.5, 1.5, -0.3, 2.0, 0.8;
+  Eigen::VectorXd fx;
+  Eigen::MatrixXd J;
+  stan::math::jacobian(f, x, fx, J);
+  Eigen::VectorXd fx_n;
+  Eigen::MatrixXd J_n;
+  stan::math::jacobian<2>(f, x, fx_n, J_n);
+  ASSERT_EQ(5, J_n.rows());
+  ASSERT_EQ(5, J_n.cols());
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_FLOAT_EQ(fx(i), fx_n(i));
+    for (int j = 0; j < 5; ++j) {
+      EXPECT_FLOAT_EQ(J(i, j), J_n(i, j));
+    }
+  }
+  stan::math::jacobian<8>(f, x, fx_n, J_n);
+  EXPECT_NEAR(0.0, (J - J_n).norm(), 1e-12);
+
+  auto g = [](const auto& x) {
+    using T = typename std::decay_t<decltype(x)>::Scalar;
+    Eigen::Matrix<T, Eigen::Dynamic, 1> y(2);
+    y(0) = x(0) * x(1);
+    y(1) = x(1) + 3 * x(2);
+    return y;
+  };
+  stan::math::jacobian<2>(g, x.head(3).eval(), fx_n, J_n);
+  ASSERT_EQ(2, J_n.rows());
+  ASSERT_EQ(3, J_n.cols());
+  Eigen::MatrixXd J_g(2, 3);
+  J_g << 1.5, 0.5, 0, 0, 1, 3;
+  EXPECT_NEAR(0.0, (J_g - J_n).norm(), 1e-12);
+  EXPECT_FLOAT_EQ(0.75, fx_n(0));
+}
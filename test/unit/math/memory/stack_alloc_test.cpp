@@ -119,3 +119,317 @@ TEST(stack_alloc, in_stack_second_block) {
   EXPECT_FALSE(allocator.in_stack(x));
   EXPECT_FALSE(allocator.in_stack(y));
 }
+
+namespace {
+// counts the blocks handed out and returned
+class counting_block_provider : public stan::math::block_provider {
+ public:
+  size_t allocated_ = 0;
+  size_t released_ = 0;
+  size_t bytes_ = 0;
+
+  char* allocate(size_t& nbytes) final {
+    ++allocated_;
+    bytes_ += nbytes;
+    return static_cast<char*>(malloc(nbytes));
+  }
+  void release(char* block, size_t nbytes) noexcept final {
+    ++released_;
+    bytes_ -= nbytes;
+    free(block);
+  }
+  const char* name() const noexcept final { return "counting"; }
+};
+
+void fill_and_check(stan::math::stack_alloc& allocator) {
+  std::vector<double*> xs;
+  for (int i = 0; i < 1000; ++i) {
+    double* x = allocator.alloc_array<double>(100 + i);
+    x[0] = i;
+    x[99 + i] = -i;
+    xs.push_back(x);
+  }
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_FLOAT_EQ(i, xs[i][0]);
+    EXPECT_FLOAT_EQ(-i, xs[i][99 + i]);
+  }
+}
+}  // namespace
+
+TEST(stack_alloc, config_provider_and_growth) {
+  counting_block_provider provider;
+  {
+    stan::math::stack_alloc_config config;
+    config.initial_nbytes = 1024;
+    config.growth_factor = 1.5;
+    config.provider = &provider;
+    config.first_touch = true;
+    stan::math::stack_alloc allocator(config);
+    EXPECT_EQ(1, allocator.blocks_reserved());
+    EXPECT_EQ(1024, allocator.bytes_reserved());
+    EXPECT_STREQ("counting", allocator.provider().name());
+
+    allocator.alloc(1000);
+    allocator.alloc(100);
+    EXPECT_EQ(2, allocator.blocks_reserved());
+    EXPECT_EQ(1024 + 1536, allocator.bytes_reserved());
+    EXPECT_EQ(2, provider.allocated_);
+
+    fill_and_check(allocator);
+    EXPECT_EQ(provider.bytes_, allocator.bytes_reserved());
+    EXPECT_EQ(allocator.blocks_reserved(), provider.allocated_);
+
+    allocator.recover_all();
+    EXPECT_EQ(provider.bytes_, allocator.bytes_reserved());
+    allocator.free_all();
+    EXPECT_EQ(1, allocator.blocks_reserved());
+    EXPECT_EQ(1024, provider.bytes_);
+  }
+  EXPECT_EQ(provider.allocated_, provider.released_);
+  EXPECT_EQ(0, provider.bytes_);
+}
+
+TEST(stack_alloc, mmap_providers) {
+  for (auto* provider :
+       {static_cast<stan::math::block_provider*>(
+            &stan::math::mmap_block_provider::instance()),
+        static_cast<stan::math::block_provider*>(
+            &stan::math::mmap_block_provider::huge_pages_instance())}) {
+    stan::math::stack_alloc_config config;
+    config.initial_nbytes = 1000;
+    config.provider = provider;
+    config.first_touch = true;
+    stan::math::stack_alloc allocator(config);
+    // blocks are rounded up to whole pages
+    EXPECT_LE(1000, allocator.bytes_reserved());
+    EXPECT_TRUE(stan::math::is_aligned(
+        static_cast<char*>(allocator.alloc(8)), 8U));
+    fill_and_check(allocator);
+    allocator.free_all();
+    fill_and_check(allocator);
+  }
+  EXPECT_STREQ("mmap", stan::math::mmap_block_provider::instance().name());
+  EXPECT_STREQ(
+      "hugepages",
+      stan::math::mmap_block_provider::huge_pages_instance().name());
+}
+
+TEST(stack_alloc, huge_pages_provider_alignment) {
+  auto& provider = stan::math::mmap_block_provider::huge_pages_instance();
+  for (size_t nbytes : {1000UL, 3UL << 20}) {
+    size_t block_nbytes = nbytes;
+    char* block = provider.allocate(block_nbytes);
+    ASSERT_NE(nullptr, block);
+    EXPECT_LE(nbytes, block_nbytes);
+    EXPECT_EQ(0U, block_nbytes % stan::math::internal::HUGE_PAGE_NBYTES);
+    EXPECT_TRUE(stan::math::is_aligned(
+        block, stan::math::internal::HUGE_PAGE_NBYTES));
+    block[0] = 1;
+    block[block_nbytes - 1] = 1;
+    provider.release(block, block_nbytes);
+  }
+}
+
+TEST(stack_alloc, default_config) {
+  stan::math::stack_alloc_config original
+      = stan::math::default_stack_alloc_config();
+  EXPECT_EQ(stan::math::internal::DEFAULT_INITIAL_NBYTES,
+            original.initial_nbytes);
+
+  stan::math::stack_alloc_config config;
+  config.initial_nbytes = 4096;
+  config.provider = &stan::math::mmap_block_provider::instance();
+  stan::math::set_default_stack_alloc_config(config);
+  {
+    stan::math::stack_alloc allocator;
+    EXPECT_EQ(4096, allocator.bytes_reserved());
+    EXPECT_STREQ("mmap", allocator.provider().name());
+    stan::math::stack_alloc sized_allocator(8192);
+    EXPECT_EQ(8192, sized_allocator.bytes_reserved());
+    EXPECT_STREQ("mmap", sized_allocator.provider().name());
+  }
+  config.growth_factor = 0.5;
+  EXPECT_THROW(stan::math::set_default_stack_alloc_config(config),
+               std::invalid_argument);
+  config.growth_factor = 2;
+  config.initial_nbytes = 0;
+  EXPECT_THROW(stan::math::set_default_stack_alloc_config(config),
+               std::invalid_argument);
+  config.initial_nbytes = 10;
+  config.provider = nullptr;
+  EXPECT_THROW(stan::math::set_default_stack_alloc_config(config),
+               std::invalid_argument);
+
+  stan::math::set_default_stack_alloc_config(original);
+  stan::math::stack_alloc allocator;
+  EXPECT_STREQ("malloc", allocator.provider().name());
+}
+
+TEST(stack_alloc, env_config) {
+  setenv("STAN_STACK_ALLOC_INITIAL_BYTES", "2048", 1);
+  setenv("STAN_STACK_ALLOC_GROWTH", "3", 1);
+  setenv("STAN_STACK_ALLOC_PROVIDER", "hugepages", 1);
+  setenv("STAN_STACK_ALLOC_FIRST_TOUCH", "1", 1);
+  stan::math::stack_alloc_config config
+      = stan::math::internal::get_env_stack_alloc_config();
+  EXPECT_EQ(2048, config.initial_nbytes);
+  EXPECT_FLOAT_EQ(3.0, config.growth_factor);
+  EXPECT_STREQ("hugepages", config.provider->name());
+  EXPECT_TRUE(config.first_touch);
+
+  setenv("STAN_STACK_ALLOC_PROVIDER", "bad", 1);
+  EXPECT_THROW(stan::math::internal::get_env_stack_alloc_config(),
+               std::invalid_argument);
+  unsetenv("STAN_STACK_ALLOC_PROVIDER");
+  setenv("STAN_STACK_ALLOC_GROWTH", "0.5", 1);
+  EXPECT_THROW(stan::math::internal::get_env_stack_alloc_config(),
+               std::invalid_argument);
+  unsetenv("STAN_STACK_ALLOC_GROWTH");
+  setenv("STAN_STACK_ALLOC_INITIAL_BYTES", "-1", 1);
+  EXPECT_THROW(stan::math::internal::get_env_stack_alloc_config(),
+               std::invalid_argument);
+  unsetenv("STAN_STACK_ALLOC_INITIAL_BYTES");
+  setenv("STAN_STACK_ALLOC_FIRST_TOUCH", "yes", 1);
+  EXPECT_THROW(stan::math::internal::get_env_stack_alloc_config(),
+               std::invalid_argument);
+  unsetenv("STAN_STACK_ALLOC_FIRST_TOUCH");
+
+  config = stan::math::internal::get_env_stack_alloc_config();
+  EXPECT_EQ(stan::math::internal::DEFAULT_INITIAL_NBYTES,
+            config.initial_nbytes);
+  EXPECT_STREQ("malloc", config.provider->name());
+}
+
+TEST(stack_alloc, alloc_aligned) {
+  stan::math::stack_alloc allocator(1024);
+  for (size_t alignment : {8, 16, 32, 64, 128}) {
+    for (int i = 0; i < 100; ++i) {
+      allocator.alloc(i % 3 == 0 ? 8 : 24);
+      char* x = static_cast<char*>(allocator.alloc_aligned(40 + i, alignment));
+      EXPECT_TRUE(stan::math::is_aligned(x, alignment));
+      EXPECT_TRUE(allocator.in_stack(x + 39 + i));
+    }
+  }
+  // crossing into a new block keeps the alignment
+  char* big = static_cast<char*>(allocator.alloc_aligned(100000, 64));
+  EXPECT_TRUE(stan::math::is_aligned(big, 64U));
+  EXPECT_TRUE(allocator.in_stack(big + 99999));
+}
+
+TEST(stack_alloc, alloc_array_aligned) {
+  stan::math::stack_alloc allocator;
+  allocator.alloc(8);
+  double* large = allocator.alloc_array_aligned<double>(100);
+  EXPECT_TRUE(stan::math::is_aligned(large, STAN_ARENA_ALIGNMENT));
+  allocator.alloc(8);
+  double* small = allocator.alloc_array_aligned<double>(3);
+  EXPECT_TRUE(stan::math::is_aligned(
+      small, stan::math::internal::SMALL_ARRAY_ALIGNMENT));
+  // the allocator remains 8 byte aligned afterwards
+  EXPECT_TRUE(stan::math::is_aligned(
+      static_cast<char*>(allocator.alloc(sizeof(double))), 8U));
+}
+
+TEST(stack_alloc, shrink_policy_release) {
+  counting_block_provider provider;
+  stan::math::stack_alloc_config config;
+  config.initial_nbytes = 1024;
+  config.provider = &provider;
+  config.shrink_policy.window = 3;
+  stan::math::stack_alloc allocator(config);
+
+  // one pathological iteration using many blocks
+  for (int i = 0; i < 100; ++i) {
+    allocator.alloc(1000);
+  }
+  size_t peak_blocks = allocator.blocks_reserved();
+  size_t peak_bytes = allocator.bytes_reserved();
+  EXPECT_GT(peak_blocks, 3);
+  EXPECT_GE(allocator.bytes_in_use(), 100 * 1000);
+  allocator.recover_all();
+  EXPECT_EQ(0, allocator.bytes_in_use());
+  EXPECT_EQ(peak_blocks, allocator.blocks_reserved());
+
+  // small iterations; the peak is forgotten after the window
+  for (int n = 0; n < 3; ++n) {
+    allocator.alloc(1000);
+    allocator.alloc(1000);
+    EXPECT_EQ(peak_blocks, allocator.blocks_reserved());
+    allocator.recover_all();
+  }
+  EXPECT_EQ(2, allocator.blocks_reserved());
+  EXPECT_EQ(peak_bytes - allocator.bytes_reserved(),
+            allocator.bytes_released());
+  EXPECT_EQ(provider.bytes_, allocator.bytes_reserved());
+  EXPECT_EQ(provider.allocated_ - provider.released_,
+            allocator.blocks_reserved());
+  fill_and_check(allocator);
+  allocator.recover_all();
+}
+
+TEST(stack_alloc, shrink_policy_decommit) {
+  stan::math::stack_alloc_config config;
+  config.initial_nbytes = 4096;
+  config.provider = &stan::math::mmap_block_provider::instance();
+  config.shrink_policy.window = 1;
+  config.shrink_policy.decommit = true;
+  stan::math::stack_alloc allocator(config);
+
+  for (int i = 0; i < 100; ++i) {
+    allocator.alloc(4000);
+  }
+  size_t peak_blocks = allocator.blocks_reserved();
+  allocator.recover_all();
+  allocator.alloc(100);
+  allocator.recover_all();
+  // blocks are kept but their memory is given back
+  EXPECT_EQ(peak_blocks, allocator.blocks_reserved());
+  EXPECT_EQ(4096, allocator.bytes_reserved());
+  size_t released = allocator.bytes_released();
+  EXPECT_GT(released, 0);
+
+  // decommitted blocks are reused
+  fill_and_check(allocator);
+  EXPECT_LE(peak_blocks, allocator.blocks_reserved());
+  EXPECT_GT(allocator.bytes_reserved(), 4096);
+  allocator.recover_all();
+  EXPECT_EQ(released, allocator.bytes_released());
+}
+
+TEST(stack_alloc, shrink_policy_set) {
+  stan::math::stack_alloc allocator(1024);
+  EXPECT_EQ(0, allocator.shrink_policy().window);
+  for (int i = 0; i < 100; ++i) {
+    allocator.alloc(1000);
+  }
+  size_t peak_blocks = allocator.blocks_reserved();
+  allocator.recover_all();
+  allocator.recover_all();
+  EXPECT_EQ(peak_blocks, allocator.blocks_reserved());
+  EXPECT_EQ(0, allocator.bytes_released());
+
+  stan::math::stack_alloc_shrink_policy policy;
+  policy.window = 1;
+  allocator.set_shrink_policy(policy);
+  EXPECT_EQ(1, allocator.shrink_policy().window);
+  allocator.recover_all();
+  EXPECT_EQ(1, allocator.blocks_reserved());
+  EXPECT_GT(allocator.bytes_released(), 0);
+}
+
+TEST(stack_alloc, shrink_policy_env) {
+  setenv("STAN_STACK_ALLOC_SHRINK_WINDOW", "10", 1);
+  setenv("STAN_STACK_ALLOC_DECOMMIT", "1", 1);
+  stan::math::stack_alloc_config config
+      = stan::math::internal::get_env_stack_alloc_config();
+  EXPECT_EQ(10, config.shrink_policy.window);
+  EXPECT_TRUE(config.shrink_policy.decommit);
+  setenv("STAN_STACK_ALLOC_SHRINK_WINDOW", "-1", 1);
+  EXPECT_THROW(stan::math::internal::get_env_stack_alloc_config(),
+               std::invalid_argument);
+  unsetenv("STAN_STACK_ALLOC_SHRINK_WINDOW");
+  setenv("STAN_STACK_ALLOC_DECOMMIT", "2", 1);
+  EXPECT_THROW(stan::math::internal::get_env_stack_alloc_config(),
+               std::invalid_argument);
+  unsetenv("STAN_STACK_ALLOC_DECOMMIT");
+}
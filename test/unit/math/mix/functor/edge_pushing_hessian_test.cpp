@@ -0,0 +1,150 @@
+// This file builds as its own program, so defining STAN_COMPACT_TAPE here
+// keeps it the same in all its translation units
+#ifndef STAN_COMPACT_TAPE
+#define STAN_COMPACT_TAPE
+#endif
+#include <stan/math/mix.hpp>
+#include <test/unit/util.hpp>
+#include <gtest/gtest.h>
+
+namespace {
+
+// every operation of the compact tape, including operations whose two
+// operands are the same variable
+struct all_ops_fun {
+  template <typename T>
+  T operator()(const Eigen::Matrix<T, Eigen::Dynamic, 1>& x) const {
+    using stan::math::exp;
+    using stan::math::log;
+    using stan::math::sqrt;
+    using stan::math::square;
+    const int n = x.size();
+    T lp = 0;
+    for (int i = 0; i < n; ++i) {
+      const T& a = x(i);
+      const T& b = x((i + 1) % n);
+      lp += a * b + exp(a) / (1.0 + square(b)) - log(b) * sqrt(a);
+      lp += (2.0 - a) / b - 3.0 / a + a * a + a / a - (-b) * 0.5;
+      lp += (a + a) * (b - 1.0) / 4.0 + x(0) * a;
+    }
+    return lp;
+  }
+};
+
+struct with_sin_fun {
+  template <typename T>
+  T operator()(const Eigen::Matrix<T, Eigen::Dynamic, 1>& x) const {
+    return stan::math::sin(x(0)) * x(1) + x(1) * x(2) * x(2);
+  }
+};
+
+struct input_fun {
+  template <typename T>
+  T operator()(const Eigen::Matrix<T, Eigen::Dynamic, 1>& x) const {
+    return x(1);
+  }
+};
+
+void expect_same_hessian(const Eigen::VectorXd& x, double fx,
+                         const Eigen::VectorXd& grad, const Eigen::MatrixXd& H,
+                         double fx_ep, const Eigen::VectorXd& grad_ep,
+                         const Eigen::MatrixXd& H_ep) {
+  EXPECT_FLOAT_EQ(fx, fx_ep);
+  ASSERT_EQ(x.size(), grad_ep.size());
+  ASSERT_EQ(x.size(), H_ep.rows());
+  ASSERT_EQ(x.size(), H_ep.cols());
+  for (int i = 0; i < x.size(); ++i) {
+    EXPECT_NEAR(grad(i), grad_ep(i), 1e-10 * (1 + std::fabs(grad(i))));
+    for (int j = 0; j < x.size(); ++j) {
+      EXPECT_NEAR(H(i, j), H_ep(i, j), 1e-10 * (1 + std::fabs(H(i, j))))
+          << i << ", " << j;
+    }
+  }
+}
+
+}  // namespace
+
+TEST(MixFunctor, edge_pushing_hessian_all_ops) {
+  Eigen::VectorXd x(6);
+  x << 0.5, 1.25, 2.0, 0.75, 1.5, 3.0;
+  double fx;
+  Eigen::VectorXd grad;
+  Eigen::MatrixXd H;
+  stan::math::hessian(all_ops_fun(), x, fx, grad, H);
+
+  double fx_ep;
+  Eigen::VectorXd grad_ep;
+  Eigen::MatrixXd H_ep;
+  ASSERT_TRUE(stan::math::internal::edge_pushing_hessian(
+      all_ops_fun(), x, fx_ep, grad_ep, H_ep));
+  expect_same_hessian(x, fx, grad, H, fx_ep, grad_ep, H_ep);
+  EXPECT_EQ(0, stan::math::ChainableStack::instance_->var_stack_.size());
+}
+
+TEST(MixFunctor, edge_pushing_hessian_method) {
+  Eigen::VectorXd x = Eigen::VectorXd::LinSpaced(40, 0.2, 3.0);
+  double fx;
+  Eigen::VectorXd grad;
+  Eigen::MatrixXd H;
+  stan::math::hessian(all_ops_fun(), x, fx, grad, H);
+
+  double fx_ep;
+  Eigen::VectorXd grad_ep;
+  Eigen::MatrixXd H_ep;
+  stan::math::hessian(all_ops_fun(), x, fx_ep, grad_ep, H_ep,
+                      stan::math::hessian_method::edge_pushing);
+  expect_same_hessian(x, fx, grad, H, fx_ep, grad_ep, H_ep);
+
+  stan::math::hessian(all_ops_fun(), x, fx_ep, grad_ep, H_ep,
+                      stan::math::hessian_method::forward_over_reverse);
+  expect_same_hessian(x, fx, grad, H, fx_ep, grad_ep, H_ep);
+}
+
+TEST(MixFunctor, edge_pushing_hessian_fallback) {
+  Eigen::VectorXd x(3);
+  x << 0.5, -1.5, 2.0;
+  double fx;
+  Eigen::VectorXd grad;
+  Eigen::MatrixXd H;
+  EXPECT_FALSE(stan::math::internal::edge_pushing_hessian(with_sin_fun(), x,
+                                                          fx, grad, H));
+  stan::math::hessian(with_sin_fun(), x, fx, grad, H);
+
+  double fx_ep;
+  Eigen::VectorXd grad_ep;
+  Eigen::MatrixXd H_ep;
+  stan::math::hessian(with_sin_fun(), x, fx_ep, grad_ep, H_ep,
+                      stan::math::hessian_method::edge_pushing);
+  expect_same_hessian(x, fx, grad, H, fx_ep, grad_ep, H_ep);
+}
+
+TEST(MixFunctor, edge_pushing_hessian_linear) {
+  Eigen::VectorXd x(3);
+  x << 0.5, -1.5, 2.0;
+  double fx;
+  Eigen::VectorXd grad;
+  Eigen::MatrixXd H;
+  ASSERT_TRUE(stan::math::internal::edge_pushing_hessian(input_fun(), x, fx,
+                                                         grad, H));
+  Eigen::VectorXd grad_expected(3);
+  grad_expected << 0, 1, 0;
+  EXPECT_FLOAT_EQ(-1.5, fx);
+  EXPECT_MATRIX_FLOAT_EQ(grad_expected, grad);
+  EXPECT_MATRIX_FLOAT_EQ(Eigen::MatrixXd::Zero(3, 3), H);
+}
+
+TEST(MixFunctor, edge_pushing_hessian_nested) {
+  using stan::math::var;
+  var a = 3;
+  var b = a * a;
+  Eigen::VectorXd x(2);
+  x << 0.5, 2.0;
+  double fx;
+  Eigen::VectorXd grad;
+  Eigen::MatrixXd H;
+  stan::math::hessian(all_ops_fun(), x, fx, grad, H,
+                      stan::math::hessian_method::edge_pushing);
+  b.grad();
+  EXPECT_FLOAT_EQ(6, a.adj());
+  stan::math::recover_memory();
+}
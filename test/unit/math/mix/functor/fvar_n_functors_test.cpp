@@ -0,0 +1,88 @@
+#include <stan/math/mix.hpp>
+#include <gtest/gtest.h>
+
+namespace {
+
+struct hessian_fun {
+  template <typename T>
+  inline T operator()(const Eigen::Matrix<T, Eigen::Dynamic, 1>& x) const {
+    T y = 0;
+    for (int i = 0; i < x.size(); ++i) {
+      const T& a = x(i);
+      const T& b = x((i + 1) % x.size());
+      y += a * b * b + stan::math::exp(a) / (1 + stan::math::square(b))
+           - stan::math::log(b) * stan::math::sin(a);
+    }
+    return y;
+  }
+};
+
+}  // namespace
+
+TEST(MixFunctorFvarN, hessian) {
+  Eigen::VectorXd x(5);
+  x << 0.5, 1.5, 0.3, 2.0, 0.8;
+  double fx;
+  Eigen::VectorXd grad;
+  Eigen::MatrixXd H;
+  stan::math::hessian(hessian_fun(), x, fx, grad, H);
+  for (int width : {1, 2, 4, 8}) {
+    double fx_n;
+    Eigen::VectorXd grad_n;
+    Eigen::MatrixXd H_n;
+    if (width == 1) {
+      stan::math::hessian<1>(hessian_fun(), x, fx_n, grad_n, H_n);
+    } else if (width == 2) {
+      stan::math::hessian<2>(hessian_fun(), x, fx_n, grad_n, H_n);
+    } else if (width == 4) {
+      stan::math::hessian<4>(hessian_fun(), x, fx_n, grad_n, H_n);
+    } else {
+      stan::math::hessian<8>(hessian_fun(), x, fx_n, grad_n, H_n);
+    }
+    EXPECT_FLOAT_EQ(fx, fx_n);
+    ASSERT_EQ(5, H_n.rows());
+    ASSERT_EQ(5, H_n.cols());
+    for (int i = 0; i < 5; ++i) {
+      EXPECT_FLOAT_EQ(grad(i), grad_n(i));
+      for (int j = 0; j < 5; ++j) {
+        EXPECT_FLOAT_EQ(H(i, j), H_n(i, j)) << width << ": " << i << ", " << j;
+      }
+    }
+  }
+  EXPECT_TRUE(stan::math::empty_nested());
+}
+
+TEST(MixFunctorFvarN, hessian_size_zero) {
+  auto f = [](const auto& x) { return 3.0 + x.size(); };
+  Eigen::VectorXd x(0);
+  double fx;
+  Eigen::VectorXd grad;
+  Eigen::MatrixXd H;
+  stan::math::hessian<4>(f, x, fx, grad, H);
+  EXPECT_FLOAT_EQ(3.0, fx);
+  EXPECT_EQ(0, grad.size());
+  EXPECT_EQ(0, H.size());
+}
+
+TEST(MixFunctorFvarN, gradient_dot_vector) {
+  Eigen::VectorXd x(5);
+  x << 0.5, 1.5, 0.3, 2.0, 0.8;
+  Eigen::MatrixXd v(5, 3);
+  v << 1, 0, 0.5, 0, 1, -1, 2, 0, 0.25, 0, 3, 1, -1, 0, 2;
+  double fx;
+  Eigen::VectorXd grad_dot_v;
+  stan::math::gradient_dot_vector<2>(hessian_fun(), x, v, fx, grad_dot_v);
+  ASSERT_EQ(3, grad_dot_v.size());
+  for (int k = 0; k < 3; ++k) {
+    double fx_k;
+    double grad_dot_v_k;
+    Eigen::VectorXd v_k = v.col(k);
+    stan::math::gradient_dot_vector(hessian_fun(), x, v_k, fx_k, grad_dot_v_k);
+    EXPECT_FLOAT_EQ(fx_k, fx);
+    EXPECT_FLOAT_EQ(grad_dot_v_k, grad_dot_v(k));
+  }
+  Eigen::MatrixXd v_bad(4, 3);
+  EXPECT_THROW(stan::math::gradient_dot_vector<2>(hessian_fun(), x, v_bad, fx,
+                                                  grad_dot_v),
+               std::invalid_argument);
+}
@@ -0,0 +1,116 @@
+// This file builds as its own program, so defining STAN_COMPACT_TAPE here
+// keeps it the same in all its translation units
+#ifndef STAN_COMPACT_TAPE
+#define STAN_COMPACT_TAPE
+#endif
+#include <stan/math/mix.hpp>
+#include <test/unit/util.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+namespace {
+
+// recorded on the compact tape, so the products use second order sweeps
+struct compact_lp {
+  template <typename T>
+  T operator()(const Eigen::Matrix<T, Eigen::Dynamic, 1>& x) const {
+    using stan::math::exp;
+    using stan::math::log;
+    using stan::math::square;
+    T lp = 0;
+    for (int i = 0; i < x.size(); ++i) {
+      const T& a = x(i);
+      const T& b = x((i + 1) % x.size());
+      lp += a * b * b + exp(a) / (1.0 + square(b)) - log(1.0 + square(a));
+    }
+    return lp;
+  }
+};
+
+// sin is not on the compact tape, so every column takes its own call
+struct callback_lp {
+  template <typename T>
+  T operator()(const Eigen::Matrix<T, Eigen::Dynamic, 1>& x) const {
+    T lp = 0;
+    for (int i = 0; i < x.size(); ++i) {
+      lp += stan::math::sin(x(i)) * x((i + 2) % x.size()) + x(i) * x(i) * x(i);
+    }
+    return lp;
+  }
+};
+
+template <int N, typename F>
+void expect_hessian_times_matrix(const F& f, int num_directions) {
+  Eigen::VectorXd x(5);
+  x << 0.3, -1.2, 0.8, 2.0, -0.5;
+  Eigen::MatrixXd V(x.size(), num_directions);
+  for (int j = 0; j < num_directions; ++j) {
+    for (int i = 0; i < x.size(); ++i) {
+      V(i, j) = std::cos(1.0 + i + 3 * j);
+    }
+  }
+  double fx_expected;
+  Eigen::VectorXd grad;
+  Eigen::MatrixXd H;
+  stan::math::hessian(f, x, fx_expected, grad, H);
+
+  double fx;
+  Eigen::MatrixXd HV;
+  stan::math::hessian_times_vector<N>(f, x, V, fx, HV);
+  EXPECT_FLOAT_EQ(fx_expected, fx);
+  ASSERT_EQ(x.size(), HV.rows());
+  ASSERT_EQ(num_directions, HV.cols());
+  EXPECT_MATRIX_NEAR(H * V, HV, 1e-10);
+
+  for (int j = 0; j < num_directions; ++j) {
+    Eigen::VectorXd Hv;
+    stan::math::hessian_times_vector(f, x, Eigen::VectorXd(V.col(j)), fx, Hv);
+    EXPECT_MATRIX_NEAR(Hv, HV.col(j), 1e-10);
+  }
+  EXPECT_EQ(0, stan::math::ChainableStack::instance_->var_stack_.size());
+}
+
+}  // namespace
+
+TEST(MixFunctor, hessian_times_matrix_lanes) {
+  expect_hessian_times_matrix<1>(compact_lp(), 3);
+  expect_hessian_times_matrix<4>(compact_lp(), 4);
+  expect_hessian_times_matrix<4>(compact_lp(), 10);
+  expect_hessian_times_matrix<8>(compact_lp(), 3);
+}
+
+TEST(MixFunctor, hessian_times_matrix_reverse_passes) {
+  expect_hessian_times_matrix<1>(callback_lp(), 2);
+  expect_hessian_times_matrix<4>(callback_lp(), 7);
+  expect_hessian_times_matrix<8>(callback_lp(), 16);
+}
+
+TEST(MixFunctor, hessian_times_matrix_default_width) {
+  Eigen::VectorXd x(3);
+  x << 0.5, 1.0, -1.5;
+  Eigen::MatrixXd V = Eigen::MatrixXd::Identity(3, 3);
+  double fx;
+  Eigen::MatrixXd HV;
+  stan::math::hessian_times_vector(compact_lp(), x, V, fx, HV);
+  double fx_expected;
+  Eigen::VectorXd grad;
+  Eigen::MatrixXd H;
+  stan::math::hessian(compact_lp(), x, fx_expected, grad, H);
+  EXPECT_FLOAT_EQ(fx_expected, fx);
+  EXPECT_MATRIX_NEAR(H, HV, 1e-10);
+}
+
+TEST(MixFunctor, hessian_times_matrix_no_directions) {
+  Eigen::VectorXd x(3);
+  x << 0.5, 1.0, -1.5;
+  double fx;
+  Eigen::MatrixXd HV;
+  stan::math::hessian_times_vector(compact_lp(), x, Eigen::MatrixXd(3, 0), fx,
+                                   HV);
+  EXPECT_FLOAT_EQ(compact_lp()(x), fx);
+  EXPECT_EQ(3, HV.rows());
+  EXPECT_EQ(0, HV.cols());
+  EXPECT_THROW(stan::math::hessian_times_vector(compact_lp(), x,
+                                                Eigen::MatrixXd(2, 4), fx, HV),
+               std::invalid_argument);
+}
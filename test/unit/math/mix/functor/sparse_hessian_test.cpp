@@ -0,0 +1,104 @@
+#include <stan/math/mix.hpp>
+#include <test/unit/util.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// chain of pairwise interactions plus a global term on the first
+// variable: an arrowhead plus tridiagonal Hessian
+struct chain_lp {
+  int* calls_;
+  template <typename T>
+  T operator()(const Eigen::Matrix<T, Eigen::Dynamic, 1>& x) const {
+    ++*calls_;
+    T lp = 0;
+    for (int i = 0; i + 1 < x.size(); ++i) {
+      lp += stan::math::square(x(i + 1) - x(i)) * stan::math::exp(x(0));
+    }
+    return lp + stan::math::sum(stan::math::log1p(stan::math::square(x)));
+  }
+};
+
+struct separable {
+  template <typename T>
+  T operator()(const Eigen::Matrix<T, Eigen::Dynamic, 1>& x) const {
+    return stan::math::sum(stan::math::exp(x)) + x(0) * x(3);
+  }
+};
+
+}  // namespace
+
+TEST(MixFunctor, sparse_hessian_matches_dense) {
+  const int n = 10;
+  int calls = 0;
+  chain_lp f{&calls};
+  Eigen::VectorXd x = Eigen::VectorXd::LinSpaced(n, -0.5, 0.7);
+  x = x.array().square();
+  double fx;
+  Eigen::VectorXd grad;
+  Eigen::MatrixXd H;
+  stan::math::hessian(f, x, fx, grad, H);
+
+  Eigen::SparseMatrix<double> pattern = stan::math::hessian_sparsity(f, x);
+  EXPECT_EQ(n + 4 * (n - 1) - 2, pattern.nonZeros());
+
+  calls = 0;
+  double fx_sparse;
+  Eigen::VectorXd grad_sparse;
+  Eigen::SparseMatrix<double> H_sparse;
+  stan::math::sparse_hessian(f, x, pattern, fx_sparse, grad_sparse,
+                             H_sparse);
+  EXPECT_FLOAT_EQ(fx, fx_sparse);
+  EXPECT_MATRIX_FLOAT_EQ(grad, grad_sparse);
+  EXPECT_EQ(pattern.nonZeros(), H_sparse.nonZeros());
+  EXPECT_MATRIX_FLOAT_EQ(H, Eigen::MatrixXd(H_sparse));
+  // one evaluation per color instead of one per variable
+  EXPECT_GE(4, calls);
+  EXPECT_EQ(0, stan::math::ChainableStack::instance_->var_stack_.size());
+}
+
+TEST(MixFunctor, sparse_hessian_lower_triangle) {
+  Eigen::VectorXd x(4);
+  x << 0.5, -1, 2, 0.25;
+  Eigen::SparseMatrix<double> lower(4, 4);
+  for (int i = 0; i < 4; ++i) {
+    lower.insert(i, i) = 1;
+  }
+  lower.insert(3, 0) = 1;
+
+  double fx;
+  Eigen::VectorXd grad;
+  Eigen::SparseMatrix<double> H;
+  stan::math::sparse_hessian(separable(), x, lower, fx, grad, H);
+  Eigen::MatrixXd H_expected = x.array().exp().matrix().asDiagonal();
+  H_expected(0, 3) = 1;
+  H_expected(3, 0) = 1;
+  Eigen::VectorXd grad_expected = x.array().exp();
+  grad_expected(0) += x(3);
+  grad_expected(3) += x(0);
+  EXPECT_FLOAT_EQ(x.array().exp().sum() + x(0) * x(3), fx);
+  EXPECT_MATRIX_FLOAT_EQ(grad_expected, grad);
+  EXPECT_EQ(6, H.nonZeros());
+  EXPECT_MATRIX_FLOAT_EQ(H_expected, Eigen::MatrixXd(H));
+}
+
+TEST(MixFunctor, sparse_hessian_empty) {
+  int calls = 0;
+  chain_lp f{&calls};
+  Eigen::VectorXd x(0);
+  double fx = 1;
+  Eigen::VectorXd grad;
+  Eigen::SparseMatrix<double> H;
+  stan::math::sparse_hessian(f, x, Eigen::SparseMatrix<double>(0, 0), fx,
+                             grad, H);
+  EXPECT_FLOAT_EQ(0, fx);
+  EXPECT_EQ(1, calls);
+  EXPECT_EQ(0, grad.size());
+  EXPECT_EQ(0, H.rows());
+  EXPECT_THROW(stan::math::sparse_hessian(f, x,
+                                          Eigen::SparseMatrix<double>(1, 1),
+                                          fx, grad, H),
+               std::invalid_argument);
+}
@@ -0,0 +1,140 @@
+#include <stan/math/prim/core.hpp>
+
+#include <gtest/gtest.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(thread_affinity, parse_cpu_list) {
+  using stan::math::internal::parse_cpu_list;
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 8}), parse_cpu_list("0-3,8"));
+  EXPECT_EQ(std::vector<int>({2, 5, 6}), parse_cpu_list(" 6,5-5 ,2\n"));
+  EXPECT_TRUE(parse_cpu_list("").empty());
+  EXPECT_THROW(parse_cpu_list("0-"), std::invalid_argument);
+  EXPECT_THROW(parse_cpu_list("3-1"), std::invalid_argument);
+  EXPECT_THROW(parse_cpu_list("a"), std::invalid_argument);
+  EXPECT_THROW(parse_cpu_list("1x"), std::invalid_argument);
+}
+
+TEST(thread_affinity, topology) {
+  const auto& nodes = stan::math::numa_topology();
+  ASSERT_FALSE(nodes.empty());
+  std::vector<int> cpus;
+  for (const auto& node : nodes) {
+    EXPECT_FALSE(node.cpus_.empty());
+    cpus.insert(cpus.end(), node.cpus_.begin(), node.cpus_.end());
+    for (int cpu : node.cpus_) {
+      EXPECT_EQ(node.id_, stan::math::internal::numa_node_of(nodes, cpu));
+    }
+  }
+  std::sort(cpus.begin(), cpus.end());
+  EXPECT_EQ(stan::math::internal::allowed_cpus(), cpus);
+}
+
+TEST(thread_affinity, topology_without_sysfs) {
+  const auto allowed = stan::math::internal::allowed_cpus();
+  const auto missing
+      = stan::math::internal::read_numa_topology("/nonexistent/node");
+  ASSERT_EQ(1, missing.size());
+  EXPECT_EQ(0, missing[0].id_);
+  EXPECT_EQ(allowed, missing[0].cpus_);
+}
+
+TEST(thread_affinity, env) {
+  using stan::math::thread_affinity;
+  using stan::math::internal::get_thread_affinity;
+  unsetenv("STAN_THREAD_AFFINITY");
+  EXPECT_EQ(thread_affinity::none, get_thread_affinity());
+  setenv("STAN_THREAD_AFFINITY", "cores", 1);
+  EXPECT_EQ(thread_affinity::cores, get_thread_affinity());
+  setenv("STAN_THREAD_AFFINITY", "numa", 1);
+  EXPECT_EQ(thread_affinity::numa, get_thread_affinity());
+  setenv("STAN_THREAD_AFFINITY", "none", 1);
+  EXPECT_EQ(thread_affinity::none, get_thread_affinity());
+  setenv("STAN_THREAD_AFFINITY", "sockets", 1);
+  EXPECT_THROW(get_thread_affinity(), std::invalid_argument);
+  unsetenv("STAN_THREAD_AFFINITY");
+}
+
+#ifdef __linux__
+TEST(thread_affinity, pin_current_thread) {
+  using stan::math::internal::current_thread_numa_node;
+  using stan::math::internal::numa_node_change_hook;
+  using stan::math::internal::pin_current_thread;
+  const auto allowed = stan::math::internal::allowed_cpus();
+  static int num_changes = 0;
+  auto* hook = numa_node_change_hook();
+  numa_node_change_hook() = [] { ++num_changes; };
+  std::thread worker([&] {
+    EXPECT_EQ(-1, current_thread_numa_node());
+    EXPECT_TRUE(pin_current_thread({allowed.back()}, 7));
+    EXPECT_EQ(allowed.back(), sched_getcpu());
+    EXPECT_EQ(std::vector<int>({allowed.back()}),
+              stan::math::internal::allowed_cpus());
+    EXPECT_EQ(7, current_thread_numa_node());
+    EXPECT_TRUE(pin_current_thread(allowed, 7));
+    EXPECT_FALSE(pin_current_thread({-1}, 3));
+    EXPECT_EQ(7, current_thread_numa_node());
+  });
+  worker.join();
+  numa_node_change_hook() = hook;
+  EXPECT_EQ(1, num_changes);
+}
+#endif
+
+TEST(thread_affinity, numa_task_arenas) {
+  using stan::math::thread_affinity;
+  const auto& nodes = stan::math::numa_topology();
+  EXPECT_THROW(stan::math::numa_task_arenas(nodes, thread_affinity::none),
+               std::invalid_argument);
+  EXPECT_THROW(stan::math::numa_task_arenas(nodes, thread_affinity::numa, -1),
+               std::invalid_argument);
+
+  for (auto affinity : {thread_affinity::cores, thread_affinity::numa}) {
+    stan::math::numa_task_arenas arenas(nodes, affinity, 2);
+    ASSERT_EQ(nodes.size(), arenas.size());
+    for (size_t i = 0; i < arenas.size(); ++i) {
+      EXPECT_EQ(nodes[i].id_, arenas.node(i).id_);
+      EXPECT_EQ(2, arenas[i].max_concurrency());
+      std::atomic<int> sum{0};
+      std::atomic<int> misplaced{0};
+      const int node_id = arenas.node(i).id_;
+      arenas[i].execute([&] {
+        tbb::parallel_for(0, 1000, [&](int k) {
+          sum += k;
+          const int node = stan::math::internal::current_thread_numa_node();
+          if (node != -1 && node != node_id) {
+            ++misplaced;
+          }
+        });
+      });
+      EXPECT_EQ(999 * 1000 / 2, sum.load());
+      EXPECT_EQ(0, misplaced.load());
+    }
+  }
+}
+
+#ifdef __linux__
+TEST(thread_affinity, init_threadpool_tbb_pinned) {
+  setenv("STAN_THREAD_AFFINITY", "sockets", 1);
+  EXPECT_THROW(stan::math::init_threadpool_tbb_pinned(2),
+               std::invalid_argument);
+  setenv("STAN_THREAD_AFFINITY", "cores", 1);
+  stan::math::init_threadpool_tbb_pinned(2);
+  unsetenv("STAN_THREAD_AFFINITY");
+  const auto& nodes = stan::math::numa_topology();
+  std::atomic<int> misplaced{0};
+  tbb::parallel_for(0, 1000, [&](int k) {
+    const int node = stan::math::internal::current_thread_numa_node();
+    if (node != -1 && stan::math::internal::numa_node_of(nodes, sched_getcpu())
+                          != node) {
+      ++misplaced;
+    }
+  });
+  EXPECT_EQ(0, misplaced.load());
+}
+#endif
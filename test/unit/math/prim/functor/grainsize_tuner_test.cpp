@@ -0,0 +1,76 @@
+#include <stan/math/prim.hpp>
+#include <gtest/gtest.h>
+#include <tbb/task_arena.h>
+
+TEST(grainsize_tuner, fit_cost_and_overhead) {
+  stan::math::grainsize_tuner tuner;
+  EXPECT_EQ(1, tuner.grainsize());
+
+  // chunks take 1e-4 seconds plus 1e-6 seconds per term
+  stan::math::chunk_timings timings;
+  for (int n = 1; n <= 100; ++n) {
+    timings.add(n, 1e-4 + 1e-6 * n);
+  }
+  tuner.update(100000000, timings);
+
+  auto summary = tuner.get_summary();
+  EXPECT_EQ(1, summary.num_evaluations_);
+  EXPECT_NEAR(1e-6, summary.cost_per_term_, 1e-12);
+  EXPECT_NEAR(1e-4, summary.overhead_per_chunk_, 1e-10);
+  // the overhead must be at most a tenth of the time of a chunk
+  EXPECT_NEAR(1000, tuner.grainsize(), 1);
+  EXPECT_EQ(summary.grainsize_, tuner.grainsize());
+
+  tuner.reset();
+  EXPECT_EQ(1, tuner.grainsize());
+  EXPECT_EQ(0, tuner.get_summary().num_evaluations_);
+}
+
+TEST(grainsize_tuner, equal_chunks_and_load_balance) {
+  stan::math::grainsize_tuner tuner;
+  stan::math::chunk_timings timings;
+  timings.add(10, 1e-6);
+  timings.add(10, 1e-6);
+
+  // without overhead, chunks must take at least target_chunk_time
+  tuner.update(100000000, timings);
+  EXPECT_NEAR(1e-7, tuner.get_summary().cost_per_term_, 1e-15);
+  EXPECT_EQ(0.0, tuner.get_summary().overhead_per_chunk_);
+  EXPECT_NEAR(stan::math::grainsize_tuner::target_chunk_time / 1e-7,
+              tuner.grainsize(), 1);
+
+  // leave enough chunks for every thread
+  tuner.reset();
+  tuner.update(100, timings);
+  const int max_grainsize = std::max(
+      1, 100
+             / (stan::math::grainsize_tuner::min_chunks_per_thread
+                * tbb::this_task_arena::max_concurrency()));
+  EXPECT_EQ(max_grainsize, tuner.grainsize());
+}
+
+TEST(grainsize_tuner, tuning_schedule) {
+  stan::math::grainsize_tuner tuner;
+  stan::math::chunk_timings fast;
+  fast.add(1, 1e-6);
+  stan::math::chunk_timings slow;
+  slow.add(1, 1e-3);
+
+  tuner.update(100000000, fast);
+  const int grainsize = tuner.grainsize();
+  EXPECT_LT(1, grainsize);
+
+  // the second evaluation is tuned, the third is not
+  tuner.update(100000000, slow);
+  const int retuned_grainsize = tuner.grainsize();
+  EXPECT_GT(grainsize, retuned_grainsize);
+  tuner.update(100000000, slow);
+  EXPECT_EQ(retuned_grainsize, tuner.grainsize());
+
+  // the older timings are forgotten
+  for (int i = 0; i < 20; ++i) {
+    tuner.update(100000000, slow);
+  }
+  EXPECT_EQ(1, tuner.grainsize());
+  EXPECT_EQ(23, tuner.get_summary().num_evaluations_);
+}
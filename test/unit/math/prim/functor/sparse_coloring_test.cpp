@@ -0,0 +1,175 @@
+#include <stan/math/prim.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+
+Eigen::SparseMatrix<double> banded(int n, int lower, int upper) {
+  std::vector<Eigen::Triplet<double>> nonzeros;
+  for (int i = 0; i < n; ++i) {
+    for (int j = std::max(0, i - lower); j <= std::min(n - 1, i + upper);
+         ++j) {
+      nonzeros.emplace_back(i, j, 1.0);
+    }
+  }
+  Eigen::SparseMatrix<double> pattern(n, n);
+  pattern.setFromTriplets(nonzeros.begin(), nonzeros.end());
+  return pattern;
+}
+
+Eigen::SparseMatrix<double> arrowhead(int n) {
+  std::vector<Eigen::Triplet<double>> nonzeros;
+  for (int i = 0; i < n; ++i) {
+    nonzeros.emplace_back(i, i, 1.0);
+    if (i > 0) {
+      nonzeros.emplace_back(i, 0, 1.0);
+      nonzeros.emplace_back(0, i, 1.0);
+    }
+  }
+  Eigen::SparseMatrix<double> pattern(n, n);
+  pattern.setFromTriplets(nonzeros.begin(), nonzeros.end());
+  return pattern;
+}
+
+// no two columns of a color share a row
+void expect_column_coloring(const Eigen::SparseMatrix<double>& pattern,
+                            const std::vector<int>& colors, int num_colors) {
+  Eigen::MatrixXd dense(pattern);
+  for (int i = 0; i < dense.rows(); ++i) {
+    std::vector<int> count(num_colors, 0);
+    for (int j = 0; j < dense.cols(); ++j) {
+      if (dense(i, j) != 0) {
+        ASSERT_LT(colors[j], num_colors);
+        EXPECT_EQ(1, ++count[colors[j]]) << "row " << i << " column " << j;
+      }
+    }
+  }
+}
+
+// every nonzero (i, j) is the only one of row i with the color of j or
+// the only one of row j with the color of i
+void expect_star_coloring(const Eigen::SparseMatrix<double>& pattern,
+                          const std::vector<int>& colors, int num_colors) {
+  Eigen::MatrixXd dense(pattern);
+  const int n = dense.rows();
+  auto unique_in_row = [&](int i, int j) {
+    for (int k = 0; k < n; ++k) {
+      if (k != j && dense(i, k) != 0 && colors[k] == colors[j]) {
+        return false;
+      }
+    }
+    return true;
+  };
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      if (dense(i, j) != 0) {
+        ASSERT_LT(colors[j], num_colors);
+        EXPECT_TRUE(unique_in_row(i, j) || unique_in_row(j, i))
+            << "element " << i << ", " << j;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(MathFunctor, color_columns_diagonal) {
+  std::vector<int> colors;
+  EXPECT_EQ(1, stan::math::internal::color_columns(banded(7, 0, 0), colors));
+  EXPECT_EQ(std::vector<int>(7, 0), colors);
+}
+
+TEST(MathFunctor, color_columns_banded) {
+  std::vector<int> colors;
+  auto tridiagonal = banded(10, 1, 1);
+  EXPECT_EQ(3, stan::math::internal::color_columns(tridiagonal, colors));
+  expect_column_coloring(tridiagonal, colors, 3);
+
+  auto wide = banded(20, 2, 3);
+  int num_colors = stan::math::internal::color_columns(wide, colors);
+  EXPECT_EQ(6, num_colors);
+  expect_column_coloring(wide, colors, num_colors);
+}
+
+TEST(MathFunctor, color_columns_rectangular) {
+  // each row couples a pair of columns
+  Eigen::SparseMatrix<double> pattern(5, 9);
+  for (int i = 0; i < 5; ++i) {
+    pattern.insert(i, i) = 1;
+    pattern.insert(i, 4 + i) = 1;
+  }
+  std::vector<int> colors;
+  int num_colors = stan::math::internal::color_columns(pattern, colors);
+  EXPECT_EQ(2, num_colors);
+  expect_column_coloring(pattern, colors, num_colors);
+
+  Eigen::SparseMatrix<double> pattern_t = pattern.transpose();
+  num_colors = stan::math::internal::color_columns(pattern_t, colors);
+  EXPECT_EQ(5, colors.size());
+  expect_column_coloring(pattern_t, colors, num_colors);
+}
+
+TEST(MathFunctor, color_columns_empty) {
+  std::vector<int> colors;
+  EXPECT_EQ(0, stan::math::internal::color_columns(
+                   Eigen::SparseMatrix<double>(3, 0), colors));
+  EXPECT_TRUE(colors.empty());
+  EXPECT_EQ(1, stan::math::internal::color_columns(
+                   Eigen::SparseMatrix<double>(0, 4), colors));
+  EXPECT_EQ(std::vector<int>(4, 0), colors);
+}
+
+TEST(MathFunctor, star_color_arrowhead) {
+  using stan::math::internal::star_color;
+  using stan::math::internal::symmetric_adjacency;
+  auto pattern = arrowhead(12);
+  std::vector<int> colors;
+  EXPECT_EQ(12, stan::math::internal::color_columns(pattern, colors));
+  EXPECT_EQ(2, star_color(symmetric_adjacency(pattern), colors));
+  expect_star_coloring(pattern, colors, 2);
+}
+
+TEST(MathFunctor, star_color_banded) {
+  using stan::math::internal::star_color;
+  using stan::math::internal::symmetric_adjacency;
+  std::vector<int> colors;
+  for (int bandwidth = 1; bandwidth < 4; ++bandwidth) {
+    auto pattern = banded(30, bandwidth, bandwidth);
+    int num_colors = star_color(symmetric_adjacency(pattern), colors);
+    EXPECT_LE(num_colors, 2 * bandwidth + 1);
+    expect_star_coloring(pattern, colors, num_colors);
+  }
+}
+
+TEST(MathFunctor, star_color_random) {
+  using stan::math::internal::star_color;
+  using stan::math::internal::symmetric_adjacency;
+  std::srand(17);
+  for (int trial = 0; trial < 20; ++trial) {
+    const int n = 25;
+    Eigen::SparseMatrix<double> pattern(n, n);
+    for (int k = 0; k < 40; ++k) {
+      const int i = std::rand() % n;
+      const int j = std::rand() % n;
+      pattern.coeffRef(i, j) = 1;
+      pattern.coeffRef(j, i) = 1;
+    }
+    std::vector<int> colors;
+    int num_colors = star_color(symmetric_adjacency(pattern), colors);
+    expect_star_coloring(pattern, colors, num_colors);
+  }
+}
+
+TEST(MathFunctor, symmetric_adjacency_lower_triangle) {
+  Eigen::SparseMatrix<double> lower(4, 4);
+  lower.insert(0, 0) = 1;
+  lower.insert(2, 0) = 1;
+  lower.insert(3, 2) = 1;
+  lower.insert(3, 0) = 1;
+  auto adjacency = stan::math::internal::symmetric_adjacency(lower);
+  ASSERT_EQ(4, adjacency.size());
+  EXPECT_EQ(std::vector<int>({2, 3}), adjacency[0]);
+  EXPECT_TRUE(adjacency[1].empty());
+  EXPECT_EQ(std::vector<int>({0, 3}), adjacency[2]);
+  EXPECT_EQ(std::vector<int>({0, 2}), adjacency[3]);
+}
@@ -35,3 +35,10 @@ void arena_allocator_test() {
 TEST(AgradRev, arena_allocator_test) {
   EXPECT_NO_THROW(arena_allocator_test());
 }
+
+TEST(AgradRev, arena_allocator_aligned_test) {
+  stan::math::ChainableStack::instance_->memalloc_.alloc(8);
+  std::vector<double, stan::math::arena_allocator<double>> v(100, 1.0);
+  EXPECT_TRUE(stan::math::is_aligned(v.data(), STAN_ARENA_ALIGNMENT));
+  stan::math::recover_memory();
+}
@@ -104,3 +104,32 @@ TEST(AgradRev, arena_matrix_transpose_test) {
 
   stan::math::recover_memory();
 }
+
+TEST(AgradRev, arena_matrix_aligned_test) {
+  using Eigen::MatrixXd;
+  using Eigen::VectorXd;
+  using stan::math::arena_matrix;
+
+  stan::math::ChainableStack::instance_->memalloc_.alloc(8);
+  arena_matrix<MatrixXd> a(MatrixXd::Random(7, 5));
+  EXPECT_TRUE(stan::math::is_aligned(a.data(), STAN_ARENA_ALIGNMENT));
+  stan::math::ChainableStack::instance_->memalloc_.alloc(8);
+  arena_matrix<VectorXd> b(20);
+  EXPECT_TRUE(stan::math::is_aligned(b.data(), STAN_ARENA_ALIGNMENT));
+  stan::math::ChainableStack::instance_->memalloc_.alloc(8);
+  arena_matrix<VectorXd> c = VectorXd::Ones(3);
+  EXPECT_TRUE(stan::math::is_aligned(
+      c.data(), stan::math::internal::SMALL_ARRAY_ALIGNMENT));
+
+  auto a_map = stan::math::as_aligned_map(a);
+  EXPECT_MATRIX_EQ(a, a_map);
+  a_map(1, 1) = 3;
+  EXPECT_EQ(3, a(1, 1));
+  EXPECT_MATRIX_EQ(c, stan::math::as_aligned_map(c));
+
+  // to_arena copies are aligned as well
+  stan::math::ChainableStack::instance_->memalloc_.alloc(8);
+  auto d = stan::math::to_arena(MatrixXd::Random(10, 10));
+  EXPECT_TRUE(stan::math::is_aligned(d.data(), STAN_ARENA_ALIGNMENT));
+  stan::math::recover_memory();
+}
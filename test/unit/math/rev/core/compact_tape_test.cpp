@@ -0,0 +1,167 @@
+// This file builds as its own program, so defining STAN_COMPACT_TAPE here
+// keeps it the same in all its translation units
+#ifndef STAN_COMPACT_TAPE
+#define STAN_COMPACT_TAPE
+#endif
+#include <stan/math/rev.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <set>
+
+struct compact_tape_fun {
+  template <typename T>
+  inline T operator()(const Eigen::Matrix<T, Eigen::Dynamic, 1>& x) const {
+    using stan::math::exp;
+    using stan::math::log;
+    using stan::math::sqrt;
+    using stan::math::square;
+    T y = exp(x(0) * x(1)) / (x(0) - x(1)) + log(x(0)) + sqrt(x(1));
+    y = y + square(x(0)) - 2.0 * x(1) + 3.0 / x(0) - x(1) / 4.0;
+    y = y + (1.5 - x(0)) + (x(1) - 0.5) + (x(0) + 2.0) + (2.0 + x(1));
+    return -y * (x(0) * 0.5) + x(1) * x(0) / x(1);
+  }
+};
+
+TEST(AgradRevCompactTape, gradient) {
+  Eigen::VectorXd x(2);
+  x << 1.3, 0.4;
+  double fx;
+  Eigen::VectorXd grad_fx;
+  stan::math::gradient(compact_tape_fun(), x, fx, grad_fx);
+
+  double fx_fd;
+  Eigen::VectorXd grad_fx_fd;
+  stan::math::finite_diff_gradient(compact_tape_fun(), x, fx_fd, grad_fx_fd);
+  EXPECT_FLOAT_EQ(fx_fd, fx);
+  EXPECT_NEAR(grad_fx_fd(0), grad_fx(0), 1e-6);
+  EXPECT_NEAR(grad_fx_fd(1), grad_fx(1), 1e-6);
+}
+
+TEST(AgradRevCompactTape, one_stack_entry_per_run) {
+  using stan::math::var;
+  stan::math::recover_memory();
+  auto& stack = *stan::math::ChainableStack::instance_;
+  var a = 2.0;
+  var b = 3.0;
+  const size_t start = stack.var_stack_.size();
+  var c = a;
+  for (int i = 0; i < 5; ++i) {
+    c = c * b + a;
+  }
+  EXPECT_EQ(start + 1, stack.var_stack_.size());
+
+  // a vari pushed by another operation ends the range
+  var d = stan::math::sin(c);
+  var e = d + a;
+  EXPECT_EQ(start + 3, stack.var_stack_.size());
+
+  e.grad();
+  double grad_a = 0;
+  double pow_b = 1;
+  for (int i = 0; i < 5; ++i) {
+    grad_a += pow_b;
+    pow_b *= 3.0;
+  }
+  grad_a += pow_b;
+  EXPECT_FLOAT_EQ(std::cos(c.val()) * grad_a + 1.0, a.adj());
+  stan::math::recover_memory();
+}
+
+TEST(AgradRevCompactTape, interleaved_operations_share_segments) {
+  using stan::math::var;
+  using stan::math::internal::compact_tape_range;
+  using stan::math::internal::compact_tape_segment;
+  stan::math::recover_memory();
+  auto& stack = *stan::math::ChainableStack::instance_;
+  var a = 0.5;
+  const size_t start = stack.var_stack_.size();
+  var c = a;
+  const int n = 100;
+  for (int i = 0; i < n; ++i) {
+    c = stan::math::sin(c) * 0.5;
+  }
+  // every operation gets its own range, in segments of 16, 32 and 64
+  // operations
+  std::set<const compact_tape_segment*> segments;
+  int num_ranges = 0;
+  for (size_t i = start; i < stack.var_stack_.size(); ++i) {
+    const auto* range
+        = dynamic_cast<const compact_tape_range*>(stack.var_stack_[i]);
+    if (range != nullptr) {
+      EXPECT_EQ(1, range->end_ - range->begin_);
+      segments.insert(range->segment_);
+      ++num_ranges;
+    }
+  }
+  EXPECT_EQ(n, num_ranges);
+  EXPECT_EQ(3, segments.size());
+
+  c.grad();
+  double x = a.val();
+  double grad_a = 1;
+  for (int i = 0; i < n; ++i) {
+    grad_a *= 0.5 * std::cos(x);
+    x = 0.5 * std::sin(x);
+  }
+  EXPECT_FLOAT_EQ(x, c.val());
+  EXPECT_FLOAT_EQ(grad_a, a.adj());
+  stan::math::set_zero_all_adjoints();
+  EXPECT_FLOAT_EQ(0.0, c.adj());
+  stan::math::recover_memory();
+}
+
+TEST(AgradRevCompactTape, segments_grow) {
+  using stan::math::var;
+  stan::math::recover_memory();
+  auto& stack = *stan::math::ChainableStack::instance_;
+  var a = 1.0;
+  const size_t start = stack.var_stack_.size();
+  var c = a;
+  const int n = 5000;
+  for (int i = 0; i < n; ++i) {
+    c = c + 1.0;
+  }
+  // capacities 16, 32, ..., 1024, 1024, ...
+  EXPECT_LT(stack.var_stack_.size() - start, 12);
+  EXPECT_FLOAT_EQ(1.0 + n, c.val());
+  c.grad();
+  EXPECT_FLOAT_EQ(1.0, a.adj());
+  stan::math::recover_memory();
+}
+
+TEST(AgradRevCompactTape, zero_adjoints) {
+  using stan::math::var;
+  stan::math::recover_memory();
+  var a = 2.0;
+  var b = a * a;
+  var c = b * a;
+  c.grad();
+  EXPECT_FLOAT_EQ(12.0, a.adj());
+  stan::math::set_zero_all_adjoints();
+  EXPECT_FLOAT_EQ(0.0, a.adj());
+  EXPECT_FLOAT_EQ(0.0, b.adj());
+  EXPECT_FLOAT_EQ(0.0, c.adj());
+  stan::math::grad(b.vi_);
+  EXPECT_FLOAT_EQ(4.0, a.adj());
+  EXPECT_FLOAT_EQ(0.0, c.adj());
+  stan::math::recover_memory();
+}
+
+TEST(AgradRevCompactTape, nested) {
+  using stan::math::var;
+  stan::math::recover_memory();
+  var a = 2.0;
+  var b = a * 3.0;
+  {
+    stan::math::nested_rev_autodiff nested;
+    var x = 4.0;
+    var y = x * x - x;
+    y.grad();
+    EXPECT_FLOAT_EQ(7.0, x.adj());
+  }
+  EXPECT_FLOAT_EQ(0.0, a.adj());
+  var c = b * b;
+  c.grad();
+  EXPECT_FLOAT_EQ(36.0, a.adj());
+  stan::math::recover_memory();
+}
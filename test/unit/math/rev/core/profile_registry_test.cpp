@@ -0,0 +1,187 @@
+#include <stan/math/rev.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <thread>
+
+TEST(ProfileRegistry, register_region) {
+  auto& registry = stan::math::profile_registry::instance();
+  const int a = registry.register_region("registry_a");
+  const int b = registry.register_region("registry_b");
+  EXPECT_NE(a, b);
+  EXPECT_EQ(a, registry.register_region("registry_a"));
+  EXPECT_EQ("registry_b", registry.region_name(b));
+  EXPECT_THROW(registry.register_region("a/b"), std::invalid_argument);
+}
+
+TEST(ProfileRegistry, nested_double) {
+  using stan::math::profile_scope;
+  auto& registry = stan::math::profile_registry::instance();
+  registry.clear();
+  const int outer = registry.register_region("outer");
+  const int inner = registry.register_region("inner");
+  double x = 0;
+  for (int i = 0; i < 10; ++i) {
+    profile_scope<double> p_outer(outer);
+    x += i;
+    for (int j = 0; j < 3; ++j) {
+      profile_scope<double> p_inner(inner);
+      x *= 1.01;
+    }
+  }
+  {
+    profile_scope<double> p_inner(inner);
+    x += 1;
+  }
+  auto regions = registry.aggregate();
+  ASSERT_EQ(3, regions.size());
+  EXPECT_EQ(10, regions["outer"].num_fwd_passes_);
+  EXPECT_EQ(30, regions["outer/inner"].num_fwd_passes_);
+  EXPECT_EQ(1, regions["inner"].num_fwd_passes_);
+  EXPECT_EQ(0, regions["outer"].num_rev_passes_);
+  EXPECT_GT(regions["outer"].fwd_time_, 0.0);
+  EXPECT_LE(regions["outer/inner"].fwd_time_, regions["outer"].fwd_time_);
+}
+
+TEST(ProfileRegistry, var_reverse_pass) {
+  using stan::math::profile_scope;
+  using stan::math::var;
+  auto& registry = stan::math::profile_registry::instance();
+  registry.clear();
+  const int outer = registry.register_region("outer");
+  const int inner = registry.register_region("inner");
+  var a = 2.0;
+  var c = 0;
+  for (int i = 0; i < 5; ++i) {
+    profile_scope<var> p_outer(outer);
+    {
+      profile_scope<var> p_inner(inner);
+      c = c + a * i;
+    }
+    c = stan::math::exp(c / 100.0);
+  }
+  c.grad();
+  auto regions = registry.aggregate();
+  EXPECT_EQ(5, regions["outer"].num_rev_passes_);
+  EXPECT_EQ(5, regions["outer/inner"].num_rev_passes_);
+  EXPECT_GT(regions["outer"].rev_time_, 0.0);
+  stan::math::recover_memory();
+}
+
+TEST(ProfileRegistry, reverse_pass_on_other_thread) {
+  using stan::math::profile_scope;
+  using stan::math::var;
+  auto& registry = stan::math::profile_registry::instance();
+  registry.clear();
+  const int outer = registry.register_region("outer");
+  const int inner = registry.register_region("inner");
+  stan::math::ScopedChainableStack tape;
+  var c = tape.execute([&]() {
+    var a = 2.0;
+    profile_scope<var> p_outer(outer);
+    profile_scope<var> p_inner(inner);
+    return a * a;
+  });
+  std::thread t([&]() { tape.execute([&]() { c.grad(); }); });
+  const auto rev_thread = t.get_id();
+  t.join();
+
+  auto regions = registry.aggregate();
+  EXPECT_EQ(1, regions["outer/inner"].num_fwd_passes_);
+  EXPECT_EQ(1, regions["outer/inner"].num_rev_passes_);
+  size_t num_threads_with_region = 0;
+  for (const auto& thread : registry.per_thread()) {
+    auto it = thread.second.find("outer/inner");
+    if (it == thread.second.end()) {
+      continue;
+    }
+    ++num_threads_with_region;
+    if (thread.first == rev_thread) {
+      EXPECT_EQ(0, it->second.num_fwd_passes_);
+      EXPECT_EQ(1, it->second.num_rev_passes_);
+    } else {
+      EXPECT_EQ(1, it->second.num_fwd_passes_);
+      EXPECT_EQ(0, it->second.num_rev_passes_);
+    }
+  }
+  EXPECT_EQ(2, num_threads_with_region);
+}
+
+TEST(ProfileRegistry, clear_with_live_callbacks) {
+  using stan::math::profile_scope;
+  using stan::math::var;
+  auto& registry = stan::math::profile_registry::instance();
+  registry.clear();
+  const int outer = registry.register_region("outer");
+  const int inner = registry.register_region("inner");
+  var a = 2.0;
+  var c;
+  {
+    profile_scope<var> p_outer(outer);
+    {
+      profile_scope<var> p_inner(inner);
+      c = a * a;
+    }
+    // the open scope is not recorded
+    registry.clear();
+  }
+  c.grad();
+  auto regions = registry.aggregate();
+  EXPECT_EQ(0, regions["outer"].num_fwd_passes_);
+  EXPECT_EQ(1, regions["outer"].num_rev_passes_);
+  EXPECT_EQ(0, regions["outer/inner"].num_fwd_passes_);
+  EXPECT_EQ(1, regions["outer/inner"].num_rev_passes_);
+  stan::math::recover_memory();
+}
+
+TEST(ProfileRegistry, threads) {
+  using stan::math::profile_scope;
+  auto& registry = stan::math::profile_registry::instance();
+  registry.clear();
+  const int region = registry.register_region("work");
+  auto work = [&]() {
+    for (int i = 0; i < 100; ++i) {
+      profile_scope<double> p(region);
+    }
+  };
+  std::thread t1(work);
+  std::thread t2(work);
+  t1.join();
+  t2.join();
+  EXPECT_EQ(200, registry.aggregate()["work"].num_fwd_passes_);
+  size_t num_threads_with_work = 0;
+  for (const auto& thread : registry.per_thread()) {
+    auto it = thread.second.find("work");
+    if (it != thread.second.end()) {
+      EXPECT_EQ(100, it->second.num_fwd_passes_);
+      ++num_threads_with_work;
+    }
+  }
+  EXPECT_EQ(2, num_threads_with_work);
+
+  std::stringstream csv;
+  registry.write_csv(csv);
+  EXPECT_EQ(0, csv.str().find("region,fwd_passes,rev_passes,fwd_time"));
+  EXPECT_NE(std::string::npos, csv.str().find("\"work\",200,0,"));
+}
+
+TEST(ProfileRegistry, hardware_counters) {
+  using stan::math::profile_scope;
+  auto& registry = stan::math::profile_registry::instance();
+  registry.enable_hardware_counters(true);
+  // counters are opened by the first region entered on a thread, which
+  // may not be permitted on this system
+  std::thread t([&]() {
+    const int region = registry.register_region("counted");
+    double x = 1;
+    for (int i = 0; i < 1000; ++i) {
+      profile_scope<double> p(region);
+      x = x * 1.0001 + 1;
+    }
+    EXPECT_GT(x, 1.0);
+  });
+  t.join();
+  registry.enable_hardware_counters(false);
+  auto stats = registry.aggregate()["counted"];
+  EXPECT_EQ(1000, stats.num_fwd_passes_);
+}
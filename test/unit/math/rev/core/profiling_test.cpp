@@ -1,5 +1,10 @@
 #include <stan/math/rev.hpp>
 #include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 TEST(Profiling, double_basic) {
   using stan::math::profile;
@@ -14,6 +19,7 @@ TEST(Profiling, double_basic) {
     profile<int> p1("p1", profiles);
     c = a + b;
   }
+  stan::math::merge_profiles(profiles);
   stan::math::profile_key key = {"p1", std::this_thread::get_id()};
   EXPECT_EQ(profiles[key].get_chain_stack_used(), 0);
   EXPECT_EQ(profiles[key].get_nochain_stack_used(), 0);
@@ -38,6 +44,7 @@ TEST(Profiling, var_basic) {
   }
   c.grad();
   stan::math::recover_memory();
+  stan::math::merge_profiles(profiles);
   stan::math::profile_key key = {"t1", std::this_thread::get_id()};
   EXPECT_EQ(profiles[key].get_chain_stack_used(), 1);
   EXPECT_EQ(profiles[key].get_nochain_stack_used(), 2);
@@ -64,6 +71,7 @@ TEST(Profiling, var_exception) {
   } catch (const std::exception& e) {
   }
   stan::math::recover_memory();
+  stan::math::merge_profiles(profiles);
   stan::math::profile_key key_t1 = {"t1", std::this_thread::get_id()};
   EXPECT_EQ(profiles[key_t1].get_chain_stack_used(), 1);
   EXPECT_EQ(profiles[key_t1].get_nochain_stack_used(), 2);
@@ -91,6 +99,7 @@ TEST(Profiling, var_loop) {
   }
   c.grad();
   stan::math::recover_memory();
+  stan::math::merge_profiles(profiles);
   stan::math::profile_key key_t1 = {"t1", std::this_thread::get_id()};
   EXPECT_EQ(profiles[key_t1].get_chain_stack_used(), N);
   EXPECT_EQ(profiles[key_t1].get_nochain_stack_used(), 2 * N);
@@ -109,3 +118,160 @@ TEST(Profiling, duplicate_active_profile) {
   profile<var> t1("t1", profiles);
   EXPECT_THROW(profile<var>("t1", profiles), std::runtime_error);
 }
+
+TEST(Profiling, threads_record_own_profiles) {
+  using stan::math::profile;
+  stan::math::profile_map profiles;
+  const int num_threads = 4;
+  const int N = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&profiles, t]() {
+      for (int i = 0; i < N; ++i) {
+        profile<double> p1("p1", profiles);
+        if (i % 2 == t % 2) {
+          profile<double> p2("p2", profiles);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  stan::math::merge_profiles(profiles);
+  EXPECT_EQ(2 * num_threads, profiles.size());
+  for (const auto& p : profiles) {
+    EXPECT_EQ(p.first.first == "p1" ? N : N / 2,
+              p.second.get_num_fwd_passes());
+  }
+  auto aggregated = stan::math::aggregate_profiles(profiles);
+  ASSERT_EQ(2, aggregated.size());
+  EXPECT_EQ(num_threads * N, aggregated["p1"].get_num_fwd_passes());
+  EXPECT_EQ(num_threads * N / 2, aggregated["p2"].get_num_no_AD_fwd_passes());
+  double p1_time = 0;
+  for (const auto& p : profiles) {
+    if (p.first.first == "p1") {
+      p1_time += p.second.get_fwd_time();
+    }
+  }
+  EXPECT_FLOAT_EQ(p1_time, aggregated["p1"].get_fwd_time());
+}
+
+TEST(Profiling, new_map_after_destroyed_map) {
+  using stan::math::profile;
+  for (int i = 1; i <= 3; ++i) {
+    stan::math::profile_map profiles;
+    for (int j = 0; j < i; ++j) {
+      profile<double> p1("p1", profiles);
+    }
+    stan::math::merge_profiles(profiles);
+    stan::math::profile_key key = {"p1", std::this_thread::get_id()};
+    ASSERT_EQ(1, profiles.size());
+    EXPECT_EQ(i, profiles[key].get_num_fwd_passes());
+  }
+}
+
+TEST(Profiling, two_maps) {
+  using stan::math::profile;
+  stan::math::profile_map profiles_a;
+  stan::math::profile_map profiles_b;
+  for (int i = 0; i < 3; ++i) {
+    profile<double> pa("p", profiles_a);
+    profile<double> pb("p", profiles_b);
+  }
+  { profile<double> pa("p", profiles_a); }
+  stan::math::merge_profiles(profiles_a);
+  stan::math::merge_profiles(profiles_b);
+  stan::math::profile_key key = {"p", std::this_thread::get_id()};
+  EXPECT_EQ(4, profiles_a[key].get_num_fwd_passes());
+  EXPECT_EQ(3, profiles_b[key].get_num_fwd_passes());
+}
+
+TEST(Profiling, merge_into_modified_map) {
+  using stan::math::profile;
+  stan::math::profile_map profiles;
+  stan::math::profile_map other;
+  stan::math::profile_key key = {"p", std::this_thread::get_id()};
+  { profile<double> p("p", profiles); }
+  { profile<double> p("p", other); }
+  stan::math::merge_profiles(profiles);
+  stan::math::merge_profiles(other);
+
+  // profiles are merged into the map they were recorded for, whatever
+  // happened to its contents meanwhile
+  profiles.swap(other);
+  { profile<double> p("p", profiles); }
+  stan::math::merge_profiles(profiles);
+  EXPECT_EQ(2, profiles[key].get_num_fwd_passes());
+  EXPECT_EQ(1, other[key].get_num_fwd_passes());
+
+  { profile<double> p("p", profiles); }
+  profiles.clear();
+  stan::math::merge_profiles(profiles);
+  EXPECT_EQ(1, profiles[key].get_num_fwd_passes());
+
+  { profile<double> p("p", profiles); }
+  profiles = std::move(other);
+  stan::math::merge_profiles(profiles);
+  EXPECT_EQ(2, profiles[key].get_num_fwd_passes());
+
+  // merging twice does not count profiles twice
+  auto aggregated = stan::math::aggregate_profiles(profiles);
+  EXPECT_EQ(2, aggregated["p"].get_num_fwd_passes());
+  stan::math::merge_profiles(profiles);
+  EXPECT_EQ(2, profiles[key].get_num_fwd_passes());
+}
+
+TEST(Profiling, merge_reverse_pass) {
+  using stan::math::profile;
+  using stan::math::var;
+  stan::math::recover_memory();
+  stan::math::profile_map profiles;
+  var c;
+  {
+    profile<var> rev("rev", profiles);
+    var a = 2.0;
+    c = a * a;
+  }
+  stan::math::merge_profiles(profiles);
+  c.grad();
+  stan::math::recover_memory();
+  stan::math::merge_profiles(profiles);
+  stan::math::profile_key key = {"rev", std::this_thread::get_id()};
+  EXPECT_EQ(1, profiles[key].get_num_fwd_passes());
+  EXPECT_EQ(1, profiles[key].get_num_rev_passes());
+  EXPECT_TRUE(profiles[key].get_rev_time() > 0.0);
+}
+
+TEST(Profiling, write_profiles_csv) {
+  using stan::math::profile;
+  using stan::math::var;
+  stan::math::profile_map profiles;
+  {
+    var a = 2.0;
+    {
+      profile<var> t1("t1", profiles);
+      var b = a * a;
+      b.grad();
+    }
+    std::thread other([&profiles]() { profile<double> t1("t1", profiles); });
+    other.join();
+  }
+  stan::math::recover_memory();
+  std::ostringstream csv;
+  stan::math::write_profiles_csv(csv, profiles);
+  std::istringstream lines(csv.str());
+  std::vector<std::string> rows;
+  for (std::string line; std::getline(lines, line);) {
+    rows.push_back(line);
+  }
+  ASSERT_EQ(4, rows.size());
+  EXPECT_EQ(
+      "name,thread_id,total_time,forward_time,reverse_time,chain_stack,"
+      "no_chain_stack,autodiff_calls,no_autodiff_calls",
+      rows[0]);
+  EXPECT_EQ(0, rows[1].find("\"t1\","));
+  EXPECT_EQ(0, rows[2].find("\"t1\","));
+  EXPECT_EQ(0, rows[3].find("\"t1\",all,"));
+  EXPECT_EQ(rows[3].size() - 4, rows[3].rfind(",1,1"));
+}
@@ -54,6 +54,7 @@ TEST(Profiling, profile_threading) {
   poisson_lpdf.grad();
   stan::math::set_zero_all_adjoints();
   stan::math::recover_memory();
+  stan::math::merge_profiles(profiling_test::profiles_threading);
   EXPECT_GT(profiling_test::profiles_threading.size(), 0);
 }
 #endif
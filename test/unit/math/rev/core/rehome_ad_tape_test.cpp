@@ -0,0 +1,52 @@
+#include <stan/math/rev.hpp>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(AgradRevRehomeAdTape, hook_is_registered) {
+  EXPECT_EQ(&stan::math::internal::rehome_ad_tape,
+            stan::math::internal::numa_node_change_hook());
+}
+
+TEST(AgradRevRehomeAdTape, releases_unused_tape) {
+  using stan::math::var;
+  std::thread worker([] {
+    stan::math::ChainableStack thread_tape;
+    auto* tape = stan::math::ChainableStack::instance_;
+    {
+      std::vector<var> x(100000, 1.0);
+      var sum = 0;
+      for (const auto& xi : x) {
+        sum += xi * xi;
+      }
+      sum.grad();
+    }
+    stan::math::recover_memory();
+    const size_t bytes_before = tape->memalloc_.bytes_reserved();
+    EXPECT_GT(tape->var_stack_.capacity(), 0);
+    stan::math::internal::rehome_ad_tape();
+    EXPECT_LT(tape->memalloc_.bytes_reserved(), bytes_before);
+    EXPECT_EQ(0, tape->var_stack_.capacity());
+
+    var a = 2.0;
+    var b = a * a;
+    b.grad();
+    EXPECT_FLOAT_EQ(4.0, a.adj());
+    stan::math::recover_memory();
+  });
+  worker.join();
+}
+
+TEST(AgradRevRehomeAdTape, keeps_tape_in_use) {
+  using stan::math::var;
+  stan::math::recover_memory();
+  var a = 2.0;
+  var b = a * a;
+  auto* tape = stan::math::ChainableStack::instance_;
+  const size_t num_vars = tape->var_stack_.size();
+  stan::math::internal::rehome_ad_tape();
+  EXPECT_EQ(num_vars, tape->var_stack_.size());
+  b.grad();
+  EXPECT_FLOAT_EQ(4.0, a.adj());
+  stan::math::recover_memory();
+}
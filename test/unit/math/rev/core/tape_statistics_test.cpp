@@ -0,0 +1,150 @@
+#include <stan/math/rev.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+TEST(AgradRevTapeStatistics, counts_by_type) {
+  using stan::math::var;
+  stan::math::recover_memory();
+  stan::math::tape_statistics stats;
+  stats.start();
+  EXPECT_TRUE(stats.is_started());
+  var a = 2.0;
+  var b = 3.0;
+  var c = a * b;
+  var d = c * a;
+  var e = stan::math::exp(d);
+  e.grad();
+  stats.stop();
+  EXPECT_FALSE(stats.is_started());
+  EXPECT_FLOAT_EQ(b.val() * 2 * a.val() * e.val(), a.adj());
+
+  EXPECT_EQ(1, stats.num_rev_passes());
+  auto entries = stats.entries();
+  size_t num_chain = 0;
+  size_t num_nochain = 0;
+  bool found_multiply = false;
+  for (const auto& e : entries) {
+    num_chain += e.second.num_chain_;
+    num_nochain += e.second.num_nochain_;
+    EXPECT_EQ(e.second.num_chain_, e.second.num_chain_calls_);
+    if (e.first.find("multiply_vv_vari") != std::string::npos) {
+      found_multiply = true;
+      EXPECT_EQ(2, e.second.num_chain_);
+      EXPECT_EQ(2 * sizeof(stan::math::internal::multiply_vv_vari),
+                e.second.bytes_);
+    }
+  }
+  EXPECT_TRUE(found_multiply);
+  EXPECT_EQ(stan::math::ChainableStack::instance_->var_stack_.size(),
+            num_chain);
+  EXPECT_EQ(stan::math::ChainableStack::instance_->var_nochain_stack_.size(),
+            num_nochain);
+  stan::math::recover_memory();
+}
+
+TEST(AgradRevTapeStatistics, disabled_and_export) {
+  using stan::math::var;
+  stan::math::tape_statistics stats;
+  {
+    var a = 2.0;
+    var b = a * a;
+    b.grad();
+  }
+  EXPECT_EQ(0, stats.num_rev_passes());
+  EXPECT_TRUE(stats.entries().empty());
+  stan::math::recover_memory();
+
+  stats.start();
+  EXPECT_THROW(stan::math::tape_statistics().start(), std::logic_error);
+  var a = 2.0;
+  var b = a / 3.0;
+  b.grad();
+  stan::math::set_zero_all_adjoints();
+  b.grad();
+  EXPECT_EQ(2, stats.num_rev_passes());
+
+  std::stringstream csv;
+  stats.write_csv(csv);
+  EXPECT_EQ(0, csv.str().find("type,num_chain,num_nochain,bytes"));
+  EXPECT_NE(std::string::npos, csv.str().find("divide_vd_vari\",1,0,"));
+
+  std::stringstream json;
+  stats.write_json(json);
+  EXPECT_EQ(0, json.str().find("{\"num_rev_passes\": 2"));
+  EXPECT_NE(std::string::npos, json.str().find("divide_vd_vari"));
+
+  stats.clear();
+  EXPECT_EQ(0, stats.num_rev_passes());
+  EXPECT_TRUE(stats.entries().empty());
+  stan::math::recover_memory();
+}
+
+TEST(AgradRevTapeStatistics, counts_varis_once) {
+  using stan::math::var;
+  stan::math::recover_memory();
+  var a = 2.0;
+  var b = a * a;
+  stan::math::tape_statistics stats;
+  stats.start();
+  var c = b * a;
+  for (int i = 0; i < 3; ++i) {
+    stan::math::set_zero_all_adjoints();
+    c.grad();
+  }
+  EXPECT_EQ(3, stats.num_rev_passes());
+  size_t num_multiply = 0;
+  for (const auto& e : stats.entries()) {
+    if (e.first.find("multiply_vv_vari") != std::string::npos) {
+      ++num_multiply;
+      // b is created before the statistics are started
+      EXPECT_EQ(1, e.second.num_chain_);
+      EXPECT_EQ(sizeof(stan::math::internal::multiply_vv_vari),
+                e.second.bytes_);
+      EXPECT_EQ(6, e.second.num_chain_calls_);
+    }
+  }
+  EXPECT_EQ(1, num_multiply);
+  stats.stop();
+  stan::math::recover_memory();
+
+  // varis of a new tape reusing the arena are counted again
+  stats.clear();
+  stats.start();
+  var x = 2.0;
+  var y = x * x;
+  y.grad();
+  y.grad();
+  num_multiply = 0;
+  for (const auto& e : stats.entries()) {
+    if (e.first.find("multiply_vv_vari") != std::string::npos) {
+      ++num_multiply;
+      EXPECT_EQ(1, e.second.num_chain_);
+      EXPECT_EQ(2, e.second.num_chain_calls_);
+    }
+  }
+  EXPECT_EQ(1, num_multiply);
+  stats.stop();
+  stan::math::recover_memory();
+}
+
+TEST(AgradRevTapeStatistics, nested) {
+  using stan::math::var;
+  stan::math::tape_statistics stats;
+  stats.start();
+  var a = 2.0;
+  var b = a * a;
+  {
+    stan::math::nested_rev_autodiff nested;
+    var x = 1.0;
+    var y = x * x * x;
+    y.grad();
+  }
+  size_t num_chain = 0;
+  for (const auto& e : stats.entries()) {
+    num_chain += e.second.num_chain_;
+  }
+  EXPECT_EQ(2, num_chain);
+  stats.stop();
+  stan::math::recover_memory();
+}
@@ -0,0 +1,112 @@
+#include <stan/math/rev.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+// a few steps of a stochastic-volatility-like recursion
+struct checkpoint_segment {
+  template <typename T1, typename T2>
+  inline auto operator()(std::ostream* msgs, const T1& state,
+                         const std::vector<T2>& theta,
+                         const std::vector<int>& n_steps) const {
+    using stan::math::exp;
+    using stan::math::square;
+    Eigen::Matrix<stan::return_type_t<T1, T2>, Eigen::Dynamic, 1> s = state;
+    for (int i = 0; i < n_steps[0]; ++i) {
+      s(1) += -0.5 * square(s(0) - theta[0]) * exp(-theta[1]);
+      s(0) = theta[0] + 0.9 * (s(0) - theta[0]) + 0.1 * exp(theta[1] / 2);
+    }
+    return s;
+  }
+};
+
+template <bool Checkpoint>
+struct checkpoint_model {
+  template <typename T>
+  inline T operator()(const Eigen::Matrix<T, Eigen::Dynamic, 1>& x) const {
+    std::vector<T> theta{x(0), x(1)};
+    std::vector<int> n_steps{50};
+    Eigen::Matrix<T, Eigen::Dynamic, 1> state(2);
+    state << x(2), 0.0;
+    for (int k = 0; k < 20; ++k) {
+      if (Checkpoint) {
+        state = stan::math::checkpoint(checkpoint_segment(), nullptr, state,
+                                       theta, n_steps);
+      } else {
+        state = checkpoint_segment()(nullptr, state, theta, n_steps);
+      }
+    }
+    return state(1);
+  }
+};
+
+TEST(RevFunctor, checkpoint_gradient) {
+  Eigen::VectorXd x(3);
+  x << 0.3, -1.2, 0.7;
+  double fx;
+  Eigen::VectorXd grad_fx;
+  stan::math::gradient(checkpoint_model<true>(), x, fx, grad_fx);
+
+  double fx_ref;
+  Eigen::VectorXd grad_fx_ref;
+  stan::math::gradient(checkpoint_model<false>(), x, fx_ref, grad_fx_ref);
+
+  EXPECT_FLOAT_EQ(fx_ref, fx);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_FLOAT_EQ(grad_fx_ref(i), grad_fx(i));
+  }
+}
+
+TEST(RevFunctor, checkpoint_tape_size) {
+  using stan::math::var;
+  Eigen::Matrix<var, Eigen::Dynamic, 1> x(3);
+  x << 0.3, -1.2, 0.7;
+  auto& stack = *stan::math::ChainableStack::instance_;
+
+  stan::math::recover_memory();
+  checkpoint_model<false>()(x);
+  const size_t full_size = stack.var_stack_.size();
+
+  stan::math::recover_memory();
+  checkpoint_model<true>()(x);
+  const size_t checkpoint_size = stack.var_stack_.size();
+  EXPECT_LT(10 * checkpoint_size, full_size);
+  stan::math::recover_memory();
+}
+
+TEST(RevFunctor, checkpoint_scalar_nested) {
+  using stan::math::var;
+  auto inner = [](std::ostream* msgs, const auto& a, const auto& b) {
+    return a * a * b;
+  };
+  auto outer = [&](std::ostream* msgs, const auto& a, const auto& b) {
+    return stan::math::checkpoint(inner, msgs, a, b) + a;
+  };
+  var a = 3.0;
+  var b = 2.0;
+  var c = stan::math::checkpoint(outer, nullptr, a, b);
+  var d = stan::math::checkpoint(inner, nullptr, c, 1.0);
+  EXPECT_FLOAT_EQ(441.0, d.val());
+  d.grad();
+  // d = (a^2 b + a)^2
+  EXPECT_FLOAT_EQ(2 * 21.0 * (2 * 3.0 * 2.0 + 1), a.adj());
+  EXPECT_FLOAT_EQ(2 * 21.0 * 9.0, b.adj());
+  stan::math::recover_memory();
+}
+
+TEST(RevFunctor, checkpoint_set_zero_adjoints) {
+  using stan::math::var;
+  auto f = [](std::ostream* msgs, const auto& a) { return a * a; };
+  var a = 3.0;
+  var b = stan::math::checkpoint(f, nullptr, a);
+  b.grad();
+  EXPECT_FLOAT_EQ(6.0, a.adj());
+  stan::math::set_zero_all_adjoints();
+  b.grad();
+  EXPECT_FLOAT_EQ(6.0, a.adj());
+  stan::math::recover_memory();
+}
+
+TEST(RevFunctor, checkpoint_data) {
+  auto f = [](std::ostream* msgs, const auto& a, int b) { return a * b; };
+  EXPECT_FLOAT_EQ(6.0, stan::math::checkpoint(f, nullptr, 3.0, 2));
+}
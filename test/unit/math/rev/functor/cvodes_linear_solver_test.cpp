@@ -0,0 +1,207 @@
+#include <stan/math/rev.hpp>
+#include <gtest/gtest.h>
+#include <test/unit/util.hpp>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace cvodes_linear_solver_test {
+
+// stiff reaction-diffusion on a line: the Jacobian is tridiagonal
+struct reaction_diffusion {
+  template <typename T0, typename T_y, typename T_D, typename T_k>
+  inline Eigen::Matrix<stan::return_type_t<T0, T_y, T_D, T_k>, Eigen::Dynamic,
+                       1>
+  operator()(const T0& t, const Eigen::Matrix<T_y, Eigen::Dynamic, 1>& y,
+             std::ostream* msgs, const T_D& D, const T_k& k) const {
+    const int N = y.size();
+    Eigen::Matrix<stan::return_type_t<T0, T_y, T_D, T_k>, Eigen::Dynamic, 1>
+        dy_dt(N);
+    for (int i = 0; i < N; ++i) {
+      auto laplacian = -2 * y(i);
+      if (i > 0) {
+        laplacian += y(i - 1);
+      }
+      if (i < N - 1) {
+        laplacian += y(i + 1);
+      }
+      dy_dt(i) = D * laplacian - k * y(i) * y(i);
+    }
+    return dy_dt;
+  }
+};
+
+inline Eigen::VectorXd initial_state(int N) {
+  Eigen::VectorXd y0(N);
+  for (int i = 0; i < N; ++i) {
+    y0(i) = 1.0 + std::sin(0.3 * i);
+  }
+  return y0;
+}
+
+inline stan::math::ode_bdf_control control(
+    stan::math::ode_linear_solver linear_solver) {
+  stan::math::ode_bdf_control control;
+  control.relative_tolerance = 1e-10;
+  control.absolute_tolerance = 1e-10;
+  control.max_num_steps = 100000;
+  control.linear_solver = linear_solver;
+  return control;
+}
+
+inline Eigen::SparseMatrix<double> tridiagonal_pattern(int N) {
+  std::vector<Eigen::Triplet<double>> nonzeros;
+  for (int i = 0; i < N; ++i) {
+    for (int j = std::max(0, i - 1); j <= std::min(N - 1, i + 1); ++j) {
+      nonzeros.emplace_back(i, j, 1.0);
+    }
+  }
+  Eigen::SparseMatrix<double> pattern(N, N);
+  pattern.setFromTriplets(nonzeros.begin(), nonzeros.end());
+  return pattern;
+}
+
+// values at all times and gradient of the sum of the final state with
+// respect to the initial state and the parameters
+inline void solve(const stan::math::ode_bdf_control& control,
+                  std::vector<Eigen::VectorXd>& values, Eigen::VectorXd& grad) {
+  using stan::math::var;
+  const int N = 20;
+  Eigen::Matrix<var, Eigen::Dynamic, 1> y0 = initial_state(N);
+  var D = 50.0;
+  var k = 2.0;
+  std::vector<double> ts = {0.1, 0.5, 1.0};
+  auto y = stan::math::ode_bdf_tol(reaction_diffusion(), y0, 0.0, ts, control,
+                                   nullptr, D, k);
+  values.clear();
+  for (const auto& y_n : y) {
+    values.push_back(stan::math::value_of(y_n));
+  }
+  stan::math::grad(stan::math::sum(y.back()).vi_);
+  grad.resize(N + 2);
+  grad.head(N) = y0.adj();
+  grad(N) = D.adj();
+  grad(N + 1) = k.adj();
+  stan::math::recover_memory();
+}
+
+inline void expect_match_dense(const stan::math::ode_bdf_control& control) {
+  std::vector<Eigen::VectorXd> values_dense;
+  Eigen::VectorXd grad_dense;
+  solve(cvodes_linear_solver_test::control(
+            stan::math::ode_linear_solver::dense),
+        values_dense, grad_dense);
+  std::vector<Eigen::VectorXd> values;
+  Eigen::VectorXd grad;
+  solve(control, values, grad);
+  ASSERT_EQ(values_dense.size(), values.size());
+  for (size_t n = 0; n < values.size(); ++n) {
+    EXPECT_MATRIX_NEAR(values_dense[n], values[n], 1e-7);
+  }
+  EXPECT_MATRIX_NEAR(grad_dense, grad, 1e-6);
+}
+
+}  // namespace cvodes_linear_solver_test
+
+TEST(StanMathRevCvodesLinearSolver, banded) {
+  using cvodes_linear_solver_test::control;
+  auto banded = control(stan::math::ode_linear_solver::banded);
+  banded.upper_bandwidth = 1;
+  banded.lower_bandwidth = 1;
+  cvodes_linear_solver_test::expect_match_dense(banded);
+}
+
+TEST(StanMathRevCvodesLinearSolver, sparse) {
+  using cvodes_linear_solver_test::control;
+  auto sparse = control(stan::math::ode_linear_solver::sparse);
+  sparse.jacobian_pattern = cvodes_linear_solver_test::tridiagonal_pattern(20);
+  cvodes_linear_solver_test::expect_match_dense(sparse);
+}
+
+TEST(StanMathRevCvodesLinearSolver, sparse_pattern_from_jacobian_sparsity) {
+  using cvodes_linear_solver_test::control;
+  using cvodes_linear_solver_test::reaction_diffusion;
+  auto sparse = control(stan::math::ode_linear_solver::sparse);
+  sparse.jacobian_pattern = stan::math::jacobian_sparsity(
+      [](const auto& y) {
+        return reaction_diffusion()(0.0, y, nullptr, 50.0, 2.0);
+      },
+      cvodes_linear_solver_test::initial_state(20));
+  EXPECT_EQ(sparse.jacobian_pattern.nonZeros(), 58);
+  cvodes_linear_solver_test::expect_match_dense(sparse);
+}
+
+TEST(StanMathRevCvodesLinearSolver, spgmr) {
+  using cvodes_linear_solver_test::control;
+  auto spgmr = control(stan::math::ode_linear_solver::spgmr);
+  spgmr.jacobian_pattern = cvodes_linear_solver_test::tridiagonal_pattern(20);
+  cvodes_linear_solver_test::expect_match_dense(spgmr);
+  // without pattern the Jacobian of the products and preconditioner is dense
+  cvodes_linear_solver_test::expect_match_dense(
+      control(stan::math::ode_linear_solver::spgmr));
+}
+
+TEST(StanMathRevCvodesLinearSolver, spbcgs) {
+  using cvodes_linear_solver_test::control;
+  auto spbcgs = control(stan::math::ode_linear_solver::spbcgs);
+  spbcgs.jacobian_pattern = cvodes_linear_solver_test::tridiagonal_pattern(20);
+  spbcgs.max_krylov_dimension = 10;
+  cvodes_linear_solver_test::expect_match_dense(spbcgs);
+}
+
+TEST(StanMathRevCvodesLinearSolver, double_arguments) {
+  using cvodes_linear_solver_test::control;
+  using cvodes_linear_solver_test::reaction_diffusion;
+  auto sparse = control(stan::math::ode_linear_solver::sparse);
+  sparse.jacobian_pattern = cvodes_linear_solver_test::tridiagonal_pattern(20);
+  std::vector<double> ts = {0.1, 0.5, 1.0};
+  Eigen::VectorXd y0 = cvodes_linear_solver_test::initial_state(20);
+  auto y_dense = stan::math::ode_bdf_tol(
+      reaction_diffusion(), y0, 0.0, ts,
+      control(stan::math::ode_linear_solver::dense), nullptr, 50.0, 2.0);
+  auto y_sparse = stan::math::ode_bdf_tol(reaction_diffusion(), y0, 0.0, ts,
+                                          sparse, nullptr, 50.0, 2.0);
+  for (size_t n = 0; n < ts.size(); ++n) {
+    EXPECT_MATRIX_NEAR(y_dense[n], y_sparse[n], 1e-7);
+  }
+}
+
+TEST(StanMathRevCvodesLinearSolver, errors) {
+  using cvodes_linear_solver_test::control;
+  using cvodes_linear_solver_test::reaction_diffusion;
+  std::vector<double> ts = {0.1, 0.5, 1.0};
+  Eigen::VectorXd y0 = cvodes_linear_solver_test::initial_state(20);
+
+  auto banded = control(stan::math::ode_linear_solver::banded);
+  banded.upper_bandwidth = 1;
+  banded.lower_bandwidth = 20;
+  EXPECT_THROW(stan::math::ode_bdf_tol(reaction_diffusion(), y0, 0.0, ts,
+                                       banded, nullptr, 50.0, 2.0),
+               std::domain_error);
+  banded.lower_bandwidth = -1;
+  EXPECT_THROW(stan::math::ode_bdf_tol(reaction_diffusion(), y0, 0.0, ts,
+                                       banded, nullptr, 50.0, 2.0),
+               std::domain_error);
+
+  // the sparse solver needs a pattern
+  auto sparse = control(stan::math::ode_linear_solver::sparse);
+  EXPECT_THROW(stan::math::ode_bdf_tol(reaction_diffusion(), y0, 0.0, ts,
+                                       sparse, nullptr, 50.0, 2.0),
+               std::invalid_argument);
+  sparse.jacobian_pattern = cvodes_linear_solver_test::tridiagonal_pattern(19);
+  EXPECT_THROW(stan::math::ode_bdf_tol(reaction_diffusion(), y0, 0.0, ts,
+                                       sparse, nullptr, 50.0, 2.0),
+               std::invalid_argument);
+
+  auto spgmr = control(stan::math::ode_linear_solver::spgmr);
+  spgmr.max_krylov_dimension = -1;
+  EXPECT_THROW(stan::math::ode_bdf_tol(reaction_diffusion(), y0, 0.0, ts,
+                                       spgmr, nullptr, 50.0, 2.0),
+               std::domain_error);
+
+  auto tolerance = control(stan::math::ode_linear_solver::dense);
+  tolerance.relative_tolerance = -1;
+  EXPECT_THROW(stan::math::ode_bdf_tol(reaction_diffusion(), y0, 0.0, ts,
+                                       tolerance, nullptr, 50.0, 2.0),
+               std::domain_error);
+}
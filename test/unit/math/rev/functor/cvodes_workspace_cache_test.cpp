@@ -0,0 +1,178 @@
+#include <stan/math/rev.hpp>
+#include <gtest/gtest.h>
+#include <test/unit/util.hpp>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace cvodes_workspace_cache_test {
+
+using cvodes_cache = stan::math::internal::sundials_workspace_cache<
+    stan::math::internal::cvodes_workspace>;
+using idas_cache = stan::math::internal::sundials_workspace_cache<
+    stan::math::internal::idas_workspace>;
+
+// a chain of first order reactions of any length
+struct decay_chain {
+  template <typename T0, typename T_y, typename T_k>
+  inline Eigen::Matrix<stan::return_type_t<T0, T_y, T_k>, Eigen::Dynamic, 1>
+  operator()(const T0& t, const Eigen::Matrix<T_y, Eigen::Dynamic, 1>& y,
+             std::ostream* msgs, const T_k& k) const {
+    Eigen::Matrix<stan::return_type_t<T0, T_y, T_k>, Eigen::Dynamic, 1> dy_dt(
+        y.size());
+    for (int i = 0; i < y.size(); ++i) {
+      dy_dt(i) = -k * (i + 1) * y(i);
+      if (i > 0) {
+        dy_dt(i) += k * i * y(i - 1);
+      }
+    }
+    return dy_dt;
+  }
+};
+
+struct chemical_kinetics {
+  template <typename T0, typename TYY, typename TYP, typename TPAR>
+  inline std::vector<stan::return_type_t<TYY, TYP, TPAR>> operator()(
+      const T0& t_in, const std::vector<TYY>& yy, const std::vector<TYP>& yp,
+      const std::vector<TPAR>& theta, const std::vector<double>& x_r,
+      const std::vector<int>& x_i, std::ostream* msgs) const {
+    std::vector<stan::return_type_t<TYY, TYP, TPAR>> res(3);
+    res[0] = yp[0] + theta[0] * yy[0] - theta[1] * yy[1] * yy[2];
+    res[1] = yp[1] - theta[0] * yy[0] + theta[1] * yy[1] * yy[2]
+             + theta[2] * yy[1] * yy[1];
+    res[2] = yy[0] + yy[1] + yy[2] - 1.0;
+    return res;
+  }
+};
+
+// states and gradient of their sum at the last time with respect to k
+inline void solve(int N, double k_val, std::vector<Eigen::VectorXd>& values,
+                  double& dk) {
+  stan::math::var k = k_val;
+  Eigen::VectorXd y0 = Eigen::VectorXd::Ones(N);
+  std::vector<double> ts = {0.5, 1.0, 2.0};
+  auto y = stan::math::ode_bdf(decay_chain(), y0, 0.0, ts, nullptr, k);
+  values.clear();
+  for (const auto& y_n : y) {
+    values.push_back(stan::math::value_of(y_n));
+  }
+  stan::math::grad(stan::math::sum(y.back()).vi_);
+  dk = k.adj();
+  stan::math::recover_memory();
+}
+
+}  // namespace cvodes_workspace_cache_test
+
+TEST(StanMathRevCvodesWorkspaceCache, reused_solve_matches_first) {
+  using cvodes_workspace_cache_test::cvodes_cache;
+  cvodes_cache::clear();
+  std::vector<Eigen::VectorXd> values_first;
+  double dk_first;
+  cvodes_workspace_cache_test::solve(4, 0.7, values_first, dk_first);
+  EXPECT_EQ(cvodes_cache::size(), 1);
+
+  // a solve of other parameters in between changes the state of CVODES
+  std::vector<Eigen::VectorXd> values;
+  double dk;
+  cvodes_workspace_cache_test::solve(4, 3.0, values, dk);
+  EXPECT_EQ(cvodes_cache::size(), 1);
+  cvodes_workspace_cache_test::solve(4, 0.7, values, dk);
+  EXPECT_EQ(cvodes_cache::size(), 1);
+  for (size_t n = 0; n < values.size(); ++n) {
+    EXPECT_MATRIX_EQ(values_first[n], values[n]);
+  }
+  EXPECT_EQ(dk_first, dk);
+
+  // solves without sensitivities have their own workspace
+  std::vector<double> ts = {0.5, 1.0, 2.0};
+  auto y = stan::math::ode_bdf(cvodes_workspace_cache_test::decay_chain(),
+                               Eigen::VectorXd::Ones(4).eval(), 0.0, ts,
+                               nullptr, 0.7);
+  EXPECT_EQ(cvodes_cache::size(), 2);
+  for (size_t n = 0; n < values.size(); ++n) {
+    EXPECT_MATRIX_NEAR(values_first[n], y[n], 1e-6);
+  }
+}
+
+TEST(StanMathRevCvodesWorkspaceCache, bounded) {
+  using cvodes_workspace_cache_test::cvodes_cache;
+  cvodes_cache::clear();
+  const size_t capacity = cvodes_cache::capacity;
+  std::vector<Eigen::VectorXd> values;
+  double dk;
+  for (size_t N = 1; N <= capacity + 3; ++N) {
+    cvodes_workspace_cache_test::solve(N, 0.7, values, dk);
+    EXPECT_EQ(cvodes_cache::size(), std::min(N, capacity));
+  }
+  cvodes_cache::clear();
+  EXPECT_EQ(cvodes_cache::size(), 0);
+}
+
+TEST(StanMathRevCvodesWorkspaceCache, failed_solve_is_not_reused) {
+  using cvodes_workspace_cache_test::cvodes_cache;
+  using cvodes_workspace_cache_test::decay_chain;
+  cvodes_cache::clear();
+  Eigen::VectorXd y0 = Eigen::VectorXd::Ones(3);
+  std::vector<double> ts = {0.5, 1.0, 200.0};
+  EXPECT_THROW(stan::math::ode_bdf_tol(decay_chain(), y0, 0.0, ts, 1e-10,
+                                       1e-10, 5, nullptr, 0.7),
+               std::domain_error);
+  EXPECT_EQ(cvodes_cache::size(), 0);
+
+  auto y = stan::math::ode_bdf(decay_chain(), y0, 0.0, ts, nullptr, 0.7);
+  auto y_again
+      = stan::math::ode_bdf(decay_chain(), y0, 0.0, ts, nullptr, 0.7);
+  EXPECT_EQ(cvodes_cache::size(), 1);
+  for (size_t n = 0; n < ts.size(); ++n) {
+    EXPECT_MATRIX_EQ(y[n], y_again[n]);
+  }
+}
+
+TEST(StanMathRevCvodesWorkspaceCache, idas_reused_solve_matches_first) {
+  using cvodes_workspace_cache_test::idas_cache;
+  using stan::math::var;
+  idas_cache::clear();
+  std::vector<double> yy0{1.0, 0.0, 0.0};
+  std::vector<double> yp0{-0.04, 0.04, 0.0};
+  std::vector<double> theta{0.040, 1.0e4, 3.0e7};
+  std::vector<double> x_r;
+  std::vector<int> x_i;
+  std::vector<double> ts{0.4, 4.0, 40.0};
+
+  auto solve = [&](const std::vector<double>& theta_val,
+                   std::vector<std::vector<double>>& values,
+                   std::vector<double>& grad) {
+    std::vector<var> theta_var = stan::math::to_var(theta_val);
+    auto yy = stan::math::integrate_dae(
+        cvodes_workspace_cache_test::chemical_kinetics(), yy0, yp0, 0.0, ts,
+        theta_var, x_r, x_i, 1e-5, 1e-12);
+    values.clear();
+    for (const auto& yy_n : yy) {
+      values.push_back(stan::math::value_of(yy_n));
+    }
+    stan::math::grad(yy.back()[0].vi_);
+    grad.clear();
+    for (const auto& theta_i : theta_var) {
+      grad.push_back(theta_i.adj());
+    }
+    stan::math::recover_memory();
+  };
+
+  std::vector<std::vector<double>> values_first, values;
+  std::vector<double> grad_first, grad;
+  solve(theta, values_first, grad_first);
+  EXPECT_EQ(idas_cache::size(), 1);
+  solve({0.040, 2.0e4, 1.0e7}, values, grad);
+  solve(theta, values, grad);
+  EXPECT_EQ(idas_cache::size(), 1);
+  EXPECT_STD_VECTOR_FLOAT_EQ(grad_first, grad);
+  for (size_t n = 0; n < ts.size(); ++n) {
+    EXPECT_STD_VECTOR_FLOAT_EQ(values_first[n], values[n]);
+  }
+
+  auto yy = stan::math::integrate_dae(
+      cvodes_workspace_cache_test::chemical_kinetics(), yy0, yp0, 0.0, ts,
+      theta, x_r, x_i, 1e-5, 1e-12);
+  EXPECT_EQ(idas_cache::size(), 2);
+  EXPECT_NEAR(values_first[0][0], yy[0][0], 1e-6);
+}
@@ -223,3 +223,68 @@ TEST(RevFunctor, RecoverMemory) {
   EXPECT_LT(stan::math::ChainableStack::instance_->memalloc_.bytes_allocated(),
             100000);
 }
+
+// fun1 for arguments of any size
+struct fun1_fixed {
+  template <typename T, int N>
+  inline T operator()(const Matrix<T, N, 1>& x) const {
+    return x(0) * x(0) * x(1) + 3.0 * x(1) * x(1);
+  }
+};
+
+// calls gradient() for fixed size arguments from within itself
+struct fun1_fixed_recursive {
+  inline stan::math::var operator()(
+      const Matrix<stan::math::var, 2, 1>& x) const {
+    Eigen::Vector2d y(1.0, 2.0);
+    double fy;
+    Eigen::Vector2d grad_fy;
+    stan::math::gradient(fun1_fixed(), y, fy, grad_fy);
+    return grad_fy(0) * fun1_fixed()(x);
+  }
+};
+
+TEST(RevFunctor, gradient_fixed_size) {
+  stan::math::var a = 1.0;
+  const size_t stack_size
+      = stan::math::ChainableStack::instance_->var_stack_.size();
+  Eigen::Vector2d x(5, 7);
+  double fx;
+  Eigen::Vector2d grad_fx;
+  for (int n = 0; n < 3; ++n) {
+    stan::math::gradient(fun1_fixed(), x, fx, grad_fx);
+    EXPECT_FLOAT_EQ(5 * 5 * 7 + 3 * 7 * 7, fx);
+    EXPECT_FLOAT_EQ(2 * x(0) * x(1), grad_fx(0));
+    EXPECT_FLOAT_EQ(x(0) * x(0) + 3 * 2 * x(1), grad_fx(1));
+  }
+  // the current AD tape is not touched
+  EXPECT_EQ(stack_size,
+            stan::math::ChainableStack::instance_->var_stack_.size());
+  EXPECT_TRUE(stan::math::empty_nested());
+
+  stan::math::gradient(fun1_fixed_recursive(), x, fx, grad_fx);
+  EXPECT_FLOAT_EQ(4 * (5 * 5 * 7 + 3 * 7 * 7), fx);
+  EXPECT_FLOAT_EQ(4 * 2 * x(0) * x(1), grad_fx(0));
+  stan::math::recover_memory();
+}
+
+stan::math::var sum_and_throw_fixed(
+    const Matrix<stan::math::var, 5, 1>& x) {
+  stan::math::var y = x.sum();
+  throw std::domain_error("fooey");
+  return y;
+}
+
+TEST(RevFunctor, gradient_fixed_size_throws) {
+  Matrix<double, 5, 1> x;
+  x << 1, 2, 3, 4, 5;
+  double fx;
+  Matrix<double, 5, 1> grad_fx;
+  auto* tape = stan::math::ChainableStack::instance_;
+  EXPECT_THROW(stan::math::gradient(sum_and_throw_fixed, x, fx, grad_fx),
+               std::domain_error);
+  EXPECT_EQ(tape, stan::math::ChainableStack::instance_);
+  Eigen::Vector2d grad_fy;
+  stan::math::gradient(fun1_fixed(), Eigen::Vector2d(1, 2), fx, grad_fy);
+  EXPECT_FLOAT_EQ(4.0, grad_fy(0));
+}
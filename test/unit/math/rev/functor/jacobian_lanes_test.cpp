@@ -0,0 +1,158 @@
+// This file builds as its own program, so defining STAN_COMPACT_TAPE here
+// keeps it the same in all its translation units
+#ifndef STAN_COMPACT_TAPE
+#define STAN_COMPACT_TAPE
+#endif
+#include <stan/math/rev.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+
+struct many_outputs_fun {
+  int num_outputs_;
+  template <typename T>
+  inline Eigen::Matrix<T, Eigen::Dynamic, 1> operator()(
+      const Eigen::Matrix<T, Eigen::Dynamic, 1>& x) const {
+    using stan::math::exp;
+    using stan::math::log;
+    using stan::math::sqrt;
+    using stan::math::square;
+    const int n = x.size();
+    Eigen::Matrix<T, Eigen::Dynamic, 1> y(num_outputs_);
+    for (int i = 0; i < num_outputs_; ++i) {
+      const T& a = x(i % n);
+      const T& b = x((i + 1) % n);
+      const T& c = x((i + 2) % n);
+      y(i) = a * b + exp(a) / (1.0 + square(c)) - log(b) * sqrt(c)
+             + (2.0 - a) / b - c;
+    }
+    // an input and a constant as outputs
+    y(0) = x(1);
+    y(1) = 3.0;
+    return y;
+  }
+};
+
+struct with_sin_fun {
+  template <typename T>
+  inline Eigen::Matrix<T, Eigen::Dynamic, 1> operator()(
+      const Eigen::Matrix<T, Eigen::Dynamic, 1>& x) const {
+    Eigen::Matrix<T, Eigen::Dynamic, 1> y(3);
+    y(0) = x(0) * x(1);
+    y(1) = stan::math::sin(x(0)) + x(1);
+    y(2) = x(1) / x(0);
+    return y;
+  }
+};
+
+/**
+ * Jacobian computed by one reverse pass per output.
+ */
+template <typename F>
+Eigen::MatrixXd jacobian_by_rows(const F& f, const Eigen::VectorXd& x) {
+  stan::math::nested_rev_autodiff nested;
+  Eigen::Matrix<stan::math::var, Eigen::Dynamic, 1> x_var(x);
+  Eigen::Matrix<stan::math::var, Eigen::Dynamic, 1> y = f(x_var);
+  Eigen::MatrixXd J(y.size(), x.size());
+  for (int i = 0; i < y.size(); ++i) {
+    nested.set_zero_all_adjoints();
+    y(i).grad();
+    J.row(i) = x_var.adj();
+  }
+  return J;
+}
+
+}  // namespace
+
+TEST(AgradRevJacobianLanes, matches_reverse_passes) {
+  Eigen::VectorXd x(5);
+  x << 1.3, 0.4, 2.1, 0.7, 1.9;
+  for (int num_outputs : {2, 8, 9, 21}) {
+    many_outputs_fun f{num_outputs};
+    Eigen::VectorXd fx;
+    Eigen::MatrixXd J;
+    stan::math::jacobian(f, x, fx, J);
+    ASSERT_EQ(num_outputs, J.rows());
+    ASSERT_EQ(5, J.cols());
+    const Eigen::MatrixXd J_ref = jacobian_by_rows(f, x);
+    for (int i = 0; i < num_outputs; ++i) {
+      for (int j = 0; j < 5; ++j) {
+        EXPECT_FLOAT_EQ(J_ref(i, j), J(i, j)) << i << ", " << j;
+      }
+    }
+    EXPECT_FLOAT_EQ(x(1), fx(0));
+    EXPECT_FLOAT_EQ(1.0, J(0, 1));
+    EXPECT_FLOAT_EQ(0.0, J.row(1).norm());
+  }
+}
+
+TEST(AgradRevJacobianLanes, linearize_nested) {
+  using stan::math::var;
+  {
+    stan::math::nested_rev_autodiff nested;
+    var a = 2.0;
+    var b = a * a + 1.0;
+    stan::math::internal::compact_tape_lanes tape;
+    ASSERT_TRUE(tape.linearize_nested());
+    // a, a * a, a * a + 1.0 and the slot of outer operands
+    EXPECT_EQ(4, tape.num_slots());
+    EXPECT_LE(0, tape.slot(a.vi_));
+    EXPECT_LE(0, tape.slot(b.vi_));
+
+    Eigen::Matrix<double, 2, Eigen::Dynamic> lanes
+        = Eigen::Matrix<double, 2, Eigen::Dynamic>::Zero(2, tape.num_slots());
+    lanes(0, tape.slot(b.vi_)) = 1.0;
+    lanes(1, tape.slot(b.vi_)) = 3.0;
+    tape.sweep(lanes);
+    EXPECT_FLOAT_EQ(4.0, lanes(0, tape.slot(a.vi_)));
+    EXPECT_FLOAT_EQ(12.0, lanes(1, tape.slot(a.vi_)));
+    EXPECT_FLOAT_EQ(0.0, a.adj());
+  }
+  {
+    stan::math::nested_rev_autodiff nested;
+    var a = 2.0;
+    var b = stan::math::sin(a) * a;
+    stan::math::internal::compact_tape_lanes tape;
+    EXPECT_FALSE(tape.linearize_nested());
+  }
+}
+
+TEST(AgradRevJacobianLanes, outer_operands) {
+  using stan::math::var;
+  var outer = 1.5;
+  auto f = [&outer](const auto& x) {
+    Eigen::Matrix<var, Eigen::Dynamic, 1> y(2);
+    y(0) = x(0) * outer;
+    y(1) = outer * outer + x(1);
+    return y;
+  };
+  Eigen::VectorXd x(2);
+  x << 0.5, 2.5;
+  Eigen::VectorXd fx;
+  Eigen::MatrixXd J;
+  stan::math::jacobian(f, x, fx, J);
+  EXPECT_FLOAT_EQ(0.75, fx(0));
+  EXPECT_FLOAT_EQ(4.75, fx(1));
+  EXPECT_FLOAT_EQ(1.5, J(0, 0));
+  EXPECT_FLOAT_EQ(0.0, J(0, 1));
+  EXPECT_FLOAT_EQ(0.0, J(1, 0));
+  EXPECT_FLOAT_EQ(1.0, J(1, 1));
+  stan::math::recover_memory();
+}
+
+TEST(AgradRevJacobianLanes, falls_back_to_reverse_passes) {
+  Eigen::VectorXd x(2);
+  x << 0.8, 1.7;
+  Eigen::VectorXd fx;
+  Eigen::MatrixXd J;
+  stan::math::jacobian(with_sin_fun(), x, fx, J);
+  const Eigen::MatrixXd J_ref = jacobian_by_rows(with_sin_fun(), x);
+  ASSERT_EQ(3, J.rows());
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      EXPECT_FLOAT_EQ(J_ref(i, j), J(i, j));
+    }
+  }
+  EXPECT_FLOAT_EQ(std::cos(0.8), J(1, 0));
+}
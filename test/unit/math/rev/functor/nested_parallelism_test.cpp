@@ -0,0 +1,216 @@
+#ifdef STAN_MPI
+#undef STAN_MPI
+#endif
+
+#include <stan/math/rev.hpp>
+#include <gtest/gtest.h>
+#include <test/unit/math/prim/functor/utils_threads.hpp>
+#include <ostream>
+#include <vector>
+
+namespace nested_parallelism_test {
+
+using stan::math::internal::current_parallel_task;
+using stan::math::internal::parallel_task_kind;
+
+// log density of the observations of a group
+struct group_obs_lpdf {
+  template <typename T1, typename T2>
+  stan::return_type_t<T1, T2> operator()(const std::vector<double>& y_slice,
+                                         std::size_t start, std::size_t end,
+                                         std::ostream* msgs, const T1& mu,
+                                         const T2& sigma) const {
+    return stan::math::normal_lpdf(y_slice, mu, sigma);
+  }
+};
+
+// log density of the groups, summing the observations of every group
+// with a nested reduce_sum
+struct groups_lpdf {
+  template <typename T1, typename T2>
+  stan::return_type_t<T1, T2> operator()(
+      const std::vector<int>& group_slice, std::size_t start, std::size_t end,
+      std::ostream* msgs, const std::vector<std::vector<double>>& y,
+      const std::vector<T1>& mu, const T2& sigma) const {
+    stan::return_type_t<T1, T2> lp = 0;
+    for (int g : group_slice) {
+      lp += stan::math::reduce_sum<group_obs_lpdf>(y[g], 3, msgs, mu[g],
+                                                   sigma);
+    }
+    return lp;
+  }
+};
+
+// job of map_rect with a nested reduce_sum over the observations of
+// its group
+struct group_job {
+  template <typename T1, typename T2>
+  Eigen::Matrix<stan::return_type_t<T1, T2>, Eigen::Dynamic, 1> operator()(
+      const Eigen::Matrix<T1, Eigen::Dynamic, 1>& sigma,
+      const Eigen::Matrix<T2, Eigen::Dynamic, 1>& mu,
+      const std::vector<double>& y, const std::vector<int>& x_i,
+      std::ostream* msgs) const {
+    Eigen::Matrix<stan::return_type_t<T1, T2>, Eigen::Dynamic, 1> lp(1);
+    lp(0) = stan::math::reduce_sum<group_obs_lpdf>(y, 2, msgs, mu(0),
+                                                   sigma(0));
+    return lp;
+  }
+};
+
+// records what the thread executes when the partial sums are computed
+struct task_kind_lpdf {
+  static std::vector<parallel_task_kind>& kinds() {
+    static std::vector<parallel_task_kind> kinds;
+    return kinds;
+  }
+
+  template <typename T>
+  T operator()(const std::vector<T>& slice, std::size_t start, std::size_t end,
+               std::ostream* msgs) const {
+    kinds().push_back(current_parallel_task());
+    return stan::math::sum(slice);
+  }
+};
+
+}  // namespace nested_parallelism_test
+
+STAN_REGISTER_MAP_RECT(0, nested_parallelism_test::group_job)
+
+using stan::math::internal::parallel_task_kind;
+
+struct nested_parallelism : public ::testing::Test {
+  std::vector<std::vector<double>> y;
+  std::vector<double> mu_val;
+  double sigma_val = 1.7;
+
+  void SetUp() {
+    set_n_threads(-1);
+    for (int g = 0; g < 11; ++g) {
+      mu_val.push_back(0.3 * g - 1.0);
+      y.emplace_back();
+      for (int i = 0; i < 8; ++i) {
+        y.back().push_back(0.1 * i * g - 0.5);
+      }
+    }
+  }
+
+  // value and gradient of the model, computed serially
+  double reference(std::vector<double>& mu_adj, double& sigma_adj) {
+    using stan::math::var;
+    std::vector<var> mu(mu_val.begin(), mu_val.end());
+    var sigma = sigma_val;
+    var lp = 0;
+    for (std::size_t g = 0; g < y.size(); ++g) {
+      lp += stan::math::normal_lpdf(y[g], mu[g], sigma);
+    }
+    lp.grad();
+    const double lp_val = lp.val();
+    mu_adj.clear();
+    for (const auto& mu_g : mu) {
+      mu_adj.push_back(mu_g.adj());
+    }
+    sigma_adj = sigma.adj();
+    stan::math::recover_memory();
+    return lp_val;
+  }
+};
+
+TEST_F(nested_parallelism, reduce_sum_in_reduce_sum) {
+  using stan::math::var;
+  std::vector<double> mu_adj_ref;
+  double sigma_adj_ref;
+  const double lp_ref = reference(mu_adj_ref, sigma_adj_ref);
+
+  std::vector<int> groups(y.size());
+  for (std::size_t g = 0; g < y.size(); ++g) {
+    groups[g] = g;
+  }
+  for (int grainsize : {1, 4}) {
+    std::vector<var> mu(mu_val.begin(), mu_val.end());
+    var sigma = sigma_val;
+    var lp = stan::math::reduce_sum<nested_parallelism_test::groups_lpdf>(
+        groups, grainsize, nullptr, y, mu, sigma);
+    EXPECT_FLOAT_EQ(lp_ref, lp.val());
+    lp.grad();
+    for (std::size_t g = 0; g < y.size(); ++g) {
+      EXPECT_FLOAT_EQ(mu_adj_ref[g], mu[g].adj());
+    }
+    EXPECT_FLOAT_EQ(sigma_adj_ref, sigma.adj());
+    stan::math::recover_memory();
+  }
+  EXPECT_EQ(parallel_task_kind::none,
+            nested_parallelism_test::current_parallel_task());
+}
+
+TEST_F(nested_parallelism, reduce_sum_in_map_rect) {
+  using stan::math::var;
+  std::vector<double> mu_adj_ref;
+  double sigma_adj_ref;
+  const double lp_ref = reference(mu_adj_ref, sigma_adj_ref);
+
+  std::vector<var> mu(mu_val.begin(), mu_val.end());
+  var sigma = sigma_val;
+  Eigen::Matrix<var, Eigen::Dynamic, 1> shared_params(1);
+  shared_params << sigma;
+  std::vector<Eigen::Matrix<var, Eigen::Dynamic, 1>> job_params;
+  for (const auto& mu_g : mu) {
+    job_params.emplace_back(1);
+    job_params.back() << mu_g;
+  }
+  std::vector<std::vector<int>> x_i(y.size(), std::vector<int>(0));
+  var lp = stan::math::sum(
+      stan::math::map_rect<0, nested_parallelism_test::group_job>(
+          shared_params, job_params, y, x_i));
+  EXPECT_FLOAT_EQ(lp_ref, lp.val());
+  lp.grad();
+  for (std::size_t g = 0; g < y.size(); ++g) {
+    EXPECT_FLOAT_EQ(mu_adj_ref[g], mu[g].adj());
+  }
+  EXPECT_FLOAT_EQ(sigma_adj_ref, sigma.adj());
+  stan::math::recover_memory();
+}
+
+TEST_F(nested_parallelism, task_kinds) {
+  using nested_parallelism_test::task_kind_lpdf;
+  using stan::math::var;
+  std::vector<var> x(10, 1.0);
+
+  task_kind_lpdf::kinds().clear();
+  stan::math::reduce_sum<task_kind_lpdf>(x, 2, nullptr);
+  ASSERT_FALSE(task_kind_lpdf::kinds().empty());
+  for (auto kind : task_kind_lpdf::kinds()) {
+#ifdef STAN_THREADS
+    EXPECT_EQ(parallel_task_kind::shared, kind);
+#else
+    EXPECT_EQ(parallel_task_kind::none, kind);
+#endif
+  }
+
+  // deterministic reductions isolate the functors they call
+  task_kind_lpdf::kinds().clear();
+  stan::math::reduce_sum_static<task_kind_lpdf>(x, 2, nullptr);
+  ASSERT_FALSE(task_kind_lpdf::kinds().empty());
+  for (auto kind : task_kind_lpdf::kinds()) {
+#ifdef STAN_THREADS
+    EXPECT_EQ(parallel_task_kind::isolated, kind);
+#else
+    EXPECT_EQ(parallel_task_kind::none, kind);
+#endif
+  }
+  stan::math::recover_memory();
+
+  {
+    stan::math::parallel_task_scope task(false);
+    EXPECT_EQ(parallel_task_kind::isolated,
+              nested_parallelism_test::current_parallel_task());
+    {
+      stan::math::parallel_task_scope nested_task;
+      EXPECT_EQ(parallel_task_kind::shared,
+                nested_parallelism_test::current_parallel_task());
+    }
+    EXPECT_EQ(parallel_task_kind::isolated,
+              nested_parallelism_test::current_parallel_task());
+  }
+  EXPECT_EQ(parallel_task_kind::none,
+            nested_parallelism_test::current_parallel_task());
+}
@@ -0,0 +1,249 @@
+#include <stan/math/rev.hpp>
+#include <gtest/gtest.h>
+#include <test/unit/util.hpp>
+#include <iostream>
+#include <vector>
+
+namespace ode_adjoint_test {
+
+struct harmonic_oscillator {
+  template <typename T0, typename T_y, typename T_theta>
+  inline Eigen::Matrix<stan::return_type_t<T0, T_y, T_theta>, Eigen::Dynamic,
+                       1>
+  operator()(const T0& t, const Eigen::Matrix<T_y, Eigen::Dynamic, 1>& y,
+             std::ostream* msgs, const std::vector<T_theta>& theta,
+             const std::vector<double>& x, int x_int) const {
+    Eigen::Matrix<stan::return_type_t<T0, T_y, T_theta>, Eigen::Dynamic, 1>
+        dy_dt(2);
+    dy_dt << y(1), -y(0) - theta[0] * y(1) + x[0] * sin(t);
+    return dy_dt;
+  }
+};
+
+// three species with a rate matrix and a forcing: many parameters for few
+// states
+struct linear_kinetics {
+  template <typename T0, typename T_y, typename T_k, typename T_b>
+  inline Eigen::Matrix<stan::return_type_t<T0, T_y, T_k, T_b>, Eigen::Dynamic,
+                       1>
+  operator()(const T0& t, const Eigen::Matrix<T_y, Eigen::Dynamic, 1>& y,
+             std::ostream* msgs, const Eigen::Matrix<T_k, -1, -1>& k,
+             const T_b& b) const {
+    Eigen::Matrix<stan::return_type_t<T0, T_y, T_k, T_b>, Eigen::Dynamic, 1>
+        dy_dt = stan::math::multiply(k, y);
+    dy_dt(0) += b * exp(-t);
+    return dy_dt;
+  }
+};
+
+// Jacobian of all the outputs of an ODE solve with respect to the vars,
+// by one reverse pass per output
+inline Eigen::MatrixXd output_jacobian(
+    const std::vector<Eigen::Matrix<stan::math::var, -1, 1>>& y,
+    const std::vector<stan::math::var>& vars) {
+  Eigen::MatrixXd J(y.size() * y[0].size(), vars.size());
+  for (size_t n = 0; n < y.size(); ++n) {
+    for (int i = 0; i < y[n].size(); ++i) {
+      stan::math::set_zero_all_adjoints();
+      stan::math::grad(y[n](i).vi_);
+      for (size_t k = 0; k < vars.size(); ++k) {
+        J(n * y[n].size() + i, k) = vars[k].adj();
+      }
+    }
+  }
+  return J;
+}
+
+}  // namespace ode_adjoint_test
+
+TEST(StanMathRevOdeAdjoint, values_match_bdf) {
+  using ode_adjoint_test::harmonic_oscillator;
+  Eigen::VectorXd y0(2);
+  y0 << 1.0, 0.5;
+  std::vector<double> theta = {0.15};
+  std::vector<double> x = {0.3};
+  std::vector<double> ts = {0.5, 1.0, 2.0, 2.0, 5.0};
+
+  auto y_bdf = stan::math::ode_bdf_tol(harmonic_oscillator(), y0, 0.0, ts,
+                                       1e-10, 1e-10, 100000, nullptr, theta, x,
+                                       1);
+  auto y_adj = stan::math::ode_adjoint_tol(harmonic_oscillator(), y0, 0.0, ts,
+                                           1e-10, 1e-10, 100000, nullptr,
+                                           theta, x, 1);
+  ASSERT_EQ(y_bdf.size(), y_adj.size());
+  for (size_t n = 0; n < ts.size(); ++n) {
+    EXPECT_MATRIX_NEAR(y_bdf[n], y_adj[n], 1e-8);
+  }
+  stan::math::recover_memory();
+}
+
+TEST(StanMathRevOdeAdjoint, gradients_match_bdf) {
+  using ode_adjoint_test::harmonic_oscillator;
+  using ode_adjoint_test::output_jacobian;
+  using stan::math::var;
+  std::vector<double> ts = {0.5, 1.0, 2.0, 2.0, 5.0};
+  std::vector<double> x = {0.3};
+
+  Eigen::Matrix<var, -1, 1> y0_bdf(2);
+  y0_bdf << 1.0, 0.5;
+  std::vector<var> theta_bdf = {0.15};
+  auto y_bdf = stan::math::ode_bdf_tol(harmonic_oscillator(), y0_bdf, 0.0, ts,
+                                       1e-10, 1e-10, 100000, nullptr,
+                                       theta_bdf, x, 1);
+  Eigen::MatrixXd J_bdf
+      = output_jacobian(y_bdf, {y0_bdf(0), y0_bdf(1), theta_bdf[0]});
+
+  Eigen::Matrix<var, -1, 1> y0_adj(2);
+  y0_adj << 1.0, 0.5;
+  std::vector<var> theta_adj = {0.15};
+  auto y_adj = stan::math::ode_adjoint_tol(harmonic_oscillator(), y0_adj, 0.0,
+                                           ts, 1e-10, 1e-10, 100000, nullptr,
+                                           theta_adj, x, 1);
+  Eigen::MatrixXd J_adj
+      = output_jacobian(y_adj, {y0_adj(0), y0_adj(1), theta_adj[0]});
+
+  EXPECT_MATRIX_NEAR(J_bdf, J_adj, 1e-6);
+  stan::math::recover_memory();
+}
+
+TEST(StanMathRevOdeAdjoint, gradients_of_times_match_bdf) {
+  using ode_adjoint_test::harmonic_oscillator;
+  using ode_adjoint_test::output_jacobian;
+  using stan::math::var;
+  Eigen::VectorXd y0(2);
+  y0 << 1.0, 0.5;
+  std::vector<double> theta = {0.15};
+  std::vector<double> x = {0.3};
+
+  var t0_bdf = 0.1;
+  std::vector<var> ts_bdf = {0.5, 1.0, 2.0};
+  auto y_bdf = stan::math::ode_bdf_tol(harmonic_oscillator(), y0, t0_bdf,
+                                       ts_bdf, 1e-10, 1e-10, 100000, nullptr,
+                                       theta, x, 1);
+  Eigen::MatrixXd J_bdf
+      = output_jacobian(y_bdf, {t0_bdf, ts_bdf[0], ts_bdf[1], ts_bdf[2]});
+
+  var t0_adj = 0.1;
+  std::vector<var> ts_adj = {0.5, 1.0, 2.0};
+  auto y_adj = stan::math::ode_adjoint_tol(harmonic_oscillator(), y0, t0_adj,
+                                           ts_adj, 1e-10, 1e-10, 100000,
+                                           nullptr, theta, x, 1);
+  Eigen::MatrixXd J_adj
+      = output_jacobian(y_adj, {t0_adj, ts_adj[0], ts_adj[1], ts_adj[2]});
+
+  EXPECT_MATRIX_NEAR(J_bdf, J_adj, 1e-6);
+  stan::math::recover_memory();
+}
+
+TEST(StanMathRevOdeAdjoint, eigen_arguments_and_ctl) {
+  using ode_adjoint_test::linear_kinetics;
+  using ode_adjoint_test::output_jacobian;
+  using stan::math::var;
+  std::vector<double> ts = {0.25, 1.0, 4.0};
+  Eigen::MatrixXd k_val(3, 3);
+  k_val << -1.0, 0.2, 0.0, 1.0, -1.2, 0.1, 0.0, 1.0, -0.1;
+  Eigen::VectorXd y0(3);
+  y0 << 1.0, 0.0, 0.0;
+
+  Eigen::Matrix<var, -1, -1> k_bdf = k_val;
+  var b_bdf = 0.5;
+  auto y_bdf = stan::math::ode_bdf_tol(linear_kinetics(), y0, 0.0, ts, 1e-10,
+                                       1e-10, 100000, nullptr, k_bdf, b_bdf);
+  std::vector<var> vars_bdf(k_bdf.data(), k_bdf.data() + k_bdf.size());
+  vars_bdf.push_back(b_bdf);
+  Eigen::MatrixXd J_bdf = output_jacobian(y_bdf, vars_bdf);
+
+  for (int solver_forward = 1; solver_forward <= 2; ++solver_forward) {
+    for (int interpolation = 1; interpolation <= 2; ++interpolation) {
+      Eigen::Matrix<var, -1, -1> k_adj = k_val;
+      var b_adj = 0.5;
+      auto y_adj = stan::math::ode_adjoint_tol_ctl(
+          linear_kinetics(), y0, 0.0, ts, 1e-10, 1e-10, 1e-10, 1e-10, 1e-10,
+          1e-10, 100000, 10, interpolation, solver_forward, 3 - solver_forward,
+          nullptr, k_adj, b_adj);
+      std::vector<var> vars_adj(k_adj.data(), k_adj.data() + k_adj.size());
+      vars_adj.push_back(b_adj);
+      Eigen::MatrixXd J_adj = output_jacobian(y_adj, vars_adj);
+
+      EXPECT_MATRIX_NEAR(J_bdf, J_adj, 1e-6);
+    }
+  }
+  stan::math::recover_memory();
+}
+
+TEST(StanMathRevOdeAdjoint, gradient_of_function_of_outputs) {
+  using ode_adjoint_test::harmonic_oscillator;
+  using stan::math::var;
+  std::vector<double> ts = {1.0, 2.0, 3.0};
+  std::vector<double> x = {0.3};
+
+  std::vector<double> grad_bdf;
+  std::vector<double> grad_adj;
+  for (int adjoint = 0; adjoint <= 1; ++adjoint) {
+    Eigen::Matrix<var, -1, 1> y0(2);
+    y0 << 1.0, 0.5;
+    std::vector<var> theta = {0.15};
+    auto y = adjoint ? stan::math::ode_adjoint_tol(harmonic_oscillator(), y0,
+                                                   0.0, ts, 1e-10, 1e-10,
+                                                   100000, nullptr, theta, x, 1)
+                     : stan::math::ode_bdf_tol(harmonic_oscillator(), y0, 0.0,
+                                               ts, 1e-10, 1e-10, 100000,
+                                               nullptr, theta, x, 1);
+    var lp = 0;
+    for (size_t n = 0; n < y.size(); ++n) {
+      lp += stan::math::normal_lpdf(y[n], 0.5, 0.1);
+    }
+    lp.grad();
+    std::vector<double>& g = adjoint ? grad_adj : grad_bdf;
+    g = {y0(0).adj(), y0(1).adj(), theta[0].adj()};
+    stan::math::recover_memory();
+  }
+  for (size_t k = 0; k < grad_bdf.size(); ++k) {
+    EXPECT_NEAR(grad_bdf[k], grad_adj[k], 1e-5 * std::fabs(grad_bdf[k]));
+  }
+}
+
+TEST(StanMathRevOdeAdjoint, errors) {
+  using ode_adjoint_test::harmonic_oscillator;
+  Eigen::VectorXd y0(2);
+  y0 << 1.0, 0.5;
+  std::vector<double> theta = {0.15};
+  std::vector<double> x = {0.3};
+  std::vector<double> ts = {0.5, 1.0};
+  std::vector<double> ts_unsorted = {1.0, 0.5};
+
+  auto solve = [&](double rtol, long int num_checkpoints,  // NOLINT
+                   int interpolation, int solver_forward, int solver_backward) {
+    return stan::math::ode_adjoint_tol_ctl(
+        harmonic_oscillator(), y0, 0.0, ts, rtol, 1e-8, 1e-8, 1e-8, 1e-8, 1e-8,
+        100000, num_checkpoints, interpolation, solver_forward,
+        solver_backward, nullptr, theta, x, 1);
+  };
+  EXPECT_NO_THROW(solve(1e-8, 150, 1, 2, 2));
+  EXPECT_THROW(solve(-1, 150, 1, 2, 2), std::domain_error);
+  EXPECT_THROW(solve(1e-8, 0, 1, 2, 2), std::domain_error);
+  EXPECT_THROW(solve(1e-8, 150, 3, 2, 2), std::domain_error);
+  EXPECT_THROW(solve(1e-8, 150, 1, 0, 2), std::domain_error);
+  EXPECT_THROW(solve(1e-8, 150, 1, 2, 3), std::domain_error);
+
+  EXPECT_THROW(stan::math::ode_adjoint_tol(harmonic_oscillator(), y0, 0.0,
+                                           ts_unsorted, 1e-8, 1e-8, 100000,
+                                           nullptr, theta, x, 1),
+               std::domain_error);
+  EXPECT_THROW(stan::math::ode_adjoint_tol(harmonic_oscillator(), y0, 2.0, ts,
+                                           1e-8, 1e-8, 100000, nullptr, theta,
+                                           x, 1),
+               std::domain_error);
+  std::vector<double> theta_inf = {stan::math::INFTY};
+  EXPECT_THROW(stan::math::ode_adjoint_tol(harmonic_oscillator(), y0, 0.0, ts,
+                                           1e-8, 1e-8, 100000, nullptr,
+                                           theta_inf, x, 1),
+               std::domain_error);
+  std::vector<double> ts_far = {1e6};
+  EXPECT_THROW_MSG(stan::math::ode_adjoint_tol(harmonic_oscillator(), y0, 0.0,
+                                               ts_far, 1e-8, 1e-8, 100,
+                                               nullptr, theta, x, 1),
+                   std::domain_error,
+                   "Failed to integrate to next output time");
+  stan::math::recover_memory();
+}
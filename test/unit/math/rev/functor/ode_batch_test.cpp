@@ -0,0 +1,246 @@
+#include <stan/math/rev.hpp>
+#include <gtest/gtest.h>
+#include <test/unit/util.hpp>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace ode_batch_test {
+
+struct damped_oscillator {
+  template <typename T0, typename T_y, typename T_theta>
+  inline Eigen::Matrix<stan::return_type_t<T0, T_y, T_theta>, Eigen::Dynamic,
+                       1>
+  operator()(const T0& t, const Eigen::Matrix<T_y, Eigen::Dynamic, 1>& y,
+             std::ostream* msgs, const std::vector<T_theta>& theta,
+             int print) const {
+    if (print && msgs) {
+      *msgs << "subject " << print << std::endl;
+    }
+    Eigen::Matrix<stan::return_type_t<T0, T_y, T_theta>, Eigen::Dynamic, 1>
+        dy_dt(2);
+    dy_dt << y(1), -theta[1] * y(0) - theta[0] * y(1);
+    return dy_dt;
+  }
+};
+
+struct subjects {
+  std::vector<Eigen::VectorXd> y0;
+  std::vector<double> t0;
+  std::vector<std::vector<double>> ts;
+  std::vector<std::vector<double>> theta;
+  std::vector<int> print;
+
+  explicit subjects(int K) {
+    for (int k = 0; k < K; ++k) {
+      Eigen::VectorXd y0_k(2);
+      y0_k << 1.0 + 0.1 * k, -0.5;
+      y0.push_back(y0_k);
+      t0.push_back(0.1 * (k % 3));
+      ts.push_back({0.5, 1.0 + 0.2 * k, 3.0});
+      theta.push_back({0.1 + 0.05 * k, 1.0 + 0.3 * k});
+      print.push_back(0);
+    }
+  }
+};
+
+// gradients of every output with respect to the initial states and the
+// parameters of all the subjects
+inline Eigen::MatrixXd output_jacobian(
+    const std::vector<std::vector<Eigen::Matrix<stan::math::var, -1, 1>>>& y,
+    const std::vector<Eigen::Matrix<stan::math::var, -1, 1>>& y0,
+    const std::vector<std::vector<stan::math::var>>& theta) {
+  std::vector<stan::math::var> vars;
+  for (size_t k = 0; k < y0.size(); ++k) {
+    vars.insert(vars.end(), y0[k].data(), y0[k].data() + y0[k].size());
+    vars.insert(vars.end(), theta[k].begin(), theta[k].end());
+  }
+  std::vector<stan::math::var> outputs;
+  for (const auto& y_k : y) {
+    for (const auto& y_kn : y_k) {
+      outputs.insert(outputs.end(), y_kn.data(), y_kn.data() + y_kn.size());
+    }
+  }
+  Eigen::MatrixXd J(outputs.size(), vars.size());
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    stan::math::set_zero_all_adjoints();
+    stan::math::grad(outputs[i].vi_);
+    for (size_t j = 0; j < vars.size(); ++j) {
+      J(i, j) = vars[j].adj();
+    }
+  }
+  return J;
+}
+
+}  // namespace ode_batch_test
+
+TEST(StanMathRevOdeBatch, bdf_matches_one_solve_per_subject) {
+  using stan::math::var;
+  ode_batch_test::subjects s(7);
+  std::vector<Eigen::Matrix<var, -1, 1>> y0;
+  std::vector<std::vector<var>> theta;
+  for (size_t k = 0; k < s.y0.size(); ++k) {
+    y0.push_back(stan::math::to_var(s.y0[k]));
+    theta.push_back(stan::math::to_var(s.theta[k]));
+  }
+
+  std::vector<std::vector<Eigen::Matrix<var, -1, 1>>> y_serial;
+  for (size_t k = 0; k < s.y0.size(); ++k) {
+    y_serial.push_back(stan::math::ode_bdf_tol(
+        ode_batch_test::damped_oscillator(), y0[k], s.t0[k], s.ts[k], 1e-8,
+        1e-8, 10000, nullptr, theta[k], s.print[k]));
+  }
+  auto y_batch = stan::math::ode_bdf_batch_tol(
+      ode_batch_test::damped_oscillator(), y0, s.t0, s.ts, 1e-8, 1e-8, 10000,
+      nullptr, theta, s.print);
+
+  ASSERT_EQ(y_serial.size(), y_batch.size());
+  for (size_t k = 0; k < y_serial.size(); ++k) {
+    ASSERT_EQ(y_serial[k].size(), y_batch[k].size());
+    for (size_t n = 0; n < y_serial[k].size(); ++n) {
+      EXPECT_MATRIX_NEAR(stan::math::value_of(y_serial[k][n]),
+                         stan::math::value_of(y_batch[k][n]), 1e-12);
+    }
+  }
+  EXPECT_MATRIX_NEAR(ode_batch_test::output_jacobian(y_serial, y0, theta),
+                     ode_batch_test::output_jacobian(y_batch, y0, theta),
+                     1e-12);
+  stan::math::recover_memory();
+}
+
+TEST(StanMathRevOdeBatch, rk45_matches_one_solve_per_subject) {
+  using stan::math::var;
+  ode_batch_test::subjects s(5);
+  std::vector<Eigen::Matrix<var, -1, 1>> y0;
+  std::vector<std::vector<var>> theta;
+  for (size_t k = 0; k < s.y0.size(); ++k) {
+    y0.push_back(stan::math::to_var(s.y0[k]));
+    theta.push_back(stan::math::to_var(s.theta[k]));
+  }
+
+  std::vector<std::vector<Eigen::Matrix<var, -1, 1>>> y_serial;
+  for (size_t k = 0; k < s.y0.size(); ++k) {
+    y_serial.push_back(stan::math::ode_rk45(ode_batch_test::damped_oscillator(),
+                                            y0[k], s.t0[k], s.ts[k], nullptr,
+                                            theta[k], s.print[k]));
+  }
+  auto y_batch
+      = stan::math::ode_rk45_batch(ode_batch_test::damped_oscillator(), y0,
+                                   s.t0, s.ts, nullptr, theta, s.print);
+
+  ASSERT_EQ(y_serial.size(), y_batch.size());
+  for (size_t k = 0; k < y_serial.size(); ++k) {
+    for (size_t n = 0; n < y_serial[k].size(); ++n) {
+      EXPECT_MATRIX_NEAR(stan::math::value_of(y_serial[k][n]),
+                         stan::math::value_of(y_batch[k][n]), 1e-12);
+    }
+  }
+  EXPECT_MATRIX_NEAR(ode_batch_test::output_jacobian(y_serial, y0, theta),
+                     ode_batch_test::output_jacobian(y_batch, y0, theta),
+                     1e-12);
+  stan::math::recover_memory();
+}
+
+TEST(StanMathRevOdeBatch, var_times) {
+  using stan::math::var;
+  ode_batch_test::subjects s(3);
+  std::vector<var> t0 = stan::math::to_var(s.t0);
+  std::vector<std::vector<var>> ts;
+  for (const auto& ts_k : s.ts) {
+    ts.push_back(stan::math::to_var(ts_k));
+  }
+  auto y_batch = stan::math::ode_bdf_batch(ode_batch_test::damped_oscillator(),
+                                           s.y0, t0, ts, nullptr, s.theta,
+                                           s.print);
+  for (size_t k = 0; k < s.y0.size(); ++k) {
+    auto y_k = stan::math::ode_bdf(ode_batch_test::damped_oscillator(),
+                                   s.y0[k], t0[k], ts[k], nullptr, s.theta[k],
+                                   s.print[k]);
+    for (size_t n = 0; n < y_k.size(); ++n) {
+      for (int i = 0; i < y_k[n].size(); ++i) {
+        stan::math::set_zero_all_adjoints();
+        stan::math::grad(y_k[n](i).vi_);
+        const double dt0 = t0[k].adj();
+        const double dt = ts[k][n].adj();
+        stan::math::set_zero_all_adjoints();
+        stan::math::grad(y_batch[k][n](i).vi_);
+        EXPECT_NEAR(dt0, t0[k].adj(), 1e-10);
+        EXPECT_NEAR(dt, ts[k][n].adj(), 1e-10);
+      }
+    }
+  }
+  stan::math::recover_memory();
+}
+
+TEST(StanMathRevOdeBatch, double_arguments) {
+  ode_batch_test::subjects s(4);
+  auto y_batch = stan::math::ode_bdf_batch(ode_batch_test::damped_oscillator(),
+                                           s.y0, s.t0, s.ts, nullptr, s.theta,
+                                           s.print);
+  EXPECT_EQ(stan::math::ChainableStack::instance_->var_stack_.size(), 0);
+  for (size_t k = 0; k < s.y0.size(); ++k) {
+    auto y_k = stan::math::ode_bdf(ode_batch_test::damped_oscillator(),
+                                   s.y0[k], s.t0[k], s.ts[k], nullptr,
+                                   s.theta[k], s.print[k]);
+    for (size_t n = 0; n < y_k.size(); ++n) {
+      EXPECT_MATRIX_NEAR(y_k[n], y_batch[k][n], 1e-12);
+    }
+  }
+  auto y_empty = stan::math::ode_rk45_batch(
+      ode_batch_test::damped_oscillator(), std::vector<Eigen::VectorXd>{},
+      std::vector<double>{}, std::vector<std::vector<double>>{}, nullptr,
+      std::vector<std::vector<double>>{}, std::vector<int>{});
+  EXPECT_EQ(y_empty.size(), 0);
+}
+
+TEST(StanMathRevOdeBatch, messages_in_subject_order) {
+  ode_batch_test::subjects s(3);
+  s.print = {1, 2, 3};
+  s.ts = {{0.5}, {0.5}, {0.5}};
+  std::stringstream msgs;
+  stan::math::ode_rk45_batch(ode_batch_test::damped_oscillator(), s.y0, s.t0,
+                             s.ts, &msgs, s.theta, s.print);
+  const std::string out = msgs.str();
+  EXPECT_LT(out.find("subject 1"), out.find("subject 2"));
+  EXPECT_LT(out.find("subject 2"), out.find("subject 3"));
+  EXPECT_NE(out.find("subject 3"), std::string::npos);
+}
+
+TEST(StanMathRevOdeBatch, errors) {
+  using stan::math::var;
+  ode_batch_test::subjects s(3);
+  ode_batch_test::subjects s2(2);
+  EXPECT_THROW(stan::math::ode_bdf_batch(ode_batch_test::damped_oscillator(),
+                                         s.y0, s2.t0, s.ts, nullptr, s.theta,
+                                         s.print),
+               std::invalid_argument);
+  EXPECT_THROW(stan::math::ode_bdf_batch(ode_batch_test::damped_oscillator(),
+                                         s.y0, s.t0, s2.ts, nullptr, s.theta,
+                                         s.print),
+               std::invalid_argument);
+  EXPECT_THROW(stan::math::ode_rk45_batch(ode_batch_test::damped_oscillator(),
+                                          s.y0, s.t0, s.ts, nullptr, s2.theta,
+                                          s.print),
+               std::invalid_argument);
+
+  // an error of one subject leaves the tape of the caller as it was
+  std::vector<std::vector<var>> theta;
+  for (const auto& theta_k : s.theta) {
+    theta.push_back(stan::math::to_var(theta_k));
+  }
+  s.ts[1] = {0.5, 0.4};
+  const size_t stack_size
+      = stan::math::ChainableStack::instance_->var_stack_.size();
+  EXPECT_THROW(stan::math::ode_bdf_batch(ode_batch_test::damped_oscillator(),
+                                         s.y0, s.t0, s.ts, nullptr, theta,
+                                         s.print),
+               std::domain_error);
+  EXPECT_EQ(stan::math::ChainableStack::instance_->var_stack_.size(),
+            stack_size);
+  EXPECT_THROW(stan::math::ode_rk45_batch_tol(
+                   ode_batch_test::damped_oscillator(), s2.y0, s2.t0, s2.ts,
+                   1e-6, 1e-6, 1, nullptr, s2.theta, s2.print),
+               std::domain_error);
+  stan::math::recover_memory();
+}
@@ -0,0 +1,167 @@
+#include <stan/math/rev.hpp>
+#include <gtest/gtest.h>
+#include <test/unit/util.hpp>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace ode_rk_dense_output_test {
+
+int num_rhs_calls = 0;
+
+// harmonic oscillator y'' = -omega^2 y with y(0) = 1, y'(0) = 0
+struct oscillator {
+  template <typename T0, typename T_y, typename T_omega>
+  inline Eigen::Matrix<stan::return_type_t<T0, T_y, T_omega>, Eigen::Dynamic,
+                       1>
+  operator()(const T0& t, const Eigen::Matrix<T_y, Eigen::Dynamic, 1>& y,
+             std::ostream* msgs, const T_omega& omega) const {
+    ++num_rhs_calls;
+    Eigen::Matrix<stan::return_type_t<T0, T_y, T_omega>, Eigen::Dynamic, 1>
+        dy_dt(2);
+    dy_dt << y(1), -omega * omega * y(0);
+    return dy_dt;
+  }
+};
+
+inline std::vector<double> output_times(int n) {
+  std::vector<double> ts(n);
+  for (int i = 0; i < n; ++i) {
+    ts[i] = 10.0 * (i + 1) / n;
+  }
+  return ts;
+}
+
+inline stan::math::ode_rk_control control(bool dense_output) {
+  stan::math::ode_rk_control control;
+  control.relative_tolerance = 1e-8;
+  control.absolute_tolerance = 1e-8;
+  control.dense_output = dense_output;
+  return control;
+}
+
+// compares the states and their derivatives with respect to omega with
+// the exact solution, solved with tolerances 1e-8, for which the errors of
+// a fourth order interpolant stay below 1e-7 and those of a cubic Hermite
+// interpolant reach 1e-6
+template <typename Solver>
+void expect_exact(const Solver& solve, double tol) {
+  using stan::math::var;
+  const double omega_val = 1.3;
+  const std::vector<double> ts = output_times(500);
+  var omega = omega_val;
+  Eigen::VectorXd y0(2);
+  y0 << 1.0, 0.0;
+  auto y = solve(y0, ts, omega);
+  ASSERT_EQ(y.size(), ts.size());
+  for (size_t n = 0; n < ts.size(); ++n) {
+    const double t = ts[n];
+    EXPECT_NEAR(std::cos(omega_val * t), y[n](0).val(), tol);
+    EXPECT_NEAR(-omega_val * std::sin(omega_val * t), y[n](1).val(), tol);
+    stan::math::set_zero_all_adjoints();
+    stan::math::grad(y[n](0).vi_);
+    EXPECT_NEAR(-t * std::sin(omega_val * t), omega.adj(), 10 * tol);
+  }
+  stan::math::recover_memory();
+}
+
+}  // namespace ode_rk_dense_output_test
+
+TEST(StanMathRevOdeRkDenseOutput, ckrk_dense_matches_exact) {
+  using ode_rk_dense_output_test::control;
+  using ode_rk_dense_output_test::oscillator;
+  for (bool dense_output : {true, false}) {
+    ode_rk_dense_output_test::expect_exact(
+        [&](const auto& y0, const auto& ts, const auto& omega) {
+          return stan::math::ode_ckrk_tol(oscillator(), y0, 0.0, ts,
+                                          control(dense_output), nullptr,
+                                          omega);
+        },
+        1e-7);
+  }
+}
+
+TEST(StanMathRevOdeRkDenseOutput, rk45_dense_matches_exact) {
+  using ode_rk_dense_output_test::control;
+  using ode_rk_dense_output_test::oscillator;
+  for (bool dense_output : {true, false}) {
+    ode_rk_dense_output_test::expect_exact(
+        [&](const auto& y0, const auto& ts, const auto& omega) {
+          return stan::math::ode_rk45_tol(oscillator(), y0, 0.0, ts,
+                                          control(dense_output), nullptr,
+                                          omega);
+        },
+        1e-7);
+  }
+}
+
+TEST(StanMathRevOdeRkDenseOutput, dense_output_takes_fewer_steps) {
+  using ode_rk_dense_output_test::control;
+  using ode_rk_dense_output_test::num_rhs_calls;
+  using ode_rk_dense_output_test::oscillator;
+  Eigen::VectorXd y0(2);
+  y0 << 1.0, 0.0;
+  const std::vector<double> ts = ode_rk_dense_output_test::output_times(2000);
+
+  num_rhs_calls = 0;
+  stan::math::ode_ckrk_tol(oscillator(), y0, 0.0, ts, control(true), nullptr,
+                           1.3);
+  const int num_rhs_calls_dense = num_rhs_calls;
+  num_rhs_calls = 0;
+  stan::math::ode_ckrk_tol(oscillator(), y0, 0.0, ts, control(false), nullptr,
+                           1.3);
+  EXPECT_LT(10 * num_rhs_calls_dense, num_rhs_calls);
+
+  // the overloads without control keep stepping to every output time
+  num_rhs_calls = 0;
+  stan::math::ode_ckrk(oscillator(), y0, 0.0, ts, nullptr, 1.3);
+  const int num_rhs_calls_ckrk = num_rhs_calls;
+  auto control_default = control(false);
+  control_default.relative_tolerance = 1e-6;
+  control_default.absolute_tolerance = 1e-6;
+  num_rhs_calls = 0;
+  stan::math::ode_ckrk_tol(oscillator(), y0, 0.0, ts, control_default,
+                           nullptr, 1.3);
+  EXPECT_EQ(num_rhs_calls_ckrk, num_rhs_calls);
+}
+
+TEST(StanMathRevOdeRkDenseOutput, output_times_between_and_at_steps) {
+  using ode_rk_dense_output_test::control;
+  using ode_rk_dense_output_test::oscillator;
+  Eigen::VectorXd y0(2);
+  y0 << 1.0, 0.0;
+  // repeated times and a single time close to the initial time
+  std::vector<double> ts = {1e-8, 0.5, 0.5, 2.0, 2.0, 7.5};
+  auto y = stan::math::ode_ckrk_tol(oscillator(), y0, 0.0, ts, control(true),
+                                    nullptr, 1.3);
+  for (size_t n = 0; n < ts.size(); ++n) {
+    EXPECT_NEAR(std::cos(1.3 * ts[n]), y[n](0), 1e-6);
+  }
+}
+
+TEST(StanMathRevOdeRkDenseOutput, errors) {
+  using ode_rk_dense_output_test::control;
+  using ode_rk_dense_output_test::oscillator;
+  Eigen::VectorXd y0(2);
+  y0 << 1.0, 0.0;
+  const std::vector<double> ts = ode_rk_dense_output_test::output_times(10);
+
+  auto tolerance = control(true);
+  tolerance.relative_tolerance = -1;
+  EXPECT_THROW(stan::math::ode_ckrk_tol(oscillator(), y0, 0.0, ts, tolerance,
+                                        nullptr, 1.3),
+               std::domain_error);
+  EXPECT_THROW(stan::math::ode_rk45_tol(oscillator(), y0, 0.0, ts, tolerance,
+                                        nullptr, 1.3),
+               std::domain_error);
+
+  auto steps = control(true);
+  steps.max_num_steps = 2;
+  EXPECT_THROW(stan::math::ode_ckrk_tol(oscillator(), y0, 0.0, ts, steps,
+                                        nullptr, 1.3),
+               std::domain_error);
+  EXPECT_THROW(stan::math::ode_rk45_tol(oscillator(), y0, 0.0, ts, steps,
+                                        nullptr, 1.3),
+               std::domain_error);
+}
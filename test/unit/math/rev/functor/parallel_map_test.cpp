@@ -0,0 +1,123 @@
+#include <stan/math/rev.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <vector>
+
+struct parallel_map_job {
+  template <typename T1, typename T2>
+  inline auto operator()(int i, std::ostream* msgs, const std::vector<T1>& y,
+                         const T2& mu, double sigma) const {
+    if (i == 0 && msgs) {
+      *msgs << "first job";
+    }
+    return stan::math::normal_lpdf(y[i], mu, sigma)
+           + stan::math::square(y[i] - mu);
+  }
+};
+
+TEST(RevFunctor, parallel_map_values_and_gradient) {
+  using stan::math::var;
+  std::vector<double> y_val{0.5, -1.2, 3.1, 0.7, 2.2, -0.3, 1.1};
+  const double mu_val = 0.4;
+  const double sigma = 1.3;
+
+  std::vector<var> y_ref(y_val.begin(), y_val.end());
+  var mu_ref = mu_val;
+  std::vector<double> res_ref(y_ref.size());
+  var total_ref = 0;
+  for (size_t i = 0; i < y_ref.size(); ++i) {
+    var res_i = parallel_map_job()(i, nullptr, y_ref, mu_ref, sigma);
+    res_ref[i] = res_i.val();
+    total_ref += (i + 1.0) * res_i;
+  }
+  total_ref.grad();
+  const double mu_adj_ref = mu_ref.adj();
+  std::vector<double> y_adj_ref(y_ref.size());
+  for (size_t i = 0; i < y_ref.size(); ++i) {
+    y_adj_ref[i] = y_ref[i].adj();
+  }
+  stan::math::recover_memory();
+
+  for (int grainsize : {1, 2, 3, 10}) {
+    std::vector<var> y(y_val.begin(), y_val.end());
+    var mu = mu_val;
+    std::stringstream msgs;
+    std::vector<var> res = stan::math::parallel_map(
+        parallel_map_job(), y.size(), grainsize, &msgs, y, mu, sigma);
+    EXPECT_EQ("first job", msgs.str());
+    ASSERT_EQ(y.size(), res.size());
+
+    var total = 0;
+    for (size_t i = 0; i < res.size(); ++i) {
+      EXPECT_FLOAT_EQ(res_ref[i], res[i].val());
+      total += (i + 1.0) * res[i];
+    }
+    total.grad();
+
+    EXPECT_FLOAT_EQ(mu_adj_ref, mu.adj());
+    for (size_t i = 0; i < y.size(); ++i) {
+      EXPECT_FLOAT_EQ(y_adj_ref[i], y[i].adj());
+    }
+    stan::math::recover_memory();
+  }
+}
+
+TEST(RevFunctor, parallel_map_repeated_gradients) {
+  using stan::math::var;
+  std::vector<var> y{1.0, 2.0, 3.0};
+  var mu = 0.5;
+  std::vector<var> res = stan::math::parallel_map(parallel_map_job(), 3, 1,
+                                                  nullptr, y, mu, 1.0);
+  for (int n = 0; n < 3; ++n) {
+    stan::math::set_zero_all_adjoints();
+    res[n].grad();
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_FLOAT_EQ(i == n ? -(y[i].val() - 0.5) + 2 * (y[i].val() - 0.5)
+                             : 0.0,
+                      y[i].adj());
+    }
+    EXPECT_FLOAT_EQ((y[n].val() - 0.5) - 2 * (y[n].val() - 0.5), mu.adj());
+  }
+  stan::math::recover_memory();
+}
+
+TEST(RevFunctor, parallel_map_data) {
+  std::vector<double> y{1.0, 2.0};
+  std::vector<double> res = stan::math::parallel_map(parallel_map_job(), 2, 1,
+                                                     nullptr, y, 0.0, 1.0);
+  EXPECT_FLOAT_EQ(stan::math::normal_lpdf(2.0, 0.0, 1.0) + 4.0, res[1]);
+}
+
+TEST(RevFunctor, parallel_map_errors) {
+  using stan::math::var;
+  std::vector<var> y{1.0, 2.0};
+  var mu = 0.0;
+  EXPECT_THROW(
+      stan::math::parallel_map(parallel_map_job(), 2, 0, nullptr, y, mu, 1.0),
+      std::domain_error);
+  EXPECT_THROW(
+      stan::math::parallel_map(parallel_map_job(), 2, 1, nullptr, y, mu, -1.0),
+      std::domain_error);
+  EXPECT_TRUE(stan::math::parallel_map(parallel_map_job(), 0, 1, nullptr, y,
+                                       mu, 1.0)
+                  .empty());
+  stan::math::recover_memory();
+}
+
+TEST(RevFunctor, parallel_map_reuses_segments) {
+  using stan::math::var;
+  auto& pool = stan::math::internal::independent_tape_segment_pool();
+  stan::math::recover_memory();
+  pool.clear();
+  for (int n = 0; n < 3; ++n) {
+    std::vector<var> y{1.0, 2.0, 3.0, 4.0};
+    var mu = 0.5;
+    std::vector<var> res = stan::math::parallel_map(parallel_map_job(), 4, 2,
+                                                    nullptr, y, mu, 1.0);
+    EXPECT_TRUE(pool.empty());
+    res[1].grad();
+    EXPECT_FLOAT_EQ(-(2.0 - 0.5) + 2 * (2.0 - 0.5), y[1].adj());
+    stan::math::recover_memory();
+    EXPECT_EQ(2, pool.size());
+  }
+}
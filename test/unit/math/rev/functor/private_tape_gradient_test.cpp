@@ -0,0 +1,171 @@
+// This file builds as its own program, so defining STAN_COMPACT_TAPE here
+// keeps it the same in all its translation units
+#ifndef STAN_COMPACT_TAPE
+#define STAN_COMPACT_TAPE
+#endif
+#include <stan/math/rev.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+
+using Eigen::Dynamic;
+using Eigen::Matrix;
+using Eigen::VectorXd;
+
+// uses every operation of the compact tape
+struct pt_fun1 {
+  template <typename T>
+  inline T operator()(const Matrix<T, Dynamic, 1>& x) const {
+    using stan::math::exp;
+    using stan::math::log;
+    using stan::math::sqrt;
+    using stan::math::square;
+    T y = exp(x(0) * x(1)) / (x(0) - x(1)) + log(x(0)) + sqrt(x(1));
+    y = y + square(x(0)) - 2.0 * x(1) + 3.0 / x(0) - x(1) / 4.0;
+    return y + (1.5 - x(0)) + (x(1) - 0.5) + (x(0) + 2.0) - (-x(1));
+  }
+};
+
+// branches on the value of its argument
+struct pt_fun_branch {
+  template <typename T>
+  inline T operator()(const Matrix<T, Dynamic, 1>& x) const {
+    if (x(0) > 0) {
+      return x(0) * x(1);
+    }
+    return stan::math::exp(x(0)) + x(1) * x(1) * x(1);
+  }
+};
+
+struct pt_fun_throw {
+  template <typename T>
+  inline T operator()(const Matrix<T, Dynamic, 1>& x) const {
+    if (x(0) < 0) {
+      throw std::domain_error("negative");
+    }
+    return x.sum();
+  }
+};
+
+// sin is not an operation of the compact tape
+struct pt_fun_sin {
+  template <typename T>
+  inline T operator()(const Matrix<T, Dynamic, 1>& x) const {
+    return stan::math::sin(x(0)) * x(1);
+  }
+};
+
+TEST(RevFunctor, private_tape_gradient_replays) {
+  stan::math::private_tape_gradient<pt_fun1> g{pt_fun1()};
+  for (int n = 0; n < 5; ++n) {
+    VectorXd x(2);
+    x << 2.5 + n, 0.5 + 0.3 * n;
+    double fx;
+    VectorXd grad_fx;
+    g(x, fx, grad_fx);
+
+    double fx_ref;
+    VectorXd grad_fx_ref;
+    stan::math::gradient(pt_fun1(), x, fx_ref, grad_fx_ref);
+    EXPECT_FLOAT_EQ(fx_ref, fx);
+    EXPECT_EQ(2, grad_fx.size());
+    EXPECT_FLOAT_EQ(grad_fx_ref(0), grad_fx(0));
+    EXPECT_FLOAT_EQ(grad_fx_ref(1), grad_fx(1));
+  }
+  EXPECT_TRUE(g.replayable());
+  EXPECT_EQ(5, g.num_evaluations());
+  EXPECT_EQ(1, g.num_recordings());
+}
+
+TEST(RevFunctor, private_tape_gradient_leaves_global_tape) {
+  stan::math::recover_memory();
+  stan::math::var a = 2.0;
+  size_t stack_size = stan::math::ChainableStack::instance_->var_stack_.size();
+
+  stan::math::private_tape_gradient<pt_fun1> g{pt_fun1()};
+  VectorXd x(2);
+  x << 1, 2;
+  double fx;
+  VectorXd grad_fx;
+  g(x, fx, grad_fx);
+  g(x, fx, grad_fx);
+
+  EXPECT_EQ(stack_size,
+            stan::math::ChainableStack::instance_->var_stack_.size());
+  EXPECT_TRUE(stan::math::empty_nested());
+  EXPECT_FLOAT_EQ(2.0, a.val());
+  stan::math::recover_memory();
+}
+
+TEST(RevFunctor, private_tape_gradient_records_on_branch) {
+  stan::math::private_tape_gradient<pt_fun_branch> g{pt_fun_branch()};
+  VectorXd x(2);
+  double fx;
+  VectorXd grad_fx;
+
+  x << 1.5, 2.0;
+  g(x, fx, grad_fx);
+  EXPECT_FLOAT_EQ(3.0, fx);
+  EXPECT_FLOAT_EQ(2.0, grad_fx(0));
+  EXPECT_FLOAT_EQ(1.5, grad_fx(1));
+
+  x << -1.0, 2.0;
+  g(x, fx, grad_fx);
+  EXPECT_FLOAT_EQ(std::exp(-1.0) + 8.0, fx);
+  EXPECT_FLOAT_EQ(std::exp(-1.0), grad_fx(0));
+  EXPECT_FLOAT_EQ(12.0, grad_fx(1));
+  EXPECT_EQ(2, g.num_recordings());
+
+  x << -2.0, 1.0;
+  g(x, fx, grad_fx);
+  EXPECT_FLOAT_EQ(std::exp(-2.0) + 1.0, fx);
+  EXPECT_FLOAT_EQ(std::exp(-2.0), grad_fx(0));
+  EXPECT_FLOAT_EQ(3.0, grad_fx(1));
+  EXPECT_EQ(3, g.num_evaluations());
+  EXPECT_EQ(2, g.num_recordings());
+}
+
+TEST(RevFunctor, private_tape_gradient_records_on_size) {
+  stan::math::private_tape_gradient<pt_fun_throw> g{pt_fun_throw()};
+  double fx;
+  VectorXd grad_fx;
+  VectorXd x = VectorXd::Ones(3);
+  g(x, fx, grad_fx);
+  EXPECT_FLOAT_EQ(3.0, fx);
+  x = VectorXd::Ones(4);
+  g(x, fx, grad_fx);
+  EXPECT_FLOAT_EQ(4.0, fx);
+  EXPECT_EQ(4, grad_fx.size());
+  EXPECT_EQ(2, g.num_recordings());
+}
+
+TEST(RevFunctor, private_tape_gradient_records_unsupported) {
+  stan::math::private_tape_gradient<pt_fun_sin> g{pt_fun_sin()};
+  double fx;
+  VectorXd grad_fx;
+  VectorXd x(2);
+  for (int n = 0; n < 3; ++n) {
+    x << 0.5 * n, 2.0;
+    g(x, fx, grad_fx);
+    EXPECT_FLOAT_EQ(std::sin(0.5 * n) * 2.0, fx);
+    EXPECT_FLOAT_EQ(std::cos(0.5 * n) * 2.0, grad_fx(0));
+    EXPECT_FLOAT_EQ(std::sin(0.5 * n), grad_fx(1));
+  }
+  EXPECT_FALSE(g.replayable());
+  EXPECT_EQ(3, g.num_recordings());
+}
+
+TEST(RevFunctor, private_tape_gradient_throws) {
+  stan::math::private_tape_gradient<pt_fun_throw> g{pt_fun_throw()};
+  double fx;
+  VectorXd grad_fx;
+  VectorXd x = VectorXd::Ones(3);
+  g(x, fx, grad_fx);
+  x = -VectorXd::Ones(3);
+  EXPECT_THROW(g(x, fx, grad_fx), std::domain_error);
+  x = 2 * VectorXd::Ones(3);
+  g(x, fx, grad_fx);
+  EXPECT_FLOAT_EQ(6.0, fx);
+  EXPECT_FLOAT_EQ(1.0, grad_fx(2));
+  EXPECT_EQ(1, g.num_recordings());
+}
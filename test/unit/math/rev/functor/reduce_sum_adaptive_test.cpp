@@ -0,0 +1,69 @@
+#include <stan/math.hpp>
+#include <test/unit/math/prim/functor/reduce_sum_util.hpp>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+TEST(StanMathRev_reduce_sum_adaptive, value_and_gradient) {
+  using stan::math::var;
+  using stan::math::test::count_lpdf;
+  using stan::math::test::get_new_msg;
+
+  const std::size_t elems = 10000;
+  std::vector<int> data(elems);
+  for (std::size_t i = 0; i != elems; ++i) {
+    data[i] = i;
+  }
+  std::vector<int> idata;
+
+  stan::math::reset_adaptive_grainsizes();
+  for (int n = 0; n < 5; ++n) {
+    var lambda_v = 10.0;
+    std::vector<var> vlambda_v(1, lambda_v);
+    var poisson_lpdf = stan::math::reduce_sum_adaptive<count_lpdf<var>>(
+        data, get_new_msg(), vlambda_v, idata);
+
+    var lambda_ref = 10.0;
+    var poisson_lpdf_ref = stan::math::poisson_lpmf(data, lambda_ref);
+    EXPECT_FLOAT_EQ(value_of(poisson_lpdf), value_of(poisson_lpdf_ref));
+
+    stan::math::grad(poisson_lpdf.vi_);
+    const double lambda_adj = lambda_v.adj();
+    stan::math::set_zero_all_adjoints();
+    stan::math::grad(poisson_lpdf_ref.vi_);
+    EXPECT_FLOAT_EQ(lambda_adj, lambda_ref.adj());
+    stan::math::recover_memory();
+  }
+
+  std::vector<double> vlambda_d(1, 10.0);
+  EXPECT_FLOAT_EQ(stan::math::poisson_lpmf(data, 10.0),
+                  stan::math::reduce_sum_adaptive<count_lpdf<double>>(
+                      data, get_new_msg(), vlambda_d, idata));
+
+  auto grainsizes = stan::math::adaptive_grainsizes();
+#ifdef STAN_THREADS
+  bool found = false;
+  for (const auto& g : grainsizes) {
+    if (g.first.find("count_lpdf<stan::math::var") != std::string::npos) {
+      found = true;
+      EXPECT_EQ(5, g.second.num_evaluations_);
+      EXPECT_LE(1, g.second.grainsize_);
+      EXPECT_LT(0.0, g.second.cost_per_term_);
+    }
+  }
+  EXPECT_TRUE(found);
+#else
+  for (const auto& g : grainsizes) {
+    EXPECT_EQ(0, g.second.num_evaluations_);
+  }
+#endif
+}
+
+TEST(StanMathRev_reduce_sum_adaptive, no_terms) {
+  using stan::math::var;
+  using stan::math::test::sum_lpdf;
+  std::vector<var> data(0);
+  EXPECT_EQ(0.0, stan::math::reduce_sum_adaptive<sum_lpdf>(
+                     data, stan::math::test::get_new_msg())
+                     .val());
+}
@@ -431,3 +431,64 @@ TEST(StanMathRev_reduce_sum, linked_args) {
 
   stan::math::recover_memory();
 }
+
+// every term only uses a few entries of a large shared argument
+struct random_effects_lpdf {
+  template <typename T>
+  inline T operator()(const std::vector<int>& sub_slice, std::size_t start,
+                      std::size_t end, std::ostream* msgs,
+                      const std::vector<T>& effects, const T& sigma) const {
+    T lp = 0;
+    for (std::size_t i = 0; i < sub_slice.size(); ++i) {
+      lp += stan::math::normal_lpdf(effects[sub_slice[i]], 0.0, sigma);
+    }
+    return lp;
+  }
+};
+
+TEST(StanMathRev_reduce_sum, sparse_shared_args) {
+  using stan::math::var;
+  using stan::math::test::get_new_msg;
+  const int num_effects = 1000;
+  std::vector<int> idx(3000);
+  for (std::size_t i = 0; i < idx.size(); ++i) {
+    idx[i] = (7 * i) % num_effects;
+  }
+
+  std::vector<var> effects_ref(num_effects);
+  for (int i = 0; i < num_effects; ++i) {
+    effects_ref[i] = 0.001 * i;
+  }
+  var sigma_ref = 1.5;
+  var lp_ref = random_effects_lpdf()(idx, 0, idx.size() - 1, get_new_msg(),
+                                     effects_ref, sigma_ref);
+  stan::math::grad(lp_ref.vi_);
+  const double lp_val_ref = lp_ref.val();
+  std::vector<double> effects_adj_ref(num_effects);
+  for (int i = 0; i < num_effects; ++i) {
+    effects_adj_ref[i] = effects_ref[i].adj();
+  }
+  const double sigma_adj_ref = sigma_ref.adj();
+  stan::math::recover_memory();
+
+  for (bool is_static : {false, true}) {
+    for (int grainsize : {1, 7, 100}) {
+      std::vector<var> effects(num_effects);
+      for (int i = 0; i < num_effects; ++i) {
+        effects[i] = 0.001 * i;
+      }
+      var sigma = 1.5;
+      var lp = is_static ? stan::math::reduce_sum_static<random_effects_lpdf>(
+                   idx, grainsize, get_new_msg(), effects, sigma)
+                         : stan::math::reduce_sum<random_effects_lpdf>(
+                             idx, grainsize, get_new_msg(), effects, sigma);
+      EXPECT_FLOAT_EQ(lp_val_ref, lp.val());
+      stan::math::grad(lp.vi_);
+      EXPECT_FLOAT_EQ(sigma_adj_ref, sigma.adj());
+      for (int i = 0; i < num_effects; ++i) {
+        EXPECT_FLOAT_EQ(effects_adj_ref[i], effects[i].adj());
+      }
+      stan::math::recover_memory();
+    }
+  }
+}
@@ -0,0 +1,120 @@
+#include <stan/math/rev.hpp>
+#include <test/unit/util.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// discretized reaction diffusion: every output depends on its
+// neighbours, and the last output on all inputs
+struct reaction_diffusion {
+  template <typename T>
+  Eigen::Matrix<T, Eigen::Dynamic, 1> operator()(
+      const Eigen::Matrix<T, Eigen::Dynamic, 1>& x) const {
+    const int n = x.size();
+    Eigen::Matrix<T, Eigen::Dynamic, 1> y(n + 1);
+    for (int i = 0; i < n; ++i) {
+      y(i) = -2 * x(i) - stan::math::exp(x(i)) * x(i);
+      if (i > 0) {
+        y(i) += x(i - 1);
+      }
+      if (i + 1 < n) {
+        y(i) += stan::math::sin(x(i + 1));
+      }
+    }
+    y(n) = stan::math::sum(stan::math::square(x));
+    return y;
+  }
+};
+
+struct non_square {
+  template <typename T>
+  Eigen::Matrix<T, Eigen::Dynamic, 1> operator()(
+      const Eigen::Matrix<T, Eigen::Dynamic, 1>& x) const {
+    Eigen::Matrix<T, Eigen::Dynamic, 1> y(2);
+    y << x(0) * x(2), x(1);
+    return y;
+  }
+};
+
+}  // namespace
+
+TEST(RevFunctor, sparse_jacobian_matches_dense) {
+  const int n = 12;
+  Eigen::VectorXd x = Eigen::VectorXd::LinSpaced(n, -1, 1.5);
+  Eigen::VectorXd fx;
+  Eigen::MatrixXd J;
+  stan::math::jacobian(reaction_diffusion(), x, fx, J);
+
+  Eigen::SparseMatrix<double> pattern
+      = stan::math::jacobian_sparsity(reaction_diffusion(), x);
+  EXPECT_EQ(n + 1, pattern.rows());
+  EXPECT_EQ(n, pattern.cols());
+  EXPECT_EQ(3 * n - 2 + n, pattern.nonZeros());
+
+  Eigen::VectorXd fx_sparse;
+  Eigen::SparseMatrix<double> J_sparse;
+  stan::math::sparse_jacobian(reaction_diffusion(), x, pattern, fx_sparse,
+                              J_sparse);
+  EXPECT_MATRIX_FLOAT_EQ(fx, fx_sparse);
+  EXPECT_EQ(pattern.nonZeros(), J_sparse.nonZeros());
+  EXPECT_MATRIX_FLOAT_EQ(J, Eigen::MatrixXd(J_sparse));
+
+  // the rows of the banded part need three sweeps, the dense row one
+  std::vector<int> colors;
+  Eigen::SparseMatrix<double> pattern_t = pattern.transpose();
+  EXPECT_EQ(4, stan::math::internal::color_columns(pattern_t, colors));
+  EXPECT_EQ(0, stan::math::ChainableStack::instance_->var_stack_.size());
+}
+
+TEST(RevFunctor, sparse_jacobian_given_pattern) {
+  // a pattern with more nonzeros than the Jacobian gives zeros
+  Eigen::VectorXd x(3);
+  x << 2, -1, 4;
+  Eigen::SparseMatrix<double> pattern(2, 3);
+  pattern.insert(0, 0) = 1;
+  pattern.insert(0, 2) = 1;
+  pattern.insert(1, 1) = 1;
+  pattern.insert(1, 2) = 1;
+  Eigen::VectorXd fx;
+  Eigen::SparseMatrix<double> J;
+  stan::math::sparse_jacobian(non_square(), x, pattern, fx, J);
+  Eigen::VectorXd fx_expected(2);
+  fx_expected << 8, -1;
+  Eigen::MatrixXd J_expected(2, 3);
+  J_expected << 4, 0, 2, 0, 1, 0;
+  EXPECT_MATRIX_FLOAT_EQ(fx_expected, fx);
+  EXPECT_EQ(4, J.nonZeros());
+  EXPECT_MATRIX_FLOAT_EQ(J_expected, Eigen::MatrixXd(J));
+}
+
+TEST(RevFunctor, sparse_jacobian_nested) {
+  using stan::math::var;
+  var a = 3;
+  var b = a * a;
+  Eigen::VectorXd x = Eigen::VectorXd::LinSpaced(5, 0.1, 0.9);
+  auto pattern = stan::math::jacobian_sparsity(reaction_diffusion(), x);
+  Eigen::VectorXd fx;
+  Eigen::SparseMatrix<double> J;
+  stan::math::sparse_jacobian(reaction_diffusion(), x, pattern, fx, J);
+  b.grad();
+  EXPECT_FLOAT_EQ(6, a.adj());
+  stan::math::recover_memory();
+}
+
+TEST(RevFunctor, sparse_jacobian_size_mismatch) {
+  Eigen::VectorXd x(3);
+  x << 1, 2, 3;
+  Eigen::VectorXd fx;
+  Eigen::SparseMatrix<double> J;
+  EXPECT_THROW(stan::math::sparse_jacobian(non_square(), x,
+                                           Eigen::SparseMatrix<double>(2, 4),
+                                           fx, J),
+               std::invalid_argument);
+  EXPECT_THROW(stan::math::sparse_jacobian(non_square(), x,
+                                           Eigen::SparseMatrix<double>(3, 3),
+                                           fx, J),
+               std::invalid_argument);
+  EXPECT_EQ(0, stan::math::ChainableStack::instance_->var_stack_.size());
+}